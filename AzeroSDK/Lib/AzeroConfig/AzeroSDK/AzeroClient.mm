@@ -7,6 +7,7 @@
 //
 
 #import "AzeroClient.h"
+#include <AACE/Engine/Alexa/VoiceLatencyTracer.h>
 
 class AlexaClientWrapper : public aace::alexa::AlexaClient {
 public:
@@ -14,6 +15,17 @@ public:
     : w (imp) {};
     
     void dialogStateChanged( DialogState state ) override {
+        using Tracer = aace::engine::alexa::VoiceLatencyTracer;
+        switch( state ) {
+            case DialogState::SPEAKING:
+                Tracer::getInstance()->stamp( Tracer::Stage::PLAYBACK_STARTED );
+                break;
+            case DialogState::IDLE:
+                Tracer::getInstance()->endTurn();
+                break;
+            default:
+                break;
+        }
         [w dialogStateChangedWithState:state];
     }
     
@@ -14,6 +14,7 @@
 #include <AACE/Engine/ContactUploader/ContactUploaderEngineService.h>
 #include <AACE/Engine/Location/LocationEngineService.h>
 #include <AACE/Engine/Logger/LoggerEngineService.h>
+#include <AACE/Engine/Logger/LogLevelFilter.h>
 #include <AACE/Engine/Metrics/MetricsEngineService.h>
 #include <AACE/Engine/Navigation/NavigationEngineService.h>
 #include <AACE/Engine/Network/NetworkEngineService.h>
@@ -61,7 +62,16 @@
         assert(configurationFile != nullptr);
         configurationFiles.push_back(configurationFile);
     }
-    return wrapper->configure(configurationFiles);
+    // drop log entries below every configured sink level before they are built
+    aace::engine::logger::LogLevelFilter::Level level;
+    bool hasLevel = aace::engine::logger::LogLevelFilter::findConfiguredLevel(configurationFiles, &level);
+    if (!wrapper->configure(configurationFiles)) {
+        return false;
+    }
+    if (hasLevel) {
+        aace::engine::logger::LogLevelFilter::setMinimumLevel(level);
+    }
+    return true;
 }
 
 -(bool) start {
@@ -7,6 +7,7 @@
 //
 
 #import "AzeroMetricsUploader.h"
+#include <AACE/Engine/Metrics/MetricsRegistry.h>
 
 class MetricsUploaderWrapper : public aace::metrics::MetricsUploader {
 public:
@@ -30,11 +31,14 @@ private:
 -(AzeroMetricsUploader *) init {
     if (self = [super init]) {
         wrapper = std::make_shared<MetricsUploaderWrapper>(self);
+        // aggregated MetricsRegistry datapoints are reported through the same uploader
+        aace::engine::metrics::MetricsRegistry::getInstance()->setUploader(wrapper);
     }
     return self;
 }
 
 -(void) dealloc {
+    aace::engine::metrics::MetricsRegistry::getInstance()->setUploader(nullptr);
     wrapper.reset();
 }
 
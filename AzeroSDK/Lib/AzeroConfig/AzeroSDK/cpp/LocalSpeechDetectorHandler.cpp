@@ -8,6 +8,7 @@
 #include "LocalSpeechDetectorHandler.h"
 #include "SpeechRecognizerHandler.h"
 #include <AACE/Engine/Core/EngineMacros.h>
+#include <AACE/Engine/Alexa/VoiceLatencyTracer.h>
 
 namespace azeroSDK {
 
@@ -44,28 +45,31 @@ LocalSpeechDetectorHandler::create(
 
 void LocalSpeechDetectorHandler::onWakeWordDetected(
 	int tag, SequenceIdType sequenceId, float angle ) {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
+	auto tracer = aace::engine::alexa::VoiceLatencyTracer::getInstance();
+	tracer->beginTurn();
+	tracer->stamp( aace::engine::alexa::VoiceLatencyTracer::Stage::WAKE_WORD_DETECTED );
 	if ( m_eventHandler ) {
 		m_eventHandler->onWakeWordDetected( tag, sequenceId, angle );
 	}
 }
 
 void LocalSpeechDetectorHandler::onSpeechStartTimeout( int tag, SequenceIdType sequenceId ) {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	if ( m_eventHandler ) {
 		m_eventHandler->onSpeechStartTimeout( tag, sequenceId );
 	}
 }
 
 void LocalSpeechDetectorHandler::onSpeechStartDetected( int tag, SequenceIdType sequenceId ) {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	if ( m_eventHandler ) {
 		m_eventHandler->onSpeechStartDetected( tag, sequenceId );
 	}
 }
 
 void LocalSpeechDetectorHandler::onSpeechStopDetected( int tag, SequenceIdType sequenceId ) {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	if ( m_eventHandler ) {
 		m_eventHandler->onSpeechStopDetected( tag, sequenceId );
 	}
@@ -80,9 +84,13 @@ void LocalSpeechDetectorHandler::onAudioQueryError( SequenceIdType sequenceId, A
 
 bool LocalSpeechDetectorHandler::onAudioQueryStart( SequenceIdType sequenceId ) {
 
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	auto ret = m_speechRecognizer->onAudioQueryStart( sequenceId );
-	SAI_WARN(LX(TAG, __FUNCTION__).d("ret", ret));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__).d("ret", ret));
+	if ( ret ) {
+		aace::engine::alexa::VoiceLatencyTracer::getInstance()->stamp(
+			aace::engine::alexa::VoiceLatencyTracer::Stage::AUDIO_QUERY_STARTED );
+	}
 	if ( m_eventHandler ) {
 		m_eventHandler->onAudioQueryStart( sequenceId, ret );
 	}
@@ -91,7 +99,7 @@ bool LocalSpeechDetectorHandler::onAudioQueryStart( SequenceIdType sequenceId )
 
 void LocalSpeechDetectorHandler::onAudioQueryStop( SequenceIdType sequenceId ) {
 
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	m_speechRecognizer->onAudioQueryStop( sequenceId );
 	if ( m_eventHandler ) {
 		m_eventHandler->onAudioQueryStop( sequenceId );
@@ -104,33 +112,33 @@ size_t LocalSpeechDetectorHandler::onAudioQueryWriteData(
 }
 
 bool LocalSpeechDetectorHandler::onModeChangePrepare( const ModeConfiguration &config ) {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	m_speechRecognizer->enableRemoteInitiation( false );
 	return true;
 }
 
 void LocalSpeechDetectorHandler::onModeChangeCancelled( const ModeConfiguration &config ) {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	m_speechRecognizer->enableRemoteInitiation( true );
 }
 
 void LocalSpeechDetectorHandler::onModeChanged( const ModeConfiguration &config ) {
-	SAI_WARN(LX(TAG, __FUNCTION__).d("ModeConfiguration", config.toString()));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__).d("ModeConfiguration", config.toString()));
 	m_speechRecognizer->enableRemoteInitiation( true );
 }
 
 void LocalSpeechDetectorHandler::onModeChangeFailed() {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	m_speechRecognizer->enableRemoteInitiation( false );
 }
 
 void LocalSpeechDetectorHandler::onModeSystemShutDown() {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 	m_speechRecognizer->enableRemoteInitiation( false );
 }
 
 void LocalSpeechDetectorHandler::onModeExecutionException() {
-	SAI_WARN(LX(TAG, __FUNCTION__));
+	SAI_VERBOSE(LX(TAG, __FUNCTION__));
 }
 
 std::shared_ptr<aace::alexa::SpeechRecognizer>
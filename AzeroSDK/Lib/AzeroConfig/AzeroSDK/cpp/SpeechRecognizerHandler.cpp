@@ -7,6 +7,7 @@
 
 #include "SpeechRecognizerHandler.h"
 #include <AACE/Engine/Core/EngineMacros.h>
+#include <AACE/Engine/Alexa/VoiceLatencyTracer.h>
 
 namespace azeroSDK {
 
@@ -64,6 +65,8 @@ bool SpeechRecognizerHandler::startAudioInput() {
 
 bool SpeechRecognizerHandler::stopAudioInput() {
 	SAI_INFO(LX(TAG, __FUNCTION__));
+	aace::engine::alexa::VoiceLatencyTracer::getInstance()->stamp(
+		getCurrentDialogRequestId(), aace::engine::alexa::VoiceLatencyTracer::Stage::STOP_CAPTURE );
 	bool ret = false;
 	auto detector = m_speechDetector.lock();
 	if (detector) {
@@ -108,6 +111,7 @@ bool SpeechRecognizerHandler::onAudioQueryStart(
 		std::lock_guard<std::mutex> lk( m_mutex );
 		m_AudioQueryStarted = true;
 		m_currentSequenceId = sequenceId;
+		m_firstAudioWritten = false;
 	}
 
 	return ret;
@@ -128,9 +132,16 @@ void SpeechRecognizerHandler::onAudioQueryStop(
 
 size_t SpeechRecognizerHandler::onAudioQueryWriteData(
 		SequenceIdType sequenceId, const char *data, size_t size ) {
-	std::lock_guard<std::mutex> lk( m_mutex );
+	std::unique_lock<std::mutex> lk( m_mutex );
 	if ( m_enableWrite && m_AudioQueryStarted && sequenceId == m_currentSequenceId ) {
 		auto ret = write( reinterpret_cast<const int16_t *>(data), size/sizeof(int16_t) );
+		if ( ret > 0 && !m_firstAudioWritten ) {
+			m_firstAudioWritten = true;
+			lk.unlock();
+			// binds the current turn to the dialogRequestId of the Recognize event
+			aace::engine::alexa::VoiceLatencyTracer::getInstance()->stamp(
+				getCurrentDialogRequestId(), aace::engine::alexa::VoiceLatencyTracer::Stage::FIRST_AUDIO_WRITTEN );
+		}
 		return ret < 0 ? 0 : ( ret * sizeof(int16_t) );
 	}
 	return size;
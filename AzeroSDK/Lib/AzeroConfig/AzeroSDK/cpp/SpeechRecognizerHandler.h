@@ -50,6 +50,7 @@ protected:
 	bool m_expectingSpeech = false;
 	std::atomic<bool> m_allowRemoteInitiation { true };
 	bool m_AudioQueryStarted = false;
+	bool m_firstAudioWritten = false;
 	SequenceIdType m_currentSequenceId = 0;
 };
 
@@ -0,0 +1,1264 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Loopback HTTP/2 server standing in for AVS, so that HTTP2Transport, DownchannelHandler, PingHandler and
+// MessageRouter can be exercised and benchmarked without the cloud.
+//
+// usage: AVSLoopbackServer [options]
+//
+//   -p port                  Port to listen on, on 127.0.0.1 (default 18443).
+//   --tls cert.pem key.pem   Serve TLS with ALPN h2.  Without it the server speaks h2c with prior knowledge.
+//   --latency ms             Delay before each response (default 0).
+//   --jitter ms              Add up to this much random delay to each response (default 0).
+//   --loss percent           Reset this share of event streams, and leave this share of pings unanswered (default 0).
+//   --goaway-after n         Send GOAWAY after every n events on a connection (default 0, never).
+//   --push-interval ms       Push a directive on each downchannel this often (default 0, never).
+//   --tts-bytes n            Size of the audio part sent with a Speak directive (default 32000).
+//   --tts-chunk-bytes n      Send the audio in chunks of this size (default 4000)...
+//   --tts-chunk-interval ms  ...this far apart (default 0, all at once).
+//   --script dir             Directive templates; see below.
+//   --gzip                   Send Accept-Encoding: gzip with responses, and take events with Content-Encoding: gzip.
+//                            Without it such events get 415.
+//   -v                       Log connections and requests.
+//
+// Paths ending in /directives are downchannels, paths ending in /events take events and paths ending in /ping are
+// pings.  Requests without an authorization header get 403.
+//
+// An event is answered with the directives in <script>/<namespace>.<name>.json, one directive per line, or with 204
+// if there is no such file.  Pushed directives come from <script>/downchannel.json.  In templates ${messageId} is
+// replaced with a new id, ${dialogRequestId} and ${eventMessageId} with those of the event, ${sentAtUs} with the
+// system clock in microseconds when the directive is sent, and ${ttsCid} with the Content-ID of an audio part of
+// --tts-bytes which is sent after the directives.  Without --script, Recognize is answered with StopCapture and a Speak
+// with audio, other events with 204, and pushes are Benchmark.Push directives.  A Benchmark.GoAway event is answered
+// with 204 and then GOAWAY, whatever the options.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <csignal>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <nghttp2/nghttp2.h>
+#include <zlib.h>
+
+#ifdef ACSDK_LOOPBACK_TLS
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#else
+typedef struct ssl_st SSL;
+#endif
+
+/// Boundary used for all multipart responses.
+static const std::string BOUNDARY = "------loopbackBoundary7b4e3f";
+
+/// Content type of multipart responses.
+static const std::string MULTIPART_CONTENT_TYPE = "multipart/related; boundary=" + BOUNDARY + "; type=\"application/json\"";
+
+/// Headers of a JSON part.
+static const std::string JSON_PART_HEADERS = "Content-Type: application/json; charset=UTF-8\r\n";
+
+/// The most request body bytes kept for one stream.
+static const size_t MAX_REQUEST_BODY_SIZE = 16 * 1024 * 1024;
+
+/// How long a connection may take to close after GOAWAY before it is dropped.
+static const std::chrono::seconds GOAWAY_GRACE_PERIOD(5);
+
+/// Directives answering Recognize when there is no script.
+static const char* DEFAULT_RECOGNIZE_SCRIPT =
+    "{\"directive\":{\"header\":{\"namespace\":\"SpeechRecognizer\",\"name\":\"StopCapture\","
+    "\"messageId\":\"${messageId}\",\"dialogRequestId\":\"${dialogRequestId}\"},\"payload\":{\"sentAtUs\":${sentAtUs}}}}\n"
+    "{\"directive\":{\"header\":{\"namespace\":\"SpeechSynthesizer\",\"name\":\"Speak\","
+    "\"messageId\":\"${messageId}\",\"dialogRequestId\":\"${dialogRequestId}\"},\"payload\":{\"url\":\"cid:${ttsCid}\","
+    "\"format\":\"AUDIO_MPEG\",\"token\":\"${messageId}\",\"sentAtUs\":${sentAtUs}}}}\n";
+
+/// Directive pushed on the downchannel when there is no script.
+static const char* DEFAULT_PUSH_SCRIPT =
+    "{\"directive\":{\"header\":{\"namespace\":\"Benchmark\",\"name\":\"Push\",\"messageId\":\"${messageId}\"},"
+    "\"payload\":{\"sentAtUs\":${sentAtUs}}}}\n";
+
+/// Command line options.
+struct Options {
+    int port = 18443;
+    std::string certFile;
+    std::string keyFile;
+    int latencyMs = 0;
+    int jitterMs = 0;
+    int lossPercent = 0;
+    int goawayAfterEvents = 0;
+    int pushIntervalMs = 0;
+    size_t ttsBytes = 32000;
+    size_t ttsChunkBytes = 4000;
+    int ttsChunkIntervalMs = 0;
+    std::string scriptDir;
+    bool gzip = false;
+    bool verbose = false;
+};
+
+/// Counters printed when the server stops.
+struct Statistics {
+    size_t connections = 0;
+    size_t events = 0;
+    size_t pings = 0;
+    size_t directives = 0;
+    size_t resets = 0;
+    size_t goaways = 0;
+    size_t compressedEvents = 0;
+};
+
+/// Set by the signal handler.
+static volatile sig_atomic_t g_isStopping = 0;
+
+/**
+ * Handle SIGINT and SIGTERM.
+ *
+ * @param signal The signal.
+ */
+static void onSignal(int signal) {
+    g_isStopping = 1;
+}
+
+/**
+ * Get the system clock in microseconds, which other processes on the host can compare with theirs.
+ *
+ * @return The system clock in microseconds.
+ */
+static long long nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * Replace every occurrence of a placeholder.
+ *
+ * @param text The text.
+ * @param placeholder The placeholder.
+ * @param value The replacement.
+ */
+static void replaceAll(std::string* text, const std::string& placeholder, const std::string& value) {
+    for (auto position = text->find(placeholder); position != std::string::npos;
+         position = text->find(placeholder, position + value.size())) {
+        text->replace(position, placeholder.size(), value);
+    }
+}
+
+/**
+ * Find the string value of a JSON key, without parsing the JSON.  Good enough for event headers.
+ *
+ * @param json The JSON text.
+ * @param key The key.
+ * @return The value, or an empty string.
+ */
+static std::string findJsonString(const std::string& json, const std::string& key) {
+    auto position = json.find("\"" + key + "\"");
+    if (position == std::string::npos) {
+        return "";
+    }
+    position = json.find(':', position + key.size() + 2);
+    if (position == std::string::npos) {
+        return "";
+    }
+    position = json.find('"', position);
+    if (position == std::string::npos) {
+        return "";
+    }
+    auto end = json.find('"', position + 1);
+    if (end == std::string::npos) {
+        return "";
+    }
+    return json.substr(position + 1, end - position - 1);
+}
+
+/**
+ * Whether a string ends with a suffix.
+ *
+ * @param text The string.
+ * @param suffix The suffix.
+ * @return Whether @c text ends with @c suffix.
+ */
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && 0 == text.compare(text.size() - suffix.size(), suffix.size(), suffix);
+}
+
+/**
+ * Render one part of a multipart body.
+ *
+ * @param headers The part's header lines, each ending in CRLF.
+ * @param body The part's body.
+ * @return The rendered part.
+ */
+static std::string renderPart(const std::string& headers, const std::string& body) {
+    return "--" + BOUNDARY + "\r\n" + headers + "\r\n" + body + "\r\n";
+}
+
+/**
+ * Decode a gzip encoded request body.
+ *
+ * @param body The request body.
+ * @param[out] decoded Receives the decoded body.
+ * @return Whether the body could be decoded.
+ */
+static bool decodeBody(const std::string& body, std::string* decoded) {
+    z_stream stream{};
+    if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK) {
+        return false;
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+    stream.avail_in = static_cast<uInt>(body.size());
+    int result = Z_OK;
+    char buffer[16 * 1024];
+    decoded->clear();
+    while (Z_OK == result) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        result = inflate(&stream, Z_NO_FLUSH);
+        decoded->append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    return Z_STREAM_END == result;
+}
+
+/// Directive templates, by event or "downchannel".
+class Script {
+public:
+    /**
+     * Constructor.
+     *
+     * @param dir Directory to read templates from, or empty for the built in ones.
+     */
+    Script(const std::string& dir) : m_dir{dir} {
+    }
+
+    /**
+     * Get the templates for an event or for downchannel pushes.
+     *
+     * @param name "<namespace>.<name>" or "downchannel".
+     * @return The templates, one per directive.  Empty if there are none.
+     */
+    const std::vector<std::string>& get(const std::string& name) {
+        auto it = m_templates.find(name);
+        if (it != m_templates.end()) {
+            return it->second;
+        }
+        std::string text;
+        if (!m_dir.empty()) {
+            std::ifstream file(m_dir + "/" + name + ".json");
+            text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        } else if ("SpeechRecognizer.Recognize" == name) {
+            text = DEFAULT_RECOGNIZE_SCRIPT;
+        } else if ("downchannel" == name) {
+            text = DEFAULT_PUSH_SCRIPT;
+        }
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) {
+            if (!line.empty() && '\r' == line.back()) {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                lines.push_back(line);
+            }
+        }
+        return m_templates[name] = lines;
+    }
+
+private:
+    /// Directory to read templates from, or empty.
+    std::string m_dir;
+
+    /// Templates read so far.
+    std::map<std::string, std::vector<std::string>> m_templates;
+};
+
+/// One HTTP/2 connection.
+class Session {
+public:
+    /**
+     * Constructor.
+     *
+     * @param fd The connected socket.
+     * @param ssl The TLS connection, or nullptr for h2c.
+     * @param options The command line options.
+     * @param script The directive templates.
+     * @param statistics The counters to update.
+     */
+    Session(int fd, SSL* ssl, const Options& options, Script& script, Statistics& statistics);
+
+    /**
+     * Destructor.  Closes the connection.
+     */
+    ~Session();
+
+    /**
+     * Set up the nghttp2 session and queue the server's SETTINGS.
+     *
+     * @return Whether it succeeded.
+     */
+    bool start();
+
+    /**
+     * Read and process whatever the client has sent.
+     *
+     * @return Whether the connection is still usable.
+     */
+    bool onReadable();
+
+    /**
+     * Write whatever nghttp2 has to send.
+     *
+     * @return Whether the connection is still usable.
+     */
+    bool flush();
+
+    /**
+     * Run the timers which are due.
+     *
+     * @param now The current time.
+     */
+    void runTimers(std::chrono::steady_clock::time_point now);
+
+    /**
+     * Get the socket.
+     *
+     * @return The socket.
+     */
+    int getFd() const;
+
+    /**
+     * Whether there is output waiting for the socket to become writable.
+     *
+     * @return Whether there is output waiting.
+     */
+    bool wantsWrite() const;
+
+    /**
+     * Whether the connection is finished with.
+     *
+     * @return Whether the connection can be closed.
+     */
+    bool isDone() const;
+
+    /**
+     * Get when the next timer is due.
+     *
+     * @param[out] when Receives the time of the next timer.
+     * @return Whether there is a timer.
+     */
+    bool getNextTimer(std::chrono::steady_clock::time_point* when) const;
+
+private:
+    /// A request and its response.
+    struct Stream {
+        /// The stream id.
+        int32_t id = 0;
+        /// The request method.
+        std::string method;
+        /// The request path.
+        std::string path;
+        /// Whether the request had an authorization header.
+        bool isAuthorized = false;
+        /// The request's content coding, in lower case, or empty if it had none.
+        std::string contentEncoding;
+        /// The request body.
+        std::string requestBody;
+        /// Response body bytes waiting to be sent.
+        std::string output;
+        /// How much of @c output has been sent.
+        size_t outputOffset = 0;
+        /// Whether the response body is complete once @c output is sent.
+        bool isOutputComplete = false;
+        /// Whether nghttp2 is waiting for more response body.
+        bool isDeferred = false;
+        /// Whether this is a downchannel.
+        bool isDownchannel = false;
+    };
+
+    /**
+     * Act on a complete request.
+     *
+     * @param stream The stream.
+     */
+    void handleRequest(Stream* stream);
+
+    /**
+     * Answer an event.
+     *
+     * @param stream The stream.
+     */
+    void handleEvent(Stream* stream);
+
+    /**
+     * Send a response once the configured latency has passed.
+     *
+     * @param streamId The stream.
+     * @param status The status code.
+     * @param isMultipart Whether the body is multipart.
+     * @param body The first part of the body.
+     * @param isComplete Whether @c body is the whole body.
+     */
+    void respondLater(int32_t streamId, int status, bool isMultipart, const std::string& body, bool isComplete);
+
+    /**
+     * Append to the body of a response.
+     *
+     * @param streamId The stream.
+     * @param data The data to send.
+     * @param isComplete Whether this completes the body.
+     */
+    void appendOutput(int32_t streamId, const std::string& data, bool isComplete);
+
+    /**
+     * Push a directive on a downchannel, and schedule the next push.
+     *
+     * @param streamId The downchannel stream.
+     */
+    void pushDirective(int32_t streamId);
+
+    /**
+     * Close the downchannels and send GOAWAY.
+     */
+    void goAway();
+
+    /**
+     * Render directives from templates.
+     *
+     * @param templates The templates.
+     * @param dialogRequestId The dialog request id of the event, if any.
+     * @param eventMessageId The message id of the event, if any.
+     * @param[out] ttsCid Receives the Content-ID of the audio to send, or is left empty.
+     * @return The rendered parts.
+     */
+    std::string renderDirectives(
+        const std::vector<std::string>& templates,
+        const std::string& dialogRequestId,
+        const std::string& eventMessageId,
+        std::string* ttsCid);
+
+    /**
+     * Get the configured latency, with jitter.
+     *
+     * @return The delay before a response.
+     */
+    std::chrono::milliseconds responseDelay();
+
+    /**
+     * Run a function after a delay.
+     *
+     * @param delay The delay.
+     * @param task The function.
+     */
+    void schedule(std::chrono::milliseconds delay, std::function<void()> task);
+
+    /**
+     * Find a stream.
+     *
+     * @param streamId The stream id.
+     * @return The stream, or nullptr if it has closed.
+     */
+    Stream* findStream(int32_t streamId);
+
+    /**
+     * Read from the socket.
+     *
+     * @param buffer Where to put the data.
+     * @param size The size of @c buffer.
+     * @return The number of bytes read, 0 at end of stream, -1 if no data is ready or -2 on error.
+     */
+    ssize_t readSome(uint8_t* buffer, size_t size);
+
+    /**
+     * Write to the socket.
+     *
+     * @param data The data.
+     * @param size The size of @c data.
+     * @return The number of bytes written, -1 if the socket is not ready or -2 on error.
+     */
+    ssize_t writeSome(const char* data, size_t size);
+
+    /// @name nghttp2 callbacks.
+    /// @{
+    static int onBeginHeaders(nghttp2_session* session, const nghttp2_frame* frame, void* userData);
+    static int onHeader(
+        nghttp2_session* session,
+        const nghttp2_frame* frame,
+        const uint8_t* name,
+        size_t nameLength,
+        const uint8_t* value,
+        size_t valueLength,
+        uint8_t flags,
+        void* userData);
+    static int onDataChunk(
+        nghttp2_session* session,
+        uint8_t flags,
+        int32_t streamId,
+        const uint8_t* data,
+        size_t length,
+        void* userData);
+    static int onFrameReceived(nghttp2_session* session, const nghttp2_frame* frame, void* userData);
+    static int onStreamClosed(nghttp2_session* session, int32_t streamId, uint32_t errorCode, void* userData);
+    static ssize_t readBody(
+        nghttp2_session* session,
+        int32_t streamId,
+        uint8_t* buffer,
+        size_t length,
+        uint32_t* flags,
+        nghttp2_data_source* source,
+        void* userData);
+    /// @}
+
+    /// The connected socket.
+    int m_fd;
+
+    /// The TLS connection, or nullptr.
+    SSL* m_ssl;
+
+    /// The command line options.
+    const Options& m_options;
+
+    /// The directive templates.
+    Script& m_script;
+
+    /// The counters to update.
+    Statistics& m_statistics;
+
+    /// The nghttp2 session.
+    nghttp2_session* m_session;
+
+    /// Open streams.
+    std::map<int32_t, std::unique_ptr<Stream>> m_streams;
+
+    /// Output waiting for the socket to become writable.
+    std::string m_pendingOutput;
+
+    /// Timers, by when they are due.
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> m_timers;
+
+    /// Events received on this connection.
+    int m_eventCount;
+
+    /// Whether GOAWAY has been sent.
+    bool m_isGoingAway;
+
+    /// Whether the connection failed or the client closed it.
+    bool m_isClosed;
+
+    /// Counter for message ids and Content-IDs.
+    unsigned long m_nextId;
+
+    /// Random numbers for jitter and loss.
+    std::mt19937 m_random;
+};
+
+Session::Session(int fd, SSL* ssl, const Options& options, Script& script, Statistics& statistics) :
+        m_fd{fd},
+        m_ssl{ssl},
+        m_options(options),
+        m_script(script),
+        m_statistics(statistics),
+        m_session{nullptr},
+        m_eventCount{0},
+        m_isGoingAway{false},
+        m_isClosed{false},
+        m_nextId{0},
+        m_random{static_cast<unsigned>(fd)} {
+}
+
+Session::~Session() {
+    if (m_session) {
+        nghttp2_session_del(m_session);
+    }
+#ifdef ACSDK_LOOPBACK_TLS
+    if (m_ssl) {
+        SSL_free(m_ssl);
+    }
+#endif
+    close(m_fd);
+}
+
+bool Session::start() {
+    nghttp2_session_callbacks* callbacks = nullptr;
+    if (nghttp2_session_callbacks_new(&callbacks) != 0) {
+        return false;
+    }
+    nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, onBeginHeaders);
+    nghttp2_session_callbacks_set_on_header_callback(callbacks, onHeader);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, onDataChunk);
+    nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, onFrameReceived);
+    nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, onStreamClosed);
+    int result = nghttp2_session_server_new(&m_session, callbacks, this);
+    nghttp2_session_callbacks_del(callbacks);
+    if (result != 0) {
+        return false;
+    }
+    nghttp2_settings_entry settings[] = {{NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 100}};
+    return 0 == nghttp2_submit_settings(m_session, NGHTTP2_FLAG_NONE, settings, 1) && flush();
+}
+
+bool Session::onReadable() {
+    uint8_t buffer[16384];
+    while (true) {
+        auto count = readSome(buffer, sizeof(buffer));
+        if (-1 == count) {
+            break;
+        }
+        if (count <= 0) {
+            m_isClosed = true;
+            return false;
+        }
+        auto result = nghttp2_session_mem_recv(m_session, buffer, count);
+        if (result < 0) {
+            if (m_options.verbose) {
+                std::cerr << "fd " << m_fd << ": " << nghttp2_strerror(static_cast<int>(result)) << std::endl;
+            }
+            m_isClosed = true;
+            return false;
+        }
+    }
+    return flush();
+}
+
+bool Session::flush() {
+    while (true) {
+        while (!m_pendingOutput.empty()) {
+            auto count = writeSome(m_pendingOutput.data(), m_pendingOutput.size());
+            if (-1 == count) {
+                return true;
+            }
+            if (count < 0) {
+                m_isClosed = true;
+                return false;
+            }
+            m_pendingOutput.erase(0, count);
+        }
+        const uint8_t* data = nullptr;
+        auto length = nghttp2_session_mem_send(m_session, &data);
+        if (length < 0) {
+            m_isClosed = true;
+            return false;
+        }
+        if (0 == length) {
+            return true;
+        }
+        m_pendingOutput.append(reinterpret_cast<const char*>(data), length);
+    }
+}
+
+void Session::runTimers(std::chrono::steady_clock::time_point now) {
+    while (!m_timers.empty() && m_timers.begin()->first <= now) {
+        auto task = std::move(m_timers.begin()->second);
+        m_timers.erase(m_timers.begin());
+        task();
+    }
+}
+
+int Session::getFd() const {
+    return m_fd;
+}
+
+bool Session::wantsWrite() const {
+    return !m_pendingOutput.empty();
+}
+
+bool Session::isDone() const {
+    return m_isClosed || (m_pendingOutput.empty() && !nghttp2_session_want_read(m_session) &&
+                          !nghttp2_session_want_write(m_session));
+}
+
+bool Session::getNextTimer(std::chrono::steady_clock::time_point* when) const {
+    if (m_timers.empty()) {
+        return false;
+    }
+    *when = m_timers.begin()->first;
+    return true;
+}
+
+void Session::handleRequest(Stream* stream) {
+    if (m_options.verbose) {
+        std::cerr << "fd " << m_fd << ": " << stream->method << " " << stream->path << " (" << stream->requestBody.size()
+                  << " bytes)" << std::endl;
+    }
+    if (!stream->isAuthorized) {
+        respondLater(stream->id, 403, false, "", true);
+    } else if (endsWith(stream->path, "/ping")) {
+        ++m_statistics.pings;
+        if (static_cast<int>(m_random() % 100) < m_options.lossPercent) {
+            // Lost: never answered, so the client's ping times out.
+            return;
+        }
+        respondLater(stream->id, 204, false, "", true);
+    } else if (endsWith(stream->path, "/directives") && "GET" == stream->method) {
+        stream->isDownchannel = true;
+        respondLater(stream->id, 200, true, "", false);
+        if (m_options.pushIntervalMs > 0) {
+            auto streamId = stream->id;
+            schedule(std::chrono::milliseconds(m_options.pushIntervalMs), [this, streamId]() { pushDirective(streamId); });
+        }
+    } else if (endsWith(stream->path, "/events") && "POST" == stream->method) {
+        handleEvent(stream);
+    } else {
+        respondLater(stream->id, 404, false, "", true);
+    }
+}
+
+void Session::handleEvent(Stream* stream) {
+    ++m_statistics.events;
+    ++m_eventCount;
+    std::string decoded;
+    bool isEncoded = !stream->contentEncoding.empty() && stream->contentEncoding != "identity";
+    if (isEncoded) {
+        if (!m_options.gzip || stream->contentEncoding != "gzip") {
+            respondLater(stream->id, 415, false, "", true);
+            return;
+        }
+        if (!decodeBody(stream->requestBody, &decoded)) {
+            respondLater(stream->id, 400, false, "", true);
+            return;
+        }
+        ++m_statistics.compressedEvents;
+        if (m_options.verbose) {
+            std::cerr << "fd " << m_fd << ": body " << decoded.size() << " bytes decoded" << std::endl;
+        }
+    }
+    const auto& json = isEncoded ? decoded : stream->requestBody;
+    // The device context comes before the event, and has headers of its own.
+    auto eventStart = json.find("\"event\"");
+    auto body = json.substr(eventStart == std::string::npos ? 0 : eventStart);
+    auto name = findJsonString(body, "namespace") + "." + findJsonString(body, "name");
+    if (static_cast<int>(m_random() % 100) < m_options.lossPercent) {
+        ++m_statistics.resets;
+        nghttp2_submit_rst_stream(m_session, NGHTTP2_FLAG_NONE, stream->id, NGHTTP2_INTERNAL_ERROR);
+    } else {
+        const auto& templates = m_script.get(name);
+        if (templates.empty()) {
+            respondLater(stream->id, 204, false, "", true);
+        } else {
+            std::string ttsCid;
+            auto parts = renderDirectives(
+                templates, findJsonString(body, "dialogRequestId"), findJsonString(body, "messageId"), &ttsCid);
+            if (ttsCid.empty() || 0 == m_options.ttsBytes) {
+                respondLater(stream->id, 200, true, parts + "--" + BOUNDARY + "--\r\n", true);
+            } else {
+                auto audioHeaders = "Content-Type: application/octet-stream\r\nContent-ID: <" + ttsCid + ">\r\n";
+                parts += "--" + BOUNDARY + "\r\n" + audioHeaders + "\r\n";
+                respondLater(stream->id, 200, true, parts, false);
+                // Audio follows the directives, at the configured rate.
+                auto streamId = stream->id;
+                auto delay = responseDelay();
+                size_t chunk = m_options.ttsChunkBytes > 0 ? m_options.ttsChunkBytes : m_options.ttsBytes;
+                for (size_t sent = 0; sent < m_options.ttsBytes; sent += chunk) {
+                    size_t size = std::min(chunk, m_options.ttsBytes - sent);
+                    bool isLast = sent + size >= m_options.ttsBytes;
+                    std::string data(size, static_cast<char>(0xff));
+                    if (isLast) {
+                        data += "\r\n--" + BOUNDARY + "--\r\n";
+                    }
+                    schedule(delay, [this, streamId, data, isLast]() { appendOutput(streamId, data, isLast); });
+                    delay += std::chrono::milliseconds(m_options.ttsChunkIntervalMs);
+                }
+            }
+        }
+    }
+    if ("Benchmark.GoAway" == name ||
+        (m_options.goawayAfterEvents > 0 && 0 == m_eventCount % m_options.goawayAfterEvents)) {
+        // After the response to this event has started, so that it is not refused.
+        schedule(responseDelay() + std::chrono::milliseconds(1), [this]() { goAway(); });
+    }
+}
+
+void Session::respondLater(int32_t streamId, int status, bool isMultipart, const std::string& body, bool isComplete) {
+    schedule(responseDelay(), [this, streamId, status, isMultipart, body, isComplete]() {
+        auto stream = findStream(streamId);
+        if (!stream) {
+            return;
+        }
+        auto statusText = std::to_string(status);
+        std::vector<nghttp2_nv> headers;
+        auto addHeader = [&headers](const std::string& name, const std::string& value) {
+            headers.push_back(
+                {reinterpret_cast<uint8_t*>(const_cast<char*>(name.c_str())),
+                 reinterpret_cast<uint8_t*>(const_cast<char*>(value.c_str())),
+                 name.size(),
+                 value.size(),
+                 NGHTTP2_NV_FLAG_NONE});
+        };
+        static const std::string statusName = ":status";
+        static const std::string contentTypeName = "content-type";
+        static const std::string acceptEncodingName = "accept-encoding";
+        static const std::string acceptEncoding = "gzip";
+        addHeader(statusName, statusText);
+        if (isMultipart) {
+            addHeader(contentTypeName, MULTIPART_CONTENT_TYPE);
+        }
+        if (m_options.gzip) {
+            // RFC 7694: the codings this server takes in request bodies.
+            addHeader(acceptEncodingName, acceptEncoding);
+        }
+        stream->output += body;
+        stream->isOutputComplete = isComplete;
+        nghttp2_data_provider provider;
+        provider.source.ptr = stream;
+        provider.read_callback = readBody;
+        bool hasBody = isMultipart || !body.empty();
+        nghttp2_submit_response(m_session, streamId, headers.data(), headers.size(), hasBody ? &provider : nullptr);
+    });
+}
+
+void Session::appendOutput(int32_t streamId, const std::string& data, bool isComplete) {
+    auto stream = findStream(streamId);
+    if (!stream || stream->isOutputComplete) {
+        return;
+    }
+    stream->output += data;
+    stream->isOutputComplete = isComplete;
+    if (stream->isDeferred) {
+        stream->isDeferred = false;
+        nghttp2_session_resume_data(m_session, streamId);
+    }
+}
+
+void Session::pushDirective(int32_t streamId) {
+    auto stream = findStream(streamId);
+    if (!stream || stream->isOutputComplete) {
+        return;
+    }
+    std::string ttsCid;
+    appendOutput(streamId, renderDirectives(m_script.get("downchannel"), "", "", &ttsCid), false);
+    schedule(std::chrono::milliseconds(m_options.pushIntervalMs), [this, streamId]() { pushDirective(streamId); });
+}
+
+void Session::goAway() {
+    if (m_isGoingAway) {
+        return;
+    }
+    m_isGoingAway = true;
+    ++m_statistics.goaways;
+    if (m_options.verbose) {
+        std::cerr << "fd " << m_fd << ": GOAWAY" << std::endl;
+    }
+    for (auto& entry : m_streams) {
+        if (entry.second->isDownchannel) {
+            appendOutput(entry.first, "--" + BOUNDARY + "--\r\n", true);
+        }
+    }
+    nghttp2_submit_goaway(
+        m_session, NGHTTP2_FLAG_NONE, nghttp2_session_get_last_proc_stream_id(m_session), NGHTTP2_NO_ERROR, nullptr, 0);
+    schedule(std::chrono::duration_cast<std::chrono::milliseconds>(GOAWAY_GRACE_PERIOD), [this]() { m_isClosed = true; });
+}
+
+std::string Session::renderDirectives(
+    const std::vector<std::string>& templates,
+    const std::string& dialogRequestId,
+    const std::string& eventMessageId,
+    std::string* ttsCid) {
+    std::string parts;
+    for (const auto& line : templates) {
+        auto directive = line;
+        replaceAll(&directive, "${messageId}", "loopback-" + std::to_string(m_fd) + "-" + std::to_string(++m_nextId));
+        replaceAll(&directive, "${dialogRequestId}", dialogRequestId);
+        replaceAll(&directive, "${eventMessageId}", eventMessageId);
+        replaceAll(&directive, "${sentAtUs}", std::to_string(nowUs()));
+        if (directive.find("${ttsCid}") != std::string::npos) {
+            if (ttsCid->empty()) {
+                *ttsCid = "tts-" + std::to_string(m_fd) + "-" + std::to_string(++m_nextId);
+            }
+            replaceAll(&directive, "${ttsCid}", *ttsCid);
+        }
+        parts += renderPart(JSON_PART_HEADERS, directive);
+        ++m_statistics.directives;
+    }
+    return parts;
+}
+
+std::chrono::milliseconds Session::responseDelay() {
+    int delay = m_options.latencyMs;
+    if (m_options.jitterMs > 0) {
+        delay += static_cast<int>(m_random() % (m_options.jitterMs + 1));
+    }
+    return std::chrono::milliseconds(delay);
+}
+
+void Session::schedule(std::chrono::milliseconds delay, std::function<void()> task) {
+    m_timers.insert(std::make_pair(std::chrono::steady_clock::now() + delay, std::move(task)));
+}
+
+Session::Stream* Session::findStream(int32_t streamId) {
+    auto it = m_streams.find(streamId);
+    return it == m_streams.end() ? nullptr : it->second.get();
+}
+
+ssize_t Session::readSome(uint8_t* buffer, size_t size) {
+#ifdef ACSDK_LOOPBACK_TLS
+    if (m_ssl) {
+        int count = SSL_read(m_ssl, buffer, static_cast<int>(size));
+        if (count > 0) {
+            return count;
+        }
+        switch (SSL_get_error(m_ssl, count)) {
+            case SSL_ERROR_WANT_READ:
+            case SSL_ERROR_WANT_WRITE:
+                return -1;
+            case SSL_ERROR_ZERO_RETURN:
+                return 0;
+            default:
+                return -2;
+        }
+    }
+#endif
+    auto count = read(m_fd, buffer, size);
+    if (count < 0) {
+        return (EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno) ? -1 : -2;
+    }
+    return count;
+}
+
+ssize_t Session::writeSome(const char* data, size_t size) {
+#ifdef ACSDK_LOOPBACK_TLS
+    if (m_ssl) {
+        int count = SSL_write(m_ssl, data, static_cast<int>(size));
+        if (count > 0) {
+            return count;
+        }
+        switch (SSL_get_error(m_ssl, count)) {
+            case SSL_ERROR_WANT_READ:
+            case SSL_ERROR_WANT_WRITE:
+                return -1;
+            default:
+                return -2;
+        }
+    }
+#endif
+    auto count = send(m_fd, data, size, MSG_NOSIGNAL);
+    if (count < 0) {
+        return (EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno) ? -1 : -2;
+    }
+    return count;
+}
+
+int Session::onBeginHeaders(nghttp2_session* session, const nghttp2_frame* frame, void* userData) {
+    if (frame->hd.type != NGHTTP2_HEADERS || frame->headers.cat != NGHTTP2_HCAT_REQUEST) {
+        return 0;
+    }
+    auto self = static_cast<Session*>(userData);
+    std::unique_ptr<Stream> stream(new Stream());
+    stream->id = frame->hd.stream_id;
+    self->m_streams[stream->id] = std::move(stream);
+    return 0;
+}
+
+int Session::onHeader(
+    nghttp2_session* session,
+    const nghttp2_frame* frame,
+    const uint8_t* name,
+    size_t nameLength,
+    const uint8_t* value,
+    size_t valueLength,
+    uint8_t flags,
+    void* userData) {
+    auto stream = static_cast<Session*>(userData)->findStream(frame->hd.stream_id);
+    if (!stream) {
+        return 0;
+    }
+    std::string headerName(reinterpret_cast<const char*>(name), nameLength);
+    std::string headerValue(reinterpret_cast<const char*>(value), valueLength);
+    if (":method" == headerName) {
+        stream->method = headerValue;
+    } else if (":path" == headerName) {
+        stream->path = headerValue.substr(0, headerValue.find('?'));
+    } else if ("authorization" == headerName) {
+        stream->isAuthorized = !headerValue.empty();
+    } else if ("content-encoding" == headerName) {
+        std::transform(headerValue.begin(), headerValue.end(), headerValue.begin(), ::tolower);
+        stream->contentEncoding = headerValue;
+    }
+    return 0;
+}
+
+int Session::onDataChunk(
+    nghttp2_session* session,
+    uint8_t flags,
+    int32_t streamId,
+    const uint8_t* data,
+    size_t length,
+    void* userData) {
+    auto stream = static_cast<Session*>(userData)->findStream(streamId);
+    if (stream && stream->requestBody.size() + length <= MAX_REQUEST_BODY_SIZE) {
+        stream->requestBody.append(reinterpret_cast<const char*>(data), length);
+    }
+    return 0;
+}
+
+int Session::onFrameReceived(nghttp2_session* session, const nghttp2_frame* frame, void* userData) {
+    if ((frame->hd.type != NGHTTP2_HEADERS && frame->hd.type != NGHTTP2_DATA) ||
+        !(frame->hd.flags & NGHTTP2_FLAG_END_STREAM)) {
+        return 0;
+    }
+    auto self = static_cast<Session*>(userData);
+    auto stream = self->findStream(frame->hd.stream_id);
+    if (stream) {
+        self->handleRequest(stream);
+    }
+    return 0;
+}
+
+int Session::onStreamClosed(nghttp2_session* session, int32_t streamId, uint32_t errorCode, void* userData) {
+    static_cast<Session*>(userData)->m_streams.erase(streamId);
+    return 0;
+}
+
+ssize_t Session::readBody(
+    nghttp2_session* session,
+    int32_t streamId,
+    uint8_t* buffer,
+    size_t length,
+    uint32_t* flags,
+    nghttp2_data_source* source,
+    void* userData) {
+    auto stream = static_cast<Stream*>(source->ptr);
+    size_t available = stream->output.size() - stream->outputOffset;
+    if (0 == available && !stream->isOutputComplete) {
+        stream->isDeferred = true;
+        return NGHTTP2_ERR_DEFERRED;
+    }
+    size_t count = std::min(available, length);
+    memcpy(buffer, stream->output.data() + stream->outputOffset, count);
+    stream->outputOffset += count;
+    if (stream->outputOffset == stream->output.size()) {
+        stream->output.clear();
+        stream->outputOffset = 0;
+        if (stream->isOutputComplete) {
+            *flags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+    }
+    return static_cast<ssize_t>(count);
+}
+
+/**
+ * Parse the command line.
+ *
+ * @param argc The argument count.
+ * @param argv The arguments.
+ * @param[out] options Receives the options.
+ * @return Whether the command line was valid.
+ */
+static bool parseOptions(int argc, char* argv[], Options* options) {
+    for (int index = 1; index < argc; ++index) {
+        std::string arg = argv[index];
+        bool hasValue = index + 1 < argc;
+        if ("-v" == arg) {
+            options->verbose = true;
+        } else if ("--gzip" == arg) {
+            options->gzip = true;
+        } else if ("--tls" == arg && index + 2 < argc) {
+            options->certFile = argv[++index];
+            options->keyFile = argv[++index];
+        } else if (!hasValue) {
+            return false;
+        } else if ("-p" == arg) {
+            options->port = std::atoi(argv[++index]);
+        } else if ("--latency" == arg) {
+            options->latencyMs = std::atoi(argv[++index]);
+        } else if ("--jitter" == arg) {
+            options->jitterMs = std::atoi(argv[++index]);
+        } else if ("--loss" == arg) {
+            options->lossPercent = std::atoi(argv[++index]);
+        } else if ("--goaway-after" == arg) {
+            options->goawayAfterEvents = std::atoi(argv[++index]);
+        } else if ("--push-interval" == arg) {
+            options->pushIntervalMs = std::atoi(argv[++index]);
+        } else if ("--tts-bytes" == arg) {
+            options->ttsBytes = std::strtoul(argv[++index], nullptr, 10);
+        } else if ("--tts-chunk-bytes" == arg) {
+            options->ttsChunkBytes = std::strtoul(argv[++index], nullptr, 10);
+        } else if ("--tts-chunk-interval" == arg) {
+            options->ttsChunkIntervalMs = std::atoi(argv[++index]);
+        } else if ("--script" == arg) {
+            options->scriptDir = argv[++index];
+        } else {
+            return false;
+        }
+    }
+    return options->port > 0 && options->latencyMs >= 0 && options->jitterMs >= 0;
+}
+
+#ifdef ACSDK_LOOPBACK_TLS
+/**
+ * Select h2 during ALPN.
+ */
+static int selectAlpn(
+    SSL* ssl,
+    const unsigned char** out,
+    unsigned char* outLength,
+    const unsigned char* in,
+    unsigned int inLength,
+    void* arg) {
+    if (nghttp2_select_next_protocol(const_cast<unsigned char**>(out), outLength, in, inLength) != 1) {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    return SSL_TLSEXT_ERR_OK;
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        std::cerr << "usage: " << argv[0]
+                  << " [-p port] [--tls cert.pem key.pem] [--latency ms] [--jitter ms] [--loss percent]"
+                     " [--goaway-after n] [--push-interval ms] [--tts-bytes n] [--tts-chunk-bytes n]"
+                     " [--tts-chunk-interval ms] [--script dir] [--gzip] [-v]"
+                  << std::endl;
+        return 2;
+    }
+
+#ifdef ACSDK_LOOPBACK_TLS
+    SSL_CTX* tlsContext = nullptr;
+    if (!options.certFile.empty()) {
+        tlsContext = SSL_CTX_new(TLS_server_method());
+        if (!tlsContext || SSL_CTX_use_certificate_chain_file(tlsContext, options.certFile.c_str()) != 1 ||
+            SSL_CTX_use_PrivateKey_file(tlsContext, options.keyFile.c_str(), SSL_FILETYPE_PEM) != 1) {
+            std::cerr << "cannot load " << options.certFile << " and " << options.keyFile << std::endl;
+            return 1;
+        }
+        SSL_CTX_set_min_proto_version(tlsContext, TLS1_2_VERSION);
+        SSL_CTX_set_mode(tlsContext, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+        SSL_CTX_set_alpn_select_cb(tlsContext, selectAlpn, nullptr);
+    }
+#else
+    if (!options.certFile.empty()) {
+        std::cerr << "built without TLS support" << std::endl;
+        return 1;
+    }
+#endif
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int enable = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listener, 16) < 0) {
+        std::cerr << "cannot listen on port " << options.port << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+    std::cerr << "listening on 127.0.0.1:" << options.port << (options.certFile.empty() ? " (h2c)" : " (h2)")
+              << std::endl;
+
+    Script script(options.scriptDir);
+    Statistics statistics;
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::vector<pollfd> pollFds;
+    while (!g_isStopping) {
+        auto now = std::chrono::steady_clock::now();
+        int timeoutMs = -1;
+        pollFds.assign(1, pollfd{listener, POLLIN, 0});
+        for (auto& session : sessions) {
+            short events = POLLIN;
+            if (session->wantsWrite()) {
+                events |= POLLOUT;
+            }
+            pollFds.push_back(pollfd{session->getFd(), events, 0});
+            std::chrono::steady_clock::time_point when;
+            if (session->getNextTimer(&when)) {
+                auto untilMs = std::chrono::duration_cast<std::chrono::milliseconds>(when - now).count() + 1;
+                untilMs = std::max<long long>(untilMs, 0);
+                if (timeoutMs < 0 || untilMs < timeoutMs) {
+                    timeoutMs = static_cast<int>(untilMs);
+                }
+            }
+        }
+        if (poll(pollFds.data(), pollFds.size(), timeoutMs) < 0 && errno != EINTR) {
+            std::cerr << "poll failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        now = std::chrono::steady_clock::now();
+        for (size_t index = 0; index < sessions.size(); ++index) {
+            auto& session = sessions[index];
+            auto revents = pollFds[index + 1].revents;
+            if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                session->onReadable();
+            }
+            session->runTimers(now);
+            session->flush();
+        }
+        auto end = std::remove_if(sessions.begin(), sessions.end(), [&options](const std::unique_ptr<Session>& s) {
+            if (s->isDone() && options.verbose) {
+                std::cerr << "fd " << s->getFd() << ": closed" << std::endl;
+            }
+            return s->isDone();
+        });
+        sessions.erase(end, sessions.end());
+
+        if (pollFds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(listener, nullptr, nullptr)) >= 0) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                SSL* ssl = nullptr;
+#ifdef ACSDK_LOOPBACK_TLS
+                if (tlsContext) {
+                    ssl = SSL_new(tlsContext);
+                    SSL_set_fd(ssl, fd);
+                    SSL_set_accept_state(ssl);
+                }
+#endif
+                std::unique_ptr<Session> session(new Session(fd, ssl, options, script, statistics));
+                if (session->start()) {
+                    ++statistics.connections;
+                    if (options.verbose) {
+                        std::cerr << "fd " << fd << ": connected" << std::endl;
+                    }
+                    sessions.push_back(std::move(session));
+                }
+            }
+        }
+    }
+
+    std::cerr << "connections " << statistics.connections << ", events " << statistics.events << ", pings "
+              << statistics.pings << ", directives " << statistics.directives << ", resets " << statistics.resets
+              << ", goaways " << statistics.goaways << ", compressed events " << statistics.compressedEvents
+              << std::endl;
+    sessions.clear();
+    close(listener);
+#ifdef ACSDK_LOOPBACK_TLS
+    if (tlsContext) {
+        SSL_CTX_free(tlsContext);
+    }
+#endif
+    return 0;
+}
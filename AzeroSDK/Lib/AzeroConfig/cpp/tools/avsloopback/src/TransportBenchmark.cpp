@@ -0,0 +1,501 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Drives MessageRouter, HTTP2Transport, DownchannelHandler, PingHandler and the HTTP/2 connection against
+// AVSLoopbackServer, and prints connect time, events per second, directive delivery latency and reconnect time.
+//
+// usage: AVSTransportBenchmark [options]
+//
+//   -e endpoint        Server to connect to (default https://127.0.0.1:18443).
+//   -c config.json     SDK configuration, for example libcurlUtils CURLOPT_CAPATH to trust the server's certificate.
+//   -n events          Events to send (default 1000).
+//   -w window          Events in flight at once (default 16).
+//   -t seconds         How long to collect downchannel directives (default 5).  Start the server with
+//                      --push-interval for there to be any.
+//   -r reconnects      Reconnects to measure (default 5).  Each sends Benchmark.GoAway, which the server answers with
+//                      GOAWAY.
+//   --thread-per-connection  Use LibcurlHTTP2Connection rather than LibcurlEventHTTP2Connection.
+//
+// Directive latency is measured from the sentAtUs the server puts in each directive to its arrival at the
+// MessageRouter observer, so the server must run on the same host.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ACL/Transport/HTTP2Transport.h>
+#include <ACL/Transport/HTTP2TransportFactory.h>
+#include <ACL/Transport/MessageRouter.h>
+#include <ACL/Transport/MessageRouterObserverInterface.h>
+#include <ACL/Transport/PostConnectFactoryInterface.h>
+#include <ACL/Transport/PostConnectInterface.h>
+#include <AVSCommon/AVS/Attachment/AttachmentManager.h>
+#include <AVSCommon/AVS/MessageRequest.h>
+#include <AVSCommon/SDKInterfaces/AuthDelegateInterface.h>
+#include <AVSCommon/SDKInterfaces/MessageRequestObserverInterface.h>
+#include <AVSCommon/Utils/Configuration/ConfigurationNode.h>
+#include <AVSCommon/Utils/LibcurlUtils/LibcurlEventHTTP2ConnectionFactory.h>
+#include <AVSCommon/Utils/LibcurlUtils/LibcurlHTTP2ConnectionFactory.h>
+
+using namespace alexaClientSDK;
+using namespace alexaClientSDK::acl;
+using namespace alexaClientSDK::avsCommon::avs;
+using namespace alexaClientSDK::avsCommon::sdkInterfaces;
+
+/// How long to wait for a connection or reconnection.
+static const std::chrono::seconds CONNECT_TIMEOUT(30);
+
+/// How long to wait for the events to complete, beyond the time they should take.
+static const std::chrono::seconds EVENTS_TIMEOUT(60);
+
+/// Command line options.
+struct Options {
+    std::string endpoint = "https://127.0.0.1:18443";
+    std::string configFile;
+    int events = 1000;
+    int window = 16;
+    int directiveSeconds = 5;
+    int reconnects = 5;
+    bool useThreadPerConnection = false;
+};
+
+/**
+ * Get the system clock in microseconds, as the server stamps directives with.
+ *
+ * @return The system clock in microseconds.
+ */
+static long long nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * Print the percentiles of a set of durations.
+ *
+ * @param name The name of the measurement.
+ * @param samplesUs The durations in microseconds.
+ */
+static void reportPercentiles(const std::string& name, std::vector<long long> samplesUs) {
+    std::cout << name << ": ";
+    if (samplesUs.empty()) {
+        std::cout << "no samples" << std::endl;
+        return;
+    }
+    std::sort(samplesUs.begin(), samplesUs.end());
+    auto percentile = [&samplesUs](size_t percent) {
+        return samplesUs[std::min(samplesUs.size() - 1, samplesUs.size() * percent / 100)] / 1000.0;
+    };
+    std::cout << "p50 " << percentile(50) << " ms, p90 " << percentile(90) << " ms, p99 " << percentile(99)
+              << " ms, max " << samplesUs.back() / 1000.0 << " ms (" << samplesUs.size() << " samples)" << std::endl;
+}
+
+/// Auth delegate with a fixed token.
+class StaticAuthDelegate : public AuthDelegateInterface {
+public:
+    void addAuthObserver(std::shared_ptr<AuthObserverInterface> observer) override {
+        observer->onAuthStateChange(AuthObserverInterface::State::REFRESHED, AuthObserverInterface::Error::SUCCESS);
+    }
+    void removeAuthObserver(std::shared_ptr<AuthObserverInterface> observer) override {
+    }
+    std::string getAuthToken() override {
+        return "loopback-benchmark-token";
+    }
+    void onAuthFailure(const std::string& token) override {
+    }
+};
+
+/// Post connect which completes at once, in place of synchronizing state.
+class ImmediatePostConnect : public PostConnectInterface {
+public:
+    bool doPostConnect(std::shared_ptr<HTTP2Transport> transport) override {
+        transport->onPostConnected();
+        return true;
+    }
+    void onDisconnect() override {
+    }
+};
+
+/// Factory for @c ImmediatePostConnect.
+class ImmediatePostConnectFactory : public PostConnectFactoryInterface {
+public:
+    std::shared_ptr<PostConnectInterface> createPostConnect() override {
+        return std::make_shared<ImmediatePostConnect>();
+    }
+};
+
+/// Records what the transport stack reports.
+class BenchmarkObserver : public MessageRouterObserverInterface {
+public:
+    /// @name MessageRouterObserverInterface methods.
+    /// @{
+    void onConnectionStatusChanged(
+        const ConnectionStatusObserverInterface::Status status,
+        const ConnectionStatusObserverInterface::ChangedReason reason) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_status = status;
+        if (ConnectionStatusObserverInterface::Status::CONNECTED == status) {
+            ++m_connectCount;
+        }
+        m_wakeTrigger.notify_all();
+    }
+
+    void receive(const std::string& contextId, const std::string& message) override {
+        static const std::string sentAtKey = "\"sentAtUs\":";
+        auto receivedAtUs = nowUs();
+        auto position = message.find(sentAtKey);
+        if (std::string::npos == position) {
+            return;
+        }
+        auto sentAtUs = std::strtoll(message.c_str() + position + sentAtKey.size(), nullptr, 10);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_directiveLatenciesUs.push_back(receivedAtUs - sentAtUs);
+    }
+    /// @}
+
+    /**
+     * Wait for the connection to be established a number of times in all.
+     *
+     * @param count The number of connections.
+     * @param timeout How long to wait.
+     * @return Whether the connection was established.
+     */
+    bool waitForConnectCount(int count, std::chrono::steady_clock::duration timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_wakeTrigger.wait_for(lock, timeout, [this, count]() {
+            return m_connectCount >= count && ConnectionStatusObserverInterface::Status::CONNECTED == m_status;
+        });
+    }
+
+    /**
+     * Get the number of times the connection has been established.
+     *
+     * @return The number of connections.
+     */
+    int getConnectCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_connectCount;
+    }
+
+    /**
+     * Take the directive latencies recorded so far.
+     *
+     * @return The latencies in microseconds.
+     */
+    std::vector<long long> takeDirectiveLatencies() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<long long> latencies;
+        latencies.swap(m_directiveLatenciesUs);
+        return latencies;
+    }
+
+private:
+    /// Serializes access to the members below.
+    std::mutex m_mutex;
+
+    /// Notified when the connection status changes.
+    std::condition_variable m_wakeTrigger;
+
+    /// The connection status.
+    ConnectionStatusObserverInterface::Status m_status = ConnectionStatusObserverInterface::Status::DISCONNECTED;
+
+    /// The number of times the connection has been established.
+    int m_connectCount = 0;
+
+    /// Directive latencies in microseconds.
+    std::vector<long long> m_directiveLatenciesUs;
+};
+
+/// Limits the events in flight, and records how long each took.
+class EventWindow {
+public:
+    /**
+     * Constructor.
+     *
+     * @param size The number of events allowed in flight.
+     */
+    EventWindow(int size) : m_size{size}, m_inFlight{0}, m_failures{0} {
+    }
+
+    /**
+     * Wait for room and take it.
+     */
+    void acquire() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeTrigger.wait(lock, [this]() { return m_inFlight < m_size; });
+        ++m_inFlight;
+    }
+
+    /**
+     * Give back room once an event has completed.
+     *
+     * @param durationUs How long the event took.
+     * @param isSuccess Whether the event succeeded.
+     */
+    void release(long long durationUs, bool isSuccess) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_inFlight;
+        m_durationsUs.push_back(durationUs);
+        if (!isSuccess) {
+            ++m_failures;
+        }
+        m_wakeTrigger.notify_all();
+    }
+
+    /**
+     * Wait for every event to complete.
+     *
+     * @param timeout How long to wait.
+     * @return Whether every event completed.
+     */
+    bool drain(std::chrono::steady_clock::duration timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_wakeTrigger.wait_for(lock, timeout, [this]() { return 0 == m_inFlight; });
+    }
+
+    /**
+     * Get how long each event took.
+     *
+     * @return The durations in microseconds.
+     */
+    std::vector<long long> getDurations() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_durationsUs;
+    }
+
+    /**
+     * Get the number of events which failed.
+     *
+     * @return The number of failures.
+     */
+    int getFailures() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_failures;
+    }
+
+private:
+    /// Serializes access to the members below.
+    std::mutex m_mutex;
+
+    /// Notified when an event completes.
+    std::condition_variable m_wakeTrigger;
+
+    /// The number of events allowed in flight.
+    const int m_size;
+
+    /// The number of events in flight.
+    int m_inFlight;
+
+    /// The number of events which failed.
+    int m_failures;
+
+    /// How long each completed event took, in microseconds.
+    std::vector<long long> m_durationsUs;
+};
+
+/// Returns an event's room in the window when it completes.
+class EventObserver : public MessageRequestObserverInterface {
+public:
+    /**
+     * Constructor.
+     *
+     * @param window The window to release.
+     */
+    EventObserver(std::shared_ptr<EventWindow> window) :
+            m_window{window},
+            m_start{std::chrono::steady_clock::now()} {
+    }
+
+    /// @name MessageRequestObserverInterface methods.
+    /// @{
+    void onSendCompleted(MessageRequestObserverInterface::Status status) override {
+        auto duration = std::chrono::steady_clock::now() - m_start;
+        bool isSuccess = MessageRequestObserverInterface::Status::SUCCESS == status ||
+                         MessageRequestObserverInterface::Status::SUCCESS_NO_CONTENT == status;
+        m_window->release(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), isSuccess);
+    }
+
+    void onExceptionReceived(const std::string& exceptionMessage) override {
+    }
+    /// @}
+
+private:
+    /// The window to release.
+    std::shared_ptr<EventWindow> m_window;
+
+    /// When the event was sent.
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * Build an event.
+ *
+ * @param name The event's name, in the Benchmark namespace.
+ * @param id Used for the message id.
+ * @return The event's JSON.
+ */
+static std::string buildEvent(const std::string& name, int id) {
+    std::ostringstream event;
+    event << "{\"event\":{\"header\":{\"namespace\":\"Benchmark\",\"name\":\"" << name << "\",\"messageId\":\"bench-"
+          << id << "\"},\"payload\":{}}}";
+    return event.str();
+}
+
+/**
+ * Parse the command line.
+ *
+ * @param argc The argument count.
+ * @param argv The arguments.
+ * @param[out] options Receives the options.
+ * @return Whether the command line was valid.
+ */
+static bool parseOptions(int argc, char* argv[], Options* options) {
+    for (int index = 1; index < argc; ++index) {
+        std::string arg = argv[index];
+        bool hasValue = index + 1 < argc;
+        if ("--thread-per-connection" == arg) {
+            options->useThreadPerConnection = true;
+        } else if (!hasValue) {
+            return false;
+        } else if ("-e" == arg) {
+            options->endpoint = argv[++index];
+        } else if ("-c" == arg) {
+            options->configFile = argv[++index];
+        } else if ("-n" == arg) {
+            options->events = std::atoi(argv[++index]);
+        } else if ("-w" == arg) {
+            options->window = std::atoi(argv[++index]);
+        } else if ("-t" == arg) {
+            options->directiveSeconds = std::atoi(argv[++index]);
+        } else if ("-r" == arg) {
+            options->reconnects = std::atoi(argv[++index]);
+        } else {
+            return false;
+        }
+    }
+    return options->events >= 0 && options->window > 0 && options->directiveSeconds >= 0 && options->reconnects >= 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        std::cerr << "usage: " << argv[0]
+                  << " [-e endpoint] [-c config.json] [-n events] [-w window] [-t seconds] [-r reconnects]"
+                     " [--thread-per-connection]"
+                  << std::endl;
+        return 2;
+    }
+
+    std::vector<std::shared_ptr<std::istream>> configStreams;
+    if (options.configFile.empty()) {
+        configStreams.push_back(std::make_shared<std::stringstream>("{}"));
+    } else {
+        auto file = std::make_shared<std::ifstream>(options.configFile);
+        if (!file->is_open()) {
+            std::cerr << options.configFile << ": cannot open file" << std::endl;
+            return 1;
+        }
+        configStreams.push_back(file);
+    }
+    if (!avsCommon::utils::configuration::ConfigurationNode::initialize(configStreams)) {
+        std::cerr << "cannot initialize configuration" << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<avsCommon::utils::http2::HTTP2ConnectionFactoryInterface> connectionFactory;
+    if (options.useThreadPerConnection) {
+        connectionFactory = std::make_shared<avsCommon::utils::libcurlUtils::LibcurlHTTP2ConnectionFactory>();
+    } else {
+        connectionFactory = std::make_shared<avsCommon::utils::libcurlUtils::LibcurlEventHTTP2ConnectionFactory>();
+    }
+    auto transportFactory =
+        std::make_shared<HTTP2TransportFactory>(connectionFactory, std::make_shared<ImmediatePostConnectFactory>());
+    auto messageRouter = std::make_shared<MessageRouter>(
+        std::make_shared<StaticAuthDelegate>(),
+        std::make_shared<attachment::AttachmentManager>(attachment::AttachmentManager::AttachmentType::IN_PROCESS),
+        transportFactory,
+        options.endpoint);
+    auto observer = std::make_shared<BenchmarkObserver>();
+    messageRouter->setObserver(observer);
+
+    std::cout << "endpoint " << options.endpoint << ", "
+              << (options.useThreadPerConnection ? "LibcurlHTTP2Connection" : "LibcurlEventHTTP2Connection")
+              << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    messageRouter->enable();
+    if (!observer->waitForConnectCount(1, CONNECT_TIMEOUT)) {
+        std::cerr << "not connected after " << CONNECT_TIMEOUT.count() << " s" << std::endl;
+        messageRouter->shutdown();
+        return 1;
+    }
+    std::cout << "connect: "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms"
+              << std::endl;
+
+    bool success = true;
+    if (options.events > 0) {
+        auto window = std::make_shared<EventWindow>(options.window);
+        start = std::chrono::steady_clock::now();
+        for (int index = 0; index < options.events; ++index) {
+            window->acquire();
+            auto request = std::make_shared<MessageRequest>(buildEvent("Event", index));
+            request->addObserver(std::make_shared<EventObserver>(window));
+            messageRouter->sendMessage(request);
+        }
+        if (!window->drain(EVENTS_TIMEOUT)) {
+            std::cerr << "events did not complete" << std::endl;
+            success = false;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "events: " << options.events << " in " << seconds << " s, " << options.events / seconds
+                  << " events/s, window " << options.window << ", " << window->getFailures() << " failed" << std::endl;
+        reportPercentiles("event completion", window->getDurations());
+    }
+
+    if (options.directiveSeconds > 0) {
+        observer->takeDirectiveLatencies();
+        std::this_thread::sleep_for(std::chrono::seconds(options.directiveSeconds));
+        reportPercentiles("directive delivery", observer->takeDirectiveLatencies());
+    }
+
+    std::vector<long long> reconnectsUs;
+    for (int index = 0; index < options.reconnects; ++index) {
+        auto connectCount = observer->getConnectCount();
+        start = std::chrono::steady_clock::now();
+        messageRouter->sendMessage(std::make_shared<MessageRequest>(buildEvent("GoAway", index)));
+        if (!observer->waitForConnectCount(connectCount + 1, CONNECT_TIMEOUT)) {
+            std::cerr << "not reconnected after " << CONNECT_TIMEOUT.count() << " s" << std::endl;
+            success = false;
+            break;
+        }
+        reconnectsUs.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+    if (options.reconnects > 0) {
+        reportPercentiles("reconnect", reconnectsUs);
+    }
+
+    messageRouter->shutdown();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,663 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Replays a directive recording through MessageInterpreter, DirectiveSequencer and stub directive handlers, and prints
+// how long each namespace's directives took from being received to being handled.
+//
+// usage: AVSDirectiveReplay [-s speed] [-n repeat] [-w waitSeconds] [-d] <recording>
+//
+// Recordings are made with DirectiveRecorder::getInstance()->start(path), which records the directives and
+// attachments of every response on connections made by LibcurlEventHTTP2ConnectionFactory.  The engine's own
+// transport, the prebuilt LibcurlHTTP2Connection, is not recorded, so recordings come from a process which sends its
+// events through that factory.  They are replayed at speed times the recorded pace (default 1), or as fast as they
+// can be received with -s 0.  With -n the recording is replayed repeat times, with the message and dialog request
+// ids of each replay suffixed so that they are not taken for duplicates.  With -d the handlers are wrapped with a
+// DirectiveDispatcher, to compare running them across mediums with running them on the sequencer.
+//
+// The pipeline is the one DefaultClient builds, but with stub handlers in place of the capability agents: Speak reads
+// its attachment to the end before completing, and the others complete at once.  Before a directive with a new dialog
+// request id is received, the tool waits up to waitSeconds (default 10) for the directives of the last dialog to be
+// handled, as a user waits for a response before speaking again, and then sets the sequencer's dialog request id, as
+// the device did when it sent the event the directive answers.  Otherwise the sequencer would drop the directives of a
+// dialog which had not finished when the next one started.  The same wait follows the last directive, after which any
+// directive which was not handled is counted.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <ADSL/DirectiveDispatcher.h>
+#include <ADSL/DirectiveSequencer.h>
+#include <ADSL/MessageInterpreter.h>
+#include <AVSCommon/AVS/Attachment/AttachmentManager.h>
+#include <AVSCommon/AVS/DirectivePayload.h>
+#include <AVSCommon/AVS/ExceptionEncounteredSender.h>
+#include <AVSCommon/SDKInterfaces/DirectiveHandlerInterface.h>
+#include <AVSCommon/SDKInterfaces/MessageSenderInterface.h>
+#include <AVSCommon/Utils/HTTP2/DirectiveRecorder.h>
+#include <AVSCommon/Utils/JSON/JSONUtils.h>
+#include <AVSCommon/Utils/Threading/Executor.h>
+
+using namespace alexaClientSDK;
+using namespace alexaClientSDK::avsCommon::avs;
+using namespace alexaClientSDK::avsCommon::avs::attachment;
+using namespace alexaClientSDK::avsCommon::sdkInterfaces;
+using namespace alexaClientSDK::avsCommon::utils::http2;
+
+/// How long to wait for a handler to read an attachment before dropping the rest of it.
+static const std::chrono::seconds ATTACHMENT_WRITE_TIMEOUT(5);
+
+/// How long a stub handler waits for more attachment data before giving up on it.
+static const std::chrono::seconds ATTACHMENT_READ_TIMEOUT(10);
+
+/// A directive or attachment record, ready to be replayed.
+struct Step {
+    /// The type of the record.
+    DirectiveRecording::RecordType type;
+
+    /// When the record was received, since the start of the recording.
+    std::chrono::microseconds time;
+
+    /// The context id attachments of the record's response are filed under.
+    std::string contextId;
+
+    /// The directive JSON, or the attachment's content id.
+    std::string text;
+
+    /// The message id of a directive.
+    std::string messageId;
+
+    /// The dialog request id of a directive.
+    std::string dialogRequestId;
+
+    /// The attachment data.  Points into the recording, which outlives the steps.
+    const std::string* data;
+
+    /// The replay the step belongs to.
+    int replay;
+};
+
+/// Latencies and counts of the directives being replayed.
+class Statistics {
+public:
+    /**
+     * Note that a directive is about to be received.
+     *
+     * @param messageId The message id of the directive.
+     */
+    void onReceiving(const std::string& messageId) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_receiveTimes[messageId] = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * Note that a handler was asked to handle a directive.
+     *
+     * @param directive The directive.
+     */
+    void onHandled(const std::shared_ptr<AVSDirective>& directive) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_receiveTimes.find(directive->getMessageId());
+        if (it == m_receiveTimes.end()) {
+            return;
+        }
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - it->second);
+        m_latencies[directive->getNamespace()].push_back(latency.count());
+        m_receiveTimes.erase(it);
+        m_lastHandled = now;
+        m_wakeTrigger.notify_all();
+    }
+
+    /**
+     * Note that a directive was cancelled.
+     *
+     * @param messageId The message id of the directive.
+     */
+    void onCancelled(const std::string& messageId) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_receiveTimes.erase(messageId)) {
+            ++m_cancelled;
+            m_wakeTrigger.notify_all();
+        }
+    }
+
+    /**
+     * Wait until every directive received has been handled or cancelled.
+     *
+     * @param timeout How long to wait.
+     * @return Whether they have been.
+     */
+    bool waitForDirectives(std::chrono::steady_clock::duration timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_wakeTrigger.wait_for(lock, timeout, [this] { return m_receiveTimes.empty(); });
+    }
+
+    /**
+     * Print the latencies and counts.
+     *
+     * @param start When the first directive was received.
+     * @param exceptions The number of ExceptionEncountered events sent.
+     */
+    void report(std::chrono::steady_clock::time_point start, size_t exceptions) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t handled = 0;
+        std::cout << "namespace                count     p50 us     p90 us     p99 us     max us" << std::endl;
+        for (auto& entry : m_latencies) {
+            auto& latencies = entry.second;
+            std::sort(latencies.begin(), latencies.end());
+            handled += latencies.size();
+            std::cout << entry.first << std::string(entry.first.size() < 24 ? 24 - entry.first.size() : 1, ' ')
+                      << pad(std::to_string(latencies.size()), 6) << pad(percentile(latencies, 50), 11)
+                      << pad(percentile(latencies, 90), 11) << pad(percentile(latencies, 99), 11)
+                      << pad(percentile(latencies, 100), 11) << std::endl;
+        }
+        double seconds = handled ? std::chrono::duration<double>(m_lastHandled - start).count() : 0;
+        std::cout << "handled " << handled << " directives";
+        if (seconds > 0) {
+            std::cout << " in " << seconds << " s (" << handled / seconds << " directives/s)";
+        }
+        std::cout << std::endl;
+        std::cout << "cancelled " << m_cancelled << ", not handled " << m_receiveTimes.size() << ", exceptions sent "
+                  << exceptions << std::endl;
+    }
+
+private:
+    /**
+     * Get a percentile of sorted latencies.
+     *
+     * @param latencies The sorted latencies.
+     * @param percent The percentile.
+     * @return The latency at the percentile, or "-" if there are none.
+     */
+    static std::string percentile(const std::vector<long long>& latencies, size_t percent) {
+        if (latencies.empty()) {
+            return "-";
+        }
+        return std::to_string(latencies[(latencies.size() - 1) * percent / 100]);
+    }
+
+    /**
+     * Right align a column.
+     *
+     * @param text The text of the column.
+     * @param width The width of the column.
+     * @return The padded text.
+     */
+    static std::string pad(const std::string& text, size_t width) {
+        return std::string(text.size() < width ? width - text.size() : 1, ' ') + text;
+    }
+
+    /// Protects the members below.
+    std::mutex m_mutex;
+
+    /// Notified when a directive is handled or cancelled.
+    std::condition_variable m_wakeTrigger;
+
+    /// When each directive not yet handled was received, by message id.
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> m_receiveTimes;
+
+    /// The latencies of handled directives in microseconds, by namespace.
+    std::map<std::string, std::vector<long long>> m_latencies;
+
+    /// The number of directives cancelled.
+    size_t m_cancelled = 0;
+
+    /// When the last directive was handled.
+    std::chrono::steady_clock::time_point m_lastHandled;
+};
+
+/// Message sender which counts the ExceptionEncountered events it is given instead of sending them.
+class CountingMessageSender : public MessageSenderInterface {
+public:
+    void sendMessage(std::shared_ptr<MessageRequest> request) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_count;
+    }
+
+    /// @return The number of messages sent.
+    size_t getCount() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_count;
+    }
+
+private:
+    /// Protects @c m_count.
+    std::mutex m_mutex;
+
+    /// The number of messages sent.
+    size_t m_count = 0;
+};
+
+/// Stub handler for every directive in the recording.
+class ReplayHandler : public DirectiveHandlerInterface {
+public:
+    /**
+     * Constructor.
+     *
+     * @param configuration The directives to handle, and their blocking policies.
+     * @param statistics Where to note handled directives.
+     */
+    ReplayHandler(DirectiveHandlerConfiguration configuration, std::shared_ptr<Statistics> statistics) :
+            m_configuration{std::move(configuration)},
+            m_statistics{std::move(statistics)},
+            m_audioExecutor{"ReplayHandlerAudio"},
+            m_executor{"ReplayHandler"} {
+    }
+
+    /// @name DirectiveHandlerInterface methods.
+    /// @{
+    void handleDirectiveImmediately(std::shared_ptr<AVSDirective> directive) override {
+        m_statistics->onHandled(directive);
+        if (auto reader = getAttachmentReader(directive)) {
+            m_audioExecutor.submit([this, reader] { drain(reader); });
+        }
+    }
+
+    void preHandleDirective(
+        std::shared_ptr<AVSDirective> directive,
+        std::unique_ptr<DirectiveHandlerResultInterface> result) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& entry = m_directives[directive->getMessageId()];
+        entry.first = directive;
+        entry.second = std::move(result);
+    }
+
+    bool handleDirective(const std::string& messageId) override {
+        std::pair<std::shared_ptr<AVSDirective>, std::shared_ptr<DirectiveHandlerResultInterface>> entry;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_directives.find(messageId);
+            if (it == m_directives.end()) {
+                return false;
+            }
+            entry = std::move(it->second);
+            m_directives.erase(it);
+        }
+        m_statistics->onHandled(entry.first);
+        auto result = entry.second;
+        auto reader = getAttachmentReader(entry.first);
+        if (reader) {
+            // Like SpeechSynthesizer, complete once the audio has been played, which here is once it has been read.
+            m_audioExecutor.submit([this, reader, result] {
+                drain(reader);
+                result->setCompleted();
+            });
+        } else {
+            // Like the capability agents, complete from another thread rather than from inside the sequencer's call.
+            m_executor.submit([result] { result->setCompleted(); });
+        }
+        return true;
+    }
+
+    void cancelDirective(const std::string& messageId) override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_directives.erase(messageId);
+        }
+        m_statistics->onCancelled(messageId);
+    }
+
+    void onDeregistered() override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_directives.clear();
+    }
+
+    DirectiveHandlerConfiguration getConfiguration() const override {
+        return m_configuration;
+    }
+    /// @}
+
+    /// Wait for the handlers' attachment reads and completions, and refuse any more.
+    void shutdown() {
+        m_audioExecutor.shutdown();
+        m_executor.shutdown();
+    }
+
+private:
+    /**
+     * Get a reader for the audio of a Speak directive.
+     *
+     * @param directive The directive.
+     * @return The reader, or nullptr if the directive is not a Speak or has no attachment.
+     */
+    static std::shared_ptr<AttachmentReader> getAttachmentReader(const std::shared_ptr<AVSDirective>& directive) {
+        if (directive->getNamespace() != "SpeechSynthesizer" || directive->getName() != "Speak") {
+            return nullptr;
+        }
+        auto payload = DirectivePayload::get(directive);
+        std::string url;
+        if (!payload || !payload->isValid() ||
+            !avsCommon::utils::json::jsonUtils::retrieveValue(payload->getRoot(), "url", &url) ||
+            url.compare(0, 4, "cid:") != 0) {
+            return nullptr;
+        }
+        return directive->getAttachmentReader(url.substr(4), avsCommon::utils::sds::ReaderPolicy::BLOCKING);
+    }
+
+    /**
+     * Read an attachment to the end.
+     *
+     * @param reader The reader of the attachment.
+     */
+    static void drain(const std::shared_ptr<AttachmentReader>& reader) {
+        char buffer[4096];
+        auto status = AttachmentReader::ReadStatus::OK;
+        while (AttachmentReader::ReadStatus::OK == status || AttachmentReader::ReadStatus::OK_WOULDBLOCK == status ||
+               AttachmentReader::ReadStatus::OK_OVERRUN_RESET == status) {
+            reader->read(
+                buffer,
+                sizeof(buffer),
+                &status,
+                std::chrono::duration_cast<std::chrono::milliseconds>(ATTACHMENT_READ_TIMEOUT));
+        }
+        reader->close();
+    }
+
+    /// The directives to handle, and their blocking policies.
+    const DirectiveHandlerConfiguration m_configuration;
+
+    /// Where to note handled directives.
+    std::shared_ptr<Statistics> m_statistics;
+
+    /// Protects @c m_directives.
+    std::mutex m_mutex;
+
+    /// Directives which have been pre-handled, and their results, by message id.
+    std::unordered_map<
+        std::string,
+        std::pair<std::shared_ptr<AVSDirective>, std::shared_ptr<DirectiveHandlerResultInterface>>>
+        m_directives;
+
+    /// Reads Speak attachments, one at a time as SpeechSynthesizer plays them.
+    avsCommon::utils::threading::Executor m_audioExecutor;
+
+    /// Completes the other directives.
+    avsCommon::utils::threading::Executor m_executor;
+};
+
+/**
+ * Get the blocking policy the capability agent handling a directive would give it.
+ *
+ * @param nameSpace The namespace of the directive.
+ * @param name The name of the directive.
+ * @return The blocking policy.
+ */
+static BlockingPolicy getBlockingPolicy(const std::string& nameSpace, const std::string& name) {
+    if (("SpeechSynthesizer" == nameSpace && "Speak" == name) ||
+        ("SpeechRecognizer" == nameSpace && "ExpectSpeech" == name)) {
+        return BlockingPolicy(BlockingPolicy::MEDIUM_AUDIO, true);
+    }
+    if ("AudioPlayer" == nameSpace) {
+        return BlockingPolicy(BlockingPolicy::MEDIUM_AUDIO, false);
+    }
+    if ("TemplateRuntime" == nameSpace) {
+        return BlockingPolicy(BlockingPolicy::MEDIUM_VISUAL, false);
+    }
+    return BlockingPolicy(BlockingPolicy::MEDIUMS_NONE, false);
+}
+
+/**
+ * Read the header of a directive, and suffix its ids for a replay after the first.
+ *
+ * @param json The directive JSON, which is rewritten if the ids are suffixed.
+ * @param replay The number of the replay.
+ * @param[out] nameSpace The namespace of the directive.
+ * @param[out] name The name of the directive.
+ * @param[out] messageId The message id of the directive, as replayed.
+ * @param[out] dialogRequestId The dialog request id of the directive, as replayed, or an empty string.
+ * @return Whether the directive could be read.
+ */
+static bool prepareDirective(
+    std::string* json,
+    int replay,
+    std::string* nameSpace,
+    std::string* name,
+    std::string* messageId,
+    std::string* dialogRequestId) {
+    rapidjson::Document document;
+    document.Parse(json->c_str());
+    if (document.HasParseError() || !document.IsObject()) {
+        return false;
+    }
+    auto directive = document.FindMember("directive");
+    if (directive == document.MemberEnd() || !directive->value.IsObject()) {
+        return false;
+    }
+    auto header = directive->value.FindMember("header");
+    if (header == directive->value.MemberEnd() || !header->value.IsObject()) {
+        return false;
+    }
+    std::map<std::string, std::string*> fields = {
+        {"namespace", nameSpace}, {"name", name}, {"messageId", messageId}, {"dialogRequestId", dialogRequestId}};
+    for (auto& field : fields) {
+        auto member = header->value.FindMember(field.first.c_str());
+        field.second->clear();
+        if (member != header->value.MemberEnd() && member->value.IsString()) {
+            field.second->assign(member->value.GetString(), member->value.GetStringLength());
+        }
+    }
+    if (nameSpace->empty() || name->empty() || messageId->empty()) {
+        return false;
+    }
+    if (0 == replay) {
+        return true;
+    }
+    auto suffix = "#" + std::to_string(replay);
+    for (auto id : {messageId, dialogRequestId}) {
+        if (id->empty()) {
+            continue;
+        }
+        id->append(suffix);
+        auto key = id == messageId ? "messageId" : "dialogRequestId";
+        header->value[key].SetString(id->c_str(), id->size(), document.GetAllocator());
+    }
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    document.Accept(writer);
+    json->assign(buffer.GetString(), buffer.GetSize());
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    double speed = 1;
+    int repeat = 1;
+    int waitSeconds = 10;
+    bool useDispatcher = false;
+    std::string path;
+    for (int index = 1; index < argc; ++index) {
+        std::string arg = argv[index];
+        if (index + 1 < argc && "-s" == arg) {
+            speed = std::atof(argv[++index]);
+        } else if (index + 1 < argc && "-n" == arg) {
+            repeat = std::atoi(argv[++index]);
+        } else if (index + 1 < argc && "-w" == arg) {
+            waitSeconds = std::atoi(argv[++index]);
+        } else if ("-d" == arg) {
+            useDispatcher = true;
+        } else if (path.empty()) {
+            path = arg;
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty() || speed < 0 || repeat <= 0 || waitSeconds < 0) {
+        std::cerr << "usage: " << argv[0] << " [-s speed] [-n repeat] [-w waitSeconds] [-d] <recording>" << std::endl;
+        return 2;
+    }
+
+    DirectiveRecordingReader reader;
+    if (!reader.open(path)) {
+        std::cerr << path << ": cannot read recording" << std::endl;
+        return 1;
+    }
+    std::vector<DirectiveRecording::Record> records;
+    DirectiveRecording::Record record;
+    while (reader.next(&record)) {
+        records.push_back(std::move(record));
+    }
+
+    // Prepare every replay up front, so that rewriting ids is not measured.
+    std::vector<Step> steps;
+    DirectiveHandlerConfiguration configuration;
+    size_t skipped = 0;
+    for (int replay = 0; replay < repeat; ++replay) {
+        for (const auto& record : records) {
+            Step step;
+            step.type = record.type;
+            step.time = record.time;
+            step.contextId = "replay-" + std::to_string(replay) + "-" + std::to_string(record.stream);
+            step.data = &record.data;
+            step.replay = replay;
+            if (DirectiveRecording::RecordType::DIRECTIVE == record.type) {
+                std::string nameSpace;
+                std::string name;
+                step.text = record.data;
+                if (!prepareDirective(
+                        &step.text, replay, &nameSpace, &name, &step.messageId, &step.dialogRequestId)) {
+                    ++skipped;
+                    continue;
+                }
+                configuration[NamespaceAndName(nameSpace, name)] = getBlockingPolicy(nameSpace, name);
+            } else {
+                step.text = record.id;
+            }
+            steps.push_back(std::move(step));
+        }
+    }
+    std::cout << path << ": " << records.size() << " records";
+    if (skipped) {
+        std::cout << ", " << skipped / repeat << " unreadable directives skipped";
+    }
+    std::cout << std::endl;
+
+    auto statistics = std::make_shared<Statistics>();
+    auto messageSender = std::make_shared<CountingMessageSender>();
+    std::shared_ptr<ExceptionEncounteredSender> exceptionSender = ExceptionEncounteredSender::create(messageSender);
+    std::shared_ptr<AttachmentManager> attachmentManager =
+        std::make_shared<AttachmentManager>(AttachmentManager::AttachmentType::IN_PROCESS);
+    std::shared_ptr<DirectiveSequencerInterface> sequencer = adsl::DirectiveSequencer::create(exceptionSender);
+    if (!exceptionSender || !sequencer) {
+        std::cerr << "cannot create the directive sequencer" << std::endl;
+        return 1;
+    }
+    auto interpreter = std::make_shared<adsl::MessageInterpreter>(exceptionSender, sequencer, attachmentManager);
+    auto handler = std::make_shared<ReplayHandler>(configuration, statistics);
+    std::shared_ptr<adsl::DirectiveDispatcher> dispatcher;
+    if (useDispatcher) {
+        dispatcher = adsl::DirectiveDispatcher::create();
+        sequencer->addDirectiveHandler(dispatcher->wrap(handler));
+    } else {
+        sequencer->addDirectiveHandler(handler);
+    }
+
+    std::unordered_map<std::string, std::unique_ptr<AttachmentWriter>> writers;
+    std::string dialogRequestId;
+    size_t droppedAttachments = 0;
+    int replay = -1;
+    std::chrono::steady_clock::time_point replayStart;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& step : steps) {
+        if (step.replay != replay) {
+            replay = step.replay;
+            replayStart = std::chrono::steady_clock::now();
+        }
+        if (speed > 0) {
+            std::this_thread::sleep_until(
+                replayStart +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(step.time / speed));
+        }
+        if (DirectiveRecording::RecordType::DIRECTIVE == step.type) {
+            if (!step.dialogRequestId.empty() && step.dialogRequestId != dialogRequestId) {
+                statistics->waitForDirectives(std::chrono::seconds(waitSeconds));
+                dialogRequestId = step.dialogRequestId;
+                sequencer->setDialogRequestId(dialogRequestId);
+            }
+            statistics->onReceiving(step.messageId);
+            interpreter->receive(step.contextId, step.text);
+            continue;
+        }
+        auto attachmentId = attachmentManager->generateAttachmentId(step.contextId, step.text);
+        auto it = writers.find(attachmentId);
+        if (DirectiveRecording::RecordType::ATTACHMENT_END == step.type) {
+            if (it != writers.end() && it->second) {
+                it->second->close();
+            }
+            // Keep the entry, so that a dropped attachment is not counted again if its content id is reused.
+            if (it != writers.end()) {
+                it->second.reset();
+            }
+            continue;
+        }
+        if (it == writers.end()) {
+            it = writers.emplace(
+                attachmentId,
+                attachmentManager->createWriter(attachmentId, avsCommon::utils::sds::WriterPolicy::BLOCKING)).first;
+            if (!it->second) {
+                ++droppedAttachments;
+            }
+        }
+        auto& writer = it->second;
+        if (!writer) {
+            continue;
+        }
+        auto status = AttachmentWriter::WriteStatus::OK;
+        writer->write(
+            step.data->data(),
+            step.data->size(),
+            &status,
+            std::chrono::duration_cast<std::chrono::milliseconds>(ATTACHMENT_WRITE_TIMEOUT));
+        if (status != AttachmentWriter::WriteStatus::OK) {
+            // Nothing read the attachment in time, or its reader went away.  Drop the rest of it.
+            ++droppedAttachments;
+            writer->close();
+            writer.reset();
+        }
+    }
+    for (auto& writer : writers) {
+        if (writer.second) {
+            writer.second->close();
+        }
+    }
+    writers.clear();
+
+    statistics->waitForDirectives(std::chrono::seconds(waitSeconds));
+    statistics->report(start, messageSender->getCount());
+    if (droppedAttachments) {
+        std::cout << "dropped " << droppedAttachments << " attachments" << std::endl;
+    }
+
+    sequencer->shutdown();
+    if (dispatcher) {
+        dispatcher->shutdown();
+    }
+    handler->shutdown();
+    return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Queues small tasks through each way of running work asynchronously, and prints the heap allocations and time per
+// task of each, so that the cost of a submission path can be compared before and after a change.
+//
+// usage: AVSExecutorBenchmark [-n tasks] [-t poolThreads]
+//
+// Each path queues tasks (default 200000) from the main thread while they run, then waits for all of them.  The
+// allocation count covers both queueing and running a task, including the future of the submit paths, and is taken
+// after a warm up round so that pooled nodes and queue chunks are already in place.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include <AVSCommon/Utils/Threading/Executor.h>
+#include <AVSCommon/Utils/Threading/Strand.h>
+#include <AVSCommon/Utils/Threading/TaskQueue.h>
+
+using namespace alexaClientSDK::avsCommon::utils::threading;
+
+/// The number of calls to operator new made by the process.
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t size) noexcept {
+    std::free(memory);
+}
+
+/// A stand-in for a component method called from its executor.
+class Component {
+public:
+    void onEvent(int value) {
+        m_sum += value;
+    }
+
+private:
+    std::atomic<long> m_sum{0};
+};
+
+/**
+ * Run one measurement after a warm up round, and print the results.
+ *
+ * @param name The name of the submission path.
+ * @param tasks The number of tasks queued by @c round.
+ * @param round Queues the tasks and waits for them to run.
+ */
+template <typename Round>
+static void measure(const std::string& name, int tasks, Round round) {
+    round();
+    size_t allocations = g_allocations;
+    auto start = std::chrono::steady_clock::now();
+    round();
+    auto duration = std::chrono::steady_clock::now() - start;
+    allocations = g_allocations - allocations;
+    double nanoseconds = std::chrono::duration<double, std::nano>(duration).count();
+    std::cout << "  " << name << std::string(name.size() < 20 ? 20 - name.size() : 1, ' ')
+              << static_cast<double>(allocations) / tasks << " allocs/task  " << nanoseconds / tasks << " ns/task"
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int tasks = 200000;
+    int poolThreads = 2;
+    for (int index = 1; index < argc; ++index) {
+        std::string arg = argv[index];
+        if (index + 1 < argc && "-n" == arg) {
+            tasks = std::atoi(argv[++index]);
+        } else if (index + 1 < argc && "-t" == arg) {
+            poolThreads = std::atoi(argv[++index]);
+        } else {
+            tasks = 0;
+            break;
+        }
+    }
+    if (tasks <= 0 || poolThreads <= 0) {
+        std::cerr << "usage: " << argv[0] << " [-n tasks] [-t poolThreads]" << std::endl;
+        return 2;
+    }
+
+    Component component;
+    std::cout << tasks << " tasks, " << poolThreads << " pool threads" << std::endl;
+
+    // A bare queue, drained on this thread, shows the cost of the queue entry alone.
+    TaskQueue queue;
+    measure("TaskQueue::push", tasks, [&] {
+        for (int count = 0; count < tasks; ++count) {
+            queue.push([&component](int value) { component.onEvent(value); }, count);
+        }
+        for (int count = 0; count < tasks; ++count) {
+            (*queue.pop())();
+        }
+    });
+    measure("TaskQueue::post", tasks, [&] {
+        for (int count = 0; count < tasks; ++count) {
+            queue.post([&component, count] { component.onEvent(count); });
+        }
+        for (int count = 0; count < tasks; ++count) {
+            (*queue.pop())();
+        }
+    });
+    queue.shutdown();
+
+    Executor executor;
+    measure("Executor::submit", tasks, [&] {
+        for (int count = 0; count < tasks; ++count) {
+            executor.submit([&component](int value) { component.onEvent(value); }, count);
+        }
+        executor.waitForSubmittedTasks();
+    });
+    measure("Executor::execute", tasks, [&] {
+        for (int count = 0; count < tasks; ++count) {
+            executor.execute([&component, count] { component.onEvent(count); });
+        }
+        executor.waitForSubmittedTasks();
+    });
+    executor.shutdown();
+
+    auto pool = ThreadPool::create(poolThreads);
+    Strand strand(pool);
+    measure("Strand::submit", tasks, [&] {
+        for (int count = 0; count < tasks; ++count) {
+            strand.submit([&component](int value) { component.onEvent(value); }, count);
+        }
+        strand.waitForSubmittedTasks();
+    });
+    measure("Strand::execute", tasks, [&] {
+        for (int count = 0; count < tasks; ++count) {
+            strand.execute([&component, count] { component.onEvent(count); });
+        }
+        strand.waitForSubmittedTasks();
+    });
+    strand.shutdown();
+    pool->shutdown();
+    return 0;
+}
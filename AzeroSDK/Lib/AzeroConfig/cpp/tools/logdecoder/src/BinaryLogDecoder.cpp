@@ -0,0 +1,81 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Host-side decoder for logs written by BinaryFileSink.  Prints each entry as LogFormatter text, the same as FileSink
+// would have written it.
+//
+// usage: AACEBinaryLogDecoder <file>...
+//
+// Pass rotated files oldest first (e.g. azero.2.bin azero.1.bin azero.bin) to get one time-ordered log.
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <AACE/Engine/Logger/BinaryLogFormat.h>
+#include <AACE/Engine/Logger/LogFormatter.h>
+
+using aace::engine::logger::BinaryLogDecoder;
+using aace::engine::logger::LogFormatter;
+
+static bool decodeFile( const std::string& filename )
+{
+    std::ifstream file( filename, std::ios::binary );
+    if( !file.is_open() ) {
+        std::cerr << filename << ": cannot open file" << std::endl;
+        return false;
+    }
+    std::string data( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+
+    BinaryLogDecoder decoder;
+    BinaryLogDecoder::Entry entry;
+    size_t offset = 0;
+    while( true )
+    {
+        switch( decoder.next( data.data(), data.size(), &offset, &entry ) )
+        {
+            case BinaryLogDecoder::Status::ENTRY:
+                std::cout << LogFormatter::format( entry.level, entry.time, entry.threadMoniker.c_str(), entry.text.c_str() ) << '\n';
+                break;
+
+            case BinaryLogDecoder::Status::END:
+                return true;
+
+            case BinaryLogDecoder::Status::TRUNCATED:
+                // expected if the device stopped part way through a write
+                std::cerr << filename << ": truncated record at offset " << offset << ", " << data.size() - offset << " bytes ignored" << std::endl;
+                return true;
+
+            case BinaryLogDecoder::Status::CORRUPT:
+                std::cerr << filename << ": invalid data at offset " << offset << std::endl;
+                return false;
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    if( argc < 2 ) {
+        std::cerr << "usage: " << argv[0] << " <file>..." << std::endl;
+        return 2;
+    }
+    bool success = true;
+    for( int index = 1; index < argc; index++ ) {
+        success = decodeFile( argv[index] ) && success;
+    }
+    std::cout.flush();
+    return success ? 0 : 1;
+}
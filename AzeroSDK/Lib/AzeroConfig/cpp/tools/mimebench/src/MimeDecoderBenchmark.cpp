@@ -0,0 +1,264 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Replays captured multipart response bodies through the MIME boundary search and HTTP2StreamingMimeResponseDecoder,
+// and prints the throughput of each boundary search implementation next to a byte by byte search.
+//
+// usage: AVSMimeDecoderBenchmark [-b boundary] [-c chunkSize] [-n iterations] <file>...
+//
+// Each file holds one response body, as captured from the downchannel or an event stream.  If no boundary is given it
+// is taken from the first delimiter line of each file.  Data is fed in chunks of chunkSize bytes (default 16384, about
+// what libcurl hands over per callback) to include the cost of boundaries split across chunks.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <AVSCommon/Utils/HTTP2/HTTP2StreamingMimeResponseDecoder.h>
+#include <AVSCommon/Utils/HTTP2/MimeBoundaryFinder.h>
+
+using namespace alexaClientSDK::avsCommon::utils::http2;
+
+/// A captured response body and its boundary.
+struct Capture {
+    std::string filename;
+    std::string boundary;
+    std::string body;
+};
+
+/// Sink which counts parts and bytes.
+class CountingSink : public HTTP2MimeResponseSinkInterface {
+public:
+    bool onReceiveResponseCode(long responseCode) override {
+        return true;
+    }
+    bool onReceiveHeaderLine(const std::string& line) override {
+        return true;
+    }
+    bool onBeginMimePart(const std::multimap<std::string, std::string>& headers) override {
+        return true;
+    }
+    HTTP2ReceiveDataStatus onReceiveMimeData(const char* bytes, size_t size) override {
+        // Touch the data so that the zero copy path is not measured as doing nothing.
+        checksum += static_cast<unsigned char>(bytes[0]) + static_cast<unsigned char>(bytes[size - 1]);
+        dataSize += size;
+        return HTTP2ReceiveDataStatus::SUCCESS;
+    }
+    bool onEndMimePart() override {
+        ++parts;
+        return true;
+    }
+    HTTP2ReceiveDataStatus onReceiveNonMimeData(const char* bytes, size_t size) override {
+        return HTTP2ReceiveDataStatus::SUCCESS;
+    }
+    void onResponseFinished(HTTP2ResponseFinishedStatus status) override {
+    }
+
+    size_t parts = 0;
+    size_t dataSize = 0;
+    size_t checksum = 0;
+};
+
+/**
+ * Search for a delimiter one byte at a time, the way the multipart parser does.
+ *
+ * @param delimiter The delimiter.
+ * @param data The data to search.
+ * @param size The size of @c data.
+ * @return The number of delimiters found.
+ */
+static size_t countByteByByte(const std::string& delimiter, const char* data, size_t size) {
+    size_t count = 0;
+    size_t matched = 0;
+    for (size_t index = 0; index < size; ++index) {
+        while (matched > 0 && data[index] != delimiter[matched]) {
+            // Restart the match at the next possible start, as a naive parser would by rescanning.
+            index -= matched - 1;
+            matched = 0;
+        }
+        if (data[index] == delimiter[matched] && ++matched == delimiter.size()) {
+            ++count;
+            matched = 0;
+        }
+    }
+    return count;
+}
+
+/**
+ * Count delimiters with a @c MimeBoundaryFinder, feeding the data in chunks.
+ *
+ * @param finder The finder.
+ * @param data The data to search.
+ * @param size The size of @c data.
+ * @param chunkSize The size of each chunk.
+ * @return The number of delimiters found.
+ */
+static size_t countWithFinder(const MimeBoundaryFinder& finder, const char* data, size_t size, size_t chunkSize) {
+    const size_t length = finder.getDelimiter().size();
+    size_t count = 0;
+    size_t offset = 0;
+    while (offset < size) {
+        size_t end = offset + chunkSize < size ? offset + chunkSize : size;
+        // Let a search run over the end of the chunk by one delimiter, as the decoder does with its carry.
+        size_t limit = end + length - 1 < size ? end + length - 1 : size;
+        while (offset < end) {
+            size_t found = finder.find(data + offset, limit - offset);
+            if (offset + found >= end) {
+                offset = end;
+                break;
+            }
+            ++count;
+            offset += found + length;
+        }
+    }
+    return count;
+}
+
+/**
+ * Print the throughput of one measurement.
+ *
+ * @param name The name of the measurement.
+ * @param bytes The number of bytes processed.
+ * @param duration How long it took.
+ * @param count The number of parts or delimiters found.
+ */
+static void report(const std::string& name, size_t bytes, std::chrono::steady_clock::duration duration, size_t count) {
+    double seconds = std::chrono::duration<double>(duration).count();
+    double megabytesPerSecond = seconds > 0 ? bytes / seconds / (1024 * 1024) : 0;
+    std::cout << "  " << name << std::string(name.size() < 14 ? 14 - name.size() : 1, ' ') << megabytesPerSecond
+              << " MB/s (" << count << ")" << std::endl;
+}
+
+/**
+ * Find the boundary from the first delimiter line of a body.
+ *
+ * @param body The body.
+ * @return The boundary, or an empty string.
+ */
+static std::string detectBoundary(const std::string& body) {
+    auto start = body.find("--");
+    if (start == std::string::npos) {
+        return "";
+    }
+    auto end = body.find_first_of(" \t\r\n", start + 2);
+    if (end == std::string::npos) {
+        return "";
+    }
+    return body.substr(start + 2, end - start - 2);
+}
+
+int main(int argc, char* argv[]) {
+    std::string boundary;
+    size_t chunkSize = 16384;
+    int iterations = 100;
+    std::vector<Capture> captures;
+    for (int index = 1; index < argc; ++index) {
+        std::string arg = argv[index];
+        if (index + 1 < argc && "-b" == arg) {
+            boundary = argv[++index];
+        } else if (index + 1 < argc && "-c" == arg) {
+            chunkSize = std::strtoul(argv[++index], nullptr, 10);
+        } else if (index + 1 < argc && "-n" == arg) {
+            iterations = std::atoi(argv[++index]);
+        } else {
+            std::ifstream file(arg, std::ios::binary);
+            if (!file.is_open()) {
+                std::cerr << arg << ": cannot open file" << std::endl;
+                return 1;
+            }
+            Capture capture;
+            capture.filename = arg;
+            capture.body.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            captures.push_back(std::move(capture));
+        }
+    }
+    if (captures.empty() || 0 == chunkSize || iterations <= 0) {
+        std::cerr << "usage: " << argv[0] << " [-b boundary] [-c chunkSize] [-n iterations] <file>..." << std::endl;
+        return 2;
+    }
+
+    bool success = true;
+    for (auto& capture : captures) {
+        capture.boundary = boundary.empty() ? detectBoundary(capture.body) : boundary;
+        if (capture.boundary.empty()) {
+            std::cerr << capture.filename << ": no boundary found" << std::endl;
+            success = false;
+            continue;
+        }
+        const std::string delimiter = "\r\n--" + capture.boundary;
+        // The body usually starts with a delimiter without its leading CRLF.
+        const std::string data = "\r\n" + capture.body;
+        const size_t totalBytes = data.size() * iterations;
+        std::cout << capture.filename << ": " << data.size() << " bytes, boundary " << capture.boundary << ", chunk "
+                  << chunkSize << std::endl;
+
+        size_t expected = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            expected = countByteByByte(delimiter, data.data(), data.size());
+        }
+        report("byte-by-byte", totalBytes, std::chrono::steady_clock::now() - start, expected);
+
+        const std::pair<MimeBoundaryFinder::Implementation, const char*> implementations[] = {
+            {MimeBoundaryFinder::Implementation::SCALAR, "scalar"},
+            {MimeBoundaryFinder::Implementation::SSE2, "sse2"},
+            {MimeBoundaryFinder::Implementation::AVX2, "avx2"},
+            {MimeBoundaryFinder::Implementation::NEON, "neon"},
+        };
+        for (const auto& implementation : implementations) {
+            if (!MimeBoundaryFinder::isSupported(implementation.first)) {
+                continue;
+            }
+            MimeBoundaryFinder finder(delimiter, implementation.first);
+            size_t count = 0;
+            start = std::chrono::steady_clock::now();
+            for (int iteration = 0; iteration < iterations; ++iteration) {
+                count = countWithFinder(finder, data.data(), data.size(), chunkSize);
+            }
+            report(implementation.second, totalBytes, std::chrono::steady_clock::now() - start, count);
+            if (count != expected) {
+                std::cerr << capture.filename << ": " << implementation.second << " found " << count
+                          << " delimiters, expected " << expected << std::endl;
+                success = false;
+            }
+        }
+
+        size_t parts = 0;
+        start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            auto sink = std::make_shared<CountingSink>();
+            HTTP2StreamingMimeResponseDecoder decoder(sink);
+            decoder.onReceiveHeaderLine("Content-Type: multipart/related; boundary=" + capture.boundary + "\r\n");
+            for (size_t offset = 0; offset < capture.body.size(); offset += chunkSize) {
+                size_t size = capture.body.size() - offset < chunkSize ? capture.body.size() - offset : chunkSize;
+                if (decoder.onReceiveData(capture.body.data() + offset, size) != HTTP2ReceiveDataStatus::SUCCESS) {
+                    std::cerr << capture.filename << ": decoder failed at offset " << offset << std::endl;
+                    success = false;
+                    break;
+                }
+            }
+            decoder.onResponseFinished(HTTP2ResponseFinishedStatus::COMPLETE);
+            parts = sink->parts;
+        }
+        report("decoder", capture.body.size() * iterations, std::chrono::steady_clock::now() - start, parts);
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,392 @@
+/*
+ * Copyright 2017-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_ALEXA_VOICE_LATENCY_TRACER_H
+#define AACE_ENGINE_ALEXA_VOICE_LATENCY_TRACER_H
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "AACE/Engine/Core/EngineMacros.h"
+#include "AACE/Engine/Metrics/MetricsRegistry.h"
+
+namespace aace {
+namespace engine {
+namespace alexa {
+
+/**
+ * Breaks the user-perceived latency measured by @c UPLService down by pipeline stage.  Each stage of a voice turn
+ * stamps the turn's trace as it passes; when the turn ends, the tracer logs the whole waterfall as one structured
+ * record and records the time spent between consecutive stages in @c MetricsRegistry histograms, so a regression can
+ * be traced to the stage that caused it.
+ *
+ * Traces are keyed by dialogRequestId.  The speech recognizer handler stamps the first audio written and the end of
+ * capture with the dialogRequestId of the Recognize event, and the first such stamp binds the dialogRequestId to the
+ * current turn, or starts a turn if the current one is bound to another.  Stages which run before the dialogRequestId
+ * is known (wake word detection, audio query start) stamp the current turn, unless it was bound at a later stage, in
+ * which case they start the next turn; so a turn started without a wake word does not merge into the one before it.
+ * The first stamp of each stage wins; repeats, such as audio query start retries, are counted.
+ *
+ * Only app-side stages are traced.  The speech encoder, the event upload, MIME parsing of the response, the directive
+ * sequencer and the TTS download all run inside the prebuilt engine libraries, which have no hook to stamp from.  Their
+ * combined time is recorded, unattributed, as the @c PLAYBACK_STARTED stage (the time since @c STOP_CAPTURE), so a
+ * regression there can only be traced to the engine as a whole.
+ */
+class VoiceLatencyTracer {
+public:
+    /**
+     * The stages of a voice turn, in pipeline order.
+     */
+    enum class Stage {
+        /// OpenDenoise detected the wake word.
+        WAKE_WORD_DETECTED,
+        /// The audio query executor started the query.  Retries are counted.
+        AUDIO_QUERY_STARTED,
+        /// The first audio was written to the speech recognizer.
+        FIRST_AUDIO_WRITTEN,
+        /// The engine stopped capture at the end of speech.
+        STOP_CAPTURE,
+        /// TTS playback started.
+        PLAYBACK_STARTED
+    };
+
+    /// The number of stages.
+    static const size_t STAGE_COUNT = static_cast<size_t>(Stage::PLAYBACK_STARTED) + 1;
+
+    /// The number of turns traced at once; the oldest unfinished turn is reported when another starts.
+    static const size_t MAX_OPEN_TURNS = 4;
+
+    /**
+     * Return the one and only @c VoiceLatencyTracer instance.
+     *
+     * @return The one and only @c VoiceLatencyTracer instance.
+     */
+    static std::shared_ptr<VoiceLatencyTracer> getInstance();
+
+    /**
+     * Starts a new current turn, e.g. on wake word detection.  An unfinished current turn is reported first.
+     */
+    void beginTurn();
+
+    /**
+     * Stamps a stage of the current turn, starting a turn if there is none.
+     *
+     * @param stage The stage reached.
+     */
+    void stamp(Stage stage);
+
+    /**
+     * Stamps a stage of a turn.  If no turn has this dialogRequestId yet, it is given to the current turn, or to a new
+     * turn if the current turn already has one.  An empty dialogRequestId stamps the current turn, as @c stamp(stage).
+     *
+     * @param dialogRequestId The dialogRequestId of the turn.
+     * @param stage The stage reached.
+     */
+    void stamp(const std::string& dialogRequestId, Stage stage);
+
+    /**
+     * Ends the current turn and reports it.
+     */
+    void endTurn();
+
+    /**
+     * Ends a turn and reports it.
+     *
+     * @param dialogRequestId The dialogRequestId of the turn.
+     */
+    void endTurn(const std::string& dialogRequestId);
+
+    /**
+     * Gets the name of a stage, as used in the log record and metric names.
+     *
+     * @param stage The stage.
+     * @return The name of the stage.
+     */
+    static const char* stageToString(Stage stage);
+
+private:
+    /// The stamps of one turn.
+    struct Trace {
+        /// The dialogRequestId, once known.
+        std::string dialogRequestId;
+
+        /// The stage whose stamp bound @c dialogRequestId.
+        size_t boundAt;
+
+        /// When each stage was first reached.
+        std::array<std::chrono::steady_clock::time_point, STAGE_COUNT> times;
+
+        /// How many times each stage was reached.
+        std::array<unsigned int, STAGE_COUNT> counts;
+
+        /// Constructor.
+        Trace();
+    };
+
+    /// Constructor.
+    VoiceLatencyTracer();
+
+    /**
+     * Finds the trace for a dialogRequestId, binding or creating one if needed.
+     *
+     * @param dialogRequestId The dialogRequestId.
+     * @param[out] evicted Receives a trace evicted to make room, if any.
+     * @return The trace.
+     */
+    Trace& findTrace(const std::string& dialogRequestId, std::deque<Trace>* evicted);
+
+    /**
+     * Starts a new current trace.  Must be called with @c m_mutex held.
+     *
+     * @param[out] evicted Receives a trace evicted to make room, if any.
+     */
+    void startTrace(std::deque<Trace>* evicted);
+
+    /**
+     * Records a stage in a trace.
+     *
+     * @param trace The trace.
+     * @param stage The stage reached.
+     * @param now The time it was reached.
+     */
+    static void record(Trace& trace, Stage stage, std::chrono::steady_clock::time_point now);
+
+    /**
+     * Logs a trace's waterfall and records its stage histograms.
+     *
+     * @param trace The trace to report.
+     */
+    void report(const Trace& trace);
+
+    /// Guards the traces.
+    std::mutex m_mutex;
+
+    /// Open traces, oldest first.  The current turn is the last one.
+    std::deque<Trace> m_traces;
+
+    /// The histogram of time spent reaching each stage from the previous stamped stage.
+    std::array<std::shared_ptr<aace::engine::metrics::MetricsRegistry::Histogram>, STAGE_COUNT> m_stageHistograms;
+
+    /// The histogram of the time from the first to the last stamped stage.
+    std::shared_ptr<aace::engine::metrics::MetricsRegistry::Histogram> m_totalHistogram;
+};
+
+inline VoiceLatencyTracer::Trace::Trace() : boundAt{STAGE_COUNT} {
+    times.fill(std::chrono::steady_clock::time_point());
+    counts.fill(0);
+}
+
+inline std::shared_ptr<VoiceLatencyTracer> VoiceLatencyTracer::getInstance() {
+    static std::shared_ptr<VoiceLatencyTracer> instance(new VoiceLatencyTracer());
+    return instance;
+}
+
+inline VoiceLatencyTracer::VoiceLatencyTracer() {
+    auto registry = aace::engine::metrics::MetricsRegistry::getInstance();
+    for (size_t index = 0; index < STAGE_COUNT; ++index) {
+        m_stageHistograms[index] =
+            registry->getHistogram("VoiceLatencyTracer", "stage", stageToString(static_cast<Stage>(index)));
+    }
+    m_totalHistogram = registry->getHistogram("VoiceLatencyTracer", "turn", "total");
+}
+
+inline void VoiceLatencyTracer::beginTurn() {
+    std::deque<Trace> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_traces.empty()) {
+            evicted.push_back(std::move(m_traces.back()));
+            m_traces.pop_back();
+        }
+        startTrace(&evicted);
+    }
+    for (auto& trace : evicted) {
+        report(trace);
+    }
+}
+
+inline void VoiceLatencyTracer::stamp(Stage stage) {
+    auto now = std::chrono::steady_clock::now();
+    std::deque<Trace> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // a stage before the one which bound the current turn belongs to the next turn
+        if (m_traces.empty() || (m_traces.back().boundAt != STAGE_COUNT &&
+                                 static_cast<size_t>(stage) < m_traces.back().boundAt)) {
+            startTrace(&evicted);
+        }
+        record(m_traces.back(), stage, now);
+    }
+    for (auto& trace : evicted) {
+        report(trace);
+    }
+}
+
+inline void VoiceLatencyTracer::stamp(const std::string& dialogRequestId, Stage stage) {
+    if (dialogRequestId.empty()) {
+        stamp(stage);
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    std::deque<Trace> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& trace = findTrace(dialogRequestId, &evicted);
+        if (trace.boundAt == STAGE_COUNT) {
+            trace.boundAt = static_cast<size_t>(stage);
+        }
+        record(trace, stage, now);
+    }
+    for (auto& trace : evicted) {
+        report(trace);
+    }
+}
+
+inline void VoiceLatencyTracer::endTurn() {
+    Trace trace;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_traces.empty()) {
+            return;
+        }
+        trace = std::move(m_traces.back());
+        m_traces.pop_back();
+    }
+    report(trace);
+}
+
+inline void VoiceLatencyTracer::endTurn(const std::string& dialogRequestId) {
+    Trace trace;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_traces.begin();
+        while (it != m_traces.end() && it->dialogRequestId != dialogRequestId) {
+            ++it;
+        }
+        if (it == m_traces.end()) {
+            return;
+        }
+        trace = std::move(*it);
+        m_traces.erase(it);
+    }
+    report(trace);
+}
+
+inline const char* VoiceLatencyTracer::stageToString(Stage stage) {
+    switch (stage) {
+        case Stage::WAKE_WORD_DETECTED:
+            return "wakeWordDetected";
+        case Stage::AUDIO_QUERY_STARTED:
+            return "audioQueryStarted";
+        case Stage::FIRST_AUDIO_WRITTEN:
+            return "firstAudioWritten";
+        case Stage::STOP_CAPTURE:
+            return "stopCapture";
+        case Stage::PLAYBACK_STARTED:
+            return "playbackStarted";
+    }
+    return "unknown";
+}
+
+inline VoiceLatencyTracer::Trace& VoiceLatencyTracer::findTrace(
+    const std::string& dialogRequestId,
+    std::deque<Trace>* evicted) {
+    for (auto& trace : m_traces) {
+        if (trace.dialogRequestId == dialogRequestId) {
+            return trace;
+        }
+    }
+    if (m_traces.empty() || !m_traces.back().dialogRequestId.empty()) {
+        startTrace(evicted);
+    }
+    m_traces.back().dialogRequestId = dialogRequestId;
+    return m_traces.back();
+}
+
+inline void VoiceLatencyTracer::startTrace(std::deque<Trace>* evicted) {
+    while (m_traces.size() >= MAX_OPEN_TURNS) {
+        evicted->push_back(std::move(m_traces.front()));
+        m_traces.pop_front();
+    }
+    m_traces.emplace_back();
+}
+
+inline void VoiceLatencyTracer::record(Trace& trace, Stage stage, std::chrono::steady_clock::time_point now) {
+    size_t index = static_cast<size_t>(stage);
+    if (0 == trace.counts[index]++) {
+        trace.times[index] = now;
+    }
+}
+
+inline void VoiceLatencyTracer::report(const Trace& trace) {
+    // stages are reported in pipeline order; a stage reached out of order is measured from the stage before it in
+    // time, so that every delta is non-negative
+    std::chrono::steady_clock::time_point first;
+    std::chrono::steady_clock::time_point last;
+    bool any = false;
+    for (size_t index = 0; index < STAGE_COUNT; ++index) {
+        if (trace.counts[index] > 0) {
+            if (!any || trace.times[index] < first) {
+                first = trace.times[index];
+            }
+            if (!any || trace.times[index] > last) {
+                last = trace.times[index];
+            }
+            any = true;
+        }
+    }
+    if (!any) {
+        return;
+    }
+
+    aace::engine::logger::LogEntry entry("VoiceLatencyTracer", "voiceLatencyWaterfall");
+    entry.d("dialogRequestId", trace.dialogRequestId.empty() ? std::string("unknown") : trace.dialogRequestId);
+    for (size_t index = 0; index < STAGE_COUNT; ++index) {
+        if (0 == trace.counts[index]) {
+            continue;
+        }
+        auto time = trace.times[index];
+        auto previous = first;
+        for (size_t other = 0; other < STAGE_COUNT; ++other) {
+            if (trace.counts[other] > 0 && trace.times[other] <= time && trace.times[other] > previous &&
+                other != index) {
+                previous = trace.times[other];
+            }
+        }
+        auto offset = std::chrono::duration_cast<std::chrono::milliseconds>(time - first).count();
+        auto name = stageToString(static_cast<Stage>(index));
+        entry.d(name, std::to_string(offset) + "ms");
+        if (trace.counts[index] > 1) {
+            entry.d((std::string(name) + "Count").c_str(), static_cast<int>(trace.counts[index]));
+        }
+        if (time != first) {
+            m_stageHistograms[index]->record(time - previous);
+        }
+    }
+    auto total = std::chrono::duration_cast<std::chrono::milliseconds>(last - first).count();
+    entry.d("totalMs", static_cast<long long>(total));
+    m_totalHistogram->record(last - first);
+    AACE_INFO(entry);
+}
+
+}  // alexa
+}  // engine
+}  // aace
+
+#endif  // AACE_ENGINE_ALEXA_VOICE_LATENCY_TRACER_H
@@ -18,6 +18,7 @@
 
 #include "AACE/Engine/Core/EngineServiceManager.h"
 #include "AACE/Engine/Logger/EngineLogger.h"
+#include "AACE/Engine/Logger/LogLevelFilter.h"
 
 #define VA_NUM_ARGS(...) VA_NUM_ARGS_IMPL(__VA_ARGS__, 5,4,3,2,1)
 #define VA_NUM_ARGS_IMPL(_1,_2,_3,_4,_5,N,...) N
@@ -43,12 +44,44 @@
 // logging
 #define AACE_LOGGER (aace::engine::logger::EngineLogger::getInstance())
 #define AACE_LOG_LEVEL aace::engine::logger::EngineLogger::Level
+
+// numeric log levels for the build-time minimums below; these must match AACE_LOG_LEVEL
+#define AACE_LOG_LEVEL_VERBOSE 0
+#define AACE_LOG_LEVEL_INFO 1
+#define AACE_LOG_LEVEL_METRIC 2
+#define AACE_LOG_LEVEL_WARN 3
+#define AACE_LOG_LEVEL_ERROR 4
+#define AACE_LOG_LEVEL_CRITICAL 5
+#define AACE_LOG_LEVEL_NONE 6
+
+static_assert( static_cast<int>( AACE_LOG_LEVEL::METRIC ) == AACE_LOG_LEVEL_METRIC, "AACE_LOG_LEVEL_METRIC mismatch" );
+static_assert( static_cast<int>( AACE_LOG_LEVEL::CRITICAL ) == AACE_LOG_LEVEL_CRITICAL, "AACE_LOG_LEVEL_CRITICAL mismatch" );
+
+// build-time minimum level of the AACE_* macros; lower levels compile to nothing, including their arguments.
+// define per module, e.g. -DAACE_MIN_LOG_LEVEL=AACE_LOG_LEVEL_WARN
+#ifndef AACE_MIN_LOG_LEVEL
+#define AACE_MIN_LOG_LEVEL AACE_LOG_LEVEL_VERBOSE
+#endif
+
+// build-time minimum level of the SAI_* macros; defaults to AACE_MIN_LOG_LEVEL in debug builds, and to at least INFO
+// otherwise, so that SAI_VERBOSE/SAI_DEBUG compile out of release builds like AACE_VERBOSE/AACE_DEBUG do
+#ifndef SAI_MIN_LOG_LEVEL
+#if defined(AACE_DEBUG_LOG_ENABLED) || defined(DEBUG) || AACE_MIN_LOG_LEVEL > AACE_LOG_LEVEL_INFO
+#define SAI_MIN_LOG_LEVEL AACE_MIN_LOG_LEVEL
+#else
+#define SAI_MIN_LOG_LEVEL AACE_LOG_LEVEL_INFO
+#endif
+#endif
+
+// the runtime level check happens before the entry expression is evaluated
 #define AACE_LOG(level, entry)                                   \
     do {                                                         \
-        AACE_LOGGER->log(level, entry);                          \
+        if (aace::engine::logger::LogLevelFilter::shouldLog(level)) { \
+            AACE_LOGGER->log(level, entry);                      \
+        }                                                        \
     } while (false)
 
-#ifdef AACE_DEBUG_LOG_ENABLED
+#if defined(AACE_DEBUG_LOG_ENABLED) && AACE_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_VERBOSE
 #define AACE_DEBUG(entry) AACE_LOG(AACE_LOG_LEVEL::VERBOSE, entry)
 #define AACE_VERBOSE(entry) AACE_LOG(AACE_LOG_LEVEL::VERBOSE, entry)
 #else // AACE_DEBUG_LOG_ENABLED
@@ -56,16 +89,35 @@
 #define AACE_VERBOSE(entry)
 #endif // AACE_DEBUG_LOG_ENABLED
 
-#ifdef AAC_LATENCY_LOGS_ENABLED
+#if defined(AAC_LATENCY_LOGS_ENABLED) && AACE_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_METRIC
 #define AACE_METRIC(entry) AACE_LOG(AACE_LOG_LEVEL::METRIC, entry)
 #else // AAC_LATENCY_LOGS_ENABLED
 #define AACE_METRIC(entry)
 #endif // AAC_LATENCY_LOGS_ENABLED
 
+#if AACE_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_INFO
 #define AACE_INFO(entry) AACE_LOG(AACE_LOG_LEVEL::INFO, entry)
+#else
+#define AACE_INFO(entry)
+#endif
+
+#if AACE_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_WARN
 #define AACE_WARN(entry) AACE_LOG(AACE_LOG_LEVEL::WARN, entry)
+#else
+#define AACE_WARN(entry)
+#endif
+
+#if AACE_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_ERROR
 #define AACE_ERROR(entry) AACE_LOG(AACE_LOG_LEVEL::ERROR, entry)
+#else
+#define AACE_ERROR(entry)
+#endif
+
+#if AACE_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_CRITICAL
 #define AACE_CRITICAL(entry) AACE_LOG(AACE_LOG_LEVEL::CRITICAL, entry)
+#else
+#define AACE_CRITICAL(entry)
+#endif
 
 // creates a log event for the aace logger
 #define LX(...) macro_dispatcher(LX, __VA_ARGS__)(__VA_ARGS__)
@@ -78,15 +130,47 @@
 #define SAI_LOG_LEVEL aace::engine::logger::EngineLogger::Level
 #define SAI_LOG(level, entry)                                   \
     do {                                                         \
-        SAI_LOGGER->log("SAI",level, entry);                          \
+        if (aace::engine::logger::LogLevelFilter::shouldLog(level)) { \
+            SAI_LOGGER->log("SAI",level, entry);                 \
+        }                                                        \
     } while (false)
 
+#if SAI_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_VERBOSE
 #define SAI_DEBUG(entry) SAI_LOG(SAI_LOG_LEVEL::VERBOSE, entry)
 #define SAI_VERBOSE(entry) SAI_LOG(SAI_LOG_LEVEL::VERBOSE, entry)
+#else
+#define SAI_DEBUG(entry)
+#define SAI_VERBOSE(entry)
+#endif
+
+#if SAI_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_METRIC
 #define SAI_METRIC(entry) SAI_LOG(SAI_LOG_LEVEL::METRIC, entry)
+#else
+#define SAI_METRIC(entry)
+#endif
+
+#if SAI_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_INFO
 #define SAI_INFO(entry) SAI_LOG(SAI_LOG_LEVEL::INFO, entry)
+#else
+#define SAI_INFO(entry)
+#endif
+
+#if SAI_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_WARN
 #define SAI_WARN(entry) SAI_LOG(SAI_LOG_LEVEL::WARN, entry)
+#else
+#define SAI_WARN(entry)
+#endif
+
+#if SAI_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_ERROR
 #define SAI_ERROR(entry) SAI_LOG(SAI_LOG_LEVEL::ERROR, entry)
+#else
+#define SAI_ERROR(entry)
+#endif
+
+#if SAI_MIN_LOG_LEVEL <= AACE_LOG_LEVEL_CRITICAL
 #define SAI_CRITICAL(entry) SAI_LOG(SAI_LOG_LEVEL::CRITICAL, entry)
+#else
+#define SAI_CRITICAL(entry)
+#endif
 
 #endif // AACE_ENGINE_CORE_ENGINE_EXCEPTIONS_H
@@ -0,0 +1,506 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOGGER_BINARY_LOG_FORMAT_H
+#define AACE_ENGINE_LOGGER_BINARY_LOG_FORMAT_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AACE/Logger/LoggerEngineInterfaces.h"
+
+namespace aace {
+namespace engine {
+namespace logger {
+
+//
+// Compact binary encoding of log entries, used by BinaryFileSink and decoded offline by the BinaryLogDecoder tool.
+//
+// A stream is one or more sections.  Each section starts with a header and has its own string table, so a rotated
+// or appended file can be decoded on its own:
+//
+//   header: "AACB" <version:u8> <base time, microseconds since epoch:u64 little endian>
+//   record: <type:varint> ...
+//     type 0 (string):  <length:varint> <bytes>            adds the next entry to the section's string table
+//     type 1-6 (entry): <time delta, microseconds:zigzag varint> <moniker piece> <text pieces>
+//
+// Entry text is split on the LogEntry separators ':', ',' and '='.  Each piece is written as an op byte
+// (kind * 4 + separator following the piece, 0 for end of text) and a payload: a string table index, a literal
+// (<length:varint> <bytes>), a decimal integer (zigzag varint), or a lowercase UUID (16 bytes).  Keys, the tag/event
+// pieces ahead of the first key and enum-like values (short, with no digits) are interned; canonical decimal values
+// are stored as integers and UUIDs (e.g. message ids) as bytes; everything else is a literal.  Decoding reproduces
+// the original text exactly.
+//
+
+class BinaryLogEncoder {
+public:
+    using Level = aace::logger::LoggerEngineInterface::Level;
+
+    BinaryLogEncoder( size_t maxStrings = 4096, size_t maxStringLength = 64 );
+
+    // starts a new section, resetting the string table
+    void begin( std::chrono::system_clock::time_point baseTime, std::string& out );
+
+    // appends an entry (and any new strings it needs) to out
+    void encode( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text, std::string& out );
+
+    static void putVarint( uint64_t value, std::string& out );
+    static uint64_t zigzag( int64_t value );
+
+private:
+    void putPiece( const char* data, size_t size, uint8_t separator, bool internable, std::string& strings );
+    static bool isCanonicalInteger( const char* data, size_t size, int64_t* value );
+    static bool isIdentifier( const char* data, size_t size );
+    static bool putUuid( const char* data, size_t size, std::string& out );
+
+private:
+    size_t m_maxStrings;
+    size_t m_maxStringLength;
+    std::unordered_map<std::string,uint32_t> m_strings;
+    int64_t m_lastMicros;
+
+    // scratch buffers, reused across entries
+    std::string m_key;
+    std::string m_record;
+};
+
+class BinaryLogDecoder {
+public:
+    using Level = aace::logger::LoggerEngineInterface::Level;
+
+    enum class Status {
+        // an entry was decoded
+        ENTRY,
+        // the end of the data was reached cleanly
+        END,
+        // the data ends part way through a record, e.g. after a crash
+        TRUNCATED,
+        // the data is not a valid stream
+        CORRUPT
+    };
+
+    struct Entry {
+        Level level;
+        std::chrono::system_clock::time_point time;
+        std::string threadMoniker;
+        std::string text;
+    };
+
+    BinaryLogDecoder();
+
+    // decodes the next entry from data, starting at and advancing *offset
+    Status next( const char* data, size_t size, size_t* offset, Entry* entry );
+
+    static bool getVarint( const char* data, size_t size, size_t* offset, uint64_t* value );
+    static int64_t unzigzag( uint64_t value );
+
+private:
+    Status getPiece( const char* data, size_t size, size_t* offset, std::string* out, uint8_t* separator );
+
+private:
+    bool m_inSection;
+    int64_t m_lastMicros;
+    std::vector<std::string> m_strings;
+};
+
+// section header
+static const char BINARY_LOG_MAGIC[] = { 'A', 'A', 'C', 'B' };
+static const uint8_t BINARY_LOG_VERSION = 1;
+static const size_t BINARY_LOG_HEADER_SIZE = 4 + 1 + 8;
+
+// piece kinds and the separators that can follow a piece
+enum : uint8_t { BINARY_LOG_PIECE_STRING = 0, BINARY_LOG_PIECE_LITERAL = 1, BINARY_LOG_PIECE_INTEGER = 2, BINARY_LOG_PIECE_UUID = 3 };
+static const size_t BINARY_LOG_UUID_LENGTH = 36;
+static const size_t BINARY_LOG_MAX_IDENTIFIER_LENGTH = 32;
+static const char BINARY_LOG_SEPARATORS[] = { '\0', ':', ',', '=' };
+
+//
+// BinaryLogEncoder
+//
+
+inline BinaryLogEncoder::BinaryLogEncoder( size_t maxStrings, size_t maxStringLength ) :
+        m_maxStrings( maxStrings ),
+        m_maxStringLength( maxStringLength ),
+        m_lastMicros( 0 ) {
+}
+
+inline void BinaryLogEncoder::begin( std::chrono::system_clock::time_point baseTime, std::string& out )
+{
+    m_strings.clear();
+    m_lastMicros = std::chrono::duration_cast<std::chrono::microseconds>( baseTime.time_since_epoch() ).count();
+
+    out.append( BINARY_LOG_MAGIC, sizeof( BINARY_LOG_MAGIC ) );
+    out.push_back( static_cast<char>( BINARY_LOG_VERSION ) );
+    uint64_t base = static_cast<uint64_t>( m_lastMicros );
+    for( int byte = 0; byte < 8; byte++ ) {
+        out.push_back( static_cast<char>( ( base >> ( byte * 8 ) ) & 0xff ) );
+    }
+}
+
+inline void BinaryLogEncoder::encode( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text, std::string& out )
+{
+    int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>( time.time_since_epoch() ).count();
+
+    m_record.clear();
+    putVarint( static_cast<uint64_t>( level ) + 1, m_record );
+    putVarint( zigzag( micros - m_lastMicros ), m_record );
+    m_lastMicros = micros;
+
+    if( threadMoniker == nullptr ) {
+        threadMoniker = "";
+    }
+    putPiece( threadMoniker, std::strlen( threadMoniker ), 0, true, out );
+
+    if( text == nullptr ) {
+        text = "";
+    }
+
+    // the tag/event pieces come before the first key; values and free text after it are not interned
+    bool inHead = true;
+    const char* start = text;
+    const char* next = text;
+    while( true )
+    {
+        char c = *next;
+        if( c == '\\' && next[1] != '\0' ) {
+            next += 2;
+            continue;
+        }
+        uint8_t separator = 0;
+        switch( c ) {
+            case '\0': separator = 0; break;
+            case ':': separator = 1; break;
+            case ',': separator = 2; break;
+            case '=': separator = 3; break;
+            default:
+                next++;
+                continue;
+        }
+        bool isKey = separator == 3;
+        putPiece( start, next - start, separator, isKey || inHead || isIdentifier( start, next - start ), out );
+        if( isKey ) {
+            inHead = false;
+        }
+        if( c == '\0' ) {
+            break;
+        }
+        start = ++next;
+    }
+
+    out.append( m_record );
+}
+
+inline void BinaryLogEncoder::putPiece( const char* data, size_t size, uint8_t separator, bool internable, std::string& strings )
+{
+    if( internable && size <= m_maxStringLength )
+    {
+        m_key.assign( data, size );
+        auto it = m_strings.find( m_key );
+        if( it == m_strings.end() && m_strings.size() < m_maxStrings ) {
+            uint32_t index = static_cast<uint32_t>( m_strings.size() );
+            it = m_strings.emplace( m_key, index ).first;
+            putVarint( 0, strings );
+            putVarint( size, strings );
+            strings.append( data, size );
+        }
+        if( it != m_strings.end() ) {
+            m_record.push_back( static_cast<char>( BINARY_LOG_PIECE_STRING * 4 + separator ) );
+            putVarint( it->second, m_record );
+            return;
+        }
+    }
+
+    int64_t value = 0;
+    if( isCanonicalInteger( data, size, &value ) ) {
+        m_record.push_back( static_cast<char>( BINARY_LOG_PIECE_INTEGER * 4 + separator ) );
+        putVarint( zigzag( value ), m_record );
+        return;
+    }
+
+    size_t uuidOffset = m_record.size();
+    m_record.push_back( static_cast<char>( BINARY_LOG_PIECE_UUID * 4 + separator ) );
+    if( putUuid( data, size, m_record ) ) {
+        return;
+    }
+    m_record.resize( uuidOffset );
+
+    m_record.push_back( static_cast<char>( BINARY_LOG_PIECE_LITERAL * 4 + separator ) );
+    putVarint( size, m_record );
+    m_record.append( data, size );
+}
+
+inline bool BinaryLogEncoder::isCanonicalInteger( const char* data, size_t size, int64_t* value )
+{
+    size_t digits = size;
+    bool negative = size > 0 && data[0] == '-';
+    if( negative ) {
+        data++;
+        digits--;
+    }
+    // 18 digits always fit in an int64_t; no leading zeros and no "-0", so that decoding gives back the same text
+    if( digits == 0 || digits > 18 || ( data[0] == '0' && ( digits > 1 || negative ) ) ) {
+        return false;
+    }
+    int64_t result = 0;
+    for( size_t index = 0; index < digits; index++ ) {
+        if( data[index] < '0' || data[index] > '9' ) {
+            return false;
+        }
+        result = result * 10 + ( data[index] - '0' );
+    }
+    *value = negative ? -result : result;
+    return true;
+}
+
+inline bool BinaryLogEncoder::isIdentifier( const char* data, size_t size )
+{
+    if( size == 0 || size > BINARY_LOG_MAX_IDENTIFIER_LENGTH ) {
+        return false;
+    }
+    for( size_t index = 0; index < size; index++ ) {
+        char c = data[index];
+        if( !( ( c >= 'A' && c <= 'Z' ) || ( c >= 'a' && c <= 'z' ) || c == '_' || c == '.' ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool BinaryLogEncoder::putUuid( const char* data, size_t size, std::string& out )
+{
+    // 8-4-4-4-12 lowercase hex digits
+    if( size != BINARY_LOG_UUID_LENGTH ) {
+        return false;
+    }
+    uint8_t byte = 0;
+    bool high = true;
+    for( size_t index = 0; index < size; index++ ) {
+        char c = data[index];
+        if( index == 8 || index == 13 || index == 18 || index == 23 ) {
+            if( c != '-' ) {
+                return false;
+            }
+            continue;
+        }
+        uint8_t nibble = 0;
+        if( c >= '0' && c <= '9' ) {
+            nibble = c - '0';
+        } else if( c >= 'a' && c <= 'f' ) {
+            nibble = c - 'a' + 10;
+        } else {
+            return false;
+        }
+        if( high ) {
+            byte = nibble << 4;
+        } else {
+            out.push_back( static_cast<char>( byte | nibble ) );
+        }
+        high = !high;
+    }
+    return true;
+}
+
+inline void BinaryLogEncoder::putVarint( uint64_t value, std::string& out )
+{
+    while( value >= 0x80 ) {
+        out.push_back( static_cast<char>( ( value & 0x7f ) | 0x80 ) );
+        value >>= 7;
+    }
+    out.push_back( static_cast<char>( value ) );
+}
+
+inline uint64_t BinaryLogEncoder::zigzag( int64_t value ) {
+    return ( static_cast<uint64_t>( value ) << 1 ) ^ static_cast<uint64_t>( value >> 63 );
+}
+
+//
+// BinaryLogDecoder
+//
+
+inline BinaryLogDecoder::BinaryLogDecoder() : m_inSection( false ), m_lastMicros( 0 ) {
+}
+
+inline BinaryLogDecoder::Status BinaryLogDecoder::next( const char* data, size_t size, size_t* offset, Entry* entry )
+{
+    while( true )
+    {
+        size_t start = *offset;
+        if( start == size ) {
+            return Status::END;
+        }
+
+        // a section header may appear at any record boundary, e.g. where a file was appended to
+        if( size - start >= sizeof( BINARY_LOG_MAGIC ) && std::memcmp( data + start, BINARY_LOG_MAGIC, sizeof( BINARY_LOG_MAGIC ) ) == 0 )
+        {
+            if( size - start < BINARY_LOG_HEADER_SIZE ) {
+                return Status::TRUNCATED;
+            }
+            if( static_cast<uint8_t>( data[start + 4] ) != BINARY_LOG_VERSION ) {
+                return Status::CORRUPT;
+            }
+            uint64_t base = 0;
+            for( int byte = 0; byte < 8; byte++ ) {
+                base |= static_cast<uint64_t>( static_cast<uint8_t>( data[start + 5 + byte] ) ) << ( byte * 8 );
+            }
+            m_lastMicros = static_cast<int64_t>( base );
+            m_strings.clear();
+            m_inSection = true;
+            *offset = start + BINARY_LOG_HEADER_SIZE;
+            continue;
+        }
+        if( !m_inSection ) {
+            bool partialHeader = size - start < sizeof( BINARY_LOG_MAGIC ) && std::memcmp( data + start, BINARY_LOG_MAGIC, size - start ) == 0;
+            return partialHeader ? Status::TRUNCATED : Status::CORRUPT;
+        }
+
+        uint64_t type = 0;
+        if( !getVarint( data, size, offset, &type ) ) {
+            *offset = start;
+            return Status::TRUNCATED;
+        }
+
+        if( type == 0 )
+        {
+            uint64_t length = 0;
+            if( !getVarint( data, size, offset, &length ) || size - *offset < length ) {
+                *offset = start;
+                return Status::TRUNCATED;
+            }
+            m_strings.emplace_back( data + *offset, length );
+            *offset += length;
+            continue;
+        }
+        if( type > static_cast<uint64_t>( Level::CRITICAL ) + 1 ) {
+            return Status::CORRUPT;
+        }
+
+        uint64_t delta = 0;
+        if( !getVarint( data, size, offset, &delta ) ) {
+            *offset = start;
+            return Status::TRUNCATED;
+        }
+        int64_t micros = m_lastMicros + unzigzag( delta );
+
+        uint8_t separator = 0;
+        entry->threadMoniker.clear();
+        Status status = getPiece( data, size, offset, &entry->threadMoniker, &separator );
+        if( status == Status::ENTRY && separator != 0 ) {
+            status = Status::CORRUPT;
+        }
+        entry->text.clear();
+        while( status == Status::ENTRY ) {
+            status = getPiece( data, size, offset, &entry->text, &separator );
+            if( separator == 0 ) {
+                break;
+            }
+            entry->text.push_back( BINARY_LOG_SEPARATORS[separator] );
+        }
+        if( status != Status::ENTRY ) {
+            if( status == Status::TRUNCATED ) {
+                *offset = start;
+            }
+            return status;
+        }
+
+        m_lastMicros = micros;
+        entry->level = static_cast<Level>( type - 1 );
+        entry->time = std::chrono::system_clock::time_point( std::chrono::duration_cast<std::chrono::system_clock::duration>( std::chrono::microseconds( micros ) ) );
+        return Status::ENTRY;
+    }
+}
+
+inline BinaryLogDecoder::Status BinaryLogDecoder::getPiece( const char* data, size_t size, size_t* offset, std::string* out, uint8_t* separator )
+{
+    if( *offset == size ) {
+        return Status::TRUNCATED;
+    }
+    uint8_t op = static_cast<uint8_t>( data[( *offset )++] );
+    *separator = op & 3;
+
+    if( ( op >> 2 ) == BINARY_LOG_PIECE_UUID )
+    {
+        if( size - *offset < 16 ) {
+            return Status::TRUNCATED;
+        }
+        static const char HEX[] = "0123456789abcdef";
+        for( size_t index = 0; index < 16; index++ ) {
+            if( index == 4 || index == 6 || index == 8 || index == 10 ) {
+                out->push_back( '-' );
+            }
+            uint8_t byte = static_cast<uint8_t>( data[*offset + index] );
+            out->push_back( HEX[byte >> 4] );
+            out->push_back( HEX[byte & 0xf] );
+        }
+        *offset += 16;
+        return Status::ENTRY;
+    }
+
+    uint64_t value = 0;
+    if( !getVarint( data, size, offset, &value ) ) {
+        return Status::TRUNCATED;
+    }
+    switch( op >> 2 )
+    {
+        case BINARY_LOG_PIECE_STRING:
+            if( value >= m_strings.size() ) {
+                return Status::CORRUPT;
+            }
+            out->append( m_strings[value] );
+            return Status::ENTRY;
+
+        case BINARY_LOG_PIECE_LITERAL:
+            if( size - *offset < value ) {
+                return Status::TRUNCATED;
+            }
+            out->append( data + *offset, value );
+            *offset += value;
+            return Status::ENTRY;
+
+        case BINARY_LOG_PIECE_INTEGER:
+            out->append( std::to_string( unzigzag( value ) ) );
+            return Status::ENTRY;
+
+        default:
+            return Status::CORRUPT;
+    }
+}
+
+inline bool BinaryLogDecoder::getVarint( const char* data, size_t size, size_t* offset, uint64_t* value )
+{
+    uint64_t result = 0;
+    for( int shift = 0; shift < 64 && *offset < size; shift += 7 ) {
+        uint8_t byte = static_cast<uint8_t>( data[( *offset )++] );
+        result |= static_cast<uint64_t>( byte & 0x7f ) << shift;
+        if( ( byte & 0x80 ) == 0 ) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline int64_t BinaryLogDecoder::unzigzag( uint64_t value ) {
+    return static_cast<int64_t>( value >> 1 ) ^ -static_cast<int64_t>( value & 1 );
+}
+
+}  // logger
+}  // engine
+}  // aace
+
+#endif // AACE_ENGINE_LOGGER_BINARY_LOG_FORMAT_H
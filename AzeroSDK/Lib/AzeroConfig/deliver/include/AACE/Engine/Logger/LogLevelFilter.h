@@ -0,0 +1,199 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOGGER_LOG_LEVEL_FILTER_H
+#define AACE_ENGINE_LOGGER_LOG_LEVEL_FILTER_H
+
+#include <atomic>
+#include <istream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <rapidjson/istreamwrapper.h>
+
+#include "AACE/Core/EngineConfiguration.h"
+#include "AACE/Logger/LoggerEngineInterfaces.h"
+
+namespace aace {
+namespace engine {
+namespace logger {
+
+/**
+ * Process-wide minimum level checked by the AACE_* and SAI_* logging macros before a LogEntry is built, so that
+ * entries filtered out at runtime cost a single relaxed load.  The filter defaults to VERBOSE, which lets every entry
+ * through to the EngineLogger and its sink rules; raising it drops lower-level entries before they reach any sink.
+ * Applications set it from the engine configuration, alongside Engine::configure():
+ *
+ * @code{.cpp}
+ * LogLevelFilter::Level level;
+ * bool hasLevel = LogLevelFilter::findConfiguredLevel( configuration, &level );
+ * if( engine->configure( configuration ) && hasLevel ) {
+ *     LogLevelFilter::setMinimumLevel( level );
+ * }
+ * @endcode
+ *
+ * Levels below the build-time minimum (AACE_MIN_LOG_LEVEL / SAI_MIN_LOG_LEVEL) are compiled out and never get here.
+ */
+class LogLevelFilter {
+public:
+    using Level = aace::logger::LoggerEngineInterface::Level;
+
+    static void setMinimumLevel( Level level );
+    static Level getMinimumLevel();
+
+    static bool shouldLog( Level level );
+
+    /**
+     * Finds the lowest level any sink is configured to log in the "aace.logger" section of the engine configuration.
+     * A sink which is declared without a rule, or a rule without a level, logs everything, so it yields VERBOSE.
+     * Each stream is read from its current position and then rewound, so the configuration can still be passed to
+     * Engine::configure().
+     *
+     * @param [in] configuration The engine configuration.
+     * @param [out] level The lowest configured level.
+     * @return @c true if the configuration has logger rules, else @c false (@c level is unchanged).
+     */
+    static bool findConfiguredLevel( const std::vector<std::shared_ptr<aace::core::config::EngineConfiguration>>& configuration, Level* level );
+
+private:
+    static std::atomic<int>& minimumLevel();
+
+    // the level a rule lets through, or VERBOSE if it has none
+    static Level ruleLevel( const rapidjson::Value& rule );
+};
+
+inline void LogLevelFilter::setMinimumLevel( Level level ) {
+    minimumLevel().store( static_cast<int>( level ), std::memory_order_relaxed );
+}
+
+inline LogLevelFilter::Level LogLevelFilter::getMinimumLevel() {
+    return static_cast<Level>( minimumLevel().load( std::memory_order_relaxed ) );
+}
+
+inline bool LogLevelFilter::shouldLog( Level level ) {
+    return static_cast<int>( level ) >= minimumLevel().load( std::memory_order_relaxed );
+}
+
+inline bool LogLevelFilter::findConfiguredLevel( const std::vector<std::shared_ptr<aace::core::config::EngineConfiguration>>& configuration, Level* level ) {
+    bool found = false;
+    Level lowest = Level::CRITICAL;
+    auto lower = [&found, &lowest]( Level next ) {
+        if( static_cast<int>( next ) < static_cast<int>( lowest ) ) {
+            lowest = next;
+        }
+        found = true;
+    };
+
+    for( auto& next : configuration ) {
+        auto stream = next != nullptr ? next->getStream() : nullptr;
+        if( stream == nullptr ) {
+            continue;
+        }
+        auto start = stream->tellg();
+        rapidjson::IStreamWrapper wrapper( *stream );
+        rapidjson::Document document;
+        document.ParseStream( wrapper );
+        stream->clear();
+        stream->seekg( start );
+        if( document.HasParseError() || !document.IsObject() ) {
+            continue;
+        }
+        auto logger = document.FindMember( "aace.logger" );
+        if( logger == document.MemberEnd() || !logger->value.IsObject() ) {
+            continue;
+        }
+
+        // rules listed at the top level name their sink
+        std::set<std::string> sinksWithRules;
+        auto rules = logger->value.FindMember( "rules" );
+        if( rules != logger->value.MemberEnd() && rules->value.IsArray() ) {
+            for( auto& rule : rules->value.GetArray() ) {
+                if( !rule.IsObject() ) {
+                    continue;
+                }
+                auto sink = rule.FindMember( "sink" );
+                if( sink != rule.MemberEnd() && sink->value.IsString() ) {
+                    sinksWithRules.insert( sink->value.GetString() );
+                }
+                auto body = rule.FindMember( "rule" );
+                lower( body != rule.MemberEnd() && body->value.IsObject() ? ruleLevel( body->value ) : Level::VERBOSE );
+            }
+        }
+
+        auto sinks = logger->value.FindMember( "sinks" );
+        if( sinks != logger->value.MemberEnd() && sinks->value.IsArray() ) {
+            for( auto& sink : sinks->value.GetArray() ) {
+                if( !sink.IsObject() ) {
+                    continue;
+                }
+                auto sinkRules = sink.FindMember( "rules" );
+                if( sinkRules != sink.MemberEnd() && sinkRules->value.IsArray() && !sinkRules->value.Empty() ) {
+                    for( auto& rule : sinkRules->value.GetArray() ) {
+                        lower( rule.IsObject() ? ruleLevel( rule ) : Level::VERBOSE );
+                    }
+                    continue;
+                }
+                auto id = sink.FindMember( "id" );
+                if( id == sink.MemberEnd() || !id->value.IsString() || sinksWithRules.count( id->value.GetString() ) == 0 ) {
+                    lower( Level::VERBOSE );
+                }
+            }
+        }
+    }
+
+    if( found ) {
+        *level = lowest;
+    }
+    return found;
+}
+
+inline LogLevelFilter::Level LogLevelFilter::ruleLevel( const rapidjson::Value& rule ) {
+    // a rule which is itself wrapped as {"sink": ..., "rule": {...}}
+    auto body = rule.FindMember( "rule" );
+    if( body != rule.MemberEnd() && body->value.IsObject() ) {
+        return ruleLevel( body->value );
+    }
+    auto level = rule.FindMember( "level" );
+    if( level == rule.MemberEnd() || !level->value.IsString() ) {
+        return Level::VERBOSE;
+    }
+    static const std::pair<const char*, Level> s_levels[] = {
+        { "VERBOSE", Level::VERBOSE },
+        { "INFO", Level::INFO },
+        { "METRIC", Level::METRIC },
+        { "WARN", Level::WARN },
+        { "ERROR", Level::ERROR },
+        { "CRITICAL", Level::CRITICAL } };
+    for( auto& next : s_levels ) {
+        if( next.first == std::string( level->value.GetString() ) ) {
+            return next.second;
+        }
+    }
+    return Level::VERBOSE;
+}
+
+inline std::atomic<int>& LogLevelFilter::minimumLevel() {
+    static std::atomic<int> s_minimumLevel( static_cast<int>( Level::VERBOSE ) );
+    return s_minimumLevel;
+}
+
+}  // aace::engine::logger
+}  // aace::engine
+}  // aace
+
+#endif // AACE_ENGINE_LOGGER_LOG_LEVEL_FILTER_H
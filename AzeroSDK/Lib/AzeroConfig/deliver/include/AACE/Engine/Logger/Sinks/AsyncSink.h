@@ -0,0 +1,389 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOGGER_SINK_ASYNC_SINK_H
+#define AACE_ENGINE_LOGGER_SINK_ASYNC_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Sink.h"
+
+namespace aace {
+namespace engine {
+namespace logger {
+namespace sink {
+
+/**
+ * A sink which queues entries in a bounded, lock-free ring and writes them to one or more wrapped sinks from a
+ * single background thread, so that logging never blocks the caller on file or console I/O.
+ *
+ * Producers (any thread calling the EngineLogger) copy each pre-formatted entry into a ring slot; the slot's strings
+ * keep their capacity, so once the ring has warmed up, queuing an entry does not allocate.  When the ring is full the
+ * @c OverflowPolicy decides what happens; dropped entries are counted, and the count is reported to the wrapped sinks
+ * as a WARN entry once there is room again.  CRITICAL entries are flushed through before @c log() returns, so they
+ * are not lost if the process is about to die.
+ *
+ * Rules are applied by the AsyncSink itself (through @c Sink::emit()); the wrapped sinks receive every entry that the
+ * AsyncSink accepts.
+ */
+class AsyncSink : public Sink {
+public:
+    /**
+     * What to do with a new entry when the ring is full.
+     */
+    enum class OverflowPolicy {
+        // discard the oldest queued entry to make room; if that does not free a slot (the writer may still be writing
+        // the oldest entry), discard the new entry instead
+        DROP_OLDEST,
+        // discard the new entry
+        DROP_NEWEST,
+        // wait for the background thread to make room; entries logged from the background thread itself (by a
+        // wrapped sink) are discarded, since they would wait on themselves
+        BLOCK
+    };
+
+private:
+    AsyncSink( const std::string& id, const std::vector<std::shared_ptr<Sink>>& sinks, size_t capacity, OverflowPolicy policy );
+
+public:
+    /**
+     * Creates an AsyncSink.
+     *
+     * @param [in] id The sink id.
+     * @param [in] sinks The sinks to write entries to, in order.
+     * @param [in] capacity The number of entries the ring can hold, rounded up to a power of two.
+     * @param [in] policy What to do when the ring is full.
+     */
+    static std::shared_ptr<AsyncSink> create( const std::string& id, const std::vector<std::shared_ptr<Sink>>& sinks, size_t capacity = 4096, OverflowPolicy policy = OverflowPolicy::DROP_OLDEST );
+
+    // drains the ring and stops the background thread
+    virtual ~AsyncSink();
+
+    void log( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text ) override;
+
+    // writes all entries queued before the call, then flushes the wrapped sinks
+    void flush() override;
+
+    // the number of entries dropped because the ring was full
+    uint64_t getDroppedCount() const;
+
+private:
+    // one ring slot; sequence follows the bounded MPMC queue scheme by Dmitry Vyukov
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Level level;
+        std::chrono::system_clock::time_point time;
+        std::string threadMoniker;
+        std::string text;
+    };
+
+    bool tryPush( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text );
+
+    // applies m_policy to an entry which did not fit; returns whether the entry was queued
+    bool pushOnOverflow( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text );
+
+    // waits until the entry fits in the ring (OverflowPolicy::BLOCK); returns false if the sink is shutting down
+    bool waitAndPush( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text );
+
+    // claims the oldest slot; write it to the sinks if requested, then release it
+    bool tryPop( bool write );
+
+    void writerLoop();
+    void reportDrops();
+
+    // wakes producers blocked in waitAndPush() after the writer has released a slot
+    void wakeProducers();
+
+private:
+    std::vector<std::shared_ptr<Sink>> m_sinks;
+    OverflowPolicy m_policy;
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+
+    // producer and consumer positions in the ring
+    std::atomic<size_t> m_enqueuePos;
+    std::atomic<size_t> m_dequeuePos;
+
+    // the number of slots released by tryPop(); slots are claimed in order, so once this reaches n, every entry
+    // before position n has been written or dropped
+    std::atomic<uint64_t> m_released;
+
+    std::atomic<uint64_t> m_dropped;
+    uint64_t m_droppedReported;
+
+    // parking and flushing for the writer thread
+    std::mutex m_mutex;
+    std::condition_variable m_wakeWriter;
+    std::condition_variable m_progress;
+    std::atomic<bool> m_writerSleeping;
+
+    // producers waiting for room in the ring (OverflowPolicy::BLOCK)
+    std::condition_variable m_spaceAvailable;
+    std::atomic<uint32_t> m_producersWaiting;
+
+    uint64_t m_flushTarget;
+    uint64_t m_flushed;
+    bool m_shutdown;
+
+    std::thread m_writerThread;
+};
+
+inline AsyncSink::AsyncSink( const std::string& id, const std::vector<std::shared_ptr<Sink>>& sinks, size_t capacity, OverflowPolicy policy ) :
+        Sink( id ),
+        m_sinks( sinks ),
+        m_policy( policy ),
+        m_enqueuePos( 0 ),
+        m_dequeuePos( 0 ),
+        m_released( 0 ),
+        m_dropped( 0 ),
+        m_droppedReported( 0 ),
+        m_writerSleeping( false ),
+        m_producersWaiting( 0 ),
+        m_flushTarget( 0 ),
+        m_flushed( 0 ),
+        m_shutdown( false ) {
+    size_t size = 2;
+    while( size < capacity ) {
+        size <<= 1;
+    }
+    m_slots.reset( new Slot[size] );
+    m_mask = size - 1;
+    for( size_t index = 0; index < size; index++ ) {
+        m_slots[index].sequence.store( index, std::memory_order_relaxed );
+    }
+    m_writerThread = std::thread( &AsyncSink::writerLoop, this );
+}
+
+inline std::shared_ptr<AsyncSink> AsyncSink::create( const std::string& id, const std::vector<std::shared_ptr<Sink>>& sinks, size_t capacity, OverflowPolicy policy ) {
+    for( auto& next : sinks ) {
+        if( next == nullptr ) {
+            return nullptr;
+        }
+    }
+    return std::shared_ptr<AsyncSink>( new AsyncSink( id, sinks, capacity, policy ) );
+}
+
+inline AsyncSink::~AsyncSink() {
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_shutdown = true;
+    }
+    m_wakeWriter.notify_all();
+    m_spaceAvailable.notify_all();
+    if( m_writerThread.joinable() ) {
+        m_writerThread.join();
+    }
+}
+
+inline void AsyncSink::log( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text ) {
+    if( !tryPush( level, time, threadMoniker, text ) && !pushOnOverflow( level, time, threadMoniker, text ) ) {
+        m_dropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+
+    // tryPush() claims the slot with a sequentially consistent CAS on m_enqueuePos, and the writer stores
+    // m_writerSleeping before comparing m_dequeuePos with m_enqueuePos, so either the writer sees the claimed
+    // position (and stays awake until the entry is published), or we see it sleeping and wake it
+    if( m_writerSleeping.load() ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_wakeWriter.notify_one();
+    }
+
+    if( level == Level::CRITICAL ) {
+        flush();
+    }
+}
+
+inline void AsyncSink::flush() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    uint64_t target = m_enqueuePos.load();
+    if( target > m_flushTarget ) {
+        m_flushTarget = target;
+    }
+    m_wakeWriter.notify_one();
+
+    // never wait on ourselves, e.g. if a wrapped sink logs from the writer thread
+    if( std::this_thread::get_id() != m_writerThread.get_id() ) {
+        m_progress.wait( lock, [this, target]() { return m_flushed >= target || m_shutdown; } );
+    }
+}
+
+inline bool AsyncSink::pushOnOverflow( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text ) {
+    switch( m_policy ) {
+        case OverflowPolicy::DROP_OLDEST:
+            // discard at most one entry, then give up rather than spin on a slot the writer is still holding
+            if( tryPop( false ) ) {
+                m_dropped.fetch_add( 1, std::memory_order_relaxed );
+            }
+            return tryPush( level, time, threadMoniker, text );
+        case OverflowPolicy::DROP_NEWEST:
+            return false;
+        case OverflowPolicy::BLOCK:
+            return waitAndPush( level, time, threadMoniker, text );
+    }
+    return false;
+}
+
+inline bool AsyncSink::waitAndPush( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text ) {
+    if( std::this_thread::get_id() == m_writerThread.get_id() ) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_producersWaiting.fetch_add( 1 );
+    // pairs with the fence in wakeProducers(): either the writer sees this waiter, or tryPush() sees the released slot
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    bool pushed = false;
+    m_spaceAvailable.wait( lock, [&]() {
+        pushed = tryPush( level, time, threadMoniker, text );
+        return pushed || m_shutdown;
+    } );
+    m_producersWaiting.fetch_sub( 1 );
+    return pushed;
+}
+
+inline uint64_t AsyncSink::getDroppedCount() const {
+    return m_dropped.load( std::memory_order_relaxed );
+}
+
+inline bool AsyncSink::tryPush( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text ) {
+    size_t pos = m_enqueuePos.load( std::memory_order_relaxed );
+    Slot* slot = nullptr;
+    while( true ) {
+        slot = &m_slots[pos & m_mask];
+        size_t sequence = slot->sequence.load( std::memory_order_acquire );
+        intptr_t difference = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( pos );
+        if( difference == 0 ) {
+            if( m_enqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+                break;
+            }
+        } else if( difference < 0 ) {
+            return false;
+        } else {
+            pos = m_enqueuePos.load( std::memory_order_relaxed );
+        }
+    }
+
+    // assign() reuses the slot's existing capacity
+    slot->level = level;
+    slot->time = time;
+    slot->threadMoniker.assign( threadMoniker != nullptr ? threadMoniker : "" );
+    slot->text.assign( text != nullptr ? text : "" );
+    slot->sequence.store( pos + 1, std::memory_order_release );
+    return true;
+}
+
+inline bool AsyncSink::tryPop( bool write ) {
+    size_t pos = m_dequeuePos.load( std::memory_order_relaxed );
+    Slot* slot = nullptr;
+    while( true ) {
+        slot = &m_slots[pos & m_mask];
+        size_t sequence = slot->sequence.load( std::memory_order_acquire );
+        intptr_t difference = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( pos + 1 );
+        if( difference == 0 ) {
+            if( m_dequeuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+                break;
+            }
+        } else if( difference < 0 ) {
+            return false;
+        } else {
+            pos = m_dequeuePos.load( std::memory_order_relaxed );
+        }
+    }
+
+    if( write ) {
+        for( auto& next : m_sinks ) {
+            next->log( slot->level, slot->time, slot->threadMoniker.c_str(), slot->text.c_str() );
+        }
+    }
+    slot->sequence.store( pos + m_mask + 1, std::memory_order_release );
+    m_released.fetch_add( 1, std::memory_order_release );
+    return true;
+}
+
+inline void AsyncSink::writerLoop() {
+    while( true ) {
+        while( tryPop( true ) ) {
+            wakeProducers();
+        }
+        reportDrops();
+
+        std::unique_lock<std::mutex> lock( m_mutex );
+
+        // everything up to m_flushTarget has been claimed; wait for slow producers to finish their slots
+        if( m_flushed < m_flushTarget ) {
+            if( m_released.load() < m_flushTarget ) {
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            for( auto& next : m_sinks ) {
+                next->flush();
+            }
+            m_flushed = m_flushTarget;
+            m_progress.notify_all();
+            continue;
+        }
+
+        if( m_shutdown && m_dequeuePos.load() == m_enqueuePos.load() ) {
+            for( auto& next : m_sinks ) {
+                next->flush();
+            }
+            m_progress.notify_all();
+            return;
+        }
+
+        m_writerSleeping.store( true );
+        if( m_dequeuePos.load() == m_enqueuePos.load() && !m_shutdown && m_flushed >= m_flushTarget ) {
+            m_wakeWriter.wait_for( lock, std::chrono::milliseconds( 100 ) );
+        }
+        m_writerSleeping.store( false );
+    }
+}
+
+inline void AsyncSink::wakeProducers() {
+    if( m_policy != OverflowPolicy::BLOCK ) {
+        return;
+    }
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( m_producersWaiting.load( std::memory_order_relaxed ) > 0 ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_spaceAvailable.notify_all();
+    }
+}
+
+inline void AsyncSink::reportDrops() {
+    uint64_t dropped = m_dropped.load( std::memory_order_relaxed );
+    if( dropped == m_droppedReported ) {
+        return;
+    }
+    std::string text = "AsyncSink:droppedEntries=" + std::to_string( dropped - m_droppedReported );
+    m_droppedReported = dropped;
+    for( auto& next : m_sinks ) {
+        next->log( Level::WARN, std::chrono::system_clock::now(), "", text.c_str() );
+    }
+}
+
+}  // aace::engine::logger::sink
+}  // aace::engine::logger
+}  // aace::engine
+}  // aace
+
+#endif // AACE_ENGINE_LOGGER_SINK_ASYNC_SINK_H
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2017-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_LOGGER_SINK_BINARY_FILE_SINK_H
+#define AACE_ENGINE_LOGGER_SINK_BINARY_FILE_SINK_H
+
+#include <cstdio>
+
+#include "Sink.h"
+#include "AACE/Engine/Logger/BinaryLogFormat.h"
+
+namespace aace {
+namespace engine {
+namespace logger {
+namespace sink {
+
+/**
+ * A file sink which writes entries in the compact format described in BinaryLogFormat.h instead of formatted text.
+ * Files are named <prefix>.bin, rotating to <prefix>.1.bin ... <prefix>.<maxFiles-1>.bin, and are decoded on the host
+ * with the BinaryLogDecoder tool.
+ *
+ * Entries are written in blocks of up to @c BLOCK_SIZE bytes to cut the number of flash writes; ERROR and CRITICAL
+ * entries, and flush(), write the block out immediately.
+ */
+class BinaryFileSink : public Sink {
+private:
+    BinaryFileSink( const std::string& id, const std::string& path, const std::string& prefix, uint32_t maxSize, uint32_t maxFiles );
+
+public:
+    static std::shared_ptr<BinaryFileSink> create( const std::string& id, const std::string& path, const std::string& prefix = "aace", uint32_t maxSize = 5242880, uint32_t maxFiles = 3, bool append = true );
+
+    ~BinaryFileSink();
+
+private:
+    void log( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text ) override;
+    void flush() override;
+
+    bool open( bool append );
+    bool rotateLog();
+    void writeBlock();
+
+    std::string getFilename( uint32_t index );
+    bool exists( const std::string& filename );
+
+    static const size_t BLOCK_SIZE = 4096;
+
+private:
+    std::string m_path;
+    std::string m_prefix;
+    uint32_t m_maxSize;
+    uint32_t m_maxFiles;
+
+    std::mutex m_mutex;
+    std::shared_ptr<std::ofstream> m_stream;
+    uint64_t m_fileSize;
+
+    aace::engine::logger::BinaryLogEncoder m_encoder;
+
+    // encoded entries waiting to be written
+    std::string m_block;
+};
+
+inline BinaryFileSink::BinaryFileSink( const std::string& id, const std::string& path, const std::string& prefix, uint32_t maxSize, uint32_t maxFiles ) :
+        Sink( id ),
+        m_path( path ),
+        m_prefix( prefix ),
+        m_maxSize( maxSize ),
+        m_maxFiles( maxFiles > 0 ? maxFiles : 1 ),
+        m_fileSize( 0 ) {
+    m_block.reserve( BLOCK_SIZE * 2 );
+}
+
+inline std::shared_ptr<BinaryFileSink> BinaryFileSink::create( const std::string& id, const std::string& path, const std::string& prefix, uint32_t maxSize, uint32_t maxFiles, bool append )
+{
+    if( path.empty() || prefix.empty() || maxSize < BLOCK_SIZE ) {
+        return nullptr;
+    }
+    auto sink = std::shared_ptr<BinaryFileSink>( new BinaryFileSink( id, path, prefix, maxSize, maxFiles ) );
+    if( !sink->open( append ) ) {
+        return nullptr;
+    }
+    return sink;
+}
+
+inline BinaryFileSink::~BinaryFileSink()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    writeBlock();
+}
+
+inline void BinaryFileSink::log( Level level, std::chrono::system_clock::time_point time, const char* threadMoniker, const char* text )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if( m_stream == nullptr ) {
+        return;
+    }
+
+    size_t blockSize = m_block.size();
+    m_encoder.encode( level, time, threadMoniker, text, m_block );
+
+    // start a new file (and string table) if this entry would take the current one past maxSize
+    if( m_fileSize + m_block.size() > m_maxSize && m_fileSize + blockSize > aace::engine::logger::BINARY_LOG_HEADER_SIZE ) {
+        m_block.resize( blockSize );
+        writeBlock();
+        if( !rotateLog() ) {
+            return;
+        }
+        m_encoder.encode( level, time, threadMoniker, text, m_block );
+    }
+
+    if( m_block.size() >= BLOCK_SIZE || level >= Level::ERROR ) {
+        writeBlock();
+    }
+}
+
+inline void BinaryFileSink::flush()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    writeBlock();
+}
+
+inline bool BinaryFileSink::open( bool append )
+{
+    std::string filename = getFilename( 0 );
+    m_fileSize = 0;
+    if( append && exists( filename ) ) {
+        std::ifstream existing( filename, std::ios::binary | std::ios::ate );
+        m_fileSize = static_cast<uint64_t>( existing.tellg() );
+    }
+    m_stream = std::make_shared<std::ofstream>( filename, std::ios::binary | ( append ? std::ios::app : std::ios::trunc ) );
+    if( !m_stream->is_open() ) {
+        m_stream.reset();
+        return false;
+    }
+
+    // every open starts a new section, so appended data decodes without the earlier string table
+    m_block.clear();
+    m_encoder.begin( std::chrono::system_clock::now(), m_block );
+    return true;
+}
+
+inline bool BinaryFileSink::rotateLog()
+{
+    m_stream.reset();
+    for( uint32_t index = m_maxFiles - 1; index > 0; index-- ) {
+        std::string from = getFilename( index - 1 );
+        if( exists( from ) ) {
+            std::rename( from.c_str(), getFilename( index ).c_str() );
+        }
+    }
+    if( m_maxFiles == 1 ) {
+        std::remove( getFilename( 0 ).c_str() );
+    }
+    return open( false );
+}
+
+inline void BinaryFileSink::writeBlock()
+{
+    if( m_stream == nullptr || m_block.empty() ) {
+        return;
+    }
+    m_stream->write( m_block.data(), m_block.size() );
+    m_stream->flush();
+    m_fileSize += m_block.size();
+    m_block.clear();
+}
+
+inline std::string BinaryFileSink::getFilename( uint32_t index ) {
+    std::string separator = ( !m_path.empty() && m_path.back() != '/' ) ? "/" : "";
+    return m_path + separator + m_prefix + ( index > 0 ? "." + std::to_string( index ) : "" ) + ".bin";
+}
+
+inline bool BinaryFileSink::exists( const std::string& filename ) {
+    return std::ifstream( filename ).good();
+}
+
+}  // aace::engine::logger::sink
+}  // aace::engine::logger
+}  // aace::engine
+}  // aace
+
+#endif // AACE_ENGINE_LOGGER_SINK_BINARY_FILE_SINK_H
@@ -0,0 +1,686 @@
+/*
+ * Copyright 2017-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef AACE_ENGINE_METRICS_METRICS_REGISTRY_H
+#define AACE_ENGINE_METRICS_METRICS_REGISTRY_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "AACE/Metrics/MetricsUploader.h"
+#include "AVSCommon/Utils/Timing/WheelTimer.h"
+
+namespace aace {
+namespace engine {
+namespace metrics {
+
+/**
+ * A native alternative to @c MetricEvent for metrics recorded on hot paths.  Instead of formatting each datapoint into
+ * a log string, which @c MetricsUploaderEngineImpl then parses back, components look up a @c Counter, @c Gauge or
+ * @c Histogram once and update it with a few relaxed atomic operations.  Counters and histograms are sharded by
+ * thread so that concurrent writers do not contend on one cache line.
+ *
+ * The registry periodically aggregates what was recorded since the previous flush and passes it to the
+ * @c MetricsUploader, one @c record() call per (program, source), and can dump all metrics in the Prometheus text
+ * exposition format.
+ */
+class MetricsRegistry {
+public:
+    /// The number of per-thread shards in each counter.
+    static const size_t SHARD_COUNT = 8;
+
+    /// The number of per-thread shards in each histogram, which are much larger than counter shards.
+    static const size_t HISTOGRAM_SHARD_COUNT = 4;
+
+    /// Alignment used to keep shards on separate cache lines.
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * A monotonically increasing count, e.g. of events or bytes.
+     */
+    class Counter {
+    public:
+        /// Constructor.
+        Counter();
+
+        /**
+         * Adds to the count.
+         *
+         * @param delta The amount to add.
+         */
+        void increment(uint64_t delta = 1);
+
+        /// @return The total count.
+        uint64_t value() const;
+
+    private:
+        friend class MetricsRegistry;
+
+        /// One shard of the count, on its own cache line.
+        struct alignas(CACHE_LINE_SIZE) Shard {
+            /// This shard's part of the count.
+            std::atomic<uint64_t> value;
+        };
+
+        /// The shards.
+        Shard m_shards[SHARD_COUNT];
+
+        /// The total at the last flush.  Guarded by the registry's flush mutex.
+        uint64_t m_flushedValue;
+    };
+
+    /**
+     * A value which can go up and down, e.g. a queue depth.
+     */
+    class Gauge {
+    public:
+        /// Constructor.
+        Gauge();
+
+        /**
+         * Sets the value.
+         *
+         * @param value The new value.
+         */
+        void set(int64_t value);
+
+        /**
+         * Adds to the value.
+         *
+         * @param delta The amount to add, which may be negative.
+         */
+        void add(int64_t delta);
+
+        /// @return The current value.
+        int64_t value() const;
+
+    private:
+        /// The current value.
+        std::atomic<int64_t> m_value;
+    };
+
+    /**
+     * A log-linear (HDR-style) histogram of durations in microseconds.  Each power of two is split in to
+     * @c SUB_BUCKET_COUNT linear buckets, so percentiles are accurate to within 12.5% from 1us up to about 12 days.
+     */
+    class Histogram {
+    public:
+        /// The number of linear buckets per power of two, as a power of two.
+        static const size_t SUB_BUCKET_BITS = 3;
+
+        /// The number of linear buckets per power of two.
+        static const size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+        /// The highest power of two with its own buckets; larger values are counted in the last bucket.
+        static const size_t MAX_EXPONENT = 39;
+
+        /// The number of buckets.
+        static const size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT;
+
+        /// A point-in-time copy of a histogram.
+        struct Snapshot {
+            /// The count in each bucket.
+            std::vector<uint64_t> buckets;
+
+            /// The number of recorded values.
+            uint64_t count = 0;
+
+            /// The sum of recorded values, in microseconds.
+            uint64_t sum = 0;
+
+            /// The largest recorded value, in microseconds.
+            uint64_t max = 0;
+
+            /**
+             * Estimates a percentile from the buckets.
+             *
+             * @param percentile The percentile, in (0, 100].
+             * @return The upper bound of the bucket holding the percentile, capped at @c max, or 0 if the snapshot is
+             *     empty.
+             */
+            uint64_t percentile(double percentile) const;
+        };
+
+        /// Constructor.
+        Histogram();
+
+        /**
+         * Records a duration.
+         *
+         * @param duration The duration to record.
+         */
+        template <typename Rep, typename Period>
+        void record(const std::chrono::duration<Rep, Period>& duration);
+
+        /**
+         * Records a duration in microseconds.
+         *
+         * @param microseconds The duration to record.
+         */
+        void recordMicroseconds(uint64_t microseconds);
+
+        /// @return A copy of everything recorded so far.
+        Snapshot snapshot() const;
+
+        /**
+         * Maps a value to its bucket.
+         *
+         * @param value The value.
+         * @return The index of the bucket holding @c value.
+         */
+        static size_t bucketIndex(uint64_t value);
+
+        /**
+         * Gets the largest value held by a bucket.
+         *
+         * @param index The index of the bucket.
+         * @return The upper bound of the bucket, inclusive.
+         */
+        static uint64_t bucketUpperBound(size_t index);
+
+    private:
+        friend class MetricsRegistry;
+
+        /// One shard of the histogram, starting on its own cache line.
+        struct alignas(CACHE_LINE_SIZE) Shard {
+            /// The count in each bucket.
+            std::atomic<uint64_t> buckets[BUCKET_COUNT];
+
+            /// The sum of recorded values.
+            std::atomic<uint64_t> sum;
+        };
+
+        /**
+         * Raises an atomic maximum.
+         *
+         * @param maximum The maximum to raise.
+         * @param value The candidate value.
+         */
+        static void raise(std::atomic<uint64_t>& maximum, uint64_t value);
+
+        /// The shards.
+        Shard m_shards[HISTOGRAM_SHARD_COUNT];
+
+        /// The largest value ever recorded.
+        std::atomic<uint64_t> m_max;
+
+        /// The largest value recorded since the last flush.
+        std::atomic<uint64_t> m_intervalMax;
+
+        /// The snapshot taken at the last flush.  Guarded by the registry's flush mutex.
+        Snapshot m_flushed;
+    };
+
+    /**
+     * Creates a registry.  Most callers should use @c getInstance().
+     *
+     * @return The new registry.
+     */
+    static std::shared_ptr<MetricsRegistry> create();
+
+    /// @return The engine-wide registry.
+    static std::shared_ptr<MetricsRegistry> getInstance();
+
+    /**
+     * Gets or creates a counter.  Keep the result rather than looking it up on every update.
+     *
+     * @param program The name that indicates where the metric comes from, as for @c MetricEvent.
+     * @param source Additional context, as for @c MetricEvent.
+     * @param name The name of the metric.
+     * @return The counter.
+     */
+    std::shared_ptr<Counter> getCounter(const std::string& program, const std::string& source, const std::string& name);
+
+    /**
+     * Gets or creates a gauge.  Keep the result rather than looking it up on every update.
+     *
+     * @param program The name that indicates where the metric comes from, as for @c MetricEvent.
+     * @param source Additional context, as for @c MetricEvent.
+     * @param name The name of the metric.
+     * @return The gauge.
+     */
+    std::shared_ptr<Gauge> getGauge(const std::string& program, const std::string& source, const std::string& name);
+
+    /**
+     * Gets or creates a histogram.  Keep the result rather than looking it up on every update.
+     *
+     * @param program The name that indicates where the metric comes from, as for @c MetricEvent.
+     * @param source Additional context, as for @c MetricEvent.
+     * @param name The name of the metric.
+     * @return The histogram.
+     */
+    std::shared_ptr<Histogram> getHistogram(
+        const std::string& program,
+        const std::string& source,
+        const std::string& name);
+
+    /**
+     * Sets the uploader that @c flush() reports to, and starts or stops the periodic flush.
+     *
+     * @param uploader The uploader, or @c nullptr to stop reporting.
+     * @param period How often to flush.  Zero means @c flush() is only called explicitly.
+     */
+    void setUploader(
+        std::shared_ptr<aace::metrics::MetricsUploader> uploader,
+        std::chrono::milliseconds period = std::chrono::minutes(1));
+
+    /**
+     * Reports everything recorded since the previous flush to the uploader, if one is set.  Counters are reported as
+     * @c COUNTER datapoints holding the increase; histograms as @c TIMER datapoints in milliseconds for the 50th, 90th
+     * and 99th percentiles and the maximum, with the number of samples as the count; gauges as @c STRING datapoints
+     * holding the current value.  Metrics which did not change are left out.
+     */
+    void flush();
+
+    /**
+     * Formats all metrics in the Prometheus text exposition format.  Histograms are shown as summaries.
+     *
+     * @return The formatted metrics.
+     */
+    std::string dump();
+
+private:
+    /// Identifies a metric: program, source and name.
+    using Key = std::tuple<std::string, std::string, std::string>;
+
+    /// Constructor.
+    MetricsRegistry();
+
+    /**
+     * Gets or creates a metric in one of the maps.
+     *
+     * @param metrics The map to look in.
+     * @param key The metric to get.
+     * @return The metric.
+     */
+    template <typename Metric>
+    std::shared_ptr<Metric> getMetric(std::map<Key, std::shared_ptr<Metric>>& metrics, const Key& key);
+
+    /**
+     * Picks the calling thread's shard.
+     *
+     * @return The index of the shard.
+     */
+    static size_t shardIndex();
+
+    /**
+     * Builds a Prometheus metric name.
+     *
+     * @param key The metric.
+     * @return The name, with characters other than letters, digits and underscores replaced.
+     */
+    static std::string exposedName(const Key& key);
+
+    /// Guards the metric maps.
+    std::mutex m_mutex;
+
+    /// Serializes @c flush(), and guards the flushed state in each metric.
+    std::mutex m_flushMutex;
+
+    /// The counters.
+    std::map<Key, std::shared_ptr<Counter>> m_counters;
+
+    /// The gauges.
+    std::map<Key, std::shared_ptr<Gauge>> m_gauges;
+
+    /// The histograms.
+    std::map<Key, std::shared_ptr<Histogram>> m_histograms;
+
+    /// The last gauge values reported by @c flush().  Guarded by @c m_flushMutex.
+    std::map<Key, int64_t> m_flushedGauges;
+
+    /// The uploader that @c flush() reports to.
+    std::weak_ptr<aace::metrics::MetricsUploader> m_uploader;
+
+    /// Runs the periodic flush.  Declared last, so that it stops before the rest of the registry is destroyed.
+    alexaClientSDK::avsCommon::utils::timing::WheelTimer m_flushTimer;
+};
+
+inline MetricsRegistry::Counter::Counter() : m_flushedValue{0} {
+    for (auto& shard : m_shards) {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+inline void MetricsRegistry::Counter::increment(uint64_t delta) {
+    m_shards[shardIndex()].value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+inline uint64_t MetricsRegistry::Counter::value() const {
+    uint64_t total = 0;
+    for (auto& shard : m_shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+inline MetricsRegistry::Gauge::Gauge() : m_value{0} {
+}
+
+inline void MetricsRegistry::Gauge::set(int64_t value) {
+    m_value.store(value, std::memory_order_relaxed);
+}
+
+inline void MetricsRegistry::Gauge::add(int64_t delta) {
+    m_value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+inline int64_t MetricsRegistry::Gauge::value() const {
+    return m_value.load(std::memory_order_relaxed);
+}
+
+inline uint64_t MetricsRegistry::Histogram::Snapshot::percentile(double percentile) const {
+    if (0 == count) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * count + 0.5);
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t index = 0; index < buckets.size(); ++index) {
+        seen += buckets[index];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(index), max);
+        }
+    }
+    return max;
+}
+
+inline MetricsRegistry::Histogram::Histogram() : m_max{0}, m_intervalMax{0} {
+    for (auto& shard : m_shards) {
+        for (auto& bucket : shard.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        shard.sum.store(0, std::memory_order_relaxed);
+    }
+    m_flushed.buckets.assign(BUCKET_COUNT, 0);
+}
+
+template <typename Rep, typename Period>
+void MetricsRegistry::Histogram::record(const std::chrono::duration<Rep, Period>& duration) {
+    auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    recordMicroseconds(microseconds > 0 ? static_cast<uint64_t>(microseconds) : 0);
+}
+
+inline void MetricsRegistry::Histogram::recordMicroseconds(uint64_t microseconds) {
+    auto& shard = m_shards[shardIndex() % HISTOGRAM_SHARD_COUNT];
+    shard.buckets[bucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(microseconds, std::memory_order_relaxed);
+    raise(m_max, microseconds);
+    raise(m_intervalMax, microseconds);
+}
+
+inline MetricsRegistry::Histogram::Snapshot MetricsRegistry::Histogram::snapshot() const {
+    Snapshot result;
+    result.buckets.assign(BUCKET_COUNT, 0);
+    for (auto& shard : m_shards) {
+        for (size_t index = 0; index < BUCKET_COUNT; ++index) {
+            uint64_t count = shard.buckets[index].load(std::memory_order_relaxed);
+            result.buckets[index] += count;
+            result.count += count;
+        }
+        result.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    result.max = m_max.load(std::memory_order_relaxed);
+    return result;
+}
+
+inline size_t MetricsRegistry::Histogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+    size_t exponent = 63 - __builtin_clzll(value);
+    size_t index = (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT +
+                   static_cast<size_t>((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+    return std::min(index, BUCKET_COUNT - 1);
+}
+
+inline uint64_t MetricsRegistry::Histogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    size_t shift = index / SUB_BUCKET_COUNT - 1;
+    uint64_t lower = static_cast<uint64_t>(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+    return lower + (static_cast<uint64_t>(1) << shift) - 1;
+}
+
+inline void MetricsRegistry::Histogram::raise(std::atomic<uint64_t>& maximum, uint64_t value) {
+    uint64_t current = maximum.load(std::memory_order_relaxed);
+    while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+inline std::shared_ptr<MetricsRegistry> MetricsRegistry::create() {
+    return std::shared_ptr<MetricsRegistry>(new MetricsRegistry());
+}
+
+inline std::shared_ptr<MetricsRegistry> MetricsRegistry::getInstance() {
+    static std::shared_ptr<MetricsRegistry> instance = create();
+    return instance;
+}
+
+inline MetricsRegistry::MetricsRegistry() {
+}
+
+inline std::shared_ptr<MetricsRegistry::Counter> MetricsRegistry::getCounter(
+    const std::string& program,
+    const std::string& source,
+    const std::string& name) {
+    return getMetric(m_counters, Key(program, source, name));
+}
+
+inline std::shared_ptr<MetricsRegistry::Gauge> MetricsRegistry::getGauge(
+    const std::string& program,
+    const std::string& source,
+    const std::string& name) {
+    return getMetric(m_gauges, Key(program, source, name));
+}
+
+inline std::shared_ptr<MetricsRegistry::Histogram> MetricsRegistry::getHistogram(
+    const std::string& program,
+    const std::string& source,
+    const std::string& name) {
+    return getMetric(m_histograms, Key(program, source, name));
+}
+
+template <typename Metric>
+std::shared_ptr<Metric> MetricsRegistry::getMetric(std::map<Key, std::shared_ptr<Metric>>& metrics, const Key& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& metric = metrics[key];
+    if (!metric) {
+        metric = std::make_shared<Metric>();
+    }
+    return metric;
+}
+
+inline void MetricsRegistry::setUploader(
+    std::shared_ptr<aace::metrics::MetricsUploader> uploader,
+    std::chrono::milliseconds period) {
+    m_flushTimer.stop();
+    {
+        std::lock_guard<std::mutex> lock(m_flushMutex);
+        m_uploader = uploader;
+    }
+    if (uploader && period > std::chrono::milliseconds::zero()) {
+        m_flushTimer.start(
+            period,
+            alexaClientSDK::avsCommon::utils::timing::WheelTimer::PeriodType::ABSOLUTE,
+            alexaClientSDK::avsCommon::utils::timing::WheelTimer::FOREVER,
+            [this] { flush(); });
+    }
+}
+
+inline void MetricsRegistry::flush() {
+    using Datapoint = aace::metrics::MetricsUploader::Datapoint;
+    using DatapointType = aace::metrics::MetricsUploader::DatapointType;
+
+    std::vector<std::pair<Key, std::shared_ptr<Counter>>> counters;
+    std::vector<std::pair<Key, std::shared_ptr<Gauge>>> gauges;
+    std::vector<std::pair<Key, std::shared_ptr<Histogram>>> histograms;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        counters.assign(m_counters.begin(), m_counters.end());
+        gauges.assign(m_gauges.begin(), m_gauges.end());
+        histograms.assign(m_histograms.begin(), m_histograms.end());
+    }
+
+    std::lock_guard<std::mutex> lock(m_flushMutex);
+    auto uploader = m_uploader.lock();
+    if (!uploader) {
+        return;
+    }
+
+    // group datapoints by (program, source), which the uploader receives as metadata
+    std::map<std::pair<std::string, std::string>, std::vector<Datapoint>> groups;
+    auto group = [&groups](const Key& key) -> std::vector<Datapoint>& {
+        return groups[std::make_pair(std::get<0>(key), std::get<1>(key))];
+    };
+    auto milliseconds = [](uint64_t microseconds) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.3f", microseconds / 1000.0);
+        return std::string(buffer);
+    };
+
+    for (auto& entry : counters) {
+        uint64_t value = entry.second->value();
+        uint64_t delta = value - entry.second->m_flushedValue;
+        entry.second->m_flushedValue = value;
+        if (delta > 0) {
+            group(entry.first).emplace_back(DatapointType::COUNTER, std::get<2>(entry.first), std::to_string(delta), 1);
+        }
+    }
+    for (auto& entry : gauges) {
+        int64_t value = entry.second->value();
+        auto flushed = m_flushedGauges.find(entry.first);
+        if (flushed == m_flushedGauges.end() || flushed->second != value) {
+            m_flushedGauges[entry.first] = value;
+            group(entry.first).emplace_back(DatapointType::STRING, std::get<2>(entry.first), std::to_string(value), 1);
+        }
+    }
+    for (auto& entry : histograms) {
+        auto& histogram = *entry.second;
+        auto current = histogram.snapshot();
+        Histogram::Snapshot interval;
+        interval.buckets.resize(Histogram::BUCKET_COUNT);
+        for (size_t index = 0; index < Histogram::BUCKET_COUNT; ++index) {
+            interval.buckets[index] = current.buckets[index] - histogram.m_flushed.buckets[index];
+        }
+        interval.count = current.count - histogram.m_flushed.count;
+        interval.sum = current.sum - histogram.m_flushed.sum;
+        interval.max = histogram.m_intervalMax.exchange(0, std::memory_order_relaxed);
+        histogram.m_flushed = std::move(current);
+        if (0 == interval.count) {
+            continue;
+        }
+        // a value counted in this interval may have raised the interval maximum after it was reset; fall back to the
+        // highest bucket so that the percentiles are not capped below it
+        size_t highest = Histogram::BUCKET_COUNT - 1;
+        while (highest > 0 && 0 == interval.buckets[highest]) {
+            --highest;
+        }
+        if (highest > 0 && interval.max <= Histogram::bucketUpperBound(highest - 1)) {
+            interval.max = Histogram::bucketUpperBound(highest);
+        }
+        uint64_t maxCount = std::numeric_limits<int>::max();
+        int count = static_cast<int>(std::min(interval.count, maxCount));
+        auto& datapoints = group(entry.first);
+        auto& name = std::get<2>(entry.first);
+        datapoints.emplace_back(DatapointType::TIMER, name + "_p50", milliseconds(interval.percentile(50)), count);
+        datapoints.emplace_back(DatapointType::TIMER, name + "_p90", milliseconds(interval.percentile(90)), count);
+        datapoints.emplace_back(DatapointType::TIMER, name + "_p99", milliseconds(interval.percentile(99)), count);
+        datapoints.emplace_back(DatapointType::TIMER, name + "_max", milliseconds(interval.max), count);
+    }
+
+    for (auto& entry : groups) {
+        std::unordered_map<std::string, std::string> metadata;
+        metadata["Program"] = entry.first.first;
+        metadata["Source"] = entry.first.second;
+        metadata["Priority"] = "NR";
+        uploader->record(entry.second, metadata);
+    }
+}
+
+inline std::string MetricsRegistry::dump() {
+    std::vector<std::pair<Key, std::shared_ptr<Counter>>> counters;
+    std::vector<std::pair<Key, std::shared_ptr<Gauge>>> gauges;
+    std::vector<std::pair<Key, std::shared_ptr<Histogram>>> histograms;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        counters.assign(m_counters.begin(), m_counters.end());
+        gauges.assign(m_gauges.begin(), m_gauges.end());
+        histograms.assign(m_histograms.begin(), m_histograms.end());
+    }
+
+    std::string out;
+    for (auto& entry : counters) {
+        auto name = exposedName(entry.first);
+        out += "# TYPE " + name + " counter\n";
+        out += name + " " + std::to_string(entry.second->value()) + "\n";
+    }
+    for (auto& entry : gauges) {
+        auto name = exposedName(entry.first);
+        out += "# TYPE " + name + " gauge\n";
+        out += name + " " + std::to_string(entry.second->value()) + "\n";
+    }
+    for (auto& entry : histograms) {
+        auto name = exposedName(entry.first) + "_us";
+        auto snapshot = entry.second->snapshot();
+        out += "# TYPE " + name + " summary\n";
+        for (const char* quantile : {"0.5", "0.9", "0.99"}) {
+            out += name + "{quantile=\"" + quantile + "\"} " +
+                   std::to_string(snapshot.percentile(std::stod(quantile) * 100)) + "\n";
+        }
+        out += name + "_max " + std::to_string(snapshot.max) + "\n";
+        out += name + "_sum " + std::to_string(snapshot.sum) + "\n";
+        out += name + "_count " + std::to_string(snapshot.count) + "\n";
+    }
+    return out;
+}
+
+inline size_t MetricsRegistry::shardIndex() {
+    static std::atomic<size_t> nextShard{0};
+    static thread_local size_t index = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+    return index;
+}
+
+inline std::string MetricsRegistry::exposedName(const Key& key) {
+    std::string name = std::get<0>(key) + "_" + std::get<1>(key) + "_" + std::get<2>(key);
+    for (auto& c : name) {
+        bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        if (!valid) {
+            c = '_';
+        }
+    }
+    if (!name.empty() && name[0] >= '0' && name[0] <= '9') {
+        name.insert(0, "_");
+    }
+    return name;
+}
+
+}  // metrics
+}  // engine
+}  // aace
+
+#endif  // AACE_ENGINE_METRICS_METRICS_REGISTRY_H
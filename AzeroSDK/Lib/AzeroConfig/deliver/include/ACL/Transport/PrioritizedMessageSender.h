@@ -0,0 +1,538 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_ACL_INCLUDE_ACL_TRANSPORT_PRIORITIZEDMESSAGESENDER_H_
+#define ALEXA_CLIENT_SDK_ACL_INCLUDE_ACL_TRANSPORT_PRIORITIZEDMESSAGESENDER_H_
+
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <rapidjson/reader.h>
+#include <rapidjson/stream.h>
+
+#include "AVSCommon/AVS/MessageRequest.h"
+#include "AVSCommon/AVS/PrioritizedMessageRequest.h"
+#include "AVSCommon/SDKInterfaces/MessageRequestObserverInterface.h"
+#include "AVSCommon/SDKInterfaces/MessageSenderInterface.h"
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace acl {
+
+/**
+ * A @c MessageSenderInterface which sits in front of another, usually the @c AVSConnectionManager, and decides the
+ * order messages are handed to it in by their @c MessageRequestPriority.
+ *
+ * @c HTTP2Transport sends messages in the order it is given them, so a @c Recognize sent while the link is congested,
+ * or queued while it reconnects, waits behind every report sent before it.  This class forwards @c INTERACTIVE and
+ * @c NORMAL messages at once, leaving their concurrency to the transport, and holds @c BACKGROUND messages back so
+ * that only a few of them are in the transport's queue at a time:
+ *
+ * @li At most @c maxBackgroundOutstanding @c BACKGROUND messages have been forwarded and not completed.
+ * @li No @c BACKGROUND message is forwarded while an @c INTERACTIVE message is outstanding.
+ *
+ * Held messages are forwarded in the order they were sent as forwarded messages complete.  The priority of a
+ * @c PrioritizedMessageRequest is its own; that of any other @c MessageRequest is looked up by the event's namespace
+ * and name, then by its namespace alone, defaulting to @c NORMAL.  The namespace and name are read from the start of
+ * the event without building a document, and the priority each event type resolves to is cached.
+ *
+ * This class is thread safe.
+ */
+class PrioritizedMessageSender
+        : public avsCommon::sdkInterfaces::MessageSenderInterface
+        , public std::enable_shared_from_this<PrioritizedMessageSender> {
+public:
+    /// Priorities by "Namespace.Name" or "Namespace".
+    using PriorityMap = std::unordered_map<std::string, avsCommon::avs::MessageRequestPriority>;
+
+    /**
+     * Create a sender.
+     *
+     * @param messageSender The sender to forward messages to.
+     * @param maxBackgroundOutstanding The most @c BACKGROUND messages forwarded and not yet completed.
+     * @param priorities Priorities of events by "Namespace.Name" or "Namespace".
+     * @return The new sender, or nullptr if the operation fails.
+     */
+    static std::shared_ptr<PrioritizedMessageSender> create(
+        std::shared_ptr<avsCommon::sdkInterfaces::MessageSenderInterface> messageSender,
+        size_t maxBackgroundOutstanding = DEFAULT_MAX_BACKGROUND_OUTSTANDING,
+        const PriorityMap& priorities = getDefaultPriorities());
+
+    /**
+     * Get the default priorities of events.
+     *
+     * @return The default priorities by "Namespace.Name" or "Namespace".
+     */
+    static PriorityMap getDefaultPriorities();
+
+    /**
+     * Get the priority of a message.
+     *
+     * @param request The message.
+     * @return The priority.
+     */
+    avsCommon::avs::MessageRequestPriority getPriority(std::shared_ptr<avsCommon::avs::MessageRequest> request);
+
+    /**
+     * Complete held messages with @c NOT_CONNECTED, and complete any sent afterwards the same way.
+     */
+    void shutdown();
+
+    /// @name MessageSenderInterface methods.
+    /// @{
+    void sendMessage(std::shared_ptr<avsCommon::avs::MessageRequest> request) override;
+    /// @}
+
+private:
+    /// A message to forward, with its priority.
+    using ForwardedRequest =
+        std::pair<std::shared_ptr<avsCommon::avs::MessageRequest>, avsCommon::avs::MessageRequestPriority>;
+
+    /// Observes a forwarded message, so that held messages can be forwarded once it completes.
+    class CompletionObserver : public avsCommon::sdkInterfaces::MessageRequestObserverInterface {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param sender The sender which forwarded the message.
+         * @param priority The priority of the message.
+         */
+        CompletionObserver(
+            std::weak_ptr<PrioritizedMessageSender> sender,
+            avsCommon::avs::MessageRequestPriority priority);
+
+        /// @name MessageRequestObserverInterface methods.
+        /// @{
+        void onSendCompleted(avsCommon::sdkInterfaces::MessageRequestObserverInterface::Status status) override;
+        void onExceptionReceived(const std::string& exceptionMessage) override;
+        /// @}
+
+    private:
+        /// The sender which forwarded the message.
+        std::weak_ptr<PrioritizedMessageSender> m_sender;
+
+        /// The priority of the message.
+        const avsCommon::avs::MessageRequestPriority m_priority;
+
+        /// Whether the message has completed.  Guards against a message being completed more than once.
+        std::once_flag m_completed;
+    };
+
+    /**
+     * Reads the namespace and name from the header of an event, and stops the parse as soon as it has both, so that
+     * the payload of the event is not read.
+     */
+    class EventHeaderHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, EventHeaderHandler> {
+    public:
+        /// Constructor.
+        EventHeaderHandler();
+
+        /// @name rapidjson SAX handler methods.
+        /// @{
+        bool StartObject();
+        bool EndObject(rapidjson::SizeType memberCount);
+        bool StartArray();
+        bool EndArray(rapidjson::SizeType elementCount);
+        bool Key(const char* str, rapidjson::SizeType length, bool copy);
+        bool String(const char* str, rapidjson::SizeType length, bool copy);
+        bool Default();
+        /// @}
+
+        /// Whether the namespace was found.
+        bool hasNamespace;
+
+        /// Whether the name was found.
+        bool hasName;
+
+        /// The namespace of the event.
+        std::string eventNamespace;
+
+        /// The name of the event.
+        std::string eventName;
+
+    private:
+        /// The members whose values are of interest.
+        enum class Member { OTHER, EVENT, HEADER, NAMESPACE, NAME };
+
+        /**
+         * Compare a key with a string.
+         *
+         * @param str The key, which need not be null-terminated.
+         * @param length The length of the key.
+         * @param key The string to compare it with.
+         * @return Whether they are equal.
+         */
+        static bool equals(const char* str, rapidjson::SizeType length, const char* key);
+
+        /// The number of objects and arrays the parse is inside.
+        int m_depth;
+
+        /// Whether the parse is inside the "event" object.
+        bool m_inEvent;
+
+        /// Whether the parse is inside the "header" object of the event.
+        bool m_inHeader;
+
+        /// The member whose value is about to be parsed.
+        Member m_member;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param messageSender The sender to forward messages to.
+     * @param maxBackgroundOutstanding The most @c BACKGROUND messages forwarded and not yet completed.
+     * @param priorities Priorities of events by "Namespace.Name" or "Namespace".
+     */
+    PrioritizedMessageSender(
+        std::shared_ptr<avsCommon::sdkInterfaces::MessageSenderInterface> messageSender,
+        size_t maxBackgroundOutstanding,
+        const PriorityMap& priorities);
+
+    /**
+     * Called when a forwarded message completes.
+     *
+     * @param priority The priority of the message.
+     */
+    void onForwardedCompleted(avsCommon::avs::MessageRequestPriority priority);
+
+    /**
+     * Take the held messages which may now be forwarded, and count them as outstanding.  @c m_mutex must be held.
+     *
+     * @param[out] requests Receives the messages to forward.
+     */
+    void takeSendableLocked(std::vector<ForwardedRequest>* requests);
+
+    /**
+     * Forward messages, observing their completion.  @c m_mutex must not be held, as the sender may complete a message
+     * before returning.
+     *
+     * @param requests The messages to forward.
+     */
+    void forward(const std::vector<ForwardedRequest>& requests);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "PrioritizedMessageSender";
+
+    /// The default for the most @c BACKGROUND messages forwarded and not yet completed.
+    static constexpr size_t DEFAULT_MAX_BACKGROUND_OUTSTANDING = 1;
+
+    /// The sender to forward messages to.
+    const std::shared_ptr<avsCommon::sdkInterfaces::MessageSenderInterface> m_messageSender;
+
+    /// The most @c BACKGROUND messages forwarded and not yet completed.
+    const size_t m_maxBackgroundOutstanding;
+
+    /// Priorities of events by "Namespace.Name" or "Namespace".
+    const PriorityMap m_priorities;
+
+    /// Serializes access to @c m_resolvedPriorities.
+    std::mutex m_resolvedPrioritiesMutex;
+
+    /// The priorities events have resolved to, by "Namespace.Name".
+    PriorityMap m_resolvedPriorities;
+
+    /// Serializes access to the members below.
+    std::mutex m_mutex;
+
+    /// Held @c BACKGROUND messages, the oldest first.
+    std::deque<std::shared_ptr<avsCommon::avs::MessageRequest>> m_backgroundQueue;
+
+    /// The number of @c INTERACTIVE messages forwarded and not yet completed.
+    size_t m_interactiveOutstanding;
+
+    /// The number of @c BACKGROUND messages forwarded and not yet completed.
+    size_t m_backgroundOutstanding;
+
+    /// Whether @c shutdown() has been called.
+    bool m_isShutdown;
+};
+
+inline std::shared_ptr<PrioritizedMessageSender> PrioritizedMessageSender::create(
+    std::shared_ptr<avsCommon::sdkInterfaces::MessageSenderInterface> messageSender,
+    size_t maxBackgroundOutstanding,
+    const PriorityMap& priorities) {
+    if (!messageSender) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "createFailed").d("reason", "nullMessageSender"));
+        return nullptr;
+    }
+    if (0 == maxBackgroundOutstanding) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "createFailed").d("reason", "zeroMaxBackgroundOutstanding"));
+        return nullptr;
+    }
+    return std::shared_ptr<PrioritizedMessageSender>(
+        new PrioritizedMessageSender(messageSender, maxBackgroundOutstanding, priorities));
+}
+
+inline PrioritizedMessageSender::PriorityMap PrioritizedMessageSender::getDefaultPriorities() {
+    using avsCommon::avs::MessageRequestPriority;
+    return {{"SpeechRecognizer.Recognize", MessageRequestPriority::INTERACTIVE},
+            {"SpeechRecognizer.ExpectSpeechTimedOut", MessageRequestPriority::INTERACTIVE},
+            {"PlaybackController", MessageRequestPriority::INTERACTIVE},
+            {"System.UserInactivityReport", MessageRequestPriority::BACKGROUND},
+            {"System.SoftwareInfo", MessageRequestPriority::BACKGROUND}};
+}
+
+inline PrioritizedMessageSender::PrioritizedMessageSender(
+    std::shared_ptr<avsCommon::sdkInterfaces::MessageSenderInterface> messageSender,
+    size_t maxBackgroundOutstanding,
+    const PriorityMap& priorities) :
+        m_messageSender{messageSender},
+        m_maxBackgroundOutstanding{maxBackgroundOutstanding},
+        m_priorities{priorities},
+        m_interactiveOutstanding{0},
+        m_backgroundOutstanding{0},
+        m_isShutdown{false} {
+}
+
+inline avsCommon::avs::MessageRequestPriority PrioritizedMessageSender::getPriority(
+    std::shared_ptr<avsCommon::avs::MessageRequest> request) {
+    using avsCommon::avs::MessageRequestPriority;
+    auto prioritized = std::dynamic_pointer_cast<avsCommon::avs::PrioritizedMessageRequest>(request);
+    if (prioritized) {
+        return prioritized->getPriority();
+    }
+    if (m_priorities.empty()) {
+        return MessageRequestPriority::NORMAL;
+    }
+    auto jsonContent = request->getJsonContent();
+    EventHeaderHandler handler;
+    rapidjson::Reader reader;
+    rapidjson::StringStream stream(jsonContent.c_str());
+    reader.Parse(stream, handler);
+    if (!handler.hasNamespace) {
+        return MessageRequestPriority::NORMAL;
+    }
+    std::string key = handler.hasName ? handler.eventNamespace + "." + handler.eventName : handler.eventNamespace;
+    {
+        std::lock_guard<std::mutex> lock(m_resolvedPrioritiesMutex);
+        auto it = m_resolvedPriorities.find(key);
+        if (it != m_resolvedPriorities.end()) {
+            return it->second;
+        }
+    }
+    auto it = handler.hasName ? m_priorities.find(key) : m_priorities.end();
+    if (it == m_priorities.end()) {
+        it = m_priorities.find(handler.eventNamespace);
+    }
+    auto priority = it != m_priorities.end() ? it->second : MessageRequestPriority::NORMAL;
+    std::lock_guard<std::mutex> lock(m_resolvedPrioritiesMutex);
+    m_resolvedPriorities.emplace(std::move(key), priority);
+    return priority;
+}
+
+inline void PrioritizedMessageSender::shutdown() {
+    std::deque<std::shared_ptr<avsCommon::avs::MessageRequest>> held;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isShutdown = true;
+        held.swap(m_backgroundQueue);
+    }
+    for (auto& request : held) {
+        request->sendCompleted(avsCommon::sdkInterfaces::MessageRequestObserverInterface::Status::NOT_CONNECTED);
+    }
+}
+
+inline void PrioritizedMessageSender::sendMessage(std::shared_ptr<avsCommon::avs::MessageRequest> request) {
+    using avsCommon::avs::MessageRequestPriority;
+    if (!request) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "sendMessageFailed").d("reason", "nullRequest"));
+        return;
+    }
+    auto priority = getPriority(request);
+    std::vector<ForwardedRequest> requests;
+    bool isShutdown = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        isShutdown = m_isShutdown;
+        if (!isShutdown) {
+            switch (priority) {
+                case MessageRequestPriority::INTERACTIVE:
+                    m_interactiveOutstanding++;
+                    requests.emplace_back(request, priority);
+                    break;
+                case MessageRequestPriority::NORMAL:
+                    requests.emplace_back(request, priority);
+                    break;
+                case MessageRequestPriority::BACKGROUND:
+                    m_backgroundQueue.push_back(request);
+                    break;
+            }
+            takeSendableLocked(&requests);
+        }
+    }
+    if (isShutdown) {
+        avsCommon::utils::logger::acsdkWarn(
+            avsCommon::utils::logger::LogEntry(TAG, "sendMessageFailed").d("reason", "isShutdown"));
+        request->sendCompleted(avsCommon::sdkInterfaces::MessageRequestObserverInterface::Status::NOT_CONNECTED);
+        return;
+    }
+    forward(requests);
+}
+
+inline void PrioritizedMessageSender::onForwardedCompleted(avsCommon::avs::MessageRequestPriority priority) {
+    using avsCommon::avs::MessageRequestPriority;
+    std::vector<ForwardedRequest> requests;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        switch (priority) {
+            case MessageRequestPriority::INTERACTIVE:
+                m_interactiveOutstanding--;
+                break;
+            case MessageRequestPriority::NORMAL:
+                break;
+            case MessageRequestPriority::BACKGROUND:
+                m_backgroundOutstanding--;
+                break;
+        }
+        if (!m_isShutdown) {
+            takeSendableLocked(&requests);
+        }
+    }
+    forward(requests);
+}
+
+inline void PrioritizedMessageSender::takeSendableLocked(std::vector<ForwardedRequest>* requests) {
+    using avsCommon::avs::MessageRequestPriority;
+    // Background messages wait for any interaction to finish.
+    while (!m_backgroundQueue.empty() && 0 == m_interactiveOutstanding &&
+           m_backgroundOutstanding < m_maxBackgroundOutstanding) {
+        requests->emplace_back(std::move(m_backgroundQueue.front()), MessageRequestPriority::BACKGROUND);
+        m_backgroundQueue.pop_front();
+        m_backgroundOutstanding++;
+    }
+}
+
+inline void PrioritizedMessageSender::forward(const std::vector<ForwardedRequest>& requests) {
+    for (const auto& request : requests) {
+        request.first->addObserver(std::make_shared<CompletionObserver>(shared_from_this(), request.second));
+        m_messageSender->sendMessage(request.first);
+    }
+}
+
+inline PrioritizedMessageSender::CompletionObserver::CompletionObserver(
+    std::weak_ptr<PrioritizedMessageSender> sender,
+    avsCommon::avs::MessageRequestPriority priority) :
+        m_sender{sender},
+        m_priority{priority} {
+}
+
+inline void PrioritizedMessageSender::CompletionObserver::onSendCompleted(
+    avsCommon::sdkInterfaces::MessageRequestObserverInterface::Status) {
+    std::call_once(m_completed, [this]() {
+        auto sender = m_sender.lock();
+        if (sender) {
+            sender->onForwardedCompleted(m_priority);
+        }
+    });
+}
+
+inline void PrioritizedMessageSender::CompletionObserver::onExceptionReceived(const std::string&) {
+}
+
+inline PrioritizedMessageSender::EventHeaderHandler::EventHeaderHandler() :
+        hasNamespace{false},
+        hasName{false},
+        m_depth{0},
+        m_inEvent{false},
+        m_inHeader{false},
+        m_member{Member::OTHER} {
+}
+
+inline bool PrioritizedMessageSender::EventHeaderHandler::StartObject() {
+    m_depth++;
+    if (2 == m_depth && Member::EVENT == m_member) {
+        m_inEvent = true;
+    } else if (3 == m_depth && m_inEvent && Member::HEADER == m_member) {
+        m_inHeader = true;
+    }
+    m_member = Member::OTHER;
+    return true;
+}
+
+inline bool PrioritizedMessageSender::EventHeaderHandler::EndObject(rapidjson::SizeType) {
+    // The header, or the event without a header, has ended; nothing further is of interest.
+    if ((3 == m_depth && m_inHeader) || (2 == m_depth && m_inEvent)) {
+        return false;
+    }
+    m_depth--;
+    m_member = Member::OTHER;
+    return true;
+}
+
+inline bool PrioritizedMessageSender::EventHeaderHandler::StartArray() {
+    m_depth++;
+    m_member = Member::OTHER;
+    return true;
+}
+
+inline bool PrioritizedMessageSender::EventHeaderHandler::EndArray(rapidjson::SizeType) {
+    m_depth--;
+    m_member = Member::OTHER;
+    return true;
+}
+
+inline bool PrioritizedMessageSender::EventHeaderHandler::Key(const char* str, rapidjson::SizeType length, bool) {
+    m_member = Member::OTHER;
+    if (1 == m_depth && equals(str, length, "event")) {
+        m_member = Member::EVENT;
+    } else if (2 == m_depth && m_inEvent && equals(str, length, "header")) {
+        m_member = Member::HEADER;
+    } else if (3 == m_depth && m_inHeader && equals(str, length, "namespace")) {
+        m_member = Member::NAMESPACE;
+    } else if (3 == m_depth && m_inHeader && equals(str, length, "name")) {
+        m_member = Member::NAME;
+    }
+    return true;
+}
+
+inline bool PrioritizedMessageSender::EventHeaderHandler::String(const char* str, rapidjson::SizeType length, bool) {
+    if (Member::NAMESPACE == m_member) {
+        eventNamespace.assign(str, length);
+        hasNamespace = true;
+    } else if (Member::NAME == m_member) {
+        eventName.assign(str, length);
+        hasName = true;
+    }
+    m_member = Member::OTHER;
+    return !(hasNamespace && hasName);
+}
+
+inline bool PrioritizedMessageSender::EventHeaderHandler::Default() {
+    m_member = Member::OTHER;
+    return true;
+}
+
+inline bool PrioritizedMessageSender::EventHeaderHandler::equals(
+    const char* str,
+    rapidjson::SizeType length,
+    const char* key) {
+    return std::strlen(key) == length && 0 == std::memcmp(str, key, length);
+}
+
+}  // namespace acl
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_ACL_INCLUDE_ACL_TRANSPORT_PRIORITIZEDMESSAGESENDER_H_
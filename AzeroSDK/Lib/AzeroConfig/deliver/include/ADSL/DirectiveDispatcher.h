@@ -0,0 +1,638 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_ADSL_INCLUDE_ADSL_DIRECTIVEDISPATCHER_H_
+#define ALEXA_CLIENT_SDK_ADSL_INCLUDE_ADSL_DIRECTIVEDISPATCHER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <AVSCommon/AVS/AVSDirective.h>
+#include <AVSCommon/AVS/BlockingPolicy.h>
+#include <AVSCommon/AVS/DirectiveHandlerConfiguration.h>
+#include <AVSCommon/AVS/NamespaceAndName.h>
+#include <AVSCommon/SDKInterfaces/DirectiveHandlerInterface.h>
+#include <AVSCommon/SDKInterfaces/DirectiveHandlerResultInterface.h>
+#include <AVSCommon/Utils/Logger/LoggerUtils.h>
+#include <AVSCommon/Utils/Threading/ThreadPool.h>
+
+namespace alexaClientSDK {
+namespace adsl {
+
+/**
+ * Runs the @c handleDirective() and @c handleDirectiveImmediately() calls of directive handlers on a shared
+ * @c ThreadPool, so that directives which do not share a medium run at the same time rather than one after another on
+ * the @c DirectiveProcessor thread.
+ *
+ * Handlers are put behind the dispatcher by registering the handler returned by @c wrap() in their place.  Each
+ * directive is given ordering keys: one for each medium of its @c BlockingPolicy, and one for its namespace.  A
+ * directive's handler is not called until every directive dispatched before it which shares a key has been handed to
+ * its handler, so directives on one medium, and directives for one capability agent, are handled in the order they
+ * arrived, while a @c TemplateRuntime directive need not wait for a @c SpeakerManager one.
+ *
+ * Ordering within a dialogRequestId is kept by the @c DirectiveProcessor as before: it hands directives over in the
+ * order they arrived, and holds later directives back until a @c BLOCKING directive's handler reports it completed or
+ * failed.  A wrapped handler's @c handleDirective() returns @c true at once; if the wrapped call returns @c false, the
+ * directive is failed through its @c DirectiveHandlerResultInterface instead.
+ *
+ * This class is thread safe.
+ */
+class DirectiveDispatcher : public std::enable_shared_from_this<DirectiveDispatcher> {
+public:
+    /**
+     * Create a dispatcher.
+     *
+     * @param pool The pool to run handlers on.  Defaults to the engine-wide pool.
+     * @return The new dispatcher, or nullptr if the operation fails.
+     */
+    static std::shared_ptr<DirectiveDispatcher> create(
+        std::shared_ptr<avsCommon::utils::threading::ThreadPool> pool =
+            avsCommon::utils::threading::ThreadPool::getDefaultThreadPool());
+
+    /**
+     * Destructor.
+     */
+    ~DirectiveDispatcher();
+
+    /**
+     * Wrap a directive handler so that its directives are handled through this dispatcher.
+     *
+     * @param handler The handler to wrap.
+     * @return The handler to register in place of @c handler, or nullptr if @c handler is nullptr.  It keeps the
+     * dispatcher alive.
+     */
+    std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> wrap(
+        std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler);
+
+    /**
+     * Run a task once every task dispatched before it which shares one of its keys has run.
+     *
+     * @param keys The ordering keys of the task.
+     * @param task The task to run.
+     * @return Whether the task was accepted, which it is not once the dispatcher has been shut down.
+     */
+    bool dispatch(std::vector<std::string> keys, std::function<void()> task);
+
+    /**
+     * Get the ordering keys of a directive.
+     *
+     * @param directive The directive.
+     * @param policy The blocking policy of the directive.
+     * @return The ordering keys.
+     */
+    static std::vector<std::string> getKeys(
+        const avsCommon::avs::AVSDirective& directive,
+        const avsCommon::avs::BlockingPolicy& policy);
+
+    /**
+     * Wait for the tasks dispatched so far to run.  Must not be called from a dispatched task.
+     */
+    void waitForDispatchedTasks();
+
+    /**
+     * Drop the tasks which have not started, and refuse any dispatched afterwards.
+     */
+    void shutdown();
+
+private:
+    /// A dispatched task.
+    struct Task {
+        /// The ordering keys of the task.
+        std::vector<std::string> keys;
+
+        /// The task to run.
+        std::function<void()> function;
+
+        /// The number of keys for which an earlier task has not yet run.
+        size_t blockedKeys = 0;
+    };
+
+    /// State shared between the dispatcher and the pool tasks which run its tasks.
+    struct State {
+        /// The pool to run tasks on.
+        std::shared_ptr<avsCommon::utils::threading::ThreadPool> pool;
+
+        /// Protects the members below.
+        std::mutex mutex;
+
+        /// The tasks not yet run by key, the oldest first.  The task at the front of a lane is blocked by no other
+        /// task on that key.
+        std::unordered_map<std::string, std::deque<std::shared_ptr<Task>>> lanes;
+
+        /// The number of tasks dispatched and not yet run.
+        size_t pendingTasks = 0;
+
+        /// Notified when @c pendingTasks falls to zero.
+        std::condition_variable idleTrigger;
+
+        /// Whether the dispatcher has been shut down.
+        bool shutdown = false;
+    };
+
+    class DispatchingHandler;
+
+    /**
+     * Constructor.
+     *
+     * @param pool The pool to run handlers on.
+     */
+    explicit DirectiveDispatcher(std::shared_ptr<avsCommon::utils::threading::ThreadPool> pool);
+
+    /**
+     * Post tasks which are no longer blocked to the pool.
+     *
+     * @param state The dispatcher state.
+     * @param tasks The tasks to post.
+     */
+    static void post(const std::shared_ptr<State>& state, const std::vector<std::shared_ptr<Task>>& tasks);
+
+    /**
+     * Run a task on a pool worker, then unblock the tasks waiting on it.
+     *
+     * @param state The dispatcher state.
+     * @param task The task to run.
+     */
+    static void run(const std::shared_ptr<State>& state, const std::shared_ptr<Task>& task);
+
+    /**
+     * Remove a task from the front of its lanes, and take the tasks which that unblocks.
+     *
+     * @param state The dispatcher state.
+     * @param task The task which has run.
+     * @param[out] unblocked Receives the tasks now free to run.
+     */
+    static void finish(
+        const std::shared_ptr<State>& state,
+        const std::shared_ptr<Task>& task,
+        std::vector<std::shared_ptr<Task>>* unblocked);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "DirectiveDispatcher";
+
+    /// The state shared with the pool tasks.
+    std::shared_ptr<State> m_state;
+};
+
+/**
+ * A @c DirectiveHandlerInterface which passes the calls which handle directives to a @c DirectiveDispatcher, and
+ * the rest straight to the handler it wraps.
+ */
+class DirectiveDispatcher::DispatchingHandler
+        : public avsCommon::sdkInterfaces::DirectiveHandlerInterface
+        , public std::enable_shared_from_this<DirectiveDispatcher::DispatchingHandler> {
+public:
+    /**
+     * Constructor.
+     *
+     * @param dispatcher The dispatcher to hand directives to.
+     * @param handler The handler to wrap.
+     */
+    DispatchingHandler(
+        std::shared_ptr<DirectiveDispatcher> dispatcher,
+        std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler);
+
+    /// @name DirectiveHandlerInterface methods.
+    /// @{
+    void handleDirectiveImmediately(std::shared_ptr<avsCommon::avs::AVSDirective> directive) override;
+    void preHandleDirective(
+        std::shared_ptr<avsCommon::avs::AVSDirective> directive,
+        std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> result) override;
+    bool handleDirective(const std::string& messageId) override;
+    void cancelDirective(const std::string& messageId) override;
+    void onDeregistered() override;
+    avsCommon::avs::DirectiveHandlerConfiguration getConfiguration() const override;
+    /// @}
+
+private:
+    /// The result of a directive, shared so that the directive can be failed if the wrapped handler refuses it.
+    class SharedResult : public avsCommon::sdkInterfaces::DirectiveHandlerResultInterface {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param result The result given by the @c DirectiveProcessor.
+         */
+        explicit SharedResult(std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> result);
+
+        /// @name DirectiveHandlerResultInterface methods.
+        /// @{
+        void setCompleted() override;
+        void setFailed(const std::string& description) override;
+        /// @}
+
+    private:
+        /**
+         * Take the result, so that it is reported only once.
+         *
+         * @return The result, or nullptr if it has already been reported.
+         */
+        std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> take();
+
+        /// Protects @c m_result.
+        std::mutex m_mutex;
+
+        /// The result given by the @c DirectiveProcessor.
+        std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> m_result;
+    };
+
+    /// The result given to the wrapped handler, which reports to a @c SharedResult.
+    class ResultProxy : public avsCommon::sdkInterfaces::DirectiveHandlerResultInterface {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param result The result to report to.
+         */
+        explicit ResultProxy(std::shared_ptr<SharedResult> result);
+
+        /// @name DirectiveHandlerResultInterface methods.
+        /// @{
+        void setCompleted() override;
+        void setFailed(const std::string& description) override;
+        /// @}
+
+    private:
+        /// The result to report to.
+        std::shared_ptr<SharedResult> m_result;
+    };
+
+    /// A directive dispatched and not yet handed to the wrapped handler.
+    struct Dispatched {
+        /// Held across the check of @c isCancelled and the wrapped @c handleDirective() call, so that a cancellation
+        /// either stops the call or reaches the wrapped handler after it.
+        std::mutex mutex;
+
+        /// Whether the directive has been cancelled.
+        bool isCancelled = false;
+    };
+
+    /// A pre-handled directive.
+    struct PreHandled {
+        /// The directive.
+        std::shared_ptr<avsCommon::avs::AVSDirective> directive;
+
+        /// Its result.
+        std::shared_ptr<SharedResult> result;
+    };
+
+    /**
+     * Get the ordering keys of a directive from the wrapped handler's configuration.
+     *
+     * @param directive The directive.
+     * @return The ordering keys.
+     */
+    std::vector<std::string> getKeys(const avsCommon::avs::AVSDirective& directive) const;
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "DispatchingHandler";
+
+    /// The dispatcher to hand directives to.
+    const std::shared_ptr<DirectiveDispatcher> m_dispatcher;
+
+    /// The wrapped handler.
+    const std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> m_handler;
+
+    /// The wrapped handler's configuration, read once as @c DirectiveRouter does.
+    const avsCommon::avs::DirectiveHandlerConfiguration m_configuration;
+
+    /// Protects the members below.
+    std::mutex m_mutex;
+
+    /// Directives pre-handled and not yet handled or cancelled, by message id.
+    std::unordered_map<std::string, PreHandled> m_preHandled;
+
+    /// Directives dispatched and not yet handed to the wrapped handler, by message id.
+    std::unordered_map<std::string, std::shared_ptr<Dispatched>> m_dispatched;
+};
+
+inline std::shared_ptr<DirectiveDispatcher> DirectiveDispatcher::create(
+    std::shared_ptr<avsCommon::utils::threading::ThreadPool> pool) {
+    if (!pool) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "createFailed").d("reason", "nullPool"));
+        return nullptr;
+    }
+    return std::shared_ptr<DirectiveDispatcher>(new DirectiveDispatcher(std::move(pool)));
+}
+
+inline DirectiveDispatcher::DirectiveDispatcher(std::shared_ptr<avsCommon::utils::threading::ThreadPool> pool) :
+        m_state{std::make_shared<State>()} {
+    m_state->pool = std::move(pool);
+}
+
+inline DirectiveDispatcher::~DirectiveDispatcher() {
+    shutdown();
+}
+
+inline std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> DirectiveDispatcher::wrap(
+    std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler) {
+    if (!handler) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "wrapFailed").d("reason", "nullHandler"));
+        return nullptr;
+    }
+    return std::make_shared<DispatchingHandler>(shared_from_this(), std::move(handler));
+}
+
+inline bool DirectiveDispatcher::dispatch(std::vector<std::string> keys, std::function<void()> task) {
+    auto dispatched = std::make_shared<Task>();
+    dispatched->keys = std::move(keys);
+    dispatched->function = std::move(task);
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->shutdown) {
+            return false;
+        }
+        for (const auto& key : dispatched->keys) {
+            auto& lane = m_state->lanes[key];
+            if (!lane.empty()) {
+                dispatched->blockedKeys++;
+            }
+            lane.push_back(dispatched);
+        }
+        m_state->pendingTasks++;
+        if (dispatched->blockedKeys > 0) {
+            return true;
+        }
+    }
+    post(m_state, {dispatched});
+    return true;
+}
+
+inline std::vector<std::string> DirectiveDispatcher::getKeys(
+    const avsCommon::avs::AVSDirective& directive,
+    const avsCommon::avs::BlockingPolicy& policy) {
+    std::vector<std::string> keys;
+    auto mediums = policy.getMediums();
+    if (mediums[avsCommon::avs::BlockingPolicy::Medium::AUDIO]) {
+        keys.push_back("medium:audio");
+    }
+    if (mediums[avsCommon::avs::BlockingPolicy::Medium::VISUAL]) {
+        keys.push_back("medium:visual");
+    }
+    keys.push_back("namespace:" + directive.getNamespace());
+    return keys;
+}
+
+inline void DirectiveDispatcher::waitForDispatchedTasks() {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->idleTrigger.wait(lock, [this]() { return 0 == m_state->pendingTasks; });
+}
+
+inline void DirectiveDispatcher::shutdown() {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->shutdown = true;
+    // Dropped tasks still pass through their lanes, without running, so that the lanes drain in order.
+    for (auto& lane : m_state->lanes) {
+        for (auto& task : lane.second) {
+            task->function = nullptr;
+        }
+    }
+}
+
+inline void DirectiveDispatcher::post(
+    const std::shared_ptr<State>& state,
+    const std::vector<std::shared_ptr<Task>>& tasks) {
+    for (const auto& task : tasks) {
+        if (!state->pool->post([state, task]() { run(state, task); })) {
+            avsCommon::utils::logger::acsdkError(
+                avsCommon::utils::logger::LogEntry(TAG, "postFailed").d("reason", "poolShutdown"));
+            std::vector<std::shared_ptr<Task>> unblocked;
+            finish(state, task, &unblocked);
+            post(state, unblocked);
+        }
+    }
+}
+
+inline void DirectiveDispatcher::run(const std::shared_ptr<State>& state, const std::shared_ptr<Task>& task) {
+    std::function<void()> function;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->shutdown) {
+            function.swap(task->function);
+        }
+    }
+    if (function) {
+        function();
+    }
+    std::vector<std::shared_ptr<Task>> unblocked;
+    finish(state, task, &unblocked);
+    post(state, unblocked);
+}
+
+inline void DirectiveDispatcher::finish(
+    const std::shared_ptr<State>& state,
+    const std::shared_ptr<Task>& task,
+    std::vector<std::shared_ptr<Task>>* unblocked) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    for (const auto& key : task->keys) {
+        auto it = state->lanes.find(key);
+        if (it == state->lanes.end() || it->second.empty() || it->second.front() != task) {
+            continue;
+        }
+        it->second.pop_front();
+        if (it->second.empty()) {
+            state->lanes.erase(it);
+            continue;
+        }
+        auto& next = it->second.front();
+        if (0 == --next->blockedKeys) {
+            unblocked->push_back(next);
+        }
+    }
+    if (0 == --state->pendingTasks) {
+        state->idleTrigger.notify_all();
+    }
+}
+
+inline DirectiveDispatcher::DispatchingHandler::DispatchingHandler(
+    std::shared_ptr<DirectiveDispatcher> dispatcher,
+    std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler) :
+        m_dispatcher{std::move(dispatcher)},
+        m_handler{std::move(handler)},
+        m_configuration{m_handler->getConfiguration()} {
+}
+
+inline void DirectiveDispatcher::DispatchingHandler::handleDirectiveImmediately(
+    std::shared_ptr<avsCommon::avs::AVSDirective> directive) {
+    if (!directive) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "handleDirectiveImmediatelyFailed").d("reason", "nullDirective"));
+        return;
+    }
+    auto handler = m_handler;
+    if (!m_dispatcher->dispatch(getKeys(*directive), [handler, directive]() {
+            handler->handleDirectiveImmediately(directive);
+        })) {
+        avsCommon::utils::logger::acsdkWarn(avsCommon::utils::logger::LogEntry(TAG, "handleDirectiveImmediatelyFailed")
+                                                .d("reason", "dispatcherShutdown")
+                                                .d("messageId", directive->getMessageId()));
+    }
+}
+
+inline void DirectiveDispatcher::DispatchingHandler::preHandleDirective(
+    std::shared_ptr<avsCommon::avs::AVSDirective> directive,
+    std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> result) {
+    if (!directive || !result) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "preHandleDirectiveFailed").d("reason", "nullDirectiveOrResult"));
+        return;
+    }
+    auto sharedResult = std::make_shared<SharedResult>(std::move(result));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_preHandled[directive->getMessageId()] = {directive, sharedResult};
+    }
+    m_handler->preHandleDirective(
+        directive,
+        std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface>(new ResultProxy(sharedResult)));
+}
+
+inline bool DirectiveDispatcher::DispatchingHandler::handleDirective(const std::string& messageId) {
+    PreHandled preHandled;
+    auto dispatched = std::make_shared<Dispatched>();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_preHandled.find(messageId);
+        if (it == m_preHandled.end()) {
+            avsCommon::utils::logger::acsdkError(avsCommon::utils::logger::LogEntry(TAG, "handleDirectiveFailed")
+                                                     .d("reason", "messageIdNotFound")
+                                                     .d("messageId", messageId));
+            return false;
+        }
+        preHandled = std::move(it->second);
+        m_preHandled.erase(it);
+        m_dispatched[messageId] = dispatched;
+    }
+    auto handler = m_handler;
+    auto result = preHandled.result;
+    std::weak_ptr<DispatchingHandler> weakThis = shared_from_this();
+    if (m_dispatcher->dispatch(getKeys(*preHandled.directive), [handler, result, messageId, dispatched, weakThis]() {
+            bool isCancelled = false;
+            bool handled = false;
+            {
+                std::lock_guard<std::mutex> lock(dispatched->mutex);
+                isCancelled = dispatched->isCancelled;
+                if (!isCancelled) {
+                    handled = handler->handleDirective(messageId);
+                }
+            }
+            // The entry stays until the call has returned, so that cancelDirective() finds it and waits for the call.
+            if (auto self = weakThis.lock()) {
+                std::lock_guard<std::mutex> lock(self->m_mutex);
+                auto it = self->m_dispatched.find(messageId);
+                if (it != self->m_dispatched.end() && it->second == dispatched) {
+                    self->m_dispatched.erase(it);
+                }
+            }
+            if (!isCancelled && !handled) {
+                result->setFailed("handleDirectiveFailed");
+            }
+        })) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dispatched.erase(messageId);
+    return false;
+}
+
+inline void DirectiveDispatcher::DispatchingHandler::cancelDirective(const std::string& messageId) {
+    std::shared_ptr<Dispatched> dispatched;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_preHandled.erase(messageId);
+        auto it = m_dispatched.find(messageId);
+        if (it != m_dispatched.end()) {
+            dispatched = it->second;
+            m_dispatched.erase(it);
+        }
+    }
+    if (dispatched) {
+        // Waits for a wrapped handleDirective() call already under way, so the wrapped handler sees the cancellation
+        // after it.
+        std::lock_guard<std::mutex> lock(dispatched->mutex);
+        dispatched->isCancelled = true;
+    }
+    m_handler->cancelDirective(messageId);
+}
+
+inline void DirectiveDispatcher::DispatchingHandler::onDeregistered() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_preHandled.clear();
+    }
+    m_handler->onDeregistered();
+}
+
+inline avsCommon::avs::DirectiveHandlerConfiguration DirectiveDispatcher::DispatchingHandler::getConfiguration()
+    const {
+    return m_configuration;
+}
+
+inline std::vector<std::string> DirectiveDispatcher::DispatchingHandler::getKeys(
+    const avsCommon::avs::AVSDirective& directive) const {
+    auto it = m_configuration.find(avsCommon::avs::NamespaceAndName(directive.getNamespace(), directive.getName()));
+    return DirectiveDispatcher::getKeys(
+        directive, it != m_configuration.end() ? it->second : avsCommon::avs::BlockingPolicy());
+}
+
+inline DirectiveDispatcher::DispatchingHandler::SharedResult::SharedResult(
+    std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> result) :
+        m_result{std::move(result)} {
+}
+
+inline void DirectiveDispatcher::DispatchingHandler::SharedResult::setCompleted() {
+    auto result = take();
+    if (result) {
+        result->setCompleted();
+    }
+}
+
+inline void DirectiveDispatcher::DispatchingHandler::SharedResult::setFailed(const std::string& description) {
+    auto result = take();
+    if (result) {
+        result->setFailed(description);
+    }
+}
+
+inline std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> DirectiveDispatcher::
+    DispatchingHandler::SharedResult::take() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_result);
+}
+
+inline DirectiveDispatcher::DispatchingHandler::ResultProxy::ResultProxy(std::shared_ptr<SharedResult> result) :
+        m_result{std::move(result)} {
+}
+
+inline void DirectiveDispatcher::DispatchingHandler::ResultProxy::setCompleted() {
+    m_result->setCompleted();
+}
+
+inline void DirectiveDispatcher::DispatchingHandler::ResultProxy::setFailed(const std::string& description) {
+    m_result->setFailed(description);
+}
+
+}  // namespace adsl
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_ADSL_INCLUDE_ADSL_DIRECTIVEDISPATCHER_H_
@@ -0,0 +1,606 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_ADSL_INCLUDE_ADSL_DIRECTIVEROUTINGTABLE_H_
+#define ALEXA_CLIENT_SDK_ADSL_INCLUDE_ADSL_DIRECTIVEROUTINGTABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <AVSCommon/AVS/AVSDirective.h>
+#include <AVSCommon/AVS/BlockingPolicy.h>
+#include <AVSCommon/AVS/DirectiveHandlerConfiguration.h>
+#include <AVSCommon/AVS/NamespaceAndName.h>
+#include <AVSCommon/SDKInterfaces/DirectiveHandlerInterface.h>
+#include <AVSCommon/SDKInterfaces/DirectiveHandlerResultInterface.h>
+#include <AVSCommon/Utils/Logger/LoggerUtils.h>
+#include <AVSCommon/Utils/RequiresShutdown.h>
+
+namespace alexaClientSDK {
+namespace adsl {
+
+/**
+ * A @c DirectiveRouter whose lookups take no lock.
+ *
+ * Handlers are added and removed at startup and on mode changes, while every directive is looked up several times.
+ * This class keeps the mappings from @c NamespaceAndName to handler and @c BlockingPolicy in an immutable table,
+ * which @c addDirectiveHandler() and @c removeDirectiveHandler() replace with an updated copy and publish through an
+ * atomic pointer.  A lookup loads the pointer, hashes the directive's namespace and name into a 64 bit key, and
+ * probes an open addressed array of interned keys; it allocates nothing and takes no lock.
+ *
+ * A replaced table is freed once no lookup can still be reading it.  Lookups are counted in one of two reader
+ * counters, chosen by the parity of an epoch; a writer flips the epoch and waits for the old parity's readers to
+ * leave, twice, after which every lookup which might have seen the old table has finished.  Writers are serialized,
+ * and wait only for lookups, never for calls to handlers.
+ *
+ * As with @c DirectiveRouter, a handler's @c onDeregistered() is called once it has been removed and no call to it is
+ * in progress.  Calls to handlers are made outside the lookup, and count against the handler's registration rather
+ * than against a lock.
+ */
+class DirectiveRoutingTable : public avsCommon::utils::RequiresShutdown {
+public:
+    /// Constructor.
+    DirectiveRoutingTable();
+
+    /// Destructor.
+    ~DirectiveRoutingTable();
+
+    /**
+     * Add mappings from handler's @c NamespaceAndName values to @c BlockingPolicy values, gotten through the handler's
+     * getConfiguration() method.  If a mapping for any of the specified @c NamespaceAndName values already exists the
+     * entire call is refused.
+     *
+     * @param handler The handler to add.
+     * @return Whether the handler was added.
+     */
+    bool addDirectiveHandler(std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler);
+
+    /**
+     * Remove the specified mappings from @c NamespaceAndName values to @c BlockingPolicy values, gotten through the
+     * handler's getConfiguration() method.  If any of the specified mappings do not match an existing mapping, the
+     * entire operation is refused.
+     *
+     * @param handler The handler to remove.
+     * @return Whether the configuration was removed.
+     */
+    bool removeDirectiveHandler(std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler);
+
+    /**
+     * Invoke @c handleDirectiveImmediately() on the handler registered for the given @c AVSDirective.
+     *
+     * @param directive The directive to be handled immediately.
+     * @return Whether or not the handler was invoked.
+     */
+    bool handleDirectiveImmediately(std::shared_ptr<avsCommon::avs::AVSDirective> directive);
+
+    /**
+     * Invoke @c preHandleDirective() on the handler registered for the given @c AVSDirective.
+     *
+     * @param directive The directive to be preHandled.
+     * @param result A result object to receive notification about the completion (or failure) of handling
+     * the @c AVSDirective.
+     * @return Whether or not the handler was invoked.
+     */
+    bool preHandleDirective(
+        std::shared_ptr<avsCommon::avs::AVSDirective> directive,
+        std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> result);
+
+    /**
+     * Invoke @c handleDirective() on the handler registered for the given @c AVSDirective.
+     *
+     * @param directive The directive to be handled.
+     * @return @c true if the the registered handler returned @c true.  @c false if there was no registered handler
+     * or the registered handler returned @c false.
+     */
+    bool handleDirective(const std::shared_ptr<avsCommon::avs::AVSDirective>& directive);
+
+    /**
+     * Invoke cancelDirective() on the handler registered for the given @c AVSDirective.
+     *
+     * @param directive The directive to be cancelled.
+     * @return Whether or not the handler was invoked.
+     */
+    bool cancelDirective(std::shared_ptr<avsCommon::avs::AVSDirective> directive);
+
+    /**
+     * Get the policy associated with the given directive.
+     *
+     * @param directive The directive for which the policy is required.
+     * @return The corresponding @c BlockingPolicy value for the directive.
+     */
+    avsCommon::avs::BlockingPolicy getPolicy(const std::shared_ptr<avsCommon::avs::AVSDirective>& directive);
+
+private:
+    /**
+     * A registered handler.  It counts one reference while any of its mappings are in the current table, and one for
+     * each call to it in progress, and calls @c onDeregistered() and deletes itself when the count reaches zero.
+     */
+    class Registration {
+    public:
+        /**
+         * Constructor.  The registration starts with the reference held by the table.
+         *
+         * @param handler The handler.
+         */
+        explicit Registration(std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler);
+
+        /// Take a reference.
+        void acquire();
+
+        /// Release a reference, deregistering the handler if it was the last.
+        void release();
+
+        /// The handler.
+        const std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler;
+
+        /// The number of mappings of the handler in the current table.  Only used by writers.
+        size_t mappingCount;
+
+    private:
+        /// The number of references.
+        std::atomic<int> m_references;
+    };
+
+    /// A mapping in a table.  A slot with no registration is empty.
+    struct Slot {
+        /// The hash of the namespace and name.
+        uint64_t hash = 0;
+
+        /// The interned namespace.
+        std::string nameSpace;
+
+        /// The interned name.
+        std::string name;
+
+        /// The policy of the mapping.
+        avsCommon::avs::BlockingPolicy policy;
+
+        /// The handler of the mapping.
+        Registration* registration = nullptr;
+    };
+
+    /// An immutable table of mappings.
+    struct Table {
+        /// Open addressed mappings, probed linearly.  The size is a power of two, and at least one slot is empty.
+        std::vector<Slot> slots;
+
+        /// The number of mappings.
+        size_t size = 0;
+    };
+
+    /// Counts a lookup in the reader counter of the current epoch for as long as it is in scope.
+    class ReadScope {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param table The routing table being read.
+         */
+        explicit ReadScope(DirectiveRoutingTable* table);
+
+        /// Destructor.
+        ~ReadScope();
+
+    private:
+        /// The reader counter taken.
+        std::atomic<int>& m_readers;
+    };
+
+    /// @name RequiresShutdown methods.
+    /// @{
+    void doShutdown() override;
+    /// @}
+
+    /**
+     * Look up the mapping of a directive, and take a reference to its handler.
+     *
+     * @param directive The directive.
+     * @param caller The name of the calling method, for logging.
+     * @return The handler's registration, which must be released, or nullptr if no handler is registered.
+     */
+    Registration* acquireHandler(const std::shared_ptr<avsCommon::avs::AVSDirective>& directive, const char* caller);
+
+    /**
+     * Find the mapping of a namespace and name in a table.
+     *
+     * @param table The table.
+     * @param nameSpace The namespace.
+     * @param name The name.
+     * @return The mapping, or nullptr if there is none.
+     */
+    static const Slot* find(const Table& table, const std::string& nameSpace, const std::string& name);
+
+    /**
+     * Hash a namespace and name.
+     *
+     * @param nameSpace The namespace.
+     * @param name The name.
+     * @return The hash, which is never zero.
+     */
+    static uint64_t hash(const std::string& nameSpace, const std::string& name);
+
+    /**
+     * Build a table from a list of mappings.
+     *
+     * @param slots The mappings.
+     * @return The new table.
+     */
+    static Table* build(const std::vector<Slot>& slots);
+
+    /**
+     * Get the mappings of the current table.  @c m_writeMutex must be held.
+     *
+     * @return The mappings.
+     */
+    std::vector<Slot> getSlotsLocked() const;
+
+    /**
+     * Publish a new table, wait until no lookup can be reading the old one, and free it.  @c m_writeMutex must be
+     * held.
+     *
+     * @param table The new table.
+     */
+    void publishLocked(Table* table);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "DirectiveRoutingTable";
+
+    /// The current table.
+    std::atomic<Table*> m_table;
+
+    /// The epoch, whose parity selects the reader counter taken by new lookups.
+    std::atomic<unsigned> m_epoch;
+
+    /// The number of lookups in progress, by the parity of the epoch they started in.
+    std::atomic<int> m_readers[2];
+
+    /// Serializes writers.
+    std::mutex m_writeMutex;
+
+    /// The registrations of the handlers with mappings in the current table.
+    std::unordered_map<
+        std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface>,
+        Registration*>
+        m_registrations;
+};
+
+inline DirectiveRoutingTable::DirectiveRoutingTable() :
+        RequiresShutdown{"DirectiveRoutingTable"},
+        m_table{build({})},
+        m_epoch{0} {
+    m_readers[0] = 0;
+    m_readers[1] = 0;
+}
+
+inline DirectiveRoutingTable::~DirectiveRoutingTable() {
+    doShutdown();
+    delete m_table.load();
+}
+
+inline bool DirectiveRoutingTable::addDirectiveHandler(
+    std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler) {
+    if (!handler) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "addDirectiveHandlersFailed").d("reason", "emptyHandler"));
+        return false;
+    }
+    auto configuration = handler->getConfiguration();
+    if (configuration.empty()) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "addDirectiveHandlersFailed").d("reason", "emptyConfiguration"));
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    auto table = m_table.load();
+    for (const auto& item : configuration) {
+        if (!item.second.isValid()) {
+            avsCommon::utils::logger::acsdkError(avsCommon::utils::logger::LogEntry(TAG, "addDirectiveHandlersFailed")
+                                                     .d("reason", "invalidBlockingPolicy")
+                                                     .d("namespace", item.first.nameSpace)
+                                                     .d("name", item.first.name));
+            return false;
+        }
+        if (find(*table, item.first.nameSpace, item.first.name)) {
+            avsCommon::utils::logger::acsdkError(avsCommon::utils::logger::LogEntry(TAG, "addDirectiveHandlersFailed")
+                                                     .d("reason", "alreadyConfigured")
+                                                     .d("namespace", item.first.nameSpace)
+                                                     .d("name", item.first.name));
+            return false;
+        }
+    }
+    auto& registration = m_registrations[handler];
+    if (!registration) {
+        registration = new Registration(handler);
+    }
+    auto slots = getSlotsLocked();
+    for (const auto& item : configuration) {
+        Slot slot;
+        slot.hash = hash(item.first.nameSpace, item.first.name);
+        slot.nameSpace = item.first.nameSpace;
+        slot.name = item.first.name;
+        slot.policy = item.second;
+        slot.registration = registration;
+        slots.push_back(slot);
+        registration->mappingCount++;
+    }
+    publishLocked(build(slots));
+    return true;
+}
+
+inline bool DirectiveRoutingTable::removeDirectiveHandler(
+    std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler) {
+    if (!handler) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "removeDirectiveHandlersFailed").d("reason", "emptyHandler"));
+        return false;
+    }
+    auto configuration = handler->getConfiguration();
+    Registration* removed = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        auto table = m_table.load();
+        for (const auto& item : configuration) {
+            auto slot = find(*table, item.first.nameSpace, item.first.name);
+            if (!slot || slot->registration->handler != handler || slot->policy != item.second) {
+                avsCommon::utils::logger::acsdkError(
+                    avsCommon::utils::logger::LogEntry(TAG, "removeDirectiveHandlersFailed")
+                        .d("reason", "notFound")
+                        .d("namespace", item.first.nameSpace)
+                        .d("name", item.first.name));
+                return false;
+            }
+        }
+        auto it = m_registrations.find(handler);
+        if (it == m_registrations.end()) {
+            return configuration.empty();
+        }
+        std::vector<Slot> slots;
+        for (const auto& slot : getSlotsLocked()) {
+            if (slot.registration == it->second &&
+                configuration.count(avsCommon::avs::NamespaceAndName(slot.nameSpace, slot.name))) {
+                it->second->mappingCount--;
+            } else {
+                slots.push_back(slot);
+            }
+        }
+        publishLocked(build(slots));
+        if (0 == it->second->mappingCount) {
+            removed = it->second;
+            m_registrations.erase(it);
+        }
+    }
+    // No lookup can reach the registration now, so its table reference can be released.
+    if (removed) {
+        removed->release();
+    }
+    return true;
+}
+
+inline bool DirectiveRoutingTable::handleDirectiveImmediately(
+    std::shared_ptr<avsCommon::avs::AVSDirective> directive) {
+    auto registration = acquireHandler(directive, "handleDirectiveImmediately");
+    if (!registration) {
+        return false;
+    }
+    registration->handler->handleDirectiveImmediately(directive);
+    registration->release();
+    return true;
+}
+
+inline bool DirectiveRoutingTable::preHandleDirective(
+    std::shared_ptr<avsCommon::avs::AVSDirective> directive,
+    std::unique_ptr<avsCommon::sdkInterfaces::DirectiveHandlerResultInterface> result) {
+    auto registration = acquireHandler(directive, "preHandleDirective");
+    if (!registration) {
+        return false;
+    }
+    registration->handler->preHandleDirective(directive, std::move(result));
+    registration->release();
+    return true;
+}
+
+inline bool DirectiveRoutingTable::handleDirective(const std::shared_ptr<avsCommon::avs::AVSDirective>& directive) {
+    auto registration = acquireHandler(directive, "handleDirective");
+    if (!registration) {
+        return false;
+    }
+    auto result = registration->handler->handleDirective(directive->getMessageId());
+    registration->release();
+    if (!result) {
+        avsCommon::utils::logger::acsdkWarn(avsCommon::utils::logger::LogEntry(TAG, "handleDirectiveFailed")
+                                                .d("messageId", directive->getMessageId())
+                                                .d("reason", "handleDirectiveFailed"));
+    }
+    return result;
+}
+
+inline bool DirectiveRoutingTable::cancelDirective(std::shared_ptr<avsCommon::avs::AVSDirective> directive) {
+    auto registration = acquireHandler(directive, "cancelDirective");
+    if (!registration) {
+        return false;
+    }
+    registration->handler->cancelDirective(directive->getMessageId());
+    registration->release();
+    return true;
+}
+
+inline avsCommon::avs::BlockingPolicy DirectiveRoutingTable::getPolicy(
+    const std::shared_ptr<avsCommon::avs::AVSDirective>& directive) {
+    if (!directive) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, "getPolicyFailed").d("reason", "nullDirective"));
+        return avsCommon::avs::BlockingPolicy();
+    }
+    auto nameSpace = directive->getNamespace();
+    auto name = directive->getName();
+    ReadScope scope(this);
+    auto slot = find(*m_table.load(), nameSpace, name);
+    return slot ? slot->policy : avsCommon::avs::BlockingPolicy();
+}
+
+inline void DirectiveRoutingTable::doShutdown() {
+    std::vector<Registration*> removed;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        publishLocked(build({}));
+        for (auto& item : m_registrations) {
+            removed.push_back(item.second);
+        }
+        m_registrations.clear();
+    }
+    for (auto registration : removed) {
+        registration->release();
+    }
+}
+
+inline DirectiveRoutingTable::Registration* DirectiveRoutingTable::acquireHandler(
+    const std::shared_ptr<avsCommon::avs::AVSDirective>& directive,
+    const char* caller) {
+    if (!directive) {
+        avsCommon::utils::logger::acsdkError(
+            avsCommon::utils::logger::LogEntry(TAG, std::string(caller) + "Failed").d("reason", "nullDirective"));
+        return nullptr;
+    }
+    auto nameSpace = directive->getNamespace();
+    auto name = directive->getName();
+    Registration* registration = nullptr;
+    {
+        ReadScope scope(this);
+        auto slot = find(*m_table.load(), nameSpace, name);
+        if (slot) {
+            registration = slot->registration;
+            registration->acquire();
+        }
+    }
+    if (!registration) {
+        avsCommon::utils::logger::acsdkWarn(avsCommon::utils::logger::LogEntry(TAG, std::string(caller) + "Failed")
+                                                .d("reason", "noHandlerRegistered")
+                                                .d("namespace", nameSpace)
+                                                .d("name", name));
+    }
+    return registration;
+}
+
+inline const DirectiveRoutingTable::Slot* DirectiveRoutingTable::find(
+    const Table& table,
+    const std::string& nameSpace,
+    const std::string& name) {
+    auto key = hash(nameSpace, name);
+    auto mask = table.slots.size() - 1;
+    for (auto index = key & mask;; index = (index + 1) & mask) {
+        const auto& slot = table.slots[index];
+        if (!slot.registration) {
+            return nullptr;
+        }
+        if (slot.hash == key && slot.nameSpace == nameSpace && slot.name == name) {
+            return &slot;
+        }
+    }
+}
+
+inline uint64_t DirectiveRoutingTable::hash(const std::string& nameSpace, const std::string& name) {
+    // 64 bit FNV-1a over the namespace, a separator, and the name.
+    uint64_t value = 14695981039346656037ULL;
+    for (auto c : nameSpace) {
+        value = (value ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    value = (value ^ '.') * 1099511628211ULL;
+    for (auto c : name) {
+        value = (value ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return value ? value : 1;
+}
+
+inline DirectiveRoutingTable::Table* DirectiveRoutingTable::build(const std::vector<Slot>& slots) {
+    auto table = new Table();
+    // Keep the table at most half full, so that probes stay short.
+    size_t capacity = 8;
+    while (capacity < slots.size() * 2) {
+        capacity *= 2;
+    }
+    table->slots.resize(capacity);
+    auto mask = capacity - 1;
+    for (const auto& slot : slots) {
+        auto index = slot.hash & mask;
+        while (table->slots[index].registration) {
+            index = (index + 1) & mask;
+        }
+        table->slots[index] = slot;
+    }
+    table->size = slots.size();
+    return table;
+}
+
+inline std::vector<DirectiveRoutingTable::Slot> DirectiveRoutingTable::getSlotsLocked() const {
+    std::vector<Slot> slots;
+    auto table = m_table.load();
+    slots.reserve(table->size);
+    for (const auto& slot : table->slots) {
+        if (slot.registration) {
+            slots.push_back(slot);
+        }
+    }
+    return slots;
+}
+
+inline void DirectiveRoutingTable::publishLocked(Table* table) {
+    auto old = m_table.exchange(table);
+    // A lookup may have taken its counter just before a flip, so each parity is drained in turn.
+    for (int flip = 0; flip < 2; ++flip) {
+        auto parity = m_epoch.fetch_add(1) & 1;
+        while (m_readers[parity].load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+    delete old;
+}
+
+inline DirectiveRoutingTable::Registration::Registration(
+    std::shared_ptr<avsCommon::sdkInterfaces::DirectiveHandlerInterface> handler) :
+        handler{std::move(handler)},
+        mappingCount{0},
+        m_references{1} {
+}
+
+inline void DirectiveRoutingTable::Registration::acquire() {
+    m_references.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void DirectiveRoutingTable::Registration::release() {
+    if (1 == m_references.fetch_sub(1, std::memory_order_acq_rel)) {
+        handler->onDeregistered();
+        delete this;
+    }
+}
+
+inline DirectiveRoutingTable::ReadScope::ReadScope(DirectiveRoutingTable* table) :
+        m_readers(table->m_readers[table->m_epoch.load() & 1]) {
+    m_readers.fetch_add(1);
+}
+
+inline DirectiveRoutingTable::ReadScope::~ReadScope() {
+    m_readers.fetch_sub(1);
+}
+
+}  // namespace adsl
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_ADSL_INCLUDE_ADSL_DIRECTIVEROUTINGTABLE_H_
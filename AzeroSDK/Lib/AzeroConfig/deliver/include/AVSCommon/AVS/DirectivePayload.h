@@ -0,0 +1,301 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_AVS_INCLUDE_AVSCOMMON_AVS_DIRECTIVEPAYLOAD_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_AVS_INCLUDE_AVSCOMMON_AVS_DIRECTIVEPAYLOAD_H_
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+
+#include "AVSCommon/AVS/AVSDirective.h"
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace avs {
+
+/**
+ * The payload of an @c AVSDirective, parsed once and shared by every handler which reads it.
+ *
+ * Handlers which call @c jsonUtils::retrieveValue() on @c AVSDirective::getPayload(), or parse it into their own
+ * @c rapidjson::Document, each copy and parse the payload again.  @c get() parses it the first time it is asked for
+ * a directive, and returns the same immutable document for as long as the directive lives.  Handlers read it through
+ * @c getRoot() with the @c rapidjson::Value overloads of @c jsonUtils:
+ *
+ * @code
+ *     auto payload = DirectivePayload::get(directive);
+ *     std::string token;
+ *     if (!payload->isValid() || !jsonUtils::retrieveValue(payload->getRoot(), "token", &token)) { ... }
+ * @endcode
+ *
+ * The payload is parsed in situ, so its strings point into the copy of the payload text returned by
+ * @c AVSDirective::getPayload() rather than being copied again.  Its values, and the parser's stack, are allocated
+ * from @c rapidjson::MemoryPoolAllocator instances whose first chunks are taken from a pool of chunks kept between
+ * directives, so for most payloads the parse itself does not allocate.  Each payload still allocates that copy of the
+ * text, the @c DirectivePayload with its reference count, and an entry in the cache of payloads by directive.
+ *
+ * This class is thread safe: a @c DirectivePayload is never modified once created.
+ */
+class DirectivePayload {
+public:
+    /**
+     * Get the parsed payload of a directive, parsing it if this is the first time it is asked for.
+     *
+     * @param directive The directive.
+     * @return The parsed payload, or nullptr if @c directive is nullptr.
+     */
+    static std::shared_ptr<const DirectivePayload> get(const std::shared_ptr<AVSDirective>& directive);
+
+    /**
+     * Parse a payload without caching it.
+     *
+     * @param payload The payload text.
+     * @return The parsed payload.
+     */
+    static std::shared_ptr<const DirectivePayload> create(std::string payload);
+
+    /**
+     * Get whether the payload was parsed as a JSON object.
+     *
+     * @return Whether @c getRoot() is an object.
+     */
+    bool isValid() const;
+
+    /**
+     * Get the root of the parsed payload.
+     *
+     * @return The root value, which is null if the payload could not be parsed.
+     */
+    const rapidjson::Value& getRoot() const;
+
+    /// The size of the pooled first chunk of each payload's allocators, in bytes.
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    /// The initial capacity of the parser's stack, in bytes.  It grows in place within its chunk.
+    static constexpr size_t STACK_CAPACITY = 1024;
+
+    /// The most idle chunks kept in the pool.
+    static constexpr size_t MAX_IDLE_CHUNKS = 16;
+
+    /// The number of cached payloads above which payloads of directives which no longer exist are swept out.
+    static constexpr size_t MIN_SWEEP_SIZE = 64;
+
+    /// Deleted copy constructor.
+    DirectivePayload(const DirectivePayload&) = delete;
+
+    /// Deleted assignment operator.
+    DirectivePayload& operator=(const DirectivePayload&) = delete;
+
+private:
+    /// A chunk taken from the pool, and returned to it once the allocator using it is destroyed.
+    class Chunk {
+    public:
+        /// Constructor.  Takes an idle chunk, or allocates one.
+        Chunk();
+
+        /// Destructor.  Returns the chunk to the pool, or frees it if the pool is full.
+        ~Chunk();
+
+        /// @return The memory of the chunk.
+        char* data();
+
+    private:
+        /// The memory of the chunk.
+        std::unique_ptr<char[]> m_data;
+    };
+
+    /// The pool of idle chunks.
+    struct ChunkPool {
+        /// Protects @c chunks.
+        std::mutex mutex;
+
+        /// Idle chunks.
+        std::vector<std::unique_ptr<char[]>> chunks;
+    };
+
+    /// A cached payload.
+    struct CacheEntry {
+        /// The directive the payload belongs to.  An expired entry is stale even if another directive now has the
+        /// same address.
+        std::weak_ptr<AVSDirective> directive;
+
+        /// The parsed payload.
+        std::shared_ptr<const DirectivePayload> payload;
+    };
+
+    /// A document whose parser stack is allocated from a pooled chunk, as its values are.
+    using Document = rapidjson::GenericDocument<
+        rapidjson::UTF8<>,
+        rapidjson::MemoryPoolAllocator<>,
+        rapidjson::MemoryPoolAllocator<>>;
+
+    /// The cache of payloads by directive.
+    struct Cache {
+        /// Protects the members below.
+        std::mutex mutex;
+
+        /// The cached payloads, by the address of their directive.
+        std::unordered_map<const AVSDirective*, CacheEntry> entries;
+
+        /// The size of @c entries above which it is next swept.
+        size_t sweepSize = MIN_SWEEP_SIZE;
+    };
+
+    /**
+     * Constructor.  Parses the payload.
+     *
+     * @param payload The payload text.
+     */
+    explicit DirectivePayload(std::string payload);
+
+    /// @return The pool of idle chunks.
+    static ChunkPool& getChunkPool();
+
+    /// @return The cache of payloads by directive.
+    static Cache& getCache();
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "DirectivePayload";
+
+    /// The first chunk of @c m_allocator.  Declared first, so that it is released after the allocator is destroyed.
+    Chunk m_chunk;
+
+    /// The first chunk of @c m_stackAllocator.
+    Chunk m_stackChunk;
+
+    /// The allocator of the document's values.
+    rapidjson::MemoryPoolAllocator<> m_allocator;
+
+    /// The allocator of the parser's stack.
+    rapidjson::MemoryPoolAllocator<> m_stackAllocator;
+
+    /// The payload text, which the document's strings point into.
+    std::string m_text;
+
+    /// The parsed payload.
+    Document m_document;
+};
+
+inline std::shared_ptr<const DirectivePayload> DirectivePayload::get(const std::shared_ptr<AVSDirective>& directive) {
+    if (!directive) {
+        utils::logger::acsdkError(utils::logger::LogEntry(TAG, "getFailed").d("reason", "nullDirective"));
+        return nullptr;
+    }
+    auto& cache = getCache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.entries.find(directive.get());
+        if (it != cache.entries.end() && it->second.directive.lock() == directive) {
+            return it->second.payload;
+        }
+    }
+    // Parse outside the lock.  If another thread parsed the same payload meanwhile, its copy is kept.
+    auto payload = create(directive->getPayload());
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto& entry = cache.entries[directive.get()];
+    if (entry.directive.lock() == directive) {
+        return entry.payload;
+    }
+    entry.directive = directive;
+    entry.payload = payload;
+    if (cache.entries.size() > cache.sweepSize) {
+        for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+            it = it->second.directive.expired() ? cache.entries.erase(it) : std::next(it);
+        }
+        cache.sweepSize = cache.entries.size() * 2;
+        if (cache.sweepSize < MIN_SWEEP_SIZE) {
+            cache.sweepSize = MIN_SWEEP_SIZE;
+        }
+    }
+    return payload;
+}
+
+inline std::shared_ptr<const DirectivePayload> DirectivePayload::create(std::string payload) {
+    return std::shared_ptr<const DirectivePayload>(new DirectivePayload(std::move(payload)));
+}
+
+inline DirectivePayload::DirectivePayload(std::string payload) :
+        m_allocator{m_chunk.data(), CHUNK_SIZE, CHUNK_SIZE},
+        m_stackAllocator{m_stackChunk.data(), CHUNK_SIZE, CHUNK_SIZE},
+        m_text{std::move(payload)},
+        m_document{&m_allocator, STACK_CAPACITY, &m_stackAllocator} {
+    m_document.ParseInsitu(&m_text[0]);
+    if (m_document.HasParseError()) {
+        utils::logger::acsdkError(utils::logger::LogEntry(TAG, "parseFailed")
+                                      .d("offset", m_document.GetErrorOffset())
+                                      .d("error", rapidjson::GetParseError_En(m_document.GetParseError())));
+        m_document.SetNull();
+    }
+}
+
+inline bool DirectivePayload::isValid() const {
+    return m_document.IsObject();
+}
+
+inline const rapidjson::Value& DirectivePayload::getRoot() const {
+    return m_document;
+}
+
+inline DirectivePayload::ChunkPool& DirectivePayload::getChunkPool() {
+    static ChunkPool pool;
+    return pool;
+}
+
+inline DirectivePayload::Cache& DirectivePayload::getCache() {
+    // The cache holds chunks, so the pool is created first and destroyed last.
+    getChunkPool();
+    static Cache cache;
+    return cache;
+}
+
+inline DirectivePayload::Chunk::Chunk() {
+    auto& pool = getChunkPool();
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (!pool.chunks.empty()) {
+            m_data = std::move(pool.chunks.back());
+            pool.chunks.pop_back();
+            return;
+        }
+    }
+    m_data.reset(new char[CHUNK_SIZE]);
+}
+
+inline DirectivePayload::Chunk::~Chunk() {
+    auto& pool = getChunkPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.chunks.size() < MAX_IDLE_CHUNKS) {
+        pool.chunks.push_back(std::move(m_data));
+    }
+}
+
+inline char* DirectivePayload::Chunk::data() {
+    return m_data.get();
+}
+
+}  // namespace avs
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_AVS_INCLUDE_AVSCOMMON_AVS_DIRECTIVEPAYLOAD_H_
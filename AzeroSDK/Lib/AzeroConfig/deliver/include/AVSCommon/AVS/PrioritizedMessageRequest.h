@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_AVS_INCLUDE_AVSCOMMON_AVS_PRIORITIZEDMESSAGEREQUEST_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_AVS_INCLUDE_AVSCOMMON_AVS_PRIORITIZEDMESSAGEREQUEST_H_
+
+#include <ostream>
+#include <string>
+
+#include "AVSCommon/AVS/MessageRequest.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace avs {
+
+/// How urgently a message should be sent, relative to other messages waiting to be sent.
+enum class MessageRequestPriority {
+    /// A user is waiting on the message, as with @c Recognize.  Never waits behind other messages.
+    INTERACTIVE,
+
+    /// The default.
+    NORMAL,
+
+    /// Reports and telemetry which can wait, as with @c UserInactivityReport or metrics uploads.
+    BACKGROUND
+};
+
+/**
+ * Write a @c MessageRequestPriority value to an @c ostream as a string.
+ *
+ * @param stream The stream to write the value to.
+ * @param priority The @c MessageRequestPriority value to write to the @c ostream as a string.
+ * @return The @c ostream that was passed in and written to.
+ */
+inline std::ostream& operator<<(std::ostream& stream, MessageRequestPriority priority) {
+    switch (priority) {
+        case MessageRequestPriority::INTERACTIVE:
+            return stream << "INTERACTIVE";
+        case MessageRequestPriority::NORMAL:
+            return stream << "NORMAL";
+        case MessageRequestPriority::BACKGROUND:
+            return stream << "BACKGROUND";
+    }
+    return stream << "UNKNOWN";
+}
+
+/**
+ * A @c MessageRequest which says how urgently it should be sent.
+ *
+ * Senders which do not create their own requests have their priority worked out from the event's namespace and name
+ * by @c PrioritizedMessageSender; creating a @c PrioritizedMessageRequest overrides that.
+ */
+class PrioritizedMessageRequest : public MessageRequest {
+public:
+    /**
+     * Constructor.
+     *
+     * @param jsonContent The message to be sent to AVS.
+     * @param priority How urgently the message should be sent.
+     * @param uriPathExtension An optional uri path extension which will be appended to the base url of the AVS
+     * endpoint.  If not specified, the default AVS path extension should be used by the sender implementation.
+     */
+    PrioritizedMessageRequest(
+        const std::string& jsonContent,
+        MessageRequestPriority priority,
+        const std::string& uriPathExtension = "");
+
+    /**
+     * Get how urgently the message should be sent.
+     *
+     * @return The priority.
+     */
+    MessageRequestPriority getPriority() const;
+
+private:
+    /// How urgently the message should be sent.
+    const MessageRequestPriority m_priority;
+};
+
+inline PrioritizedMessageRequest::PrioritizedMessageRequest(
+    const std::string& jsonContent,
+    MessageRequestPriority priority,
+    const std::string& uriPathExtension) :
+        MessageRequest(jsonContent, uriPathExtension),
+        m_priority{priority} {
+}
+
+inline MessageRequestPriority PrioritizedMessageRequest::getPriority() const {
+    return m_priority;
+}
+
+}  // namespace avs
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_AVS_INCLUDE_AVSCOMMON_AVS_PRIORITIZEDMESSAGEREQUEST_H_
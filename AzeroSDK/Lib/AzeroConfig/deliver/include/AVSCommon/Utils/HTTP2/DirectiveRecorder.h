@@ -0,0 +1,452 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_DIRECTIVERECORDER_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_DIRECTIVERECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace http2 {
+
+/**
+ * The file format written by @c DirectiveRecorder and read by @c DirectiveRecordingReader.  All integers are little
+ * endian.
+ *
+ *   header: "ADRC" <version:u8> <start time, microseconds since epoch:u64>
+ *   record: <type:u8> <stream:u32> <time since start, microseconds:u64> <id size:u32> <data size:u32> <id> <data>
+ *
+ * The stream numbers each response the records came from, so that attachments can be matched with the directives
+ * which refer to them.
+ */
+struct DirectiveRecording {
+    /// The types of record.
+    enum class RecordType : uint8_t {
+        /// The JSON of a directive.  The id is empty.
+        DIRECTIVE = 1,
+        /// Some of the content of an attachment.  The id is the attachment's content id.
+        ATTACHMENT_DATA = 2,
+        /// The end of an attachment.  The id is the attachment's content id, and the data is empty.
+        ATTACHMENT_END = 3
+    };
+
+    /// A record.
+    struct Record {
+        /// The type of the record.
+        RecordType type;
+
+        /// The number of the response the record came from.
+        uint32_t stream;
+
+        /// The time the record was received, since the recording started.
+        std::chrono::microseconds time;
+
+        /// The content id of an attachment.
+        std::string id;
+
+        /// The JSON of a directive, or the content of an attachment.
+        std::string data;
+    };
+
+    /// The bytes at the start of a recording.
+    static constexpr const char* MAGIC = "ADRC";
+
+    /// The size of @c MAGIC.
+    static constexpr size_t MAGIC_SIZE = 4;
+
+    /// The version of the format.
+    static constexpr uint8_t VERSION = 1;
+
+    /// The size of the fixed part of a record.
+    static constexpr size_t RECORD_HEADER_SIZE = 1 + 4 + 8 + 4 + 4;
+};
+
+/**
+ * Records the directives and attachments received from AVS to a file, for replay with the @c AVSDirectiveReplay tool.
+ *
+ * Recording is off until @c start() is called.  @c HTTP2RecordingResponseSink feeds the recorder while it is on, and
+ * while it is off costs one atomic load per response.
+ *
+ * Only @c LibcurlEventHTTP2Connection wraps its responses with that sink, so only connections made by
+ * @c LibcurlEventHTTP2ConnectionFactory are recorded.  The engine's own transport, the prebuilt
+ * @c LibcurlHTTP2Connection, is not.
+ *
+ * This class is thread safe.
+ */
+class DirectiveRecorder {
+public:
+    /**
+     * Get the engine wide recorder.
+     *
+     * @return The recorder.
+     */
+    static std::shared_ptr<DirectiveRecorder> getInstance();
+
+    /**
+     * Destructor.  Stops recording.
+     */
+    ~DirectiveRecorder();
+
+    /**
+     * Start recording to a file, replacing any recording in progress.
+     *
+     * @param path The path of the file, which is truncated.
+     * @return Whether the file was opened.
+     */
+    bool start(const std::string& path);
+
+    /**
+     * Stop recording and close the file.
+     */
+    void stop();
+
+    /**
+     * Get whether a recording is in progress.
+     *
+     * @return Whether records are being written.
+     */
+    bool isRecording() const;
+
+    /**
+     * Allocate the number of a new response.
+     *
+     * @return The stream number.
+     */
+    uint32_t nextStream();
+
+    /**
+     * Record the JSON of a directive.
+     *
+     * @param stream The number of the response.
+     * @param json The JSON.
+     */
+    void recordDirective(uint32_t stream, const std::string& json);
+
+    /**
+     * Record some of the content of an attachment.
+     *
+     * @param stream The number of the response.
+     * @param contentId The content id of the attachment.
+     * @param bytes The content.
+     * @param size The size of the content.
+     */
+    void recordAttachmentData(uint32_t stream, const std::string& contentId, const char* bytes, size_t size);
+
+    /**
+     * Record the end of an attachment.
+     *
+     * @param stream The number of the response.
+     * @param contentId The content id of the attachment.
+     */
+    void recordAttachmentEnd(uint32_t stream, const std::string& contentId);
+
+private:
+    /// Constructor.
+    DirectiveRecorder();
+
+    /**
+     * Write a record.
+     *
+     * @param type The type of the record.
+     * @param stream The number of the response.
+     * @param id The content id, or empty.
+     * @param bytes The data.
+     * @param size The size of the data.
+     */
+    void write(
+        DirectiveRecording::RecordType type,
+        uint32_t stream,
+        const std::string& id,
+        const char* bytes,
+        size_t size);
+
+    /**
+     * Append an integer to a buffer, little endian.
+     *
+     * @param value The integer.
+     * @param size The number of bytes to append.
+     * @param[out] out The buffer.
+     */
+    static void appendInteger(uint64_t value, size_t size, std::string* out);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "DirectiveRecorder";
+
+    /// Whether a recording is in progress.
+    std::atomic<bool> m_isRecording;
+
+    /// The number of the next response.
+    std::atomic<uint32_t> m_nextStream;
+
+    /// Serializes access to the members below.
+    std::mutex m_mutex;
+
+    /// The file being written, or nullptr.
+    FILE* m_file;
+
+    /// When the recording started.
+    std::chrono::steady_clock::time_point m_startTime;
+};
+
+/**
+ * Reads a file written by @c DirectiveRecorder.
+ */
+class DirectiveRecordingReader {
+public:
+    /// Constructor.
+    DirectiveRecordingReader();
+
+    /// Destructor.
+    ~DirectiveRecordingReader();
+
+    /**
+     * Open a recording and read its header.
+     *
+     * @param path The path of the file.
+     * @return Whether the file is a recording this reader understands.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Read the next record.
+     *
+     * @param[out] record Receives the record.
+     * @return Whether a whole record was read.  A recording cut short ends at its last whole record.
+     */
+    bool next(DirectiveRecording::Record* record);
+
+    /**
+     * Get when the recording started.
+     *
+     * @return The start time, in microseconds since the epoch.
+     */
+    uint64_t getStartTime() const;
+
+    /// Deleted copy constructor.
+    DirectiveRecordingReader(const DirectiveRecordingReader&) = delete;
+
+    /// Deleted assignment operator.
+    DirectiveRecordingReader& operator=(const DirectiveRecordingReader&) = delete;
+
+private:
+    /**
+     * Read a little endian integer.
+     *
+     * @param bytes The bytes.
+     * @param size The number of bytes.
+     * @return The integer.
+     */
+    static uint64_t readInteger(const unsigned char* bytes, size_t size);
+
+    /// The file being read, or nullptr.
+    FILE* m_file;
+
+    /// When the recording started, in microseconds since the epoch.
+    uint64_t m_startTime;
+
+    /// The size of the file being read, in bytes.
+    uint64_t m_fileSize;
+};
+
+inline std::shared_ptr<DirectiveRecorder> DirectiveRecorder::getInstance() {
+    static std::shared_ptr<DirectiveRecorder> instance(new DirectiveRecorder());
+    return instance;
+}
+
+inline DirectiveRecorder::DirectiveRecorder() : m_isRecording{false}, m_nextStream{0}, m_file{nullptr} {
+}
+
+inline DirectiveRecorder::~DirectiveRecorder() {
+    stop();
+}
+
+inline bool DirectiveRecorder::start(const std::string& path) {
+    auto file = fopen(path.c_str(), "wb");
+    if (!file) {
+        logger::acsdkError(logger::LogEntry(TAG, "startFailed").d("reason", "openFailed").d("path", path));
+        return false;
+    }
+    std::string header(DirectiveRecording::MAGIC, DirectiveRecording::MAGIC_SIZE);
+    header.push_back(static_cast<char>(DirectiveRecording::VERSION));
+    auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    appendInteger(std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count(), 8, &header);
+    fwrite(header.data(), 1, header.size(), file);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file) {
+        fclose(m_file);
+    }
+    m_file = file;
+    m_startTime = std::chrono::steady_clock::now();
+    m_isRecording = true;
+    logger::acsdkInfo(logger::LogEntry(TAG, "start").d("path", path));
+    return true;
+}
+
+inline void DirectiveRecorder::stop() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isRecording = false;
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+inline bool DirectiveRecorder::isRecording() const {
+    return m_isRecording;
+}
+
+inline uint32_t DirectiveRecorder::nextStream() {
+    return m_nextStream++;
+}
+
+inline void DirectiveRecorder::recordDirective(uint32_t stream, const std::string& json) {
+    write(DirectiveRecording::RecordType::DIRECTIVE, stream, "", json.data(), json.size());
+}
+
+inline void DirectiveRecorder::recordAttachmentData(
+    uint32_t stream,
+    const std::string& contentId,
+    const char* bytes,
+    size_t size) {
+    write(DirectiveRecording::RecordType::ATTACHMENT_DATA, stream, contentId, bytes, size);
+}
+
+inline void DirectiveRecorder::recordAttachmentEnd(uint32_t stream, const std::string& contentId) {
+    write(DirectiveRecording::RecordType::ATTACHMENT_END, stream, contentId, nullptr, 0);
+}
+
+inline void DirectiveRecorder::write(
+    DirectiveRecording::RecordType type,
+    uint32_t stream,
+    const std::string& id,
+    const char* bytes,
+    size_t size) {
+    std::string header;
+    header.reserve(DirectiveRecording::RECORD_HEADER_SIZE + id.size());
+    header.push_back(static_cast<char>(type));
+    appendInteger(stream, 4, &header);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file) {
+        return;
+    }
+    auto time = std::chrono::steady_clock::now() - m_startTime;
+    appendInteger(std::chrono::duration_cast<std::chrono::microseconds>(time).count(), 8, &header);
+    appendInteger(id.size(), 4, &header);
+    appendInteger(size, 4, &header);
+    header.append(id);
+    if (fwrite(header.data(), 1, header.size(), m_file) != header.size() ||
+        (size > 0 && fwrite(bytes, 1, size, m_file) != size)) {
+        logger::acsdkError(logger::LogEntry(TAG, "writeFailed").d("reason", "recordingStopped"));
+        m_isRecording = false;
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+inline void DirectiveRecorder::appendInteger(uint64_t value, size_t size, std::string* out) {
+    for (size_t index = 0; index < size; ++index) {
+        out->push_back(static_cast<char>((value >> (8 * index)) & 0xff));
+    }
+}
+
+inline DirectiveRecordingReader::DirectiveRecordingReader() : m_file{nullptr}, m_startTime{0}, m_fileSize{0} {
+}
+
+inline DirectiveRecordingReader::~DirectiveRecordingReader() {
+    if (m_file) {
+        fclose(m_file);
+    }
+}
+
+inline bool DirectiveRecordingReader::open(const std::string& path) {
+    if (m_file) {
+        fclose(m_file);
+    }
+    m_file = fopen(path.c_str(), "rb");
+    if (!m_file) {
+        return false;
+    }
+    long fileSize = -1;
+    if (0 == fseek(m_file, 0, SEEK_END)) {
+        fileSize = ftell(m_file);
+    }
+    if (fileSize < 0 || fseek(m_file, 0, SEEK_SET) != 0) {
+        fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    m_fileSize = static_cast<uint64_t>(fileSize);
+    unsigned char header[DirectiveRecording::MAGIC_SIZE + 1 + 8];
+    if (fread(header, 1, sizeof(header), m_file) != sizeof(header) ||
+        memcmp(header, DirectiveRecording::MAGIC, DirectiveRecording::MAGIC_SIZE) != 0 ||
+        header[DirectiveRecording::MAGIC_SIZE] != DirectiveRecording::VERSION) {
+        fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    m_startTime = readInteger(header + DirectiveRecording::MAGIC_SIZE + 1, 8);
+    return true;
+}
+
+inline bool DirectiveRecordingReader::next(DirectiveRecording::Record* record) {
+    unsigned char header[DirectiveRecording::RECORD_HEADER_SIZE];
+    if (!m_file || fread(header, 1, sizeof(header), m_file) != sizeof(header)) {
+        return false;
+    }
+    record->type = static_cast<DirectiveRecording::RecordType>(header[0]);
+    record->stream = static_cast<uint32_t>(readInteger(header + 1, 4));
+    record->time = std::chrono::microseconds(readInteger(header + 5, 8));
+    auto idSize = static_cast<size_t>(readInteger(header + 13, 4));
+    auto dataSize = static_cast<size_t>(readInteger(header + 17, 4));
+    // A record cut short, or a corrupt size, must not allocate more than is left of the file.
+    auto position = ftell(m_file);
+    if (position < 0 || static_cast<uint64_t>(idSize) + dataSize > m_fileSize - static_cast<uint64_t>(position)) {
+        return false;
+    }
+    record->id.resize(idSize);
+    record->data.resize(dataSize);
+    return (0 == idSize || fread(&record->id[0], 1, idSize, m_file) == idSize) &&
+           (0 == dataSize || fread(&record->data[0], 1, dataSize, m_file) == dataSize);
+}
+
+inline uint64_t DirectiveRecordingReader::getStartTime() const {
+    return m_startTime;
+}
+
+inline uint64_t DirectiveRecordingReader::readInteger(const unsigned char* bytes, size_t size) {
+    uint64_t value = 0;
+    for (size_t index = 0; index < size; ++index) {
+        value |= static_cast<uint64_t>(bytes[index]) << (8 * index);
+    }
+    return value;
+}
+
+}  // namespace http2
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_DIRECTIVERECORDER_H_
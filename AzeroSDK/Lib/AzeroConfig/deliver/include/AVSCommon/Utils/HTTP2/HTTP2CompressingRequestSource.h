@@ -0,0 +1,367 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2COMPRESSINGREQUESTSOURCE_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2COMPRESSINGREQUESTSOURCE_H_
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AVSCommon/Utils/HTTP2/HTTP2RequestCompressor.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2RequestSourceInterface.h"
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace http2 {
+
+/**
+ * Wraps the @c HTTP2RequestSourceInterface of a request, such as an @c HTTP2MimeRequestEncoder, and sends its body
+ * compressed with gzip, with a @c Content-Encoding header on the request.
+ *
+ * An event without attachments is a few KB of JSON holding the event and the device context, all of which its
+ * source can give at once.  When asked for the request's header lines, this class reads the body from the wrapped
+ * source, and if it completes within @c MAX_BUFFERED_SIZE bytes, is at least @c HTTP2RequestCompressor::getMinSize()
+ * long and gets smaller, sends its gzip encoding instead.  A body which is not available at once, such as one
+ * streaming audio, is not compressed: what has been read is sent as it is, and the rest is passed through untouched.
+ *
+ * Bodies are also passed through untouched if the server has not said that it accepts compressed bodies, if the
+ * request already has a @c Content-Encoding, or if the request opts out by sending the
+ * @c getNoCompressionHeaderLine() header, for example because it is latency sensitive and its body is small.  That
+ * header is removed before the request is sent.
+ *
+ * The uncompressed body of a compressed request is kept, so that if the server rejects the request it can be sent
+ * again uncompressed, from @c takeUncompressedSource().
+ */
+class HTTP2CompressingRequestSource : public HTTP2RequestSourceInterface {
+public:
+    /**
+     * Constructor.
+     *
+     * @param source The source of the request.
+     * @param compressor The compressor.
+     */
+    HTTP2CompressingRequestSource(
+        std::shared_ptr<HTTP2RequestSourceInterface> source,
+        std::shared_ptr<HTTP2RequestCompressor> compressor);
+
+    /// @name HTTP2RequestSourceInterface methods.
+    /// @{
+    HTTP2SendDataResult onSendData(char* bytes, size_t size) override;
+    std::vector<std::string> getRequestHeaderLines() override;
+    /// @}
+
+    /**
+     * Get whether the body is being sent compressed.  This is known once @c getRequestHeaderLines() has been called.
+     *
+     * @return Whether the body is compressed.
+     */
+    bool isCompressed() const;
+
+    /**
+     * Get a source which sends the request again, uncompressed.  This may only be called once, and only if
+     * @c isCompressed().
+     *
+     * @return The source, or nullptr if the body is not compressed or has already been taken.
+     */
+    std::shared_ptr<HTTP2RequestSourceInterface> takeUncompressedSource();
+
+    /**
+     * Get the header line with which a request source opts its request out of compression.
+     *
+     * @return The header line.
+     */
+    static const char* getNoCompressionHeaderLine();
+
+private:
+    /// Sends a request whose header lines and body are already known.
+    class BufferedSource : public HTTP2RequestSourceInterface {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param headerLines The header lines of the request.
+         * @param body The body of the request.
+         */
+        BufferedSource(std::vector<std::string> headerLines, std::string body);
+
+        /// @name HTTP2RequestSourceInterface methods.
+        /// @{
+        HTTP2SendDataResult onSendData(char* bytes, size_t size) override;
+        std::vector<std::string> getRequestHeaderLines() override;
+        /// @}
+
+    private:
+        /// The header lines of the request.
+        std::vector<std::string> m_headerLines;
+
+        /// The body of the request.
+        std::string m_body;
+
+        /// Number of bytes of @c m_body already sent.
+        size_t m_bodyIndex;
+    };
+
+    /// The states that the source transitions through.
+    enum class State {
+        /// Sending the buffered start of the body, compressed or not.
+        SENDING_BUFFERED,
+        /// Passing the rest of the body through from the wrapped source.
+        PASSING_THROUGH,
+        /// Done sending.
+        DONE,
+        /// The wrapped source aborted while the body was being read.
+        ABORTED
+    };
+
+    /**
+     * Read the body from the wrapped source into @c m_buffer, until it completes, pauses or reaches
+     * @c MAX_BUFFERED_SIZE bytes.
+     *
+     * @return Whether the whole body was read.
+     */
+    bool bufferBody();
+
+    /**
+     * Get the header lines to send, with a @c Content-Encoding if the body is compressed.
+     *
+     * @return The header lines.
+     */
+    std::vector<std::string> headerLinesToSend() const;
+
+    /**
+     * Whether a request header line is the one returned by @c getNoCompressionHeaderLine().
+     *
+     * @param line The header line, in lower case.
+     * @return Whether the request opts out of compression.
+     */
+    static bool isNoCompressionHeaderLine(const std::string& line);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "HTTP2CompressingRequestSource";
+
+    /// The most of the body read looking for its end.
+    static constexpr size_t MAX_BUFFERED_SIZE = 256 * 1024;
+
+    /// The size of each read from the wrapped source while buffering.
+    static constexpr size_t READ_SIZE = 16 * 1024;
+
+    /// The source of the request.
+    std::shared_ptr<HTTP2RequestSourceInterface> m_source;
+
+    /// The compressor.
+    std::shared_ptr<HTTP2RequestCompressor> m_compressor;
+
+    /// Current state.
+    State m_state;
+
+    /// The header lines of the request, without a @c Content-Encoding added for compression.
+    std::vector<std::string> m_headerLines;
+
+    /// The start of the body, or all of it compressed.
+    std::string m_buffer;
+
+    /// Number of bytes of @c m_buffer already sent.
+    size_t m_bufferIndex;
+
+    /// Whether the body has been read from the wrapped source to be compressed.
+    bool m_isBodyRead;
+
+    /// Whether the wrapped source has completed.
+    bool m_isSourceComplete;
+
+    /// Whether the body is compressed.
+    bool m_isCompressed;
+
+    /// The uncompressed body, kept while the body is compressed.
+    std::string m_uncompressedBody;
+};
+
+inline HTTP2CompressingRequestSource::HTTP2CompressingRequestSource(
+    std::shared_ptr<HTTP2RequestSourceInterface> source,
+    std::shared_ptr<HTTP2RequestCompressor> compressor) :
+        m_source{std::move(source)},
+        m_compressor{std::move(compressor)},
+        m_state{State::PASSING_THROUGH},
+        m_bufferIndex{0},
+        m_isBodyRead{false},
+        m_isSourceComplete{false},
+        m_isCompressed{false} {
+}
+
+inline HTTP2SendDataResult HTTP2CompressingRequestSource::onSendData(char* bytes, size_t size) {
+    if (!m_source) {
+        return HTTP2SendDataResult::ABORT;
+    }
+    switch (m_state) {
+        case State::SENDING_BUFFERED: {
+            auto count = std::min(size, m_buffer.size() - m_bufferIndex);
+            memcpy(bytes, m_buffer.data() + m_bufferIndex, count);
+            m_bufferIndex += count;
+            if (m_bufferIndex == m_buffer.size()) {
+                m_state = m_isSourceComplete ? State::DONE : State::PASSING_THROUGH;
+                std::string().swap(m_buffer);
+            }
+            if (count > 0) {
+                return HTTP2SendDataResult(count);
+            }
+            return onSendData(bytes, size);
+        }
+        case State::PASSING_THROUGH:
+            return m_source->onSendData(bytes, size);
+        case State::DONE:
+            return HTTP2SendDataResult::COMPLETE;
+        case State::ABORTED:
+            return HTTP2SendDataResult::ABORT;
+    }
+    return HTTP2SendDataResult::ABORT;
+}
+
+inline std::vector<std::string> HTTP2CompressingRequestSource::getRequestHeaderLines() {
+    if (!m_source) {
+        return {};
+    }
+    if (m_isBodyRead) {
+        return headerLinesToSend();
+    }
+    static const std::string CONTENT_ENCODING = "content-encoding:";
+    m_headerLines = m_source->getRequestHeaderLines();
+    bool isCompressionDisabled = !m_compressor || !m_compressor->isAccepted();
+    auto it = m_headerLines.begin();
+    while (it != m_headerLines.end()) {
+        std::string lower(*it);
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        if (isNoCompressionHeaderLine(lower)) {
+            isCompressionDisabled = true;
+            it = m_headerLines.erase(it);
+            continue;
+        }
+        if (lower.compare(0, CONTENT_ENCODING.size(), CONTENT_ENCODING) == 0) {
+            isCompressionDisabled = true;
+        }
+        ++it;
+    }
+    if (isCompressionDisabled) {
+        return m_headerLines;
+    }
+    m_isBodyRead = true;
+    m_isSourceComplete = bufferBody();
+    if (State::ABORTED == m_state) {
+        return m_headerLines;
+    }
+    m_bufferIndex = 0;
+    m_state = State::SENDING_BUFFERED;
+    std::string compressed;
+    if (!m_isSourceComplete || m_buffer.size() < m_compressor->getMinSize() ||
+        !m_compressor->compress(m_buffer.data(), m_buffer.size(), &compressed) ||
+        compressed.size() >= m_buffer.size()) {
+        return m_headerLines;
+    }
+    logger::acsdkDebug9(
+        logger::LogEntry(TAG, "getRequestHeaderLines").d("size", m_buffer.size()).d("compressed", compressed.size()));
+    m_uncompressedBody.swap(m_buffer);
+    m_buffer.swap(compressed);
+    m_isCompressed = true;
+    return headerLinesToSend();
+}
+
+inline bool HTTP2CompressingRequestSource::isCompressed() const {
+    return m_isCompressed;
+}
+
+inline std::shared_ptr<HTTP2RequestSourceInterface> HTTP2CompressingRequestSource::takeUncompressedSource() {
+    if (!m_isCompressed || m_uncompressedBody.empty()) {
+        return nullptr;
+    }
+    std::string body;
+    body.swap(m_uncompressedBody);
+    return std::make_shared<BufferedSource>(m_headerLines, std::move(body));
+}
+
+inline const char* HTTP2CompressingRequestSource::getNoCompressionHeaderLine() {
+    return "x-acsdk-compression: none";
+}
+
+inline bool HTTP2CompressingRequestSource::isNoCompressionHeaderLine(const std::string& line) {
+    static const std::string NO_COMPRESSION = getNoCompressionHeaderLine();
+    auto end = line.find_last_not_of(" \t\r\n");
+    return end != std::string::npos && line.compare(0, end + 1, NO_COMPRESSION) == 0;
+}
+
+inline std::vector<std::string> HTTP2CompressingRequestSource::headerLinesToSend() const {
+    auto lines = m_headerLines;
+    if (m_isCompressed) {
+        lines.push_back(std::string("Content-Encoding: ") + HTTP2RequestCompressor::getContentEncoding());
+    }
+    return lines;
+}
+
+inline bool HTTP2CompressingRequestSource::bufferBody() {
+    while (m_buffer.size() < MAX_BUFFERED_SIZE) {
+        auto offset = m_buffer.size();
+        m_buffer.resize(offset + READ_SIZE);
+        auto result = m_source->onSendData(&m_buffer[offset], READ_SIZE);
+        m_buffer.resize(offset + (HTTP2SendStatus::CONTINUE == result.status ? result.size : 0));
+        switch (result.status) {
+            case HTTP2SendStatus::CONTINUE:
+                if (0 == result.size) {
+                    return false;
+                }
+                break;
+            case HTTP2SendStatus::PAUSE:
+                return false;
+            case HTTP2SendStatus::COMPLETE:
+                return true;
+            case HTTP2SendStatus::ABORT:
+                m_state = State::ABORTED;
+                return false;
+        }
+    }
+    return false;
+}
+
+inline HTTP2CompressingRequestSource::BufferedSource::BufferedSource(
+    std::vector<std::string> headerLines,
+    std::string body) :
+        m_headerLines{std::move(headerLines)},
+        m_body{std::move(body)},
+        m_bodyIndex{0} {
+}
+
+inline HTTP2SendDataResult HTTP2CompressingRequestSource::BufferedSource::onSendData(char* bytes, size_t size) {
+    auto count = std::min(size, m_body.size() - m_bodyIndex);
+    if (0 == count) {
+        return HTTP2SendDataResult::COMPLETE;
+    }
+    memcpy(bytes, m_body.data() + m_bodyIndex, count);
+    m_bodyIndex += count;
+    return HTTP2SendDataResult(count);
+}
+
+inline std::vector<std::string> HTTP2CompressingRequestSource::BufferedSource::getRequestHeaderLines() {
+    return m_headerLines;
+}
+
+}  // namespace http2
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2COMPRESSINGREQUESTSOURCE_H_
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2COMPRESSIONNEGOTIATIONSINK_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2COMPRESSIONNEGOTIATIONSINK_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "AVSCommon/Utils/HTTP2/HTTP2CompressingRequestSource.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2RequestCompressor.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2ResponseSinkInterface.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace http2 {
+
+/**
+ * Wraps the @c HTTP2ResponseSinkInterface of a request, passing the response's header lines to an
+ * @c HTTP2RequestCompressor so that it learns whether the server accepts compressed request bodies.
+ *
+ * If the request was sent compressed and the server answers with a client error (4xx), compression is turned off,
+ * the response is kept from the wrapped sink, and once it finishes the request is sent again uncompressed through
+ * the retry function.  The wrapped sink then sees only the response to the uncompressed request.
+ */
+class HTTP2CompressionNegotiationSink : public HTTP2ResponseSinkInterface {
+public:
+    /**
+     * Sends a request again with another source.  It returns whether the request was handed on, in which case the
+     * new request reports the response to the wrapped sink.
+     */
+    using RetryFunction = std::function<bool(std::shared_ptr<HTTP2RequestSourceInterface> source)>;
+
+    /**
+     * Constructor.
+     *
+     * @param sink The sink for the response.
+     * @param compressor The compressor to tell about the response.
+     * @param source The source of the request, or nullptr if it is not compressed.
+     * @param retry Sends the request again uncompressed if the server rejects it compressed, or nullptr.
+     */
+    HTTP2CompressionNegotiationSink(
+        std::shared_ptr<HTTP2ResponseSinkInterface> sink,
+        std::shared_ptr<HTTP2RequestCompressor> compressor,
+        std::shared_ptr<HTTP2CompressingRequestSource> source = nullptr,
+        RetryFunction retry = nullptr);
+
+    /// @name HTTP2ResponseSinkInterface methods.
+    /// @{
+    bool onReceiveResponseCode(long responseCode) override;
+    bool onReceiveHeaderLine(const std::string& line) override;
+    HTTP2ReceiveDataStatus onReceiveData(const char* bytes, size_t size) override;
+    void onResponseFinished(HTTP2ResponseFinishedStatus status) override;
+    /// @}
+
+private:
+    /// The sink for the response.
+    std::shared_ptr<HTTP2ResponseSinkInterface> m_sink;
+
+    /// The compressor to tell about the response.
+    std::shared_ptr<HTTP2RequestCompressor> m_compressor;
+
+    /// The source of the request.
+    std::shared_ptr<HTTP2CompressingRequestSource> m_source;
+
+    /// Sends the request again uncompressed.
+    RetryFunction m_retry;
+
+    /// The status code of a rejection of the compressed request, kept from @c m_sink, or zero.
+    long m_rejectedResponseCode;
+};
+
+inline HTTP2CompressionNegotiationSink::HTTP2CompressionNegotiationSink(
+    std::shared_ptr<HTTP2ResponseSinkInterface> sink,
+    std::shared_ptr<HTTP2RequestCompressor> compressor,
+    std::shared_ptr<HTTP2CompressingRequestSource> source,
+    RetryFunction retry) :
+        m_sink{std::move(sink)},
+        m_compressor{std::move(compressor)},
+        m_source{std::move(source)},
+        m_retry{std::move(retry)},
+        m_rejectedResponseCode{0} {
+}
+
+inline bool HTTP2CompressionNegotiationSink::onReceiveResponseCode(long responseCode) {
+    if (responseCode >= 400 && responseCode < 500 && m_source && m_source->isCompressed()) {
+        m_compressor->onCompressedRequestRejected(responseCode);
+        if (m_retry) {
+            m_rejectedResponseCode = responseCode;
+            return true;
+        }
+    }
+    return m_sink->onReceiveResponseCode(responseCode);
+}
+
+inline bool HTTP2CompressionNegotiationSink::onReceiveHeaderLine(const std::string& line) {
+    if (m_rejectedResponseCode != 0) {
+        return true;
+    }
+    m_compressor->onResponseHeaderLine(line);
+    return m_sink->onReceiveHeaderLine(line);
+}
+
+inline HTTP2ReceiveDataStatus HTTP2CompressionNegotiationSink::onReceiveData(const char* bytes, size_t size) {
+    if (m_rejectedResponseCode != 0) {
+        return HTTP2ReceiveDataStatus::SUCCESS;
+    }
+    return m_sink->onReceiveData(bytes, size);
+}
+
+inline void HTTP2CompressionNegotiationSink::onResponseFinished(HTTP2ResponseFinishedStatus status) {
+    auto retry = std::move(m_retry);
+    m_retry = nullptr;
+    if (m_rejectedResponseCode != 0) {
+        if (HTTP2ResponseFinishedStatus::COMPLETE == status) {
+            auto source = m_source->takeUncompressedSource();
+            if (source && retry(source)) {
+                return;
+            }
+        }
+        // Not sent again, so the wrapped sink gets the rejection after all.
+        m_sink->onReceiveResponseCode(m_rejectedResponseCode);
+    }
+    m_sink->onResponseFinished(status);
+}
+
+}  // namespace http2
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2COMPRESSIONNEGOTIATIONSINK_H_
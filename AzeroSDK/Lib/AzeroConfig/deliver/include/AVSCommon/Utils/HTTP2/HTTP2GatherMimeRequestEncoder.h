@@ -0,0 +1,255 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2GATHERMIMEREQUESTENCODER_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2GATHERMIMEREQUESTENCODER_H_
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AVSCommon/Utils/HTTP2/HTTP2MimeRequestSourceInterface.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2RequestSourceInterface.h"
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace http2 {
+
+/**
+ * Encodes mime parts from an @c HTTP2MimeRequestSourceInterface in to a single request stream, like
+ * @c HTTP2MimeRequestEncoder, with fewer copies and callbacks.
+ *
+ * The boundary and headers before each part are rendered in to one block when the part's headers are received, and
+ * copied with a single @c memcpy().  Part data is written by the source straight in to the buffer passed to
+ * @c onSendData(), at the position following the framing, so the JSON part and attachment data are not staged.  Each
+ * call fills as much of the buffer as the source allows, across part boundaries, so the framing and the data after it
+ * go out together.
+ */
+class HTTP2GatherMimeRequestEncoder : public HTTP2RequestSourceInterface {
+public:
+    /**
+     * Constructor.
+     *
+     * @param boundary The mime boundary to include between mime parts.
+     * @param source Pointer to an object providing the mime parts in sequence.
+     */
+    HTTP2GatherMimeRequestEncoder(const std::string& boundary, std::shared_ptr<HTTP2MimeRequestSourceInterface> source);
+
+    /// @name HTTP2RequestSourceInterface methods.
+    /// @{
+    HTTP2SendDataResult onSendData(char* bytes, size_t size) override;
+    std::vector<std::string> getRequestHeaderLines() override;
+    /// @}
+
+private:
+    /// The states that the encoder transitions through.
+    enum class State {
+        /// Requesting the source for the headers for the next part.
+        GETTING_PART_HEADERS,
+        /// Sending the boundary and headers before a part, or the final boundary.
+        SENDING_FRAMING,
+        /// Sending data for the current part.
+        SENDING_PART_DATA,
+        /// Done sending.
+        DONE,
+        /// Bad state.
+        ABORT
+    };
+
+    /**
+     * Render the boundary and headers which go before a part.
+     *
+     * @param headers The part's header lines.
+     */
+    void renderPartFraming(const std::vector<std::string>& headers);
+
+    /**
+     * Render the boundary which ends the request.
+     */
+    void renderFinalFraming();
+
+    /**
+     * Return the bytes copied so far, or @c PAUSE if there are none.
+     *
+     * @param copied The number of bytes copied.
+     * @return The result to return from @c onSendData().
+     */
+    static HTTP2SendDataResult continueOrPause(size_t copied);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "HTTP2GatherMimeRequestEncoder";
+
+    /// Current state.
+    State m_state;
+
+    /// The boundry string without a CRLF or two-dash prefix.
+    std::string m_rawBoundary;
+
+    /// Shared pointer to the MimeRequestSource implementation.
+    std::shared_ptr<HTTP2MimeRequestSourceInterface> m_source;
+
+    /// Number of parts whose headers have been received.
+    size_t m_partCount;
+
+    /// Whether @c m_framing is the boundary which ends the request.
+    bool m_isFinalFraming;
+
+    /// The boundary and headers being sent.
+    std::string m_framing;
+
+    /// Number of bytes of @c m_framing already sent.
+    size_t m_framingIndex;
+};
+
+inline HTTP2GatherMimeRequestEncoder::HTTP2GatherMimeRequestEncoder(
+    const std::string& boundary,
+    std::shared_ptr<HTTP2MimeRequestSourceInterface> source) :
+        m_state{State::GETTING_PART_HEADERS},
+        m_rawBoundary{boundary},
+        m_source{std::move(source)},
+        m_partCount{0},
+        m_isFinalFraming{false},
+        m_framingIndex{0} {
+}
+
+inline HTTP2SendDataResult HTTP2GatherMimeRequestEncoder::onSendData(char* bytes, size_t size) {
+    if (!m_source) {
+        return HTTP2SendDataResult::ABORT;
+    }
+    size_t copied = 0;
+    while (copied < size) {
+        switch (m_state) {
+            case State::GETTING_PART_HEADERS: {
+                auto result = m_source->getMimePartHeaderLines();
+                switch (result.status) {
+                    case HTTP2SendStatus::CONTINUE:
+                        renderPartFraming(result.headers);
+                        break;
+                    case HTTP2SendStatus::COMPLETE:
+                        renderFinalFraming();
+                        break;
+                    case HTTP2SendStatus::PAUSE:
+                        return continueOrPause(copied);
+                    case HTTP2SendStatus::ABORT:
+                        m_state = State::ABORT;
+                        return HTTP2SendDataResult::ABORT;
+                }
+                m_state = State::SENDING_FRAMING;
+                break;
+            }
+            case State::SENDING_FRAMING: {
+                size_t count = m_framing.size() - m_framingIndex;
+                if (count > size - copied) {
+                    count = size - copied;
+                }
+                memcpy(bytes + copied, m_framing.data() + m_framingIndex, count);
+                copied += count;
+                m_framingIndex += count;
+                if (m_framingIndex == m_framing.size()) {
+                    m_state = m_isFinalFraming ? State::DONE : State::SENDING_PART_DATA;
+                }
+                break;
+            }
+            case State::SENDING_PART_DATA: {
+                size_t requested = size - copied;
+                auto result = m_source->onSendMimePartData(bytes + copied, requested);
+                switch (result.status) {
+                    case HTTP2SendStatus::CONTINUE:
+                        if (result.size > requested) {
+                            logger::acsdkError(logger::LogEntry(TAG, "onSendDataFailed")
+                                                   .d("reason", "sourceOverflow")
+                                                   .d("size", result.size)
+                                                   .d("requested", requested));
+                            m_state = State::ABORT;
+                            return HTTP2SendDataResult::ABORT;
+                        }
+                        copied += result.size;
+                        if (result.size < requested) {
+                            // The source has nothing more for now.
+                            return HTTP2SendDataResult(copied);
+                        }
+                        break;
+                    case HTTP2SendStatus::COMPLETE:
+                        m_state = State::GETTING_PART_HEADERS;
+                        break;
+                    case HTTP2SendStatus::PAUSE:
+                        return continueOrPause(copied);
+                    case HTTP2SendStatus::ABORT:
+                        m_state = State::ABORT;
+                        return HTTP2SendDataResult::ABORT;
+                }
+                break;
+            }
+            case State::DONE:
+                return copied > 0 ? HTTP2SendDataResult(copied) : HTTP2SendDataResult::COMPLETE;
+            case State::ABORT:
+                return HTTP2SendDataResult::ABORT;
+        }
+    }
+    return HTTP2SendDataResult(copied);
+}
+
+inline std::vector<std::string> HTTP2GatherMimeRequestEncoder::getRequestHeaderLines() {
+    if (!m_source) {
+        return {};
+    }
+    auto lines = m_source->getRequestHeaderLines();
+    lines.push_back("Content-Type: multipart/form-data; boundary=" + m_rawBoundary);
+    return lines;
+}
+
+inline void HTTP2GatherMimeRequestEncoder::renderPartFraming(const std::vector<std::string>& headers) {
+    size_t length = m_rawBoundary.size() + 8;
+    for (const auto& header : headers) {
+        length += header.size() + 2;
+    }
+    m_framing.clear();
+    m_framing.reserve(length);
+    if (m_partCount > 0) {
+        m_framing.append("\r\n");
+    }
+    m_framing.append("--").append(m_rawBoundary).append("\r\n");
+    for (const auto& header : headers) {
+        m_framing.append(header).append("\r\n");
+    }
+    m_framing.append("\r\n");
+    m_framingIndex = 0;
+    m_isFinalFraming = false;
+    ++m_partCount;
+}
+
+inline void HTTP2GatherMimeRequestEncoder::renderFinalFraming() {
+    m_framing.clear();
+    if (m_partCount > 0) {
+        m_framing.append("\r\n");
+    }
+    m_framing.append("--").append(m_rawBoundary).append("--\r\n");
+    m_framingIndex = 0;
+    m_isFinalFraming = true;
+}
+
+inline HTTP2SendDataResult HTTP2GatherMimeRequestEncoder::continueOrPause(size_t copied) {
+    return copied > 0 ? HTTP2SendDataResult(copied) : HTTP2SendDataResult::PAUSE;
+}
+
+}  // namespace http2
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2GATHERMIMEREQUESTENCODER_H_
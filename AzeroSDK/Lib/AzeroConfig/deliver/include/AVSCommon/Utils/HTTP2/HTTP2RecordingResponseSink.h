@@ -0,0 +1,223 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2RECORDINGRESPONSESINK_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2RECORDINGRESPONSESINK_H_
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "AVSCommon/Utils/HTTP2/DirectiveRecorder.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2MimeResponseSinkInterface.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2ResponseSinkInterface.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2StreamingMimeResponseDecoder.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace http2 {
+
+/**
+ * Wraps the @c HTTP2ResponseSinkInterface of a request, usually the decoder in front of a @c MimeResponseSink, and
+ * records the directives and attachments in the response with a @c DirectiveRecorder.
+ *
+ * The response is passed to the wrapped sink untouched, and decoded a second time by a
+ * @c HTTP2StreamingMimeResponseDecoder for the recording.  JSON parts are recorded as directives when they end, and
+ * parts with a @c Content-ID header are recorded as attachments as their data arrives, so that a replay can feed them
+ * at the pace they were received.
+ */
+class HTTP2RecordingResponseSink : public HTTP2ResponseSinkInterface {
+public:
+    /**
+     * Constructor.
+     *
+     * @param sink The sink for the response.
+     * @param recorder The recorder.
+     */
+    HTTP2RecordingResponseSink(
+        std::shared_ptr<HTTP2ResponseSinkInterface> sink,
+        std::shared_ptr<DirectiveRecorder> recorder);
+
+    /// @name HTTP2ResponseSinkInterface methods.
+    /// @{
+    bool onReceiveResponseCode(long responseCode) override;
+    bool onReceiveHeaderLine(const std::string& line) override;
+    HTTP2ReceiveDataStatus onReceiveData(const char* bytes, size_t size) override;
+    void onResponseFinished(HTTP2ResponseFinishedStatus status) override;
+    /// @}
+
+private:
+    /// Receives the decoded parts of the response and records them.
+    class PartRecorder : public HTTP2MimeResponseSinkInterface {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param recorder The recorder.
+         */
+        explicit PartRecorder(std::shared_ptr<DirectiveRecorder> recorder);
+
+        /// @name HTTP2MimeResponseSinkInterface methods.
+        /// @{
+        bool onReceiveResponseCode(long responseCode) override;
+        bool onReceiveHeaderLine(const std::string& line) override;
+        bool onBeginMimePart(const std::multimap<std::string, std::string>& headers) override;
+        HTTP2ReceiveDataStatus onReceiveMimeData(const char* bytes, size_t size) override;
+        bool onEndMimePart() override;
+        HTTP2ReceiveDataStatus onReceiveNonMimeData(const char* bytes, size_t size) override;
+        void onResponseFinished(HTTP2ResponseFinishedStatus status) override;
+        /// @}
+
+    private:
+        /// The recorder.
+        std::shared_ptr<DirectiveRecorder> m_recorder;
+
+        /// The number of the response.
+        const uint32_t m_stream;
+
+        /// Whether the current part is a directive.
+        bool m_isDirective;
+
+        /// The content id of the current part, if it is an attachment.
+        std::string m_contentId;
+
+        /// The JSON of the current part, if it is a directive.
+        std::string m_json;
+    };
+
+    /// The sink for the response.
+    std::shared_ptr<HTTP2ResponseSinkInterface> m_sink;
+
+    /// Decodes the response for the recording, or nullptr once decoding has failed.
+    std::unique_ptr<HTTP2StreamingMimeResponseDecoder> m_decoder;
+};
+
+inline HTTP2RecordingResponseSink::HTTP2RecordingResponseSink(
+    std::shared_ptr<HTTP2ResponseSinkInterface> sink,
+    std::shared_ptr<DirectiveRecorder> recorder) :
+        m_sink{std::move(sink)},
+        m_decoder{new HTTP2StreamingMimeResponseDecoder(std::make_shared<PartRecorder>(std::move(recorder)))} {
+}
+
+inline bool HTTP2RecordingResponseSink::onReceiveResponseCode(long responseCode) {
+    if (m_decoder && !m_decoder->onReceiveResponseCode(responseCode)) {
+        m_decoder.reset();
+    }
+    return m_sink->onReceiveResponseCode(responseCode);
+}
+
+inline bool HTTP2RecordingResponseSink::onReceiveHeaderLine(const std::string& line) {
+    if (m_decoder && !m_decoder->onReceiveHeaderLine(line)) {
+        m_decoder.reset();
+    }
+    return m_sink->onReceiveHeaderLine(line);
+}
+
+inline HTTP2ReceiveDataStatus HTTP2RecordingResponseSink::onReceiveData(const char* bytes, size_t size) {
+    auto status = m_sink->onReceiveData(bytes, size);
+    // A paused sink is handed the same data again, so it is only recorded once the sink has taken it.
+    if (m_decoder && HTTP2ReceiveDataStatus::SUCCESS == status &&
+        m_decoder->onReceiveData(bytes, size) != HTTP2ReceiveDataStatus::SUCCESS) {
+        m_decoder.reset();
+    }
+    return status;
+}
+
+inline void HTTP2RecordingResponseSink::onResponseFinished(HTTP2ResponseFinishedStatus status) {
+    if (m_decoder) {
+        m_decoder->onResponseFinished(status);
+    }
+    m_sink->onResponseFinished(status);
+}
+
+inline HTTP2RecordingResponseSink::PartRecorder::PartRecorder(std::shared_ptr<DirectiveRecorder> recorder) :
+        m_recorder{std::move(recorder)},
+        m_stream{m_recorder->nextStream()},
+        m_isDirective{false} {
+}
+
+inline bool HTTP2RecordingResponseSink::PartRecorder::onReceiveResponseCode(long) {
+    return true;
+}
+
+inline bool HTTP2RecordingResponseSink::PartRecorder::onReceiveHeaderLine(const std::string&) {
+    return true;
+}
+
+inline bool HTTP2RecordingResponseSink::PartRecorder::onBeginMimePart(
+    const std::multimap<std::string, std::string>& headers) {
+    m_isDirective = false;
+    m_contentId.clear();
+    m_json.clear();
+    for (const auto& header : headers) {
+        std::string name(header.first);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if ("content-id" == name) {
+            m_contentId = header.second;
+            // The directive refers to the attachment as "cid:<id>", without the angle brackets of the header.
+            if (m_contentId.size() >= 2 && '<' == m_contentId.front() && '>' == m_contentId.back()) {
+                m_contentId = m_contentId.substr(1, m_contentId.size() - 2);
+            }
+        } else if ("content-type" == name) {
+            std::string value(header.second);
+            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+            m_isDirective = value.find("application/json") != std::string::npos;
+        }
+    }
+    if (!m_contentId.empty()) {
+        m_isDirective = false;
+    }
+    return true;
+}
+
+inline HTTP2ReceiveDataStatus HTTP2RecordingResponseSink::PartRecorder::onReceiveMimeData(
+    const char* bytes,
+    size_t size) {
+    if (m_isDirective) {
+        m_json.append(bytes, size);
+    } else if (!m_contentId.empty()) {
+        m_recorder->recordAttachmentData(m_stream, m_contentId, bytes, size);
+    }
+    return HTTP2ReceiveDataStatus::SUCCESS;
+}
+
+inline bool HTTP2RecordingResponseSink::PartRecorder::onEndMimePart() {
+    if (m_isDirective) {
+        m_recorder->recordDirective(m_stream, m_json);
+        std::string().swap(m_json);
+    } else if (!m_contentId.empty()) {
+        m_recorder->recordAttachmentEnd(m_stream, m_contentId);
+    }
+    m_isDirective = false;
+    m_contentId.clear();
+    return true;
+}
+
+inline HTTP2ReceiveDataStatus HTTP2RecordingResponseSink::PartRecorder::onReceiveNonMimeData(const char*, size_t) {
+    return HTTP2ReceiveDataStatus::SUCCESS;
+}
+
+inline void HTTP2RecordingResponseSink::PartRecorder::onResponseFinished(HTTP2ResponseFinishedStatus) {
+}
+
+}  // namespace http2
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2RECORDINGRESPONSESINK_H_
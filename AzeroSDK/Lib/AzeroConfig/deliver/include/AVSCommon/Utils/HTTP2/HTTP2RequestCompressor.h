@@ -0,0 +1,328 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2REQUESTCOMPRESSOR_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2REQUESTCOMPRESSOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace http2 {
+
+/**
+ * Compresses request bodies with gzip, once the server has said that it accepts them.
+ *
+ * The server says so as described in RFC 7694: an @c Accept-Encoding header listing @c gzip on any response turns
+ * compression on, and one which does not list it turns it off.  Until then nothing is compressed.  A client error
+ * (4xx) response to a compressed request turns compression off for good, whatever later responses say, so that a
+ * server which advertises gzip but cannot take it does not have every request sent twice.  Only @c setAccepted()
+ * turns it back on.
+ *
+ * Bodies smaller than the minimum size are not worth the CPU time, and are left as they are.  The zlib streams are
+ * kept between requests and reset rather than created for each, which saves allocating and initializing their
+ * windows; one is kept for each request being compressed at once.
+ *
+ * This class is thread safe.
+ */
+class HTTP2RequestCompressor {
+public:
+    /**
+     * Get the engine wide compressor.
+     *
+     * @return The compressor.
+     */
+    static std::shared_ptr<HTTP2RequestCompressor> getInstance();
+
+    /**
+     * Create a compressor.
+     *
+     * @param minSize The smallest body which is compressed, in bytes.
+     * @param level The zlib compression level, from 1 to 9, or @c Z_DEFAULT_COMPRESSION.
+     * @return The new compressor.
+     */
+    static std::shared_ptr<HTTP2RequestCompressor> create(
+        size_t minSize = DEFAULT_MIN_SIZE,
+        int level = Z_DEFAULT_COMPRESSION);
+
+    /**
+     * Destructor.
+     */
+    ~HTTP2RequestCompressor();
+
+    /**
+     * Get whether the server accepts compressed bodies.
+     *
+     * @return Whether bodies may be compressed.
+     */
+    bool isAccepted() const;
+
+    /**
+     * Override what the server has said, for servers known to accept compressed bodies without saying so, or known
+     * not to.  This also clears a rejection by @c onCompressedRequestRejected().
+     *
+     * @param isAccepted Whether bodies may be compressed.
+     */
+    void setAccepted(bool isAccepted);
+
+    /**
+     * Notification that the server answered a compressed request with a client error.
+     *
+     * @param responseCode The status code.
+     */
+    void onCompressedRequestRejected(long responseCode);
+
+    /**
+     * Notification of a header line of a response from the server.
+     *
+     * @param line The header line.
+     */
+    void onResponseHeaderLine(const std::string& line);
+
+    /**
+     * Get the smallest body which is compressed.
+     *
+     * @return The size in bytes.
+     */
+    size_t getMinSize() const;
+
+    /**
+     * Compress a body with gzip.
+     *
+     * @param data The body.
+     * @param size The size of the body.
+     * @param[out] out Receives the compressed body.
+     * @return Whether the operation was successful.
+     */
+    bool compress(const char* data, size_t size, std::string* out);
+
+    /**
+     * Get the content coding of compressed bodies.
+     *
+     * @return The value for a @c Content-Encoding header.
+     */
+    static const char* getContentEncoding();
+
+private:
+    /**
+     * Constructor.
+     *
+     * @param minSize The smallest body which is compressed, in bytes.
+     * @param level The zlib compression level.
+     */
+    HTTP2RequestCompressor(size_t minSize, int level);
+
+    /**
+     * Take an idle zlib stream, or create one.
+     *
+     * @return The stream, reset, or nullptr if a new stream could not be created.
+     */
+    std::unique_ptr<z_stream> takeStream();
+
+    /**
+     * Return a zlib stream to the idle streams.
+     *
+     * @param stream The stream.
+     */
+    void releaseStream(std::unique_ptr<z_stream> stream);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "HTTP2RequestCompressor";
+
+    /// The default for the smallest body which is compressed, in bytes.  Below this the saving is a few dozen bytes.
+    static constexpr size_t DEFAULT_MIN_SIZE = 1024;
+
+    /// The most idle zlib streams kept.  Each holds about 256KB.
+    static constexpr size_t MAX_IDLE_STREAMS = 2;
+
+    /// The smallest body which is compressed, in bytes.
+    const size_t m_minSize;
+
+    /// The zlib compression level.
+    const int m_level;
+
+    /// Whether the server accepts compressed bodies.
+    std::atomic<bool> m_isAccepted;
+
+    /// Whether the server has rejected a compressed request, after which its @c Accept-Encoding headers are ignored.
+    std::atomic<bool> m_isRejected;
+
+    /// Serializes access to @c m_idleStreams.
+    std::mutex m_mutex;
+
+    /// zlib streams not in use.
+    std::vector<std::unique_ptr<z_stream>> m_idleStreams;
+};
+
+inline std::shared_ptr<HTTP2RequestCompressor> HTTP2RequestCompressor::getInstance() {
+    static std::shared_ptr<HTTP2RequestCompressor> instance(create());
+    return instance;
+}
+
+inline std::shared_ptr<HTTP2RequestCompressor> HTTP2RequestCompressor::create(size_t minSize, int level) {
+    return std::shared_ptr<HTTP2RequestCompressor>(new HTTP2RequestCompressor(minSize, level));
+}
+
+inline HTTP2RequestCompressor::HTTP2RequestCompressor(size_t minSize, int level) :
+        m_minSize{minSize},
+        m_level{level},
+        m_isAccepted{false},
+        m_isRejected{false} {
+}
+
+inline HTTP2RequestCompressor::~HTTP2RequestCompressor() {
+    for (auto& stream : m_idleStreams) {
+        deflateEnd(stream.get());
+    }
+}
+
+inline bool HTTP2RequestCompressor::isAccepted() const {
+    return m_isAccepted;
+}
+
+inline void HTTP2RequestCompressor::setAccepted(bool isAccepted) {
+    m_isRejected = false;
+    m_isAccepted = isAccepted;
+}
+
+inline void HTTP2RequestCompressor::onCompressedRequestRejected(long responseCode) {
+    m_isRejected = true;
+    if (m_isAccepted.exchange(false)) {
+        logger::acsdkWarn(logger::LogEntry(TAG, "compressionDisabled")
+                              .d("reason", "compressedRequestRejected")
+                              .d("responseCode", responseCode));
+    }
+}
+
+inline void HTTP2RequestCompressor::onResponseHeaderLine(const std::string& line) {
+    static const std::string ACCEPT_ENCODING = "accept-encoding:";
+    if (line.size() < ACCEPT_ENCODING.size() ||
+        !std::equal(ACCEPT_ENCODING.begin(), ACCEPT_ENCODING.end(), line.begin(), [](char a, char b) {
+            return a == tolower(static_cast<unsigned char>(b));
+        }) ||
+        m_isRejected) {
+        return;
+    }
+    bool isAccepted = false;
+    size_t position = ACCEPT_ENCODING.size();
+    while (position < line.size()) {
+        auto end = line.find(',', position);
+        if (std::string::npos == end) {
+            end = line.size();
+        }
+        std::string coding;
+        for (auto i = position; i < end; ++i) {
+            auto c = static_cast<unsigned char>(line[i]);
+            if (!isspace(c)) {
+                coding += static_cast<char>(tolower(c));
+            }
+        }
+        // A coding may carry a weight, and a weight of zero means it is not accepted.
+        auto name = coding.substr(0, coding.find(';'));
+        auto weight = coding.find(";q=");
+        if (("gzip" == name || "*" == name) &&
+            (std::string::npos == weight || strtod(coding.c_str() + weight + 3, nullptr) > 0)) {
+            isAccepted = true;
+        }
+        position = end + 1;
+    }
+    if (m_isAccepted.exchange(isAccepted) != isAccepted) {
+        logger::acsdkInfo(logger::LogEntry(TAG, "onResponseHeaderLine").d("isAccepted", isAccepted));
+    }
+}
+
+inline size_t HTTP2RequestCompressor::getMinSize() const {
+    return m_minSize;
+}
+
+inline bool HTTP2RequestCompressor::compress(const char* data, size_t size, std::string* out) {
+    auto stream = takeStream();
+    if (!stream) {
+        return false;
+    }
+    out->resize(deflateBound(stream.get(), static_cast<uLong>(size)));
+    stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream->avail_in = static_cast<uInt>(size);
+    stream->next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+    stream->avail_out = static_cast<uInt>(out->size());
+    auto result = deflate(stream.get(), Z_FINISH);
+    if (result != Z_STREAM_END) {
+        logger::acsdkError(logger::LogEntry(TAG, "compressFailed").d("result", result));
+        deflateEnd(stream.get());
+        return false;
+    }
+    out->resize(stream->total_out);
+    releaseStream(std::move(stream));
+    return true;
+}
+
+inline const char* HTTP2RequestCompressor::getContentEncoding() {
+    return "gzip";
+}
+
+inline std::unique_ptr<z_stream> HTTP2RequestCompressor::takeStream() {
+    std::unique_ptr<z_stream> stream;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idleStreams.empty()) {
+            stream = std::move(m_idleStreams.back());
+            m_idleStreams.pop_back();
+        }
+    }
+    if (stream) {
+        if (Z_OK == deflateReset(stream.get())) {
+            return stream;
+        }
+        deflateEnd(stream.get());
+    }
+    stream.reset(new z_stream());
+    // 16 more than the window bits asks for a gzip header and trailer.
+    if (deflateInit2(stream.get(), m_level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        logger::acsdkError(logger::LogEntry(TAG, "takeStreamFailed").d("reason", "deflateInit2Failed"));
+        return nullptr;
+    }
+    return stream;
+}
+
+inline void HTTP2RequestCompressor::releaseStream(std::unique_ptr<z_stream> stream) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_idleStreams.size() < MAX_IDLE_STREAMS) {
+            m_idleStreams.push_back(std::move(stream));
+            return;
+        }
+    }
+    deflateEnd(stream.get());
+}
+
+}  // namespace http2
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2REQUESTCOMPRESSOR_H_
@@ -0,0 +1,440 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2STREAMINGMIMERESPONSEDECODER_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2STREAMINGMIMERESPONSEDECODER_H_
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "AVSCommon/Utils/HTTP2/HTTP2MimeResponseSinkInterface.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2ResponseSinkInterface.h"
+#include "AVSCommon/Utils/HTTP2/MimeBoundaryFinder.h"
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace http2 {
+
+/**
+ * Adapts between HTTP2ResponseSinkInterface and HTTP2MimeResponseSinkInterface, like @c HTTP2MimeResponseDecoder,
+ * but searches for boundaries with a @c MimeBoundaryFinder and passes part data to the sink as pointers into the
+ * buffer received from libcurl.
+ *
+ * The only bytes copied are part headers and, at the end of each buffer, the few bytes which may be the start of a
+ * boundary split across two buffers.  When the sink pauses, the decoder remembers how far into the buffer it got;
+ * libcurl delivers the same bytes again when the stream is resumed, and decoding carries on from that point.
+ */
+class HTTP2StreamingMimeResponseDecoder : public HTTP2ResponseSinkInterface {
+public:
+    /**
+     * Constructor.
+     *
+     * @param sink Pointer to the object to receive the mime parts.
+     */
+    HTTP2StreamingMimeResponseDecoder(std::shared_ptr<HTTP2MimeResponseSinkInterface> sink);
+
+    /// @name HTTP2ResponseSinkInterface methods.
+    /// @{
+    bool onReceiveResponseCode(long responseCode) override;
+    bool onReceiveHeaderLine(const std::string& line) override;
+    HTTP2ReceiveDataStatus onReceiveData(const char* bytes, size_t size) override;
+    void onResponseFinished(HTTP2ResponseFinishedStatus status) override;
+    /// @}
+
+    /// The most bytes of headers accepted for one part.
+    static constexpr size_t MAX_PART_HEADER_SIZE = 16 * 1024;
+
+private:
+    /// Where the decoder is in the multipart body.
+    enum class State {
+        /// Before the first delimiter.
+        PREAMBLE,
+        /// After a delimiter, before the end of its line.
+        DELIMITER_LINE,
+        /// In the headers of a part.
+        HEADERS,
+        /// In the data of a part.
+        BODY,
+        /// After the closing delimiter.
+        EPILOGUE
+    };
+
+    /**
+     * Decode from @c *offset to the end of a buffer.
+     *
+     * @param bytes The buffer.
+     * @param size The size of @c bytes.
+     * @param[in,out] offset Where to start; receives how far decoding got.
+     * @return SUCCESS if the whole buffer was decoded, PAUSE if the sink paused, or ABORT.
+     */
+    HTTP2ReceiveDataStatus decode(const char* bytes, size_t size, size_t* offset);
+
+    /**
+     * Decode the preamble or the data of a part, up to and including the next delimiter if there is one.
+     *
+     * @param bytes The buffer.
+     * @param size The size of @c bytes.
+     * @param[in,out] offset Where to start; receives how far decoding got.
+     * @return The decoding status.
+     */
+    HTTP2ReceiveDataStatus decodeData(const char* bytes, size_t size, size_t* offset);
+
+    /**
+     * Decode the rest of a delimiter line.
+     *
+     * @param bytes The buffer.
+     * @param size The size of @c bytes.
+     * @param[in,out] offset Where to start; receives how far decoding got.
+     * @return The decoding status.
+     */
+    HTTP2ReceiveDataStatus decodeDelimiterLine(const char* bytes, size_t size, size_t* offset);
+
+    /**
+     * Decode part headers, and begin the part once they are complete.
+     *
+     * @param bytes The buffer.
+     * @param size The size of @c bytes.
+     * @param[in,out] offset Where to start; receives how far decoding got.
+     * @return The decoding status.
+     */
+    HTTP2ReceiveDataStatus decodeHeaders(const char* bytes, size_t size, size_t* offset);
+
+    /**
+     * Pass part data to the sink.  Preamble data is dropped.
+     *
+     * @param bytes The data.
+     * @param size The size of @c bytes.
+     * @return The sink's status.
+     */
+    HTTP2ReceiveDataStatus emit(const char* bytes, size_t size);
+
+    /**
+     * Handle a complete delimiter.
+     *
+     * @return The decoding status.
+     */
+    HTTP2ReceiveDataStatus onDelimiter();
+
+    /**
+     * Strip leading and trailing spaces and tabs.
+     *
+     * @param text The text.
+     * @return The text without surrounding whitespace.
+     */
+    static std::string trim(const std::string& text);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "HTTP2StreamingMimeResponseDecoder";
+
+    /// MIMEResponseSinkInterface implementation to pass MIME data to
+    std::shared_ptr<HTTP2MimeResponseSinkInterface> m_sink;
+
+    /// Response code that has been received, or zero.
+    long m_responseCode;
+
+    /// Finds the delimiter, once the boundary is known.
+    std::unique_ptr<MimeBoundaryFinder> m_finder;
+
+    /// Where the decoder is in the multipart body.
+    State m_state;
+
+    /// Bytes at the end of the last buffer which may be the start of a delimiter.
+    std::string m_carry;
+
+    /// Whether a '-' has been seen on the current delimiter line.
+    bool m_isDelimiterDashSeen;
+
+    /// The header line being read.
+    std::string m_headerLine;
+
+    /// The number of header bytes read for the current part.
+    size_t m_headerSize;
+
+    /// The headers of the current part.
+    std::multimap<std::string, std::string> m_headers;
+
+    /// Status returned from the last @c onReceiveData() call.
+    HTTP2ReceiveDataStatus m_lastStatus;
+
+    /// How far into the buffer decoding got before a PAUSE.
+    size_t m_resumeOffset;
+};
+
+inline HTTP2StreamingMimeResponseDecoder::HTTP2StreamingMimeResponseDecoder(
+    std::shared_ptr<HTTP2MimeResponseSinkInterface> sink) :
+        m_sink{std::move(sink)},
+        m_responseCode{0},
+        m_state{State::PREAMBLE},
+        m_isDelimiterDashSeen{false},
+        m_headerSize{0},
+        m_lastStatus{HTTP2ReceiveDataStatus::SUCCESS},
+        m_resumeOffset{0} {
+}
+
+inline bool HTTP2StreamingMimeResponseDecoder::onReceiveResponseCode(long responseCode) {
+    m_responseCode = responseCode;
+    if (!m_sink) {
+        return false;
+    }
+    return m_sink->onReceiveResponseCode(responseCode);
+}
+
+inline bool HTTP2StreamingMimeResponseDecoder::onReceiveHeaderLine(const std::string& line) {
+    static const std::string boundaryPrefix = "boundary=";
+    auto position = line.find(boundaryPrefix);
+    if (!m_finder && position != std::string::npos) {
+        auto boundary = line.substr(position + boundaryPrefix.size());
+        boundary = boundary.substr(0, boundary.find_first_of("; \t\r\n"));
+        if (boundary.size() >= 2 && '"' == boundary.front() && '"' == boundary.back()) {
+            boundary = boundary.substr(1, boundary.size() - 2);
+        }
+        if (!boundary.empty()) {
+            m_finder.reset(new MimeBoundaryFinder("\r\n--" + boundary));
+            // The body may start with the delimiter without its leading CRLF; pretend the CRLF has been seen.
+            m_carry = "\r\n";
+        }
+    }
+    if (!m_sink) {
+        return false;
+    }
+    return m_sink->onReceiveHeaderLine(line);
+}
+
+inline HTTP2ReceiveDataStatus HTTP2StreamingMimeResponseDecoder::onReceiveData(const char* bytes, size_t size) {
+    if (!bytes || !m_sink) {
+        logger::acsdkError(logger::LogEntry(TAG, "onReceiveDataFailed").d("reason", "nullBytesOrSink"));
+        return HTTP2ReceiveDataStatus::ABORT;
+    }
+    if (!m_finder) {
+        return m_sink->onReceiveNonMimeData(bytes, size);
+    }
+    size_t offset = 0;
+    if (HTTP2ReceiveDataStatus::PAUSE == m_lastStatus) {
+        // libcurl delivers the paused bytes again, possibly followed by more.
+        offset = m_resumeOffset < size ? m_resumeOffset : size;
+    }
+    m_lastStatus = decode(bytes, size, &offset);
+    m_resumeOffset = offset;
+    return m_lastStatus;
+}
+
+inline void HTTP2StreamingMimeResponseDecoder::onResponseFinished(HTTP2ResponseFinishedStatus status) {
+    if (m_sink) {
+        m_sink->onResponseFinished(status);
+    }
+}
+
+inline HTTP2ReceiveDataStatus HTTP2StreamingMimeResponseDecoder::decode(
+    const char* bytes,
+    size_t size,
+    size_t* offset) {
+    auto status = HTTP2ReceiveDataStatus::SUCCESS;
+    while (HTTP2ReceiveDataStatus::SUCCESS == status && *offset < size) {
+        switch (m_state) {
+            case State::PREAMBLE:
+            case State::BODY:
+                status = decodeData(bytes, size, offset);
+                break;
+            case State::DELIMITER_LINE:
+                status = decodeDelimiterLine(bytes, size, offset);
+                break;
+            case State::HEADERS:
+                status = decodeHeaders(bytes, size, offset);
+                break;
+            case State::EPILOGUE:
+                *offset = size;
+                break;
+        }
+    }
+    return status;
+}
+
+inline HTTP2ReceiveDataStatus HTTP2StreamingMimeResponseDecoder::decodeData(
+    const char* bytes,
+    size_t size,
+    size_t* offset) {
+    const auto& delimiter = m_finder->getDelimiter();
+    const char* next = bytes + *offset;
+    size_t available = size - *offset;
+
+    // First see whether a delimiter which started at the end of the last buffer finishes in this one.
+    if (!m_carry.empty()) {
+        size_t carried = m_carry.size();
+        for (size_t start = 0; start < carried; ++start) {
+            size_t inCarry = carried - start;
+            size_t needed = delimiter.size() - inCarry;
+            size_t compared = needed < available ? needed : available;
+            if (0 != memcmp(m_carry.data() + start, delimiter.data(), inCarry) ||
+                0 != memcmp(next, delimiter.data() + inCarry, compared)) {
+                continue;
+            }
+            auto status = emit(m_carry.data(), start);
+            if (HTTP2ReceiveDataStatus::SUCCESS != status) {
+                return status;
+            }
+            if (compared < needed) {
+                // Still only the start of a delimiter.
+                m_carry.erase(0, start);
+                m_carry.append(next, available);
+                *offset = size;
+                return HTTP2ReceiveDataStatus::SUCCESS;
+            }
+            m_carry.clear();
+            *offset += needed;
+            return onDelimiter();
+        }
+        auto status = emit(m_carry.data(), carried);
+        if (HTTP2ReceiveDataStatus::SUCCESS != status) {
+            return status;
+        }
+        m_carry.clear();
+    }
+
+    size_t found = m_finder->find(next, available);
+    if (found < available) {
+        auto status = emit(next, found);
+        if (HTTP2ReceiveDataStatus::SUCCESS != status) {
+            return status;
+        }
+        *offset += found + delimiter.size();
+        return onDelimiter();
+    }
+
+    // Hold back anything which may be the start of a delimiter split across buffers.
+    size_t partial = m_finder->partialMatchAtEnd(next, available);
+    auto status = emit(next, available - partial);
+    if (HTTP2ReceiveDataStatus::SUCCESS != status) {
+        return status;
+    }
+    m_carry.assign(next + available - partial, partial);
+    *offset = size;
+    return HTTP2ReceiveDataStatus::SUCCESS;
+}
+
+inline HTTP2ReceiveDataStatus HTTP2StreamingMimeResponseDecoder::decodeDelimiterLine(
+    const char* bytes,
+    size_t size,
+    size_t* offset) {
+    while (*offset < size) {
+        char next = bytes[(*offset)++];
+        if (m_isDelimiterDashSeen) {
+            if ('-' != next) {
+                break;
+            }
+            m_state = State::EPILOGUE;
+            return HTTP2ReceiveDataStatus::SUCCESS;
+        }
+        switch (next) {
+            case '-':
+                m_isDelimiterDashSeen = true;
+                break;
+            case ' ':
+            case '\t':
+            case '\r':
+                break;
+            case '\n':
+                m_state = State::HEADERS;
+                m_headers.clear();
+                m_headerLine.clear();
+                m_headerSize = 0;
+                return HTTP2ReceiveDataStatus::SUCCESS;
+            default:
+                logger::acsdkError(logger::LogEntry(TAG, "decodeFailed").d("reason", "badDelimiterLine"));
+                return HTTP2ReceiveDataStatus::ABORT;
+        }
+    }
+    if (m_isDelimiterDashSeen && *offset < size) {
+        logger::acsdkError(logger::LogEntry(TAG, "decodeFailed").d("reason", "badCloseDelimiter"));
+        return HTTP2ReceiveDataStatus::ABORT;
+    }
+    return HTTP2ReceiveDataStatus::SUCCESS;
+}
+
+inline HTTP2ReceiveDataStatus HTTP2StreamingMimeResponseDecoder::decodeHeaders(
+    const char* bytes,
+    size_t size,
+    size_t* offset) {
+    while (*offset < size) {
+        const char* next = bytes + *offset;
+        size_t available = size - *offset;
+        auto newline = static_cast<const char*>(memchr(next, '\n', available));
+        size_t length = newline ? static_cast<size_t>(newline - next) : available;
+        m_headerSize += length + 1;
+        if (m_headerSize > MAX_PART_HEADER_SIZE) {
+            logger::acsdkError(logger::LogEntry(TAG, "decodeFailed").d("reason", "headersTooLarge"));
+            return HTTP2ReceiveDataStatus::ABORT;
+        }
+        m_headerLine.append(next, length);
+        if (!newline) {
+            *offset = size;
+            break;
+        }
+        *offset += length + 1;
+        if (!m_headerLine.empty() && '\r' == m_headerLine.back()) {
+            m_headerLine.pop_back();
+        }
+        if (m_headerLine.empty()) {
+            if (!m_sink->onBeginMimePart(m_headers)) {
+                return HTTP2ReceiveDataStatus::ABORT;
+            }
+            m_state = State::BODY;
+            return HTTP2ReceiveDataStatus::SUCCESS;
+        }
+        auto colon = m_headerLine.find(':');
+        if (colon == std::string::npos) {
+            logger::acsdkWarn(logger::LogEntry(TAG, "decodeHeaders").d("reason", "headerWithoutColon"));
+        } else {
+            m_headers.insert(std::make_pair(trim(m_headerLine.substr(0, colon)), trim(m_headerLine.substr(colon + 1))));
+        }
+        m_headerLine.clear();
+    }
+    return HTTP2ReceiveDataStatus::SUCCESS;
+}
+
+inline HTTP2ReceiveDataStatus HTTP2StreamingMimeResponseDecoder::emit(const char* bytes, size_t size) {
+    if (State::BODY != m_state || 0 == size) {
+        return HTTP2ReceiveDataStatus::SUCCESS;
+    }
+    return m_sink->onReceiveMimeData(bytes, size);
+}
+
+inline HTTP2ReceiveDataStatus HTTP2StreamingMimeResponseDecoder::onDelimiter() {
+    if (State::BODY == m_state && !m_sink->onEndMimePart()) {
+        return HTTP2ReceiveDataStatus::ABORT;
+    }
+    m_state = State::DELIMITER_LINE;
+    m_isDelimiterDashSeen = false;
+    return HTTP2ReceiveDataStatus::SUCCESS;
+}
+
+inline std::string HTTP2StreamingMimeResponseDecoder::trim(const std::string& text) {
+    auto begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    auto end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+}  // namespace http2
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_HTTP2STREAMINGMIMERESPONSEDECODER_H_
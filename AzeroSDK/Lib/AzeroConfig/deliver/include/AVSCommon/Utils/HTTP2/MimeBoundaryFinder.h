@@ -0,0 +1,365 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_MIMEBOUNDARYFINDER_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_MIMEBOUNDARYFINDER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define ACSDK_MIME_BOUNDARY_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define ACSDK_MIME_BOUNDARY_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ACSDK_MIME_BOUNDARY_NEON
+#include <arm_neon.h>
+#endif
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace http2 {
+
+/**
+ * Finds a MIME delimiter (CRLF, "--" and the boundary) in a buffer, testing 16 or 32 positions at a time.
+ *
+ * Each block of the buffer is compared against the first and the last byte of the delimiter at once, and only the
+ * positions where both match are compared in full.  The delimiter starts with CR and ends with the last byte of a
+ * random boundary, so in audio and JSON data very few positions survive the first test.  AVX2 is used where the CPU
+ * supports it, otherwise SSE2 on x86 and NEON on ARM; other targets fall back to @c memchr.
+ */
+class MimeBoundaryFinder {
+public:
+    /**
+     * The ways a @c MimeBoundaryFinder can search.
+     */
+    enum class Implementation {
+        /// @c memchr for the first byte, then a full compare.
+        SCALAR,
+        /// 16 bytes at a time with SSE2.
+        SSE2,
+        /// 32 bytes at a time with AVX2.
+        AVX2,
+        /// 16 bytes at a time with NEON.
+        NEON
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param delimiter The delimiter to search for.  Must not be empty.
+     * @param implementation How to search.  If not supported by this build or CPU, @c getBestImplementation() is used.
+     */
+    explicit MimeBoundaryFinder(
+        const std::string& delimiter,
+        Implementation implementation = getBestImplementation());
+
+    /**
+     * Find the first full occurrence of the delimiter.
+     *
+     * @param data The buffer to search.
+     * @param size The size of @c data.
+     * @return The offset of the delimiter in @c data, or @c size if it does not occur.
+     */
+    size_t find(const char* data, size_t size) const;
+
+    /**
+     * Get the length of the longest suffix of a buffer which is a proper prefix of the delimiter, i.e. the number of
+     * bytes at the end of the buffer which may be the start of a delimiter split across two buffers.
+     *
+     * @param data The buffer, which must not contain the full delimiter.
+     * @param size The size of @c data.
+     * @return The length of the suffix.
+     */
+    size_t partialMatchAtEnd(const char* data, size_t size) const;
+
+    /**
+     * @return The delimiter.
+     */
+    const std::string& getDelimiter() const;
+
+    /**
+     * @return How this finder searches.
+     */
+    Implementation getImplementation() const;
+
+    /**
+     * @return The fastest implementation supported by this build and CPU.
+     */
+    static Implementation getBestImplementation();
+
+    /**
+     * Check whether an implementation is supported by this build and CPU.
+     *
+     * @param implementation The implementation.
+     * @return Whether it is supported.
+     */
+    static bool isSupported(Implementation implementation);
+
+private:
+    /// @name Search implementations, with the same contract as @c find().
+    /// @{
+    size_t findScalar(const char* data, size_t size, size_t offset) const;
+#ifdef ACSDK_MIME_BOUNDARY_SSE2
+    size_t findSse2(const char* data, size_t size) const;
+#endif
+#ifdef ACSDK_MIME_BOUNDARY_AVX2
+    __attribute__((target("avx2"))) size_t findAvx2(const char* data, size_t size) const;
+#endif
+#ifdef ACSDK_MIME_BOUNDARY_NEON
+    size_t findNeon(const char* data, size_t size) const;
+#endif
+    /// @}
+
+    /**
+     * Check the candidate positions in a block, given as a bit mask with @c bitsPerByte bits per position.
+     *
+     * @param data The buffer.
+     * @param blockStart The offset of the block in @c data.
+     * @param mask The candidate mask.
+     * @param bitsPerByte The number of mask bits per position.
+     * @param[out] position Receives the offset of the delimiter if one is found.
+     * @return Whether the delimiter was found.
+     */
+    bool checkCandidates(const char* data, size_t blockStart, uint64_t mask, unsigned bitsPerByte, size_t* position)
+        const;
+
+    /**
+     * Count trailing zero bits.
+     *
+     * @param mask A non-zero mask.
+     * @return The index of the lowest set bit.
+     */
+    static unsigned lowestBit(uint64_t mask);
+
+    /// The delimiter.
+    std::string m_delimiter;
+
+    /// How this finder searches.
+    Implementation m_implementation;
+};
+
+inline MimeBoundaryFinder::MimeBoundaryFinder(const std::string& delimiter, Implementation implementation) :
+        m_delimiter{delimiter},
+        m_implementation{isSupported(implementation) ? implementation : getBestImplementation()} {
+}
+
+inline size_t MimeBoundaryFinder::find(const char* data, size_t size) const {
+    if (m_delimiter.empty() || size < m_delimiter.size()) {
+        return size;
+    }
+    switch (m_implementation) {
+#ifdef ACSDK_MIME_BOUNDARY_AVX2
+        case Implementation::AVX2:
+            return findAvx2(data, size);
+#endif
+#ifdef ACSDK_MIME_BOUNDARY_SSE2
+        case Implementation::SSE2:
+            return findSse2(data, size);
+#endif
+#ifdef ACSDK_MIME_BOUNDARY_NEON
+        case Implementation::NEON:
+            return findNeon(data, size);
+#endif
+        default:
+            return findScalar(data, size, 0);
+    }
+}
+
+inline size_t MimeBoundaryFinder::partialMatchAtEnd(const char* data, size_t size) const {
+    size_t longest = m_delimiter.size() - 1 < size ? m_delimiter.size() - 1 : size;
+    for (size_t length = longest; length > 0; --length) {
+        if (data[size - length] == m_delimiter[0] && 0 == memcmp(data + size - length, m_delimiter.data(), length)) {
+            return length;
+        }
+    }
+    return 0;
+}
+
+inline const std::string& MimeBoundaryFinder::getDelimiter() const {
+    return m_delimiter;
+}
+
+inline MimeBoundaryFinder::Implementation MimeBoundaryFinder::getImplementation() const {
+    return m_implementation;
+}
+
+inline MimeBoundaryFinder::Implementation MimeBoundaryFinder::getBestImplementation() {
+    if (isSupported(Implementation::AVX2)) {
+        return Implementation::AVX2;
+    }
+    if (isSupported(Implementation::SSE2)) {
+        return Implementation::SSE2;
+    }
+    if (isSupported(Implementation::NEON)) {
+        return Implementation::NEON;
+    }
+    return Implementation::SCALAR;
+}
+
+inline bool MimeBoundaryFinder::isSupported(Implementation implementation) {
+    switch (implementation) {
+        case Implementation::SCALAR:
+            return true;
+        case Implementation::SSE2:
+#ifdef ACSDK_MIME_BOUNDARY_SSE2
+            return true;
+#else
+            return false;
+#endif
+        case Implementation::AVX2: {
+#ifdef ACSDK_MIME_BOUNDARY_AVX2
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+#else
+            return false;
+#endif
+        }
+        case Implementation::NEON:
+#ifdef ACSDK_MIME_BOUNDARY_NEON
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+inline size_t MimeBoundaryFinder::findScalar(const char* data, size_t size, size_t offset) const {
+    const size_t length = m_delimiter.size();
+    const char first = m_delimiter[0];
+    const char last = m_delimiter[length - 1];
+    while (offset + length <= size) {
+        auto candidate = static_cast<const char*>(memchr(data + offset, first, size - length + 1 - offset));
+        if (!candidate) {
+            return size;
+        }
+        offset = candidate - data;
+        if (data[offset + length - 1] == last && 0 == memcmp(data + offset, m_delimiter.data(), length)) {
+            return offset;
+        }
+        ++offset;
+    }
+    return size;
+}
+
+inline bool MimeBoundaryFinder::checkCandidates(
+    const char* data,
+    size_t blockStart,
+    uint64_t mask,
+    unsigned bitsPerByte,
+    size_t* position) const {
+    const size_t length = m_delimiter.size();
+    const uint64_t byteMask = (bitsPerByte >= 64) ? ~uint64_t(0) : ((uint64_t(1) << bitsPerByte) - 1);
+    while (mask) {
+        unsigned index = lowestBit(mask) / bitsPerByte;
+        size_t candidate = blockStart + index;
+        // The first and last bytes are known to match.
+        if (length <= 2 || 0 == memcmp(data + candidate + 1, m_delimiter.data() + 1, length - 2)) {
+            *position = candidate;
+            return true;
+        }
+        mask &= ~(byteMask << (index * bitsPerByte));
+    }
+    return false;
+}
+
+inline unsigned MimeBoundaryFinder::lowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+    unsigned index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+#ifdef ACSDK_MIME_BOUNDARY_SSE2
+inline size_t MimeBoundaryFinder::findSse2(const char* data, size_t size) const {
+    const size_t length = m_delimiter.size();
+    const __m128i first = _mm_set1_epi8(m_delimiter[0]);
+    const __m128i last = _mm_set1_epi8(m_delimiter[length - 1]);
+    size_t offset = 0;
+    // A block tests the positions offset .. offset + 15, reading up to offset + 15 + length - 1.
+    for (; offset + 16 + length - 1 <= size; offset += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset + length - 1));
+        __m128i matches = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last));
+        auto mask = static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(matches)));
+        size_t position = 0;
+        if (mask && checkCandidates(data, offset, mask, 1, &position)) {
+            return position;
+        }
+    }
+    return findScalar(data, size, offset);
+}
+#endif
+
+#ifdef ACSDK_MIME_BOUNDARY_AVX2
+inline __attribute__((target("avx2"))) size_t MimeBoundaryFinder::findAvx2(const char* data, size_t size) const {
+    const size_t length = m_delimiter.size();
+    const __m256i first = _mm256_set1_epi8(m_delimiter[0]);
+    const __m256i last = _mm256_set1_epi8(m_delimiter[length - 1]);
+    size_t offset = 0;
+    for (; offset + 32 + length - 1 <= size; offset += 32) {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset + length - 1));
+        __m256i matches = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last));
+        auto mask = static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(matches)));
+        size_t position = 0;
+        if (mask && checkCandidates(data, offset, mask, 1, &position)) {
+            return position;
+        }
+    }
+    return findScalar(data, size, offset);
+}
+#endif
+
+#ifdef ACSDK_MIME_BOUNDARY_NEON
+inline size_t MimeBoundaryFinder::findNeon(const char* data, size_t size) const {
+    const size_t length = m_delimiter.size();
+    const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(m_delimiter[0]));
+    const uint8x16_t last = vdupq_n_u8(static_cast<uint8_t>(m_delimiter[length - 1]));
+    size_t offset = 0;
+    for (; offset + 16 + length - 1 <= size; offset += 16) {
+        uint8x16_t blockFirst = vld1q_u8(reinterpret_cast<const uint8_t*>(data + offset));
+        uint8x16_t blockLast = vld1q_u8(reinterpret_cast<const uint8_t*>(data + offset + length - 1));
+        uint8x16_t matches = vandq_u8(vceqq_u8(blockFirst, first), vceqq_u8(blockLast, last));
+        // NEON has no movemask; narrowing each 16-bit lane by 4 leaves a 64-bit mask with 4 bits per position.
+        uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(matches), 4);
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+        size_t position = 0;
+        if (mask && checkCandidates(data, offset, mask, 4, &position)) {
+            return position;
+        }
+    }
+    return findScalar(data, size, offset);
+}
+#endif
+
+}  // namespace http2
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_HTTP2_MIMEBOUNDARYFINDER_H_
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_CURLEASYHANDLEPOOL_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_CURLEASYHANDLEPOOL_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+#include "CurlEasyHandleWrapper.h"
+#include "CurlShareHandleWrapper.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace libcurlUtils {
+
+/**
+ * A pool of idle @c CurlEasyHandleWrapper instances, by origin, so that one-shot requests reuse a handle whose
+ * connection to the server is still open rather than opening a new one.
+ *
+ * libcurl keeps the connections an easy handle has used open after a transfer, and @c curl_easy_reset() keeps them,
+ * so a handle taken from the pool for the same scheme, host and port can send its request on the existing connection.
+ * Handles ask for HTTP/2 over TLS, which sends each request as a new stream on the connection, falling back to
+ * HTTP/1.1 keep-alive where the server does not offer h2.  Handles are also attached to the process wide
+ * @c CurlShareHandleWrapper, so a handle which does need a new connection resumes a TLS session.
+ *
+ * Handles are returned to the pool when the last reference to them is released.  The most recently used handle is
+ * handed out first, as its connection is the least likely to have been closed by the server.
+ */
+class CurlEasyHandlePool : public std::enable_shared_from_this<CurlEasyHandlePool> {
+public:
+    /**
+     * Get the engine wide pool.
+     *
+     * @return The pool.
+     */
+    static std::shared_ptr<CurlEasyHandlePool> getInstance();
+
+    /**
+     * Create a pool.
+     *
+     * @param maxIdlePerOrigin The most idle handles kept for one origin.
+     * @param maxIdleTime How long an idle handle is kept.
+     * @return The new pool.
+     */
+    static std::shared_ptr<CurlEasyHandlePool> create(
+        size_t maxIdlePerOrigin = DEFAULT_MAX_IDLE_PER_ORIGIN,
+        std::chrono::seconds maxIdleTime = std::chrono::seconds(DEFAULT_MAX_IDLE_TIME_SECONDS));
+
+    /**
+     * Take a handle for a request to a URL.  The handle has been reset, so only the default options are set.
+     *
+     * @param url The URL the request will be sent to.
+     * @return A handle, which goes back to the pool when released, or nullptr if a new handle could not be created.
+     */
+    std::shared_ptr<CurlEasyHandleWrapper> acquire(const std::string& url);
+
+    /**
+     * Destroy all idle handles, closing their connections.
+     */
+    void clear();
+
+    /**
+     * Get the origin of a URL, which handles are pooled by.
+     *
+     * @param url The URL.
+     * @return The scheme, host and port of @c url in lower case.
+     */
+    static std::string getOrigin(const std::string& url);
+
+private:
+    /// An idle handle.
+    struct IdleHandle {
+        /// The handle.
+        std::unique_ptr<CurlEasyHandleWrapper> handle;
+
+        /// When the handle was returned to the pool.
+        std::chrono::steady_clock::time_point releaseTime;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param maxIdlePerOrigin The most idle handles kept for one origin.
+     * @param maxIdleTime How long an idle handle is kept.
+     */
+    CurlEasyHandlePool(size_t maxIdlePerOrigin, std::chrono::seconds maxIdleTime);
+
+    /**
+     * Take an idle handle for an origin, or create one.
+     *
+     * @param origin The origin.
+     * @return The handle, or nullptr if a new handle could not be created.
+     */
+    std::unique_ptr<CurlEasyHandleWrapper> takeHandle(const std::string& origin);
+
+    /**
+     * Return a handle to the pool.
+     *
+     * @param origin The origin the handle was used for.
+     * @param handle The handle.
+     */
+    void release(const std::string& origin, std::unique_ptr<CurlEasyHandleWrapper> handle);
+
+    /**
+     * Remove idle handles which have been idle too long.  @c m_mutex must be held.
+     *
+     * @param now The current time.
+     * @param[out] expired Receives the expired handles, to be destroyed once @c m_mutex is released.
+     */
+    void pruneLocked(
+        std::chrono::steady_clock::time_point now,
+        std::deque<std::unique_ptr<CurlEasyHandleWrapper>>* expired);
+
+    /**
+     * Prepare a handle for a request.
+     *
+     * @param handle The handle.
+     * @return Whether the operation was successful.
+     */
+    bool prepare(CurlEasyHandleWrapper* handle);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "CurlEasyHandlePool";
+
+    /// The default for the most idle handles kept for one origin.
+    static constexpr size_t DEFAULT_MAX_IDLE_PER_ORIGIN = 4;
+
+    /// The default for how long an idle handle is kept, in seconds.  Servers rarely keep an idle connection open
+    /// longer.
+    static constexpr int DEFAULT_MAX_IDLE_TIME_SECONDS = 120;
+
+    /// The most idle handles kept for one origin.
+    const size_t m_maxIdlePerOrigin;
+
+    /// How long an idle handle is kept.
+    const std::chrono::seconds m_maxIdleTime;
+
+    /// The TLS session and DNS caches which handles are attached to, or nullptr if there are none.
+    std::shared_ptr<CurlShareHandleWrapper> m_share;
+
+    /// Serializes access to @c m_idleHandles.
+    std::mutex m_mutex;
+
+    /// Idle handles by origin, the most recently used last.
+    std::unordered_map<std::string, std::deque<IdleHandle>> m_idleHandles;
+};
+
+inline std::shared_ptr<CurlEasyHandlePool> CurlEasyHandlePool::getInstance() {
+    static std::shared_ptr<CurlEasyHandlePool> instance(create());
+    return instance;
+}
+
+inline std::shared_ptr<CurlEasyHandlePool> CurlEasyHandlePool::create(
+    size_t maxIdlePerOrigin,
+    std::chrono::seconds maxIdleTime) {
+    return std::shared_ptr<CurlEasyHandlePool>(new CurlEasyHandlePool(maxIdlePerOrigin, maxIdleTime));
+}
+
+inline CurlEasyHandlePool::CurlEasyHandlePool(size_t maxIdlePerOrigin, std::chrono::seconds maxIdleTime) :
+        m_maxIdlePerOrigin{maxIdlePerOrigin},
+        m_maxIdleTime{maxIdleTime},
+        m_share{CurlShareHandleWrapper::getInstance()} {
+}
+
+inline std::shared_ptr<CurlEasyHandleWrapper> CurlEasyHandlePool::acquire(const std::string& url) {
+    auto origin = getOrigin(url);
+    auto handle = takeHandle(origin);
+    if (!handle) {
+        return nullptr;
+    }
+    std::weak_ptr<CurlEasyHandlePool> pool = shared_from_this();
+    // The share handle is captured so that it outlives a handle released after the pool has gone.
+    auto share = m_share;
+    return std::shared_ptr<CurlEasyHandleWrapper>(handle.release(), [pool, origin, share](CurlEasyHandleWrapper* raw) {
+        std::unique_ptr<CurlEasyHandleWrapper> released(raw);
+        auto strongPool = pool.lock();
+        if (strongPool) {
+            strongPool->release(origin, std::move(released));
+        }
+    });
+}
+
+inline void CurlEasyHandlePool::clear() {
+    std::unordered_map<std::string, std::deque<IdleHandle>> idleHandles;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        idleHandles.swap(m_idleHandles);
+    }
+}
+
+inline std::string CurlEasyHandlePool::getOrigin(const std::string& url) {
+    auto authority = url.find("://");
+    auto start = authority == std::string::npos ? 0 : authority + 3;
+    auto end = url.find_first_of("/?#", start);
+    auto origin = url.substr(0, end);
+    std::transform(origin.begin(), origin.end(), origin.begin(), ::tolower);
+    return origin;
+}
+
+inline std::unique_ptr<CurlEasyHandleWrapper> CurlEasyHandlePool::takeHandle(const std::string& origin) {
+    std::unique_ptr<CurlEasyHandleWrapper> handle;
+    std::deque<std::unique_ptr<CurlEasyHandleWrapper>> expired;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pruneLocked(std::chrono::steady_clock::now(), &expired);
+        auto it = m_idleHandles.find(origin);
+        if (it != m_idleHandles.end()) {
+            handle = std::move(it->second.back().handle);
+            it->second.pop_back();
+            if (it->second.empty()) {
+                m_idleHandles.erase(it);
+            }
+        }
+    }
+    if (handle) {
+        if (handle->reset() && prepare(handle.get())) {
+            return handle;
+        }
+        logger::acsdkWarn(logger::LogEntry(TAG, "takeHandle").d("reason", "resetFailed").m("creating a new handle"));
+    }
+    handle.reset(new CurlEasyHandleWrapper());
+    if (!handle->isValid() || !prepare(handle.get())) {
+        logger::acsdkError(logger::LogEntry(TAG, "takeHandleFailed").d("reason", "createHandleFailed"));
+        return nullptr;
+    }
+    return handle;
+}
+
+inline void CurlEasyHandlePool::release(const std::string& origin, std::unique_ptr<CurlEasyHandleWrapper> handle) {
+    // Declared before the lock, so that expired handles are destroyed after it is released.  Closing their
+    // connections may block briefly.
+    std::deque<std::unique_ptr<CurlEasyHandleWrapper>> expired;
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pruneLocked(now, &expired);
+    if (0 == m_maxIdlePerOrigin) {
+        expired.push_back(std::move(handle));
+        return;
+    }
+    auto& idle = m_idleHandles[origin];
+    if (idle.size() >= m_maxIdlePerOrigin) {
+        expired.push_back(std::move(idle.front().handle));
+        idle.pop_front();
+    }
+    idle.push_back(IdleHandle{std::move(handle), now});
+}
+
+inline void CurlEasyHandlePool::pruneLocked(
+    std::chrono::steady_clock::time_point now,
+    std::deque<std::unique_ptr<CurlEasyHandleWrapper>>* expired) {
+    auto it = m_idleHandles.begin();
+    while (it != m_idleHandles.end()) {
+        auto& idle = it->second;
+        while (!idle.empty() && now - idle.front().releaseTime > m_maxIdleTime) {
+            expired->push_back(std::move(idle.front().handle));
+            idle.pop_front();
+        }
+        if (idle.empty()) {
+            it = m_idleHandles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+inline bool CurlEasyHandlePool::prepare(CurlEasyHandleWrapper* handle) {
+    if (m_share) {
+        // Not fatal: the handle works without the caches.
+        m_share->attach(handle->getCurlHandle());
+    }
+    return handle->setopt(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+}
+
+}  // namespace libcurlUtils
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_CURLEASYHANDLEPOOL_H_
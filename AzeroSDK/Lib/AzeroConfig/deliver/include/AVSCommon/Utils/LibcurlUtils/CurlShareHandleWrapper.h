@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_CURLSHAREHANDLEWRAPPER_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_CURLSHAREHANDLEWRAPPER_H_
+
+#include <curl/curl.h>
+#include <memory>
+#include <mutex>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace libcurlUtils {
+
+/**
+ * This class wraps a @c libcurl @c share @c handle holding the TLS session and DNS caches, so that every curl handle
+ * attached to it can resume a TLS session negotiated by any other, and skip a DNS lookup another has done.
+ *
+ * The process wide instance from @c getInstance() outlives any one connection, so a connection created after a
+ * disconnect resumes the previous connection's session with an abbreviated handshake rather than a full one.
+ *
+ * Connections are not shared: HTTP/2 connections belong to the multi handle which multiplexes streams over them, and
+ * libcurl does not support handles on different threads using one connection cache at once.
+ *
+ * A share handle must outlive the easy handles attached to it, so holders of easy handles should keep a reference to
+ * the instance they attached them to, or @c detach() the handles when their transfers are done.
+ */
+class CurlShareHandleWrapper {
+public:
+    /**
+     * Get the process wide share handle.
+     *
+     * @return The share handle, or nullptr if it could not be created.
+     */
+    static std::shared_ptr<CurlShareHandleWrapper> getInstance();
+
+    /**
+     * Create a share handle.
+     *
+     * @return The new share handle, or nullptr if the operation fails.
+     */
+    static std::unique_ptr<CurlShareHandleWrapper> create();
+
+    /**
+     * Destructor.
+     */
+    ~CurlShareHandleWrapper();
+
+    /**
+     * Attach an easy handle, so that it uses the shared caches.  Must be called before the handle is used for a
+     * transfer.
+     *
+     * @param handle The easy handle.
+     * @return Whether the operation was successful.
+     */
+    bool attach(CURL* handle);
+
+    /**
+     * Detach an easy handle.  Must not be called while the handle is in a multi handle or in a transfer.
+     *
+     * @param handle The easy handle.
+     */
+    void detach(CURL* handle);
+
+    /**
+     * Get the underlying libcurl share handle.
+     *
+     * @return The underlying libcurl share handle.
+     */
+    CURLSH* getCurlHandle();
+
+private:
+    /**
+     * Constructor.
+     *
+     * @param handle The libcurl share handle to wrap.
+     */
+    CurlShareHandleWrapper(CURLSH* handle);
+
+    /**
+     * libcurl callback to lock shared data.
+     *
+     * @param handle The easy handle using the data.
+     * @param data The data to lock.
+     * @param access Whether the data will be read or written.
+     * @param userData The @c CurlShareHandleWrapper.
+     */
+    static void lockCallback(CURL* handle, curl_lock_data data, curl_lock_access access, void* userData);
+
+    /**
+     * libcurl callback to unlock shared data.
+     *
+     * @param handle The easy handle using the data.
+     * @param data The data to unlock.
+     * @param userData The @c CurlShareHandleWrapper.
+     */
+    static void unlockCallback(CURL* handle, curl_lock_data data, void* userData);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "CurlShareHandleWrapper";
+
+    /// The libcurl share handle.
+    CURLSH* m_handle;
+
+    /// One mutex for each kind of shared data.  libcurl may hold locks on different kinds at once.
+    std::mutex m_mutexes[CURL_LOCK_DATA_LAST];
+};
+
+inline std::shared_ptr<CurlShareHandleWrapper> CurlShareHandleWrapper::getInstance() {
+    static std::shared_ptr<CurlShareHandleWrapper> instance(create());
+    return instance;
+}
+
+inline std::unique_ptr<CurlShareHandleWrapper> CurlShareHandleWrapper::create() {
+    auto handle = curl_share_init();
+    if (!handle) {
+        logger::acsdkError(logger::LogEntry(TAG, "createFailed").d("reason", "curl_share_init failed"));
+        return nullptr;
+    }
+    std::unique_ptr<CurlShareHandleWrapper> wrapper(new CurlShareHandleWrapper(handle));
+    const curl_lock_data sharedData[] = {CURL_LOCK_DATA_SSL_SESSION, CURL_LOCK_DATA_DNS};
+    if (curl_share_setopt(handle, CURLSHOPT_USERDATA, wrapper.get()) != CURLSHE_OK ||
+        curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, lockCallback) != CURLSHE_OK ||
+        curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, unlockCallback) != CURLSHE_OK) {
+        logger::acsdkError(logger::LogEntry(TAG, "createFailed").d("reason", "setLockCallbacksFailed"));
+        return nullptr;
+    }
+    for (auto data : sharedData) {
+        auto result = curl_share_setopt(handle, CURLSHOPT_SHARE, data);
+        if (result != CURLSHE_OK) {
+            logger::acsdkError(logger::LogEntry(TAG, "createFailed")
+                                   .d("reason", "shareFailed")
+                                   .d("data", static_cast<int>(data))
+                                   .d("result", curl_share_strerror(result)));
+            return nullptr;
+        }
+    }
+    return wrapper;
+}
+
+inline CurlShareHandleWrapper::CurlShareHandleWrapper(CURLSH* handle) : m_handle{handle} {
+}
+
+inline CurlShareHandleWrapper::~CurlShareHandleWrapper() {
+    auto result = curl_share_cleanup(m_handle);
+    if (result != CURLSHE_OK) {
+        logger::acsdkError(
+            logger::LogEntry(TAG, "cleanupFailed").d("result", curl_share_strerror(result)).m("handles still attached"));
+    }
+}
+
+inline bool CurlShareHandleWrapper::attach(CURL* handle) {
+    auto result = curl_easy_setopt(handle, CURLOPT_SHARE, m_handle);
+    if (result != CURLE_OK) {
+        logger::acsdkError(logger::LogEntry(TAG, "attachFailed").d("result", curl_easy_strerror(result)));
+        return false;
+    }
+    return true;
+}
+
+inline void CurlShareHandleWrapper::detach(CURL* handle) {
+    curl_easy_setopt(handle, CURLOPT_SHARE, nullptr);
+}
+
+inline CURLSH* CurlShareHandleWrapper::getCurlHandle() {
+    return m_handle;
+}
+
+inline void CurlShareHandleWrapper::lockCallback(CURL*, curl_lock_data data, curl_lock_access, void* userData) {
+    static_cast<CurlShareHandleWrapper*>(userData)->m_mutexes[data].lock();
+}
+
+inline void CurlShareHandleWrapper::unlockCallback(CURL*, curl_lock_data data, void* userData) {
+    static_cast<CurlShareHandleWrapper*>(userData)->m_mutexes[data].unlock();
+}
+
+}  // namespace libcurlUtils
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_CURLSHAREHANDLEWRAPPER_H_
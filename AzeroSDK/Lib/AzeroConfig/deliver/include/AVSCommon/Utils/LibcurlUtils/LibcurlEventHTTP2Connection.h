@@ -0,0 +1,1063 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_LIBCURLEVENTHTTP2CONNECTION_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_LIBCURLEVENTHTTP2CONNECTION_H_
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#include <poll.h>
+#endif
+
+#include "AVSCommon/Utils/HTTP2/HTTP2CompressingRequestSource.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2CompressionNegotiationSink.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2ConnectionInterface.h"
+#include "AVSCommon/Utils/HTTP2/HTTP2RecordingResponseSink.h"
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+#include "CurlMultiHandleWrapper.h"
+#include "CurlShareHandleWrapper.h"
+#include "LibcurlHTTP2Request.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace libcurlUtils {
+
+/**
+ * An @c HTTP2ConnectionInterface which drives libcurl from socket readiness instead of polling it.
+ *
+ * The network thread sleeps in @c epoll_wait (or @c poll where epoll is not available) on the sockets which libcurl
+ * asks for through @c CURLMOPT_SOCKETFUNCTION, for no longer than the timeout libcurl sets through
+ * @c CURLMOPT_TIMERFUNCTION, and hands each ready socket to @c curl_multi_socket_action.  New requests, cancelled
+ * requests and @c wakeUp() signal an eventfd, so they are acted on at once rather than at the end of a poll timeout.
+ *
+ * Request sources and sinks which return a pause have no way to say when they can make progress again, so while any
+ * stream is paused it is retried every @c PAUSED_STREAM_RETRY_INTERVAL_MS.  Stalled streams are looked for every
+ * @c ACTIVE_HOUSEKEEPING_INTERVAL_MS while a non-intermittent stream is open, and every
+ * @c INTERMITTENT_HOUSEKEEPING_INTERVAL_MS while only intermittent streams (such as the downchannel) are.  With no
+ * streams open the thread sleeps until a request arrives.
+ *
+ * Each stream's handle is attached to the process wide @c CurlShareHandleWrapper while it is in the multi handle, so
+ * the connection which replaces this one after a disconnect resumes its TLS session instead of negotiating a new one.
+ *
+ * Responses are shown to the process wide @c HTTP2RequestCompressor, and once the server has said that it accepts
+ * gzip the body of each POST which is available at once, such as an event with its device context, is sent with
+ * @c Content-Encoding: gzip, unless the request sends @c HTTP2CompressingRequestSource::getNoCompressionHeaderLine().
+ * A compressed request which the server rejects with a client error is sent again uncompressed, on a new stream
+ * behind the same request handle, and compression is turned off.
+ *
+ * While the process wide @c DirectiveRecorder is recording, the directives and attachments in each response are
+ * recorded as they arrive, for replaying through the directive pipeline offline.
+ */
+class LibcurlEventHTTP2Connection
+        : public avsCommon::utils::http2::HTTP2ConnectionInterface
+        , public std::enable_shared_from_this<LibcurlEventHTTP2Connection> {
+public:
+    /**
+     * Create an @c LibcurlEventHTTP2Connection.
+     *
+     * @return The new @c LibcurlEventHTTP2Connection or nullptr if the operation fails.
+     */
+    static std::shared_ptr<LibcurlEventHTTP2Connection> create();
+
+    /**
+     * Destructor.
+     */
+    ~LibcurlEventHTTP2Connection();
+
+    /// @name HTTP2ConnectionInterface methods.
+    /// @{
+    std::shared_ptr<avsCommon::utils::http2::HTTP2RequestInterface> createAndSendRequest(
+        const http2::HTTP2RequestConfig& config) override;
+    void disconnect() override;
+    /// @}
+
+    /**
+     * Wake the network thread, which then retries paused streams and releases cancelled ones straight away.  A request
+     * source or sink which returned a pause may call this once it can make progress again.
+     */
+    void wakeUp();
+
+    /// How often paused streams are retried, in milliseconds.
+    static constexpr int PAUSED_STREAM_RETRY_INTERVAL_MS = 10;
+
+    /// How often streams are checked for stalls while a non-intermittent stream is open, in milliseconds.
+    static constexpr int ACTIVE_HOUSEKEEPING_INTERVAL_MS = 100;
+
+    /// How often streams are checked for stalls while only intermittent streams are open, in milliseconds.
+    static constexpr int INTERMITTENT_HOUSEKEEPING_INTERVAL_MS = 1000;
+
+    /// Deleted copy constructor.
+    LibcurlEventHTTP2Connection(const LibcurlEventHTTP2Connection&) = delete;
+
+    /// Deleted assignment operator.
+    LibcurlEventHTTP2Connection& operator=(const LibcurlEventHTTP2Connection&) = delete;
+
+private:
+    /**
+     * The request handle returned to callers.  Cancelling it wakes the network thread, so that the stream is released
+     * without waiting for the next housekeeping pass.  A request sent again uncompressed replaces the one it holds.
+     */
+    class RequestHandle : public avsCommon::utils::http2::HTTP2RequestInterface {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param connection The connection sending the request.
+         */
+        explicit RequestHandle(std::weak_ptr<LibcurlEventHTTP2Connection> connection);
+
+        /**
+         * Set the request being sent.
+         *
+         * @param request The request.
+         * @return Whether the request was set, which it is not once the handle has been cancelled.
+         */
+        bool setRequest(std::shared_ptr<LibcurlHTTP2Request> request);
+
+        /// @name HTTP2RequestInterface methods.
+        /// @{
+        bool cancel() override;
+        std::string getId() const override;
+        /// @}
+
+    private:
+        /// Serializes access to @c m_request and @c m_isCancelled.
+        mutable std::mutex m_mutex;
+
+        /// The request being sent.
+        std::shared_ptr<LibcurlHTTP2Request> m_request;
+
+        /// Whether the handle has been cancelled.
+        bool m_isCancelled;
+
+        /// The connection sending it.
+        std::weak_ptr<LibcurlEventHTTP2Connection> m_connection;
+    };
+
+    /**
+     * Constructor.
+     */
+    LibcurlEventHTTP2Connection();
+
+    /**
+     * Deleter for the @c std::shared_ptr returned by @c create().  The last reference may be released by a request
+     * callback on the network thread, which cannot join itself or free the connection from under its own loop, so
+     * there the connection is only stopped, and the network thread deletes it once its loop has exited.
+     *
+     * @param connection The connection to delete.
+     */
+    static void destroy(LibcurlEventHTTP2Connection* connection);
+
+    /**
+     * Create the epoll instance (or wake pipe) and the eventfd used to wake the network thread.
+     *
+     * @return Whether the operation was successful.
+     */
+    bool openPoller();
+
+    /**
+     * Close the descriptors opened by @c openPoller().
+     */
+    void closePoller();
+
+    /**
+     * Set up the multi-handle and install the socket and timer callbacks.
+     *
+     * @return Whether the operation was successful.
+     */
+    bool createMultiHandle();
+
+    /**
+     * Queue a stream to be added to the multi-handle by the network thread.
+     *
+     * @param stream Request object with a configured curl handle.
+     * @return Whether the stream was queued.
+     */
+    bool addStream(std::shared_ptr<LibcurlHTTP2Request> stream);
+
+    /**
+     * Main network loop.  Waits for socket, timer or wake events and passes them to @c curl_multi_socket_action.
+     */
+    void networkLoop();
+
+    /**
+     * Find out whether or not the network loop is stopping.
+     *
+     * @return Whether or not the network loop is stopping.
+     */
+    bool isStopping();
+
+    /**
+     * Add every queued request to the multi-handle.
+     */
+    void processQueuedRequests();
+
+    /**
+     * Sleep until a socket is ready, the timeout passes, or the network thread is woken, and act on ready sockets.
+     *
+     * @param timeoutMs How long to wait in milliseconds, or -1 to wait until something happens.
+     * @return Whether the network thread was woken.
+     */
+    bool waitForEvents(int timeoutMs);
+
+    /**
+     * Call @c curl_multi_socket_action.
+     *
+     * @param socket The ready socket, or @c CURL_SOCKET_TIMEOUT if libcurl's timer expired.
+     * @param eventMask The @c CURL_CSELECT_* bits for the socket.
+     */
+    void socketAction(curl_socket_t socket, int eventMask);
+
+    /**
+     * Start, change or stop watching a socket, as asked by libcurl.
+     *
+     * @param socket The socket.
+     * @param what The @c CURL_POLL_* value from libcurl.
+     */
+    void updateSocket(curl_socket_t socket, int what);
+
+    /**
+     * The @c CURLMOPT_SOCKETFUNCTION callback.
+     *
+     * @param easy The easy handle the socket belongs to.
+     * @param socket The socket.
+     * @param what The @c CURL_POLL_* value.
+     * @param userData The @c LibcurlEventHTTP2Connection.
+     * @param socketData Unused.
+     * @return 0.
+     */
+    static int socketCallback(CURL* easy, curl_socket_t socket, int what, void* userData, void* socketData);
+
+    /**
+     * The @c CURLMOPT_TIMERFUNCTION callback.
+     *
+     * @param multi The multi handle.
+     * @param timeoutMs When to call @c curl_multi_socket_action with @c CURL_SOCKET_TIMEOUT, or -1 to stop the timer.
+     * @param userData The @c LibcurlEventHTTP2Connection.
+     * @return 0.
+     */
+    static int timerCallback(CURLM* multi, long timeoutMs, void* userData);
+
+    /**
+     * Wrap the source and sink of a request, so that its body is compressed if the server accepts that, its response
+     * tells @c m_compressor whether it does, and it is sent again uncompressed if the server rejects it compressed.
+     *
+     * @param config The configuration of a request being sent.
+     * @param handle The handle returned for the request.
+     * @return The configuration to send the request with.
+     */
+    http2::HTTP2RequestConfig applyCompression(
+        const http2::HTTP2RequestConfig& config,
+        std::weak_ptr<RequestHandle> handle);
+
+    /**
+     * Send a request again, uncompressed, after the server rejected it compressed.
+     *
+     * @param config The configuration the request was originally sent with.
+     * @param source The uncompressed source for the request.
+     * @param handle The handle returned for the request, or nullptr if the caller has released it.
+     * @return Whether the request was handed on, which it is not if the handle has been cancelled.
+     */
+    bool retryUncompressed(
+        const http2::HTTP2RequestConfig& config,
+        std::shared_ptr<http2::HTTP2RequestSourceInterface> source,
+        std::shared_ptr<RequestHandle> handle);
+
+    /**
+     * Wrap the sink of a request, so that the directives in its response are recorded, if @c m_recorder is recording.
+     *
+     * @param config The configuration of a request being sent.
+     * @return The configuration to send the request with.
+     */
+    http2::HTTP2RequestConfig applyRecording(const http2::HTTP2RequestConfig& config);
+
+    /**
+     * Checks if any active streams have finished and reports the response code and completion status for them.
+     */
+    void cleanupFinishedStreams();
+
+    /**
+     * Checks for streams that have been cancelled, removes them, and reports CANCELLED completion status.
+     * Checks for streams that have not progressed within their timeout, removes them, and reports the response code
+     * (if any) and completion status (TIMEOUT).
+     */
+    void cleanupCancelledAndStalledStreams();
+
+    /**
+     * @return Whether any active stream is paused.
+     */
+    bool areStreamsPaused();
+
+    /**
+     * @return Whether any active stream does not expect intermittent transfers.
+     */
+    bool hasNonIntermittentStreams();
+
+    /**
+     * UnPause the paused streams.
+     */
+    void unPauseActiveStreams();
+
+    /** Release a stream.
+     *
+     * @param stream The stream to release.
+     * @return Whether the operation was successful.
+     */
+    bool releaseStream(LibcurlHTTP2Request& stream);
+
+    /**
+     * Cancel a stream and report CANCELLED completion status.
+     *
+     * @param stream The stream to cancel.
+     * @return Whether the operation was successful.
+     */
+    bool cancelStream(LibcurlHTTP2Request& stream);
+
+    /**
+     * Release any streams that are active or queued and report CANCELLED completion status.
+     */
+    void cancelAllStreams();
+
+    /**
+     * Get the number of milliseconds until a deadline, rounded up.
+     *
+     * @param now The current time.
+     * @param deadline The deadline.
+     * @return The number of milliseconds until @c deadline, or 0 if it has passed.
+     */
+    static int millisecondsUntil(
+        std::chrono::steady_clock::time_point now,
+        std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * Get the earlier of two @c waitForEvents() timeouts.
+     *
+     * @param timeoutMs A timeout in milliseconds, or -1 for none.
+     * @param otherMs Another timeout in milliseconds, or -1 for none.
+     * @return The earlier timeout.
+     */
+    static int earliest(int timeoutMs, int otherMs);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "LibcurlEventHTTP2Connection";
+
+    /// The most events taken from one @c epoll_wait call.
+    static constexpr int MAX_EVENTS = 16;
+
+    /// Main thread for this class.
+    std::thread m_networkThread;
+
+    /// The TLS session and DNS caches shared with other connections, or nullptr if there are none.  Declared before
+    /// @c m_multi so that it outlives the handles attached to it.
+    std::shared_ptr<CurlShareHandleWrapper> m_share;
+
+    /// Compresses request bodies once the server accepts them.
+    std::shared_ptr<http2::HTTP2RequestCompressor> m_compressor;
+
+    /// Records the directives in responses while it is recording.
+    std::shared_ptr<http2::DirectiveRecorder> m_recorder;
+
+    /// Represents a CURL multi handle.  Intended to only be accessed by the network loop thread.
+    std::unique_ptr<avsCommon::utils::libcurlUtils::CurlMultiHandleWrapper> m_multi;
+
+    /// Serializes concurrent access to the m_requestQueue and m_isStopping members.
+    std::mutex m_mutex;
+
+    /// The list of streams that either do not have HTTP response headers, or have outstanding response data.
+    /// Only accessed from the network loop thread.
+    std::map<CURL*, std::shared_ptr<LibcurlHTTP2Request>> m_activeStreams;
+
+    /// Queue of requests send. Serialized by @c m_mutex.
+    std::deque<std::shared_ptr<LibcurlHTTP2Request>> m_requestQueue;
+
+    /// Set to true when we want to exit the network loop.
+    bool m_isStopping;
+
+    /// Set when the last reference was released on the network thread, which then deletes the connection once its loop
+    /// has exited.  Only accessed from the network loop thread.
+    bool m_isDestroyPending;
+
+    /// The sockets libcurl asked us to watch, with their @c CURL_POLL_* values.  Only accessed from the network loop
+    /// thread.
+    std::unordered_map<curl_socket_t, int> m_sockets;
+
+    /// Whether libcurl's timer is running.  Only accessed from the network loop thread.
+    bool m_isCurlTimerArmed;
+
+    /// When libcurl's timer expires.  Only accessed from the network loop thread.
+    std::chrono::steady_clock::time_point m_curlDeadline;
+
+    /// Set when a wake-up has been signalled but not yet seen by the network thread, so repeated calls to
+    /// @c wakeUp() cost one write.
+    std::atomic_bool m_isWakePending;
+
+    /// The epoll instance.  Unused where epoll is not available.
+    int m_pollFd;
+
+    /// The descriptor the network thread waits on to be woken: an eventfd, or the read end of a pipe.
+    int m_wakeFd;
+
+    /// The descriptor written to wake the network thread: the eventfd, or the write end of the pipe.
+    int m_wakeWriteFd;
+
+#ifndef __linux__
+    /// The descriptors passed to @c poll, kept to reuse their storage.
+    std::vector<pollfd> m_pollFds;
+#endif
+};
+
+inline LibcurlEventHTTP2Connection::RequestHandle::RequestHandle(
+    std::weak_ptr<LibcurlEventHTTP2Connection> connection) :
+        m_isCancelled{false},
+        m_connection{std::move(connection)} {
+}
+
+inline bool LibcurlEventHTTP2Connection::RequestHandle::setRequest(std::shared_ptr<LibcurlHTTP2Request> request) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isCancelled) {
+        return false;
+    }
+    m_request = std::move(request);
+    return true;
+}
+
+inline bool LibcurlEventHTTP2Connection::RequestHandle::cancel() {
+    std::shared_ptr<LibcurlHTTP2Request> request;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isCancelled = true;
+        request = m_request;
+    }
+    auto result = request && request->cancel();
+    auto connection = m_connection.lock();
+    if (connection) {
+        connection->wakeUp();
+    }
+    return result;
+}
+
+inline std::string LibcurlEventHTTP2Connection::RequestHandle::getId() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_request ? m_request->getId() : "";
+}
+
+inline std::shared_ptr<LibcurlEventHTTP2Connection> LibcurlEventHTTP2Connection::create() {
+    std::shared_ptr<LibcurlEventHTTP2Connection> connection(new LibcurlEventHTTP2Connection(), destroy);
+    if (!connection->openPoller() || !connection->createMultiHandle()) {
+        return nullptr;
+    }
+    connection->m_networkThread = std::thread(&LibcurlEventHTTP2Connection::networkLoop, connection.get());
+    return connection;
+}
+
+inline LibcurlEventHTTP2Connection::LibcurlEventHTTP2Connection() :
+        m_share{CurlShareHandleWrapper::getInstance()},
+        m_compressor{http2::HTTP2RequestCompressor::getInstance()},
+        m_recorder{http2::DirectiveRecorder::getInstance()},
+        m_isStopping{false},
+        m_isDestroyPending{false},
+        m_isCurlTimerArmed{false},
+        m_isWakePending{false},
+        m_pollFd{-1},
+        m_wakeFd{-1},
+        m_wakeWriteFd{-1} {
+}
+
+inline LibcurlEventHTTP2Connection::~LibcurlEventHTTP2Connection() {
+    disconnect();
+    // Cleaning up the multi handle may still call socketCallback(), so do it while the poller is open.
+    m_multi.reset();
+    closePoller();
+}
+
+inline void LibcurlEventHTTP2Connection::destroy(LibcurlEventHTTP2Connection* connection) {
+    if (connection->m_networkThread.get_id() == std::this_thread::get_id()) {
+        {
+            std::lock_guard<std::mutex> lock(connection->m_mutex);
+            connection->m_isStopping = true;
+        }
+        connection->m_isDestroyPending = true;
+        return;
+    }
+    delete connection;
+}
+
+inline std::shared_ptr<avsCommon::utils::http2::HTTP2RequestInterface> LibcurlEventHTTP2Connection::
+    createAndSendRequest(const http2::HTTP2RequestConfig& config) {
+    auto handle = std::make_shared<RequestHandle>(shared_from_this());
+    auto request =
+        std::make_shared<LibcurlHTTP2Request>(applyRecording(applyCompression(config, handle)), config.getId());
+    handle->setRequest(request);
+    if (!addStream(request)) {
+        return nullptr;
+    }
+    return handle;
+}
+
+inline void LibcurlEventHTTP2Connection::disconnect() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    wakeUp();
+    if (m_networkThread.get_id() == std::this_thread::get_id()) {
+        // Called from a request callback.  The loop exits once the callback returns, and is joined by the destructor,
+        // so the multi handle and poller outlive it.
+        logger::acsdkWarn(logger::LogEntry(TAG, "disconnect").d("reason", "calledFromNetworkThread"));
+    } else if (m_networkThread.joinable()) {
+        m_networkThread.join();
+    }
+}
+
+inline void LibcurlEventHTTP2Connection::wakeUp() {
+    if (m_wakeWriteFd < 0 || m_isWakePending.exchange(true)) {
+        return;
+    }
+#ifdef __linux__
+    uint64_t count = 1;
+    if (::write(m_wakeWriteFd, &count, sizeof(count)) < 0) {
+#else
+    char count = 1;
+    if (::write(m_wakeWriteFd, &count, sizeof(count)) < 0 && EAGAIN != errno) {
+#endif
+        logger::acsdkError(logger::LogEntry(TAG, "wakeUpFailed").d("errno", errno));
+    }
+}
+
+inline bool LibcurlEventHTTP2Connection::openPoller() {
+#ifdef __linux__
+    m_pollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_pollFd < 0 || m_wakeFd < 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "openPollerFailed").d("reason", "createFailed").d("errno", errno));
+        return false;
+    }
+    m_wakeWriteFd = m_wakeFd;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = m_wakeFd;
+    if (epoll_ctl(m_pollFd, EPOLL_CTL_ADD, m_wakeFd, &event) < 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "openPollerFailed").d("reason", "epollCtlFailed").d("errno", errno));
+        return false;
+    }
+#else
+    int fds[2];
+    if (pipe(fds) < 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "openPollerFailed").d("reason", "pipeFailed").d("errno", errno));
+        return false;
+    }
+    m_wakeFd = fds[0];
+    m_wakeWriteFd = fds[1];
+    for (auto fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+#endif
+    return true;
+}
+
+inline void LibcurlEventHTTP2Connection::closePoller() {
+    if (m_wakeWriteFd >= 0 && m_wakeWriteFd != m_wakeFd) {
+        ::close(m_wakeWriteFd);
+    }
+    if (m_wakeFd >= 0) {
+        ::close(m_wakeFd);
+    }
+    if (m_pollFd >= 0) {
+        ::close(m_pollFd);
+    }
+    m_wakeWriteFd = -1;
+    m_wakeFd = -1;
+    m_pollFd = -1;
+}
+
+inline bool LibcurlEventHTTP2Connection::createMultiHandle() {
+    m_multi = CurlMultiHandleWrapper::create();
+    if (!m_multi) {
+        logger::acsdkError(logger::LogEntry(TAG, "createMultiHandleFailed").d("reason", "createFailed"));
+        return false;
+    }
+    auto multi = m_multi->getCurlHandle();
+    if (curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, socketCallback) != CURLM_OK ||
+        curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this) != CURLM_OK ||
+        curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, timerCallback) != CURLM_OK ||
+        curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this) != CURLM_OK) {
+        logger::acsdkError(logger::LogEntry(TAG, "createMultiHandleFailed").d("reason", "setCallbacksFailed"));
+        return false;
+    }
+    return true;
+}
+
+inline bool LibcurlEventHTTP2Connection::addStream(std::shared_ptr<LibcurlHTTP2Request> stream) {
+    if (!stream) {
+        logger::acsdkError(logger::LogEntry(TAG, "addStreamFailed").d("reason", "nullStream"));
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_isStopping) {
+            stream->reportCompletion(http2::HTTP2ResponseFinishedStatus::CANCELLED);
+            return false;
+        }
+        m_requestQueue.push_back(std::move(stream));
+    }
+    wakeUp();
+    return true;
+}
+
+inline void LibcurlEventHTTP2Connection::networkLoop() {
+    auto now = std::chrono::steady_clock::now();
+    auto nextHousekeeping = now;
+    auto nextUnpause = now;
+    bool woken = false;
+    while (!isStopping()) {
+        processQueuedRequests();
+
+        now = std::chrono::steady_clock::now();
+        if (m_isCurlTimerArmed && now >= m_curlDeadline) {
+            m_isCurlTimerArmed = false;
+            socketAction(CURL_SOCKET_TIMEOUT, 0);
+        }
+        cleanupFinishedStreams();
+
+        // A wake-up may be a cancellation, so look for cancelled streams straight away.
+        if (woken || now >= nextHousekeeping) {
+            cleanupCancelledAndStalledStreams();
+            int interval = INTERMITTENT_HOUSEKEEPING_INTERVAL_MS;
+            if (hasNonIntermittentStreams()) {
+                interval = ACTIVE_HOUSEKEEPING_INTERVAL_MS;
+            }
+            nextHousekeeping = now + std::chrono::milliseconds(interval);
+        }
+
+        bool paused = areStreamsPaused();
+        if (paused && (woken || now >= nextUnpause)) {
+            unPauseActiveStreams();
+            // Let libcurl run the unpaused transfers now rather than when its timer next fires.
+            socketAction(CURL_SOCKET_TIMEOUT, 0);
+            cleanupFinishedStreams();
+            int interval = PAUSED_STREAM_RETRY_INTERVAL_MS;
+            nextUnpause = now + std::chrono::milliseconds(interval);
+        }
+
+        if (isStopping()) {
+            break;
+        }
+
+        int timeoutMs = -1;
+        if (m_isCurlTimerArmed) {
+            timeoutMs = millisecondsUntil(now, m_curlDeadline);
+        }
+        if (!m_activeStreams.empty()) {
+            timeoutMs = earliest(timeoutMs, millisecondsUntil(now, nextHousekeeping));
+        }
+        if (paused) {
+            timeoutMs = earliest(timeoutMs, millisecondsUntil(now, nextUnpause));
+        }
+        woken = waitForEvents(timeoutMs);
+    }
+    cancelAllStreams();
+    if (m_isDestroyPending) {
+        // The last reference was released on this thread, by a callback in the loop or in cancelAllStreams().
+        m_networkThread.detach();
+        delete this;
+    }
+}
+
+inline bool LibcurlEventHTTP2Connection::isStopping() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_isStopping;
+}
+
+inline void LibcurlEventHTTP2Connection::processQueuedRequests() {
+    std::deque<std::shared_ptr<LibcurlHTTP2Request>> requests;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_requestQueue.empty()) {
+            return;
+        }
+        requests.swap(m_requestQueue);
+    }
+    for (auto& stream : requests) {
+        stream->setTimeOfLastTransfer();
+        auto handle = stream->getCurlHandle();
+        if (m_share) {
+            // Not fatal: the stream works without the caches, with a full handshake if it opens a connection.
+            m_share->attach(handle);
+        }
+        // Adding a handle sets libcurl's timer to expire at once, so the transfer starts on the next pass.
+        auto result = m_multi->addHandle(handle);
+        if (CURLM_OK != result) {
+            logger::acsdkError(logger::LogEntry(TAG, "processQueuedRequestsFailed")
+                                   .d("reason", "addHandleFailed")
+                                   .d("streamId", stream->getId())
+                                   .d("result", curl_multi_strerror(result)));
+            stream->reportCompletion(http2::HTTP2ResponseFinishedStatus::INTERNAL_ERROR);
+            continue;
+        }
+        m_activeStreams[handle] = stream;
+    }
+}
+
+inline http2::HTTP2RequestConfig LibcurlEventHTTP2Connection::applyCompression(
+    const http2::HTTP2RequestConfig& config,
+    std::weak_ptr<RequestHandle> handle) {
+    http2::HTTP2RequestConfig compressedConfig(config);
+    std::shared_ptr<http2::HTTP2CompressingRequestSource> compressingSource;
+    auto source = config.getSource();
+    if (source && http2::HTTP2RequestType::POST == config.getRequestType()) {
+        compressingSource = std::make_shared<http2::HTTP2CompressingRequestSource>(source, m_compressor);
+        compressedConfig.setRequestSource(compressingSource);
+    }
+    auto sink = config.getSink();
+    if (sink) {
+        std::weak_ptr<LibcurlEventHTTP2Connection> connection = shared_from_this();
+        auto retry = [connection, config, handle](std::shared_ptr<http2::HTTP2RequestSourceInterface> source) {
+            auto self = connection.lock();
+            return self && self->retryUncompressed(config, std::move(source), handle.lock());
+        };
+        compressedConfig.setResponseSink(
+            std::make_shared<http2::HTTP2CompressionNegotiationSink>(sink, m_compressor, compressingSource, retry));
+    }
+    return compressedConfig;
+}
+
+inline bool LibcurlEventHTTP2Connection::retryUncompressed(
+    const http2::HTTP2RequestConfig& config,
+    std::shared_ptr<http2::HTTP2RequestSourceInterface> source,
+    std::shared_ptr<RequestHandle> handle) {
+    http2::HTTP2RequestConfig retryConfig(config);
+    retryConfig.setRequestSource(std::move(source));
+    // Not compressed again, and not sent again a second time.
+    retryConfig.setResponseSink(
+        std::make_shared<http2::HTTP2CompressionNegotiationSink>(config.getSink(), m_compressor));
+    auto request = std::make_shared<LibcurlHTTP2Request>(applyRecording(retryConfig), config.getId());
+    if (handle && !handle->setRequest(request)) {
+        return false;
+    }
+    logger::acsdkInfo(logger::LogEntry(TAG, "retryUncompressed").d("streamId", request->getId()));
+    // If the stream cannot be added it reports its own completion.
+    addStream(request);
+    return true;
+}
+
+inline http2::HTTP2RequestConfig LibcurlEventHTTP2Connection::applyRecording(const http2::HTTP2RequestConfig& config) {
+    auto sink = config.getSink();
+    if (!sink || !m_recorder->isRecording()) {
+        return config;
+    }
+    http2::HTTP2RequestConfig recordingConfig(config);
+    recordingConfig.setResponseSink(std::make_shared<http2::HTTP2RecordingResponseSink>(sink, m_recorder));
+    return recordingConfig;
+}
+
+inline bool LibcurlEventHTTP2Connection::waitForEvents(int timeoutMs) {
+    bool woken = false;
+#ifdef __linux__
+    epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(m_pollFd, events, MAX_EVENTS, timeoutMs);
+    if (count < 0) {
+        if (EINTR != errno) {
+            logger::acsdkError(logger::LogEntry(TAG, "waitForEventsFailed").d("errno", errno));
+        }
+        return false;
+    }
+    for (int index = 0; index < count; ++index) {
+        int fd = events[index].data.fd;
+        if (fd == m_wakeFd) {
+            woken = true;
+            continue;
+        }
+        int eventMask = 0;
+        if (events[index].events & EPOLLIN) {
+            eventMask |= CURL_CSELECT_IN;
+        }
+        if (events[index].events & EPOLLOUT) {
+            eventMask |= CURL_CSELECT_OUT;
+        }
+        if (events[index].events & (EPOLLERR | EPOLLHUP)) {
+            eventMask |= CURL_CSELECT_ERR;
+        }
+        socketAction(fd, eventMask);
+    }
+#else
+    m_pollFds.clear();
+    m_pollFds.push_back({m_wakeFd, POLLIN, 0});
+    for (const auto& entry : m_sockets) {
+        short events = ((entry.second & CURL_POLL_IN) ? POLLIN : 0) | ((entry.second & CURL_POLL_OUT) ? POLLOUT : 0);
+        m_pollFds.push_back({entry.first, events, 0});
+    }
+    int count = poll(m_pollFds.data(), m_pollFds.size(), timeoutMs);
+    if (count < 0) {
+        if (EINTR != errno) {
+            logger::acsdkError(logger::LogEntry(TAG, "waitForEventsFailed").d("errno", errno));
+        }
+        return false;
+    }
+    woken = (m_pollFds[0].revents & POLLIN) != 0;
+    for (size_t index = 1; index < m_pollFds.size() && count > 0; ++index) {
+        auto revents = m_pollFds[index].revents;
+        if (0 == revents) {
+            continue;
+        }
+        int eventMask = 0;
+        if (revents & POLLIN) {
+            eventMask |= CURL_CSELECT_IN;
+        }
+        if (revents & POLLOUT) {
+            eventMask |= CURL_CSELECT_OUT;
+        }
+        if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            eventMask |= CURL_CSELECT_ERR;
+        }
+        socketAction(m_pollFds[index].fd, eventMask);
+    }
+#endif
+    if (woken) {
+        // Clear the flag before draining, so that a wake-up racing with the drain signals again.
+        m_isWakePending = false;
+#ifdef __linux__
+        uint64_t value = 0;
+        while (::read(m_wakeFd, &value, sizeof(value)) > 0) {
+        }
+#else
+        char buffer[64];
+        while (::read(m_wakeFd, buffer, sizeof(buffer)) > 0) {
+        }
+#endif
+    }
+    return woken;
+}
+
+inline void LibcurlEventHTTP2Connection::socketAction(curl_socket_t socket, int eventMask) {
+    int runningHandles = 0;
+    auto result = curl_multi_socket_action(m_multi->getCurlHandle(), socket, eventMask, &runningHandles);
+    if (CURLM_OK != result) {
+        logger::acsdkError(logger::LogEntry(TAG, "socketActionFailed")
+                               .d("socket", socket)
+                               .d("result", curl_multi_strerror(result)));
+    }
+}
+
+inline void LibcurlEventHTTP2Connection::updateSocket(curl_socket_t socket, int what) {
+    if (CURL_POLL_REMOVE == what) {
+        m_sockets.erase(socket);
+#ifdef __linux__
+        // Fails harmlessly if libcurl has already closed the socket, which removes it from the epoll set.
+        epoll_ctl(m_pollFd, EPOLL_CTL_DEL, socket, nullptr);
+#endif
+        return;
+    }
+#ifdef __linux__
+    epoll_event event{};
+    event.events = ((what & CURL_POLL_IN) ? EPOLLIN : 0) | ((what & CURL_POLL_OUT) ? EPOLLOUT : 0);
+    event.data.fd = socket;
+    int operation = m_sockets.count(socket) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (epoll_ctl(m_pollFd, operation, socket, &event) < 0) {
+        // A socket number may be reused after a close, so our bookkeeping can disagree with the epoll set.
+        operation = (EEXIST == errno) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        if (epoll_ctl(m_pollFd, operation, socket, &event) < 0) {
+            logger::acsdkError(logger::LogEntry(TAG, "updateSocketFailed").d("socket", socket).d("errno", errno));
+            return;
+        }
+    }
+#endif
+    m_sockets[socket] = what;
+}
+
+inline int LibcurlEventHTTP2Connection::socketCallback(
+    CURL* easy,
+    curl_socket_t socket,
+    int what,
+    void* userData,
+    void* socketData) {
+    static_cast<LibcurlEventHTTP2Connection*>(userData)->updateSocket(socket, what);
+    return 0;
+}
+
+inline int LibcurlEventHTTP2Connection::timerCallback(CURLM* multi, long timeoutMs, void* userData) {
+    auto connection = static_cast<LibcurlEventHTTP2Connection*>(userData);
+    if (timeoutMs < 0) {
+        connection->m_isCurlTimerArmed = false;
+    } else {
+        connection->m_isCurlTimerArmed = true;
+        connection->m_curlDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    }
+    return 0;
+}
+
+inline void LibcurlEventHTTP2Connection::cleanupFinishedStreams() {
+    CURLMsg* message = nullptr;
+    do {
+        int messagesLeft = 0;
+        message = m_multi->infoRead(&messagesLeft);
+        if (message && CURLMSG_DONE == message->msg) {
+            auto it = m_activeStreams.find(message->easy_handle);
+            if (it == m_activeStreams.end()) {
+                logger::acsdkError(logger::LogEntry(TAG, "cleanupFinishedStreamsFailed").d("reason", "streamNotFound"));
+                m_multi->removeHandle(message->easy_handle);
+                continue;
+            }
+            auto stream = it->second;
+            stream->reportResponseCode();
+            auto result = message->data.result;
+            releaseStream(*stream);
+            if (CURLE_OK == result) {
+                stream->reportCompletion(http2::HTTP2ResponseFinishedStatus::COMPLETE);
+            } else {
+                logger::acsdkDebug0(logger::LogEntry(TAG, "streamFinishedWithError")
+                                        .d("streamId", stream->getId())
+                                        .d("result", curl_easy_strerror(result)));
+                stream->reportCompletion(
+                    CURLE_OPERATION_TIMEDOUT == result ? http2::HTTP2ResponseFinishedStatus::TIMEOUT
+                                                       : http2::HTTP2ResponseFinishedStatus::INTERNAL_ERROR);
+            }
+        }
+    } while (message);
+}
+
+inline void LibcurlEventHTTP2Connection::cleanupCancelledAndStalledStreams() {
+    auto it = m_activeStreams.begin();
+    while (it != m_activeStreams.end()) {
+        // Advance first; releasing the stream erases its entry.
+        auto stream = (it++)->second;
+        if (stream->isCancelled()) {
+            cancelStream(*stream);
+        } else if (stream->hasProgressTimedOut()) {
+            logger::acsdkInfo(logger::LogEntry(TAG, "streamProgressTimedOut").d("streamId", stream->getId()));
+            stream->reportResponseCode();
+            releaseStream(*stream);
+            stream->reportCompletion(http2::HTTP2ResponseFinishedStatus::TIMEOUT);
+        }
+    }
+}
+
+inline bool LibcurlEventHTTP2Connection::areStreamsPaused() {
+    for (const auto& entry : m_activeStreams) {
+        if (entry.second->isPaused()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool LibcurlEventHTTP2Connection::hasNonIntermittentStreams() {
+    for (const auto& entry : m_activeStreams) {
+        if (!entry.second->isIntermittentTransferExpected()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void LibcurlEventHTTP2Connection::unPauseActiveStreams() {
+    for (auto& entry : m_activeStreams) {
+        if (entry.second->isPaused()) {
+            entry.second->unPause();
+        }
+    }
+}
+
+inline bool LibcurlEventHTTP2Connection::releaseStream(LibcurlHTTP2Request& stream) {
+    auto handle = stream.getCurlHandle();
+    auto result = m_multi->removeHandle(handle);
+    m_activeStreams.erase(handle);
+    if (m_share) {
+        // The request may outlive this connection, and with it the last reference to the share handle.
+        m_share->detach(handle);
+    }
+    if (CURLM_OK != result) {
+        logger::acsdkError(logger::LogEntry(TAG, "releaseStreamFailed")
+                               .d("reason", "removeHandleFailed")
+                               .d("streamId", stream.getId())
+                               .d("result", curl_multi_strerror(result)));
+        return false;
+    }
+    return true;
+}
+
+inline bool LibcurlEventHTTP2Connection::cancelStream(LibcurlHTTP2Request& stream) {
+    logger::acsdkInfo(logger::LogEntry(TAG, "cancelStream").d("streamId", stream.getId()));
+    auto result = releaseStream(stream);
+    stream.reportCompletion(http2::HTTP2ResponseFinishedStatus::CANCELLED);
+    return result;
+}
+
+inline void LibcurlEventHTTP2Connection::cancelAllStreams() {
+    while (!m_activeStreams.empty()) {
+        auto stream = m_activeStreams.begin()->second;
+        cancelStream(*stream);
+    }
+    std::deque<std::shared_ptr<LibcurlHTTP2Request>> requests;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        requests.swap(m_requestQueue);
+    }
+    for (auto& stream : requests) {
+        stream->reportCompletion(http2::HTTP2ResponseFinishedStatus::CANCELLED);
+    }
+}
+
+inline int LibcurlEventHTTP2Connection::millisecondsUntil(
+    std::chrono::steady_clock::time_point now,
+    std::chrono::steady_clock::time_point deadline) {
+    if (deadline <= now) {
+        return 0;
+    }
+    auto remaining = deadline - now;
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(remaining);
+    if (milliseconds < remaining) {
+        milliseconds += std::chrono::milliseconds(1);
+    }
+    if (milliseconds.count() > std::numeric_limits<int>::max()) {
+        return std::numeric_limits<int>::max();
+    }
+    return static_cast<int>(milliseconds.count());
+}
+
+inline int LibcurlEventHTTP2Connection::earliest(int timeoutMs, int otherMs) {
+    if (timeoutMs < 0) {
+        return otherMs;
+    }
+    if (otherMs < 0) {
+        return timeoutMs;
+    }
+    return timeoutMs < otherMs ? timeoutMs : otherMs;
+}
+
+}  // namespace libcurlUtils
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_LIBCURLEVENTHTTP2CONNECTION_H_
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_LIBCURLEVENTHTTP2CONNECTIONFACTORY_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_LIBCURLEVENTHTTP2CONNECTIONFACTORY_H_
+
+#include <AVSCommon/Utils/HTTP2/HTTP2ConnectionFactoryInterface.h>
+
+#include "LibcurlEventHTTP2Connection.h"
+#include "LibcurlHTTP2Connection.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace libcurlUtils {
+
+/**
+ * Creates @c LibcurlEventHTTP2Connection instances, falling back to @c LibcurlHTTP2Connection if the event loop cannot
+ * be set up.
+ *
+ * The engine's transport is built inside the prebuilt @c AlexaEngineService, which creates its own connection factory,
+ * so this factory is not used there.  It is installed by passing it to an
+ * @c HTTP2TransportFactory, as @c AVSTransportBenchmark does; @c AVSEventConnectionCheck checks the connections it
+ * makes against @c AVSLoopbackServer.
+ */
+class LibcurlEventHTTP2ConnectionFactory : public avsCommon::utils::http2::HTTP2ConnectionFactoryInterface {
+public:
+    /// @name HTTP2ConnectionFactoryInterface methods.
+    /// @{
+    std::shared_ptr<avsCommon::utils::http2::HTTP2ConnectionInterface> createHTTP2Connection() override;
+    /// @}
+};
+
+inline std::shared_ptr<avsCommon::utils::http2::HTTP2ConnectionInterface> LibcurlEventHTTP2ConnectionFactory::
+    createHTTP2Connection() {
+    auto connection = LibcurlEventHTTP2Connection::create();
+    if (connection) {
+        return connection;
+    }
+    logger::acsdkWarn(logger::LogEntry("LibcurlEventHTTP2ConnectionFactory", "createHTTP2Connection")
+                          .d("reason", "eventConnectionFailed")
+                          .m("falling back to LibcurlHTTP2Connection"));
+    return LibcurlHTTP2Connection::create();
+}
+
+}  // namespace libcurlUtils
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_LIBCURLEVENTHTTP2CONNECTIONFACTORY_H_
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_POOLEDHTTPCLIENT_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_POOLEDHTTPCLIENT_H_
+
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+#include "CurlEasyHandlePool.h"
+#include "HttpDeleteInterface.h"
+#include "HttpGetInterface.h"
+#include "HttpPostInterface.h"
+#include "HttpPutInterface.h"
+#include "HttpResponseCodes.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace libcurlUtils {
+
+/**
+ * LIBCURL based implementation of the one-shot HTTP interfaces which takes a handle from a @c CurlEasyHandlePool for
+ * each request, so that requests to the same server share its connection instead of each opening its own.
+ *
+ * Unlike @c HttpPost, which holds one handle and serializes its callers, requests from different threads run at once
+ * on different handles.  A single instance can be passed wherever an @c HttpGetInterface, @c HttpPostInterface,
+ * @c HttpPutInterface or @c HttpDeleteInterface is expected.
+ */
+class PooledHttpClient
+        : public HttpGetInterface
+        , public HttpPostInterface
+        , public HttpPutInterface
+        , public HttpDeleteInterface {
+public:
+    /**
+     * Create a client.
+     *
+     * @param pool The pool to take handles from.  If nullptr, the engine wide pool.
+     * @return The new client, or nullptr if the operation fails.
+     */
+    static std::shared_ptr<PooledHttpClient> create(std::shared_ptr<CurlEasyHandlePool> pool = nullptr);
+
+    /// @name HttpGetInterface methods.
+    /// @{
+    HTTPResponse doGet(const std::string& url, const std::vector<std::string>& headers) override;
+    HTTPResponse doGet(const std::string& url, const std::vector<std::string>& headers, std::chrono::seconds timeout)
+        override;
+    /// @}
+
+    /// @name HttpPostInterface methods.
+    /// @{
+    long doPost(const std::string& url, const std::string& data, std::chrono::seconds timeout, std::string& body)
+        override;
+    HTTPResponse doPost(
+        const std::string& url,
+        const std::vector<std::string> headerLines,
+        const std::vector<std::pair<std::string, std::string>>& data,
+        std::chrono::seconds timeout) override;
+    HTTPResponse doPost(
+        const std::string& url,
+        const std::vector<std::string> headerLines,
+        const std::string& data,
+        std::chrono::seconds timeout) override;
+    /// @}
+
+    /// @name HttpPutInterface methods.
+    /// @{
+    HTTPResponse doPut(const std::string& url, const std::vector<std::string>& headers, const std::string& data)
+        override;
+    /// @}
+
+    /// @name HttpDeleteInterface methods.
+    /// @{
+    HTTPResponse doDelete(const std::string& url, const std::vector<std::string>& headers) override;
+    /// @}
+
+private:
+    /**
+     * Constructor.
+     *
+     * @param pool The pool to take handles from.
+     */
+    PooledHttpClient(std::shared_ptr<CurlEasyHandlePool> pool);
+
+    /**
+     * Perform a request.
+     *
+     * @param type The request method.
+     * @param url The URL to send the request to.
+     * @param headers Header lines to add to the request.
+     * @param data The request body, for POST and PUT.
+     * @param timeout The maximum amount of time to wait for the request to complete, or zero for no limit.
+     * @return The response, with code @c HTTP_RESPONSE_CODE_UNDEFINED if no response was received.
+     */
+    HTTPResponse perform(
+        CurlEasyHandleWrapper::TransferType type,
+        const std::string& url,
+        const std::vector<std::string>& headers,
+        const std::string& data,
+        std::chrono::seconds timeout);
+
+    /**
+     * URL encode and join form fields.
+     *
+     * @param data Key, value pairs to encode.
+     * @return The encoded form.
+     */
+    static std::string buildPostData(const std::vector<std::pair<std::string, std::string>>& data);
+
+    /**
+     * URL encode a string, as @c curl_easy_escape does, without needing a handle.
+     *
+     * @param in The string.
+     * @param[out] out Receives the encoded string.
+     */
+    static void urlEncode(const std::string& in, std::string* out);
+
+    /**
+     * Callback from libcurl with response body data.
+     *
+     * @param ptr The data.
+     * @param size The size of each block.
+     * @param nmemb The number of blocks.
+     * @param userdata The @c std::string to append the data to.
+     * @return The number of bytes consumed.
+     */
+    static size_t writeCallback(char* ptr, size_t size, size_t nmemb, void* userdata);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "PooledHttpClient";
+
+    /// The pool to take handles from.
+    std::shared_ptr<CurlEasyHandlePool> m_pool;
+};
+
+inline std::shared_ptr<PooledHttpClient> PooledHttpClient::create(std::shared_ptr<CurlEasyHandlePool> pool) {
+    if (!pool) {
+        pool = CurlEasyHandlePool::getInstance();
+    }
+    return std::shared_ptr<PooledHttpClient>(new PooledHttpClient(std::move(pool)));
+}
+
+inline PooledHttpClient::PooledHttpClient(std::shared_ptr<CurlEasyHandlePool> pool) : m_pool{std::move(pool)} {
+}
+
+inline HTTPResponse PooledHttpClient::doGet(const std::string& url, const std::vector<std::string>& headers) {
+    return perform(CurlEasyHandleWrapper::TransferType::kGET, url, headers, "", std::chrono::seconds::zero());
+}
+
+inline HTTPResponse PooledHttpClient::doGet(
+    const std::string& url,
+    const std::vector<std::string>& headers,
+    std::chrono::seconds timeout) {
+    return perform(CurlEasyHandleWrapper::TransferType::kGET, url, headers, "", timeout);
+}
+
+inline long PooledHttpClient::doPost(
+    const std::string& url,
+    const std::string& data,
+    std::chrono::seconds timeout,
+    std::string& body) {
+    auto response = perform(CurlEasyHandleWrapper::TransferType::kPOST, url, {}, data, timeout);
+    body = std::move(response.body);
+    return response.code;
+}
+
+inline HTTPResponse PooledHttpClient::doPost(
+    const std::string& url,
+    const std::vector<std::string> headerLines,
+    const std::vector<std::pair<std::string, std::string>>& data,
+    std::chrono::seconds timeout) {
+    return perform(CurlEasyHandleWrapper::TransferType::kPOST, url, headerLines, buildPostData(data), timeout);
+}
+
+inline HTTPResponse PooledHttpClient::doPost(
+    const std::string& url,
+    const std::vector<std::string> headerLines,
+    const std::string& data,
+    std::chrono::seconds timeout) {
+    return perform(CurlEasyHandleWrapper::TransferType::kPOST, url, headerLines, data, timeout);
+}
+
+inline HTTPResponse PooledHttpClient::doPut(
+    const std::string& url,
+    const std::vector<std::string>& headers,
+    const std::string& data) {
+    return perform(CurlEasyHandleWrapper::TransferType::kPUT, url, headers, data, std::chrono::seconds::zero());
+}
+
+inline HTTPResponse PooledHttpClient::doDelete(const std::string& url, const std::vector<std::string>& headers) {
+    return perform(CurlEasyHandleWrapper::TransferType::kDELETE, url, headers, "", std::chrono::seconds::zero());
+}
+
+inline HTTPResponse PooledHttpClient::perform(
+    CurlEasyHandleWrapper::TransferType type,
+    const std::string& url,
+    const std::vector<std::string>& headers,
+    const std::string& data,
+    std::chrono::seconds timeout) {
+    HTTPResponse response;
+    auto handle = m_pool->acquire(url);
+    if (!handle) {
+        logger::acsdkError(logger::LogEntry(TAG, "performFailed").d("reason", "acquireFailed"));
+        return response;
+    }
+    if (!handle->setURL(url) || !handle->setTransferType(type) ||
+        !handle->setWriteCallback(writeCallback, &response.body)) {
+        logger::acsdkError(logger::LogEntry(TAG, "performFailed").d("reason", "setOptionsFailed"));
+        return response;
+    }
+    for (const auto& header : headers) {
+        if (!handle->addHTTPHeader(header)) {
+            logger::acsdkError(logger::LogEntry(TAG, "performFailed").d("reason", "addHTTPHeaderFailed"));
+            return response;
+        }
+    }
+    if ((CurlEasyHandleWrapper::TransferType::kPOST == type || CurlEasyHandleWrapper::TransferType::kPUT == type) &&
+        !handle->setPostData(data)) {
+        logger::acsdkError(logger::LogEntry(TAG, "performFailed").d("reason", "setPostDataFailed"));
+        return response;
+    }
+    if (timeout > std::chrono::seconds::zero() && !handle->setTransferTimeout(static_cast<long>(timeout.count()))) {
+        logger::acsdkError(logger::LogEntry(TAG, "performFailed").d("reason", "setTransferTimeoutFailed"));
+        return response;
+    }
+    auto result = handle->perform();
+    if (result != CURLE_OK) {
+        logger::acsdkError(logger::LogEntry(TAG, "performFailed")
+                               .d("reason", "performFailed")
+                               .d("result", curl_easy_strerror(result)));
+        response.body.clear();
+        return response;
+    }
+    response.code = handle->getHTTPResponseCode();
+    return response;
+}
+
+inline std::string PooledHttpClient::buildPostData(const std::vector<std::pair<std::string, std::string>>& data) {
+    std::string form;
+    for (const auto& field : data) {
+        if (!form.empty()) {
+            form += '&';
+        }
+        urlEncode(field.first, &form);
+        form += '=';
+        urlEncode(field.second, &form);
+    }
+    return form;
+}
+
+inline void PooledHttpClient::urlEncode(const std::string& in, std::string* out) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+    for (unsigned char c : in) {
+        if (isalnum(c) || '-' == c || '.' == c || '_' == c || '~' == c) {
+            *out += static_cast<char>(c);
+        } else {
+            *out += '%';
+            *out += hexDigits[c >> 4];
+            *out += hexDigits[c & 0xf];
+        }
+    }
+}
+
+inline size_t PooledHttpClient::writeCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto count = size * nmemb;
+    static_cast<std::string*>(userdata)->append(ptr, count);
+    return count;
+}
+
+}  // namespace libcurlUtils
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LIBCURLUTILS_POOLEDHTTPCLIENT_H_
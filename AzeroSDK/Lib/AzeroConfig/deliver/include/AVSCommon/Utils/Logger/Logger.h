@@ -113,7 +113,8 @@ namespace logger {
  * logs of severity @c DEBUG0 and above are included in @c DEBUG builds, and logs of severity
  * @c INFO and above are in included in non @c DEBUG builds.  These macros also perform an in-line @c logLevel
  * check before evaluating the @c LX() expression.  That allows much of the CPU overhead of compiled-in log
- * lines to be selectively bypassed at run-time if the @c Logger's log level is set to not emit them.
+ * lines to be selectively bypassed at run-time if the @c Logger's log level is set to not emit them.  Defining
+ * @c ACSDK_MIN_LOG_LEVEL raises the compiled-in minimum for a module, so that lower levels cost nothing at all.
  *
  * Logging may also be configured on a per-module basis.  Modules are defined by defining
  * @c ACSDK_LOG_MODULE to a common name for all source files in a module.  This name specifies the name
@@ -343,6 +344,46 @@ inline Logger& ACSDK_GET_LOGGER_FUNCTION() {
 
 #endif
 
+/**
+ * Numeric values of @c Level for use in preprocessor conditionals.  These must match the order of @c Level.
+ */
+#define ACSDK_LOG_LEVEL_DEBUG9 0
+#define ACSDK_LOG_LEVEL_DEBUG8 1
+#define ACSDK_LOG_LEVEL_DEBUG7 2
+#define ACSDK_LOG_LEVEL_DEBUG6 3
+#define ACSDK_LOG_LEVEL_DEBUG5 4
+#define ACSDK_LOG_LEVEL_DEBUG4 5
+#define ACSDK_LOG_LEVEL_DEBUG3 6
+#define ACSDK_LOG_LEVEL_DEBUG2 7
+#define ACSDK_LOG_LEVEL_DEBUG1 8
+#define ACSDK_LOG_LEVEL_DEBUG0 9
+#define ACSDK_LOG_LEVEL_INFO 10
+#define ACSDK_LOG_LEVEL_WARN 11
+#define ACSDK_LOG_LEVEL_ERROR 12
+#define ACSDK_LOG_LEVEL_CRITICAL 13
+#define ACSDK_LOG_LEVEL_NONE 14
+
+static_assert(
+    static_cast<int>(alexaClientSDK::avsCommon::utils::logger::Level::NONE) == ACSDK_LOG_LEVEL_NONE,
+    "ACSDK_LOG_LEVEL_* out of sync with Level");
+
+/**
+ * The lowest severity level compiled in to this translation unit.  The @c ACSDK_<LEVEL> macros for lower levels
+ * expand to nothing, so neither the @c LogEntry nor its arguments are evaluated.  Define it per module to trim
+ * logging from release builds, e.g.:
+ *
+ *     add_definitions("-DACSDK_MIN_LOG_LEVEL=ACSDK_LOG_LEVEL_WARN")
+ *
+ * Debug levels are only compiled in when @c ACSDK_DEBUG_LOG_ENABLED is also defined.
+ */
+#ifndef ACSDK_MIN_LOG_LEVEL
+#ifdef ACSDK_DEBUG_LOG_ENABLED
+#define ACSDK_MIN_LOG_LEVEL ACSDK_LOG_LEVEL_DEBUG9
+#else
+#define ACSDK_MIN_LOG_LEVEL ACSDK_LOG_LEVEL_INFO
+#endif
+#endif
+
 /**
  * Common implementation for sending entries to the log.
  *
@@ -357,7 +398,7 @@ inline Logger& ACSDK_GET_LOGGER_FUNCTION() {
         }                                                                                             \
     } while (false)
 
-#ifdef ACSDK_DEBUG_LOG_ENABLED
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG9
 
 /**
  * Send a DEBUG9 severity log line.
@@ -367,167 +408,227 @@ inline Logger& ACSDK_GET_LOGGER_FUNCTION() {
  */
 #define ACSDK_DEBUG9(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG9, entry)
 
+#else
+
 /**
- * Send a DEBUG8 severity log line.
+ * Compile out a DEBUG9 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG8(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG8, entry)
+#define ACSDK_DEBUG9(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG8
 
 /**
- * Send a DEBUG7 severity log line.
+ * Send a DEBUG8 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG7(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG7, entry)
+#define ACSDK_DEBUG8(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG8, entry)
+
+#else
 
 /**
- * Send a DEBUG6 severity log line.
+ * Compile out a DEBUG8 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG6(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG6, entry)
+#define ACSDK_DEBUG8(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG7
 
 /**
- * Send a DEBUG5 severity log line.
+ * Send a DEBUG7 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG5(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG5, entry)
+#define ACSDK_DEBUG7(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG7, entry)
+
+#else
 
 /**
- * Send a DEBUG4 severity log line.
+ * Compile out a DEBUG7 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG4(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG4, entry)
+#define ACSDK_DEBUG7(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG6
 
 /**
- * Send a DEBUG3 severity log line.
+ * Send a DEBUG6 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG3(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG3, entry)
+#define ACSDK_DEBUG6(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG6, entry)
+
+#else
 
 /**
- * Send a DEBUG2 severity log line.
+ * Compile out a DEBUG6 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG2(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG2, entry)
+#define ACSDK_DEBUG6(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG5
 
 /**
- * Send a DEBUG1 severity log line.
+ * Send a DEBUG5 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG1(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG1, entry)
+#define ACSDK_DEBUG5(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG5, entry)
+
+#else
 
 /**
- * Send a DEBUG0 severity log line.
+ * Compile out a DEBUG5 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG0(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG0, entry)
+#define ACSDK_DEBUG5(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG4
 
 /**
- * Send a log line at the default debug level (DEBUG0).
+ * Send a DEBUG4 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG0, entry)
+#define ACSDK_DEBUG4(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG4, entry)
 
-#else  // ACSDK_DEBUG_LOG_ENABLED
+#else
 
 /**
- * Compile out a DEBUG9 severity log line.
+ * Compile out a DEBUG4 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG9(entry)
+#define ACSDK_DEBUG4(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG3
 
 /**
- * Compile out a DEBUG8 severity log line.
+ * Send a DEBUG3 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG8(entry)
+#define ACSDK_DEBUG3(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG3, entry)
+
+#else
 
 /**
- * Compile out a DEBUG7 severity log line.
+ * Compile out a DEBUG3 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG7(entry)
+#define ACSDK_DEBUG3(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG2
 
 /**
- * Compile out a DEBUG6 severity log line.
+ * Send a DEBUG2 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG6(entry)
+#define ACSDK_DEBUG2(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG2, entry)
+
+#else
 
 /**
- * Compile out a DEBUG5 severity log line.
+ * Compile out a DEBUG2 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG5(entry)
+#define ACSDK_DEBUG2(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG1
 
 /**
- * Compile out a DEBUG4 severity log line.
+ * Send a DEBUG1 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG4(entry)
+#define ACSDK_DEBUG1(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG1, entry)
+
+#else
 
 /**
- * Compile out a DEBUG3 severity log line.
+ * Compile out a DEBUG1 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG3(entry)
+#define ACSDK_DEBUG1(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG0
 
 /**
- * Compile out a DEBUG2 severity log line.
+ * Send a DEBUG0 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG2(entry)
+#define ACSDK_DEBUG0(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG0, entry)
+
+#else
 
 /**
- * Compile out a DEBUG1 severity log line.
+ * Compile out a DEBUG0 severity log line.
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG1(entry)
+#define ACSDK_DEBUG0(entry)
+
+#endif
+
+#if defined(ACSDK_DEBUG_LOG_ENABLED) && ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_DEBUG0
 
 /**
- * Compile out a DEBUG0 severity log line.
+ * Send a log line at the default debug level (DEBUG0).
  *
  * @param loggerArg The Logger to send the line to.
  * @param entry The text (or builder of the text) for the log entry.
  */
-#define ACSDK_DEBUG0(entry)
+#define ACSDK_DEBUG(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::DEBUG0, entry)
+
+#else
 
 /**
  * Compile out a DEBUG severity log line.
@@ -537,7 +638,9 @@ inline Logger& ACSDK_GET_LOGGER_FUNCTION() {
  */
 #define ACSDK_DEBUG(entry)
 
-#endif  // ACSDK_DEBUG_LOG_ENABLED
+#endif
+
+#if ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_INFO
 
 /**
  * Send a INFO severity log line.
@@ -547,6 +650,20 @@ inline Logger& ACSDK_GET_LOGGER_FUNCTION() {
  */
 #define ACSDK_INFO(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::INFO, entry)
 
+#else
+
+/**
+ * Compile out a INFO severity log line.
+ *
+ * @param loggerArg The Logger to send the line to.
+ * @param entry The text (or builder of the text) for the log entry.
+ */
+#define ACSDK_INFO(entry)
+
+#endif
+
+#if ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_WARN
+
 /**
  * Send a WARN severity log line.
  *
@@ -555,6 +672,20 @@ inline Logger& ACSDK_GET_LOGGER_FUNCTION() {
  */
 #define ACSDK_WARN(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::WARN, entry)
 
+#else
+
+/**
+ * Compile out a WARN severity log line.
+ *
+ * @param loggerArg The Logger to send the line to.
+ * @param entry The text (or builder of the text) for the log entry.
+ */
+#define ACSDK_WARN(entry)
+
+#endif
+
+#if ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_ERROR
+
 /**
  * Send a ERROR severity log line.
  *
@@ -562,6 +693,21 @@ inline Logger& ACSDK_GET_LOGGER_FUNCTION() {
  * @param entry The text (or builder of the text) for the log entry.
  */
 #define ACSDK_ERROR(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::ERROR, entry)
+
+#else
+
+/**
+ * Compile out a ERROR severity log line.
+ *
+ * @param loggerArg The Logger to send the line to.
+ * @param entry The text (or builder of the text) for the log entry.
+ */
+#define ACSDK_ERROR(entry)
+
+#endif
+
+#if ACSDK_MIN_LOG_LEVEL <= ACSDK_LOG_LEVEL_CRITICAL
+
 /**
  * Send a CRITICAL severity log line.
  *
@@ -570,4 +716,16 @@ inline Logger& ACSDK_GET_LOGGER_FUNCTION() {
  */
 #define ACSDK_CRITICAL(entry) ACSDK_LOG(alexaClientSDK::avsCommon::utils::logger::Level::CRITICAL, entry)
 
+#else
+
+/**
+ * Compile out a CRITICAL severity log line.
+ *
+ * @param loggerArg The Logger to send the line to.
+ * @param entry The text (or builder of the text) for the log entry.
+ */
+#define ACSDK_CRITICAL(entry)
+
+#endif
+
 #endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_LOGGER_LOGGER_H_
@@ -24,12 +24,25 @@
 
 #include "AVSCommon/Utils/Logger/LoggerUtils.h"
 #include "SharedDataStream.h"
+#include "SingleReaderTraits.h"
 
 namespace alexaClientSDK {
 namespace avsCommon {
 namespace utils {
 namespace sds {
 
+/**
+ * Reports whether a @c Mutex or @c ConditionVariable from a traits type is usable.  Primitives which cannot fail to
+ * initialize are always usable; traits whose primitives can fail provide an overload which reports the outcome.
+ *
+ * @param primitive The mutex or condition variable.
+ * @return @c true.
+ */
+template <typename Primitive>
+bool isInitialized(const Primitive& primitive) {
+    return true;
+}
+
 /**
  * This is a nested class inside @c SharedDatastream which defines the layout of a @c Buffer for use with a
  * @c SharedDataStream.  This layout begins with a fixed @c Header structure, followed by two arrays of
@@ -301,7 +314,19 @@ public:
      */
     static size_t calculateDataOffset(size_t wordSize, size_t maxReaders);
 
-    /// This function calls @c updateOldestUnconsumedCursorLocked() while holding @c Header::backwardSeekMutex.
+    /**
+     * This function reports whether the stream's traits opt in to single-reader mode (see @c IsSingleReaderTraits).
+     * Such streams run in single-producer/single-consumer mode: cursors are exchanged through the atomic @c Header
+     * fields alone, and @c dataAvailableMutex / @c backwardSeekMutex are only taken to wake a peer which is blocked.
+     *
+     * @return @c true if this stream supports a single @c Reader, else @c false.
+     */
+    bool isSingleReader() const;
+
+    /**
+     * This function calls @c updateOldestUnconsumedCursorLocked() while holding @c Header::backwardSeekMutex.  In
+     * single-reader mode, the lone @c Reader's cursor is published directly without taking the mutex.
+     */
     void updateOldestUnconsumedCursor();
 
     /**
@@ -382,6 +407,21 @@ private:
      */
     void calculateAndCacheConstants(size_t wordSize, size_t maxReaders);
 
+    /**
+     * This function is the single-reader equivalent of @c updateOldestUnconsumedCursorLocked().  Because there is only
+     * one @c Reader, nothing else can move a read cursor backwards concurrently, so @c backwardSeekMutex is only taken
+     * to notify a @c Writer which is blocked waiting for space.
+     */
+    void updateOldestUnconsumedCursorSingleReader();
+
+    /**
+     * This function reports whether all of the mutexes and condition variables in the @c Header were initialized
+     * successfully.
+     *
+     * @return @c true if the @c Header's synchronization primitives are usable, else @c false.
+     */
+    bool isHeaderSynchronizationInitialized() const;
+
     /**
      * The tag associated with log entries from this class.
      */
@@ -478,12 +518,23 @@ bool SharedDataStream<T>::BufferLayout::init(size_t wordSize, size_t maxReaders)
                                .d("maxReadersLimit", std::numeric_limits<decltype(Header::maxReaders)>::max()));
         return false;
     }
-
-    // Pre-calculate some pointers and sizes that are frequently accessed.
-    calculateAndCacheConstants(wordSize, maxReaders);
+    if (isSingleReader() && maxReaders != 1) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed")
+                               .d("reason", "singleReaderTraitsRequireOneReader")
+                               .d("maxReaders", maxReaders));
+        return false;
+    }
 
     // Default construction of the Header.
     auto header = new (getHeader()) Header;
+    if (!isHeaderSynchronizationInitialized()) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "synchronizationInitFailed"));
+        header->~Header();
+        return false;
+    }
+
+    // Pre-calculate some pointers and sizes that are frequently accessed.
+    calculateAndCacheConstants(wordSize, maxReaders);
 
     // Default construction of the reader arrays.
     size_t id;
@@ -541,6 +592,10 @@ bool SharedDataStream<T>::BufferLayout::attach() {
                                .d("expectedHash", stableHash(T::traitsName)));
         return false;
     }
+    if (!isHeaderSynchronizationInitialized()) {
+        logger::acsdkError(logger::LogEntry(TAG, "attachFailed").d("reason", "synchronizationNotInitialized"));
+        return false;
+    }
 
     // Attach.
     std::lock_guard<Mutex> lock(header->attachMutex);
@@ -570,12 +625,16 @@ void SharedDataStream<T>::BufferLayout::detach() {
     }
 
     auto header = getHeader();
-    std::lock_guard<Mutex> lock(header->attachMutex);
+    std::unique_lock<Mutex> lock(header->attachMutex);
     --header->referenceCount;
     if (header->referenceCount > 0) {
         return;
     }
 
+    // Nothing else is attached, so release attachMutex before it is destroyed along with the Header.  A mutex must not
+    // be destroyed while it is held (a robust pthread mutex would be left on this thread's robust list).
+    lock.unlock();
+
     // Destruction of reader arrays.
     for (size_t id = 0; id < header->maxReaders; ++id) {
         m_readerCloseIndexArray[id].~AtomicIndex();
@@ -612,8 +671,18 @@ size_t SharedDataStream<T>::BufferLayout::calculateDataOffset(size_t wordSize, s
     return alignSizeTo(calculateReaderCloseIndexArrayOffset(maxReaders) + (maxReaders * sizeof(AtomicIndex)), wordSize);
 }
 
+template <typename T>
+bool SharedDataStream<T>::BufferLayout::isSingleReader() const {
+    return IsSingleReaderTraits<T>::value;
+}
+
 template <typename T>
 void SharedDataStream<T>::BufferLayout::updateOldestUnconsumedCursor() {
+    if (isSingleReader()) {
+        updateOldestUnconsumedCursorSingleReader();
+        return;
+    }
+
     // Note: as an optimization, we could skip this function if Writer policy is nonblockable (ACSDK-251).
     std::lock_guard<Mutex> backwardSeekLock(getHeader()->backwardSeekMutex);
     updateOldestUnconsumedCursorLocked();
@@ -714,6 +783,33 @@ void SharedDataStream<T>::BufferLayout::calculateAndCacheConstants(size_t wordSi
     m_data = buffer + calculateDataOffset(wordSize, maxReaders);
 }
 
+template <typename T>
+void SharedDataStream<T>::BufferLayout::updateOldestUnconsumedCursorSingleReader() {
+    auto header = getHeader();
+
+    // Same barrier rule as updateOldestUnconsumedCursorLocked(): with no enabled reader, retain data at the writer.
+    Index oldest = isReaderEnabled(0) ? getReaderCursorArray()[0].load() : header->writeStartCursor.load();
+    if (oldest <= header->oldestUnconsumedCursor) {
+        return;
+    }
+    header->oldestUnconsumedCursor = oldest;
+
+    // Only wake a writer which is waiting for space (see WaiterCountingConditionVariable).
+    if (hasWaiters(header->spaceAvailableConditionVariable)) {
+        std::lock_guard<Mutex> backwardSeekLock(header->backwardSeekMutex);
+        header->spaceAvailableConditionVariable.notify_all();
+    }
+}
+
+template <typename T>
+bool SharedDataStream<T>::BufferLayout::isHeaderSynchronizationInitialized() const {
+    auto header = getHeader();
+    return isInitialized(header->dataAvailableConditionVariable) && isInitialized(header->dataAvailableMutex) &&
+           isInitialized(header->spaceAvailableConditionVariable) && isInitialized(header->backwardSeekMutex) &&
+           isInitialized(header->writerEnableMutex) && isInitialized(header->attachMutex) &&
+           isInitialized(header->readerEnableMutex);
+}
+
 template <typename T>
 bool SharedDataStream<T>::BufferLayout::isAttached() const {
     return m_data != nullptr;
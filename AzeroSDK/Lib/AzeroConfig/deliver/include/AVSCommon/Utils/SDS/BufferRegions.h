@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_BUFFERREGIONS_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_BUFFERREGIONS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace sds {
+
+/**
+ * A view of a range of words in the circular data of a @c SharedDataStream.  Because the range may wrap around the end
+ * of the buffer, it is described by up to two contiguous regions; @c second is only used when the range wraps.
+ *
+ * @tparam ByteType @c uint8_t for writable views (@c ReservingWriter::reserve()), or `const uint8_t` for read-only
+ *     views (@c Reader::peek()).
+ */
+template <typename ByteType>
+struct BufferRegions {
+    /// Start of the first contiguous region.
+    ByteType* first = nullptr;
+
+    /// Number of words in the first contiguous region.
+    size_t firstWords = 0;
+
+    /// Start of the second contiguous region (the base of the circular data), or @c nullptr if the range does not wrap.
+    ByteType* second = nullptr;
+
+    /// Number of words in the second contiguous region.
+    size_t secondWords = 0;
+
+    /**
+     * This function returns the total size of the view.
+     *
+     * @return The number of words covered by both regions.
+     */
+    size_t size() const {
+        return firstWords + secondWords;
+    }
+};
+
+}  // namespace sds
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_BUFFERREGIONS_H_
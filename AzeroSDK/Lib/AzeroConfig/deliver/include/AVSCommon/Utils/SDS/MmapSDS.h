@@ -0,0 +1,565 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_MMAPSDS_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_MMAPSDS_H_
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+#include "SharedDataStream.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace sds {
+
+/**
+ * A @c Buffer which maps a file or POSIX shared memory object into the address space of the calling process.  Any
+ * number of processes may map the same backing object; one of them must @c SharedDataStream::create() the stream
+ * and the others @c SharedDataStream::open() it.
+ *
+ * A file-backed buffer also leaves the exact ring contents on disk, so a capture can be inspected or replayed offline.
+ */
+class MmapSDSBuffer {
+public:
+    /**
+     * Creates (or truncates) a file of @c size bytes and maps it.
+     *
+     * @param path The path of the file to back the buffer with.
+     * @param size The size (in bytes) of the buffer (see @c SharedDataStream::calculateBufferSize()).
+     * @return The mapped buffer, or @c nullptr on failure.
+     */
+    static std::shared_ptr<MmapSDSBuffer> createFile(const std::string& path, size_t size);
+
+    /**
+     * Maps an existing file, using its current size.
+     *
+     * @param path The path of a file previously set up with @c createFile().
+     * @return The mapped buffer, or @c nullptr on failure.
+     */
+    static std::shared_ptr<MmapSDSBuffer> openFile(const std::string& path);
+
+    /**
+     * Creates (or truncates) a POSIX shared memory object of @c size bytes and maps it.
+     *
+     * @param name The @c shm_open() name of the object, which must start with '/'.
+     * @param size The size (in bytes) of the buffer (see @c SharedDataStream::calculateBufferSize()).
+     * @return The mapped buffer, or @c nullptr on failure.
+     */
+    static std::shared_ptr<MmapSDSBuffer> createSharedMemory(const std::string& name, size_t size);
+
+    /**
+     * Maps an existing POSIX shared memory object, using its current size.
+     *
+     * @param name The @c shm_open() name of an object previously set up with @c createSharedMemory().
+     * @return The mapped buffer, or @c nullptr on failure.
+     */
+    static std::shared_ptr<MmapSDSBuffer> openSharedMemory(const std::string& name);
+
+    /**
+     * Removes the name of a shared memory object.  Existing mappings stay valid until they are released.
+     *
+     * @param name The @c shm_open() name of the object.
+     * @return @c true if the name was removed, else @c false.
+     */
+    static bool unlinkSharedMemory(const std::string& name);
+
+    /// The destructor unmaps the buffer.
+    ~MmapSDSBuffer();
+
+    /// @return A pointer to the start of the mapping.
+    uint8_t* data();
+
+    /// @return The size (in bytes) of the mapping.
+    size_t size() const;
+
+private:
+    /**
+     * Constructor.
+     *
+     * @param data The start of the mapping.
+     * @param size The size (in bytes) of the mapping.
+     */
+    MmapSDSBuffer(uint8_t* data, size_t size);
+
+    /**
+     * Sizes (if @c size is non-zero) and maps an open descriptor, then closes the descriptor.
+     *
+     * @param fd The descriptor of the backing object.
+     * @param size The size to truncate the object to, or zero to map the object's current size.
+     * @param name The name of the backing object, for logging.
+     * @return The mapped buffer, or @c nullptr on failure.
+     */
+    static std::shared_ptr<MmapSDSBuffer> map(int fd, size_t size, const std::string& name);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "MmapSDSBuffer";
+
+    /// The start of the mapping.
+    uint8_t* m_data;
+
+    /// The size (in bytes) of the mapping.
+    size_t m_size;
+};
+
+/**
+ * A mutex which lives in a shared @c Buffer and can be locked from any process which maps it.  It is initialized by
+ * the placement construction of the @c SharedDataStream header in @c SharedDataStream::create().
+ *
+ * Where the platform supports it, the mutex is robust: if a process dies while holding it, the next process to lock it
+ * marks it consistent and carries on.  The @c SharedDataStream state it guards is kept in atomics, so it is still
+ * coherent when that happens.
+ */
+class ProcessSharedMutex {
+public:
+    /// Initializes the mutex with @c PTHREAD_PROCESS_SHARED (and @c PTHREAD_MUTEX_ROBUST where supported).
+    ProcessSharedMutex();
+
+    /// Destroys the mutex.  This happens when the last @c SharedDataStream detaches from the @c Buffer.
+    ~ProcessSharedMutex();
+
+    /**
+     * Locks the mutex, waiting indefinitely.
+     *
+     * @throw std::system_error if the mutex cannot be locked, as @c std::mutex::lock() does.
+     */
+    void lock();
+
+    /// Unlocks the mutex.
+    void unlock();
+
+    /// @return The underlying pthread mutex.
+    pthread_mutex_t* nativeHandle();
+
+    /**
+     * Completes an acquisition of the mutex through @c nativeHandle(), recovering it if its previous owner died.
+     *
+     * @param result The result of the pthread call which acquired the mutex.
+     * @throw std::system_error if the mutex was not acquired.
+     */
+    void onAcquired(int result);
+
+    /// @return Whether the mutex was initialized successfully.
+    bool isInitialized() const;
+
+    /// Deleted copy constructor.
+    ProcessSharedMutex(const ProcessSharedMutex&) = delete;
+
+    /// Deleted assignment operator.
+    ProcessSharedMutex& operator=(const ProcessSharedMutex&) = delete;
+
+private:
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "ProcessSharedMutex";
+
+    /// The underlying pthread mutex.
+    pthread_mutex_t m_mutex;
+
+    /// Whether @c m_mutex was initialized successfully.
+    bool m_initialized;
+};
+
+/**
+ * A condition variable which lives in a shared @c Buffer and works with @c ProcessSharedMutex from any process which
+ * maps it.  It provides the subset of the @c std::condition_variable interface that @c SharedDataStream uses.
+ */
+class ProcessSharedConditionVariable {
+public:
+    /// Initializes the condition variable with @c PTHREAD_PROCESS_SHARED (and a monotonic clock where supported).
+    ProcessSharedConditionVariable();
+
+    /// Destroys the condition variable.
+    ~ProcessSharedConditionVariable();
+
+    /// Unblocks all threads (in any process) waiting on this condition variable.
+    void notify_all();
+
+    /**
+     * Waits until notified.
+     *
+     * @param lock A lock which holds a @c ProcessSharedMutex.
+     */
+    template <typename Lock>
+    void wait(Lock& lock);
+
+    /**
+     * Waits until @c predicate is satisfied.
+     *
+     * @param lock A lock which holds a @c ProcessSharedMutex.
+     * @param predicate The condition to wait for.
+     */
+    template <typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate predicate);
+
+    /**
+     * Waits up to @c timeout for @c predicate to be satisfied.
+     *
+     * @param lock A lock which holds a @c ProcessSharedMutex.
+     * @param timeout The maximum time to wait.
+     * @param predicate The condition to wait for.
+     * @return The value of @c predicate when the wait ended.
+     */
+    template <typename Lock, typename Rep, typename Period, typename Predicate>
+    bool wait_for(Lock& lock, const std::chrono::duration<Rep, Period>& timeout, Predicate predicate);
+
+    /// @return Whether the condition variable was initialized successfully.
+    bool isInitialized() const;
+
+    /// Deleted copy constructor.
+    ProcessSharedConditionVariable(const ProcessSharedConditionVariable&) = delete;
+
+    /// Deleted assignment operator.
+    ProcessSharedConditionVariable& operator=(const ProcessSharedConditionVariable&) = delete;
+
+private:
+    /// The clock @c m_condition measures timeouts against.
+#ifdef __APPLE__
+    static constexpr clockid_t CLOCK_ID = CLOCK_REALTIME;
+#else
+    static constexpr clockid_t CLOCK_ID = CLOCK_MONOTONIC;
+#endif
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "ProcessSharedConditionVariable";
+
+    /// The underlying pthread condition variable.
+    pthread_cond_t m_condition;
+
+    /// Whether @c m_condition was initialized successfully.
+    bool m_initialized;
+};
+
+/**
+ * Reports whether a @c ProcessSharedMutex is usable, so that @c SharedDataStream::create() and
+ * @c SharedDataStream::open() can fail instead of using it.
+ *
+ * @param mutex The mutex.
+ * @return Whether @c mutex was initialized successfully.
+ */
+inline bool isInitialized(const ProcessSharedMutex& mutex) {
+    return mutex.isInitialized();
+}
+
+/**
+ * Reports whether a @c ProcessSharedConditionVariable is usable, so that @c SharedDataStream::create() and
+ * @c SharedDataStream::open() can fail instead of using it.
+ *
+ * @param condition The condition variable.
+ * @return Whether @c condition was initialized successfully.
+ */
+inline bool isInitialized(const ProcessSharedConditionVariable& condition) {
+    return condition.isInitialized();
+}
+
+/// Structure for specifying the traits of a SharedDataStream which works between processes through a mapped buffer.
+struct MmapSDSTraits {
+    /// Lock-free std::atomic operates directly on the shared memory, so it works between processes.
+    using AtomicIndex = std::atomic<uint64_t>;
+
+    /// Lock-free std::atomic operates directly on the shared memory, so it works between processes.
+    using AtomicBool = std::atomic<bool>;
+
+    /// A memory-mapped file or shared memory object.
+    using Buffer = MmapSDSBuffer;
+
+    /// A pthread mutex initialized with @c PTHREAD_PROCESS_SHARED.
+    using Mutex = ProcessSharedMutex;
+
+    /// A pthread condition variable initialized with @c PTHREAD_PROCESS_SHARED.
+    using ConditionVariable = ProcessSharedConditionVariable;
+
+    /// A unique identifier representing this combination of traits.
+    static constexpr const char* traitsName = "alexaClientSDK::avsCommon::utils::sds::MmapSDSTraits";
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "MmapSDS requires lock-free 64-bit atomics");
+static_assert(ATOMIC_BOOL_LOCK_FREE == 2, "MmapSDS requires lock-free boolean atomics");
+
+/// Type alias for a SharedDataStream which works between processes through a mapped buffer.
+using MmapSDS = SharedDataStream<MmapSDSTraits>;
+
+inline std::shared_ptr<MmapSDSBuffer> MmapSDSBuffer::createFile(const std::string& path, size_t size) {
+    if (0 == size) {
+        logger::acsdkError(logger::LogEntry(TAG, "createFileFailed").d("reason", "zeroSize"));
+        return nullptr;
+    }
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        logger::acsdkError(
+            logger::LogEntry(TAG, "createFileFailed").d("reason", "openFailed").d("path", path).d("errno", errno));
+        return nullptr;
+    }
+    return map(fd, size, path);
+}
+
+inline std::shared_ptr<MmapSDSBuffer> MmapSDSBuffer::openFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        logger::acsdkError(
+            logger::LogEntry(TAG, "openFileFailed").d("reason", "openFailed").d("path", path).d("errno", errno));
+        return nullptr;
+    }
+    return map(fd, 0, path);
+}
+
+inline std::shared_ptr<MmapSDSBuffer> MmapSDSBuffer::createSharedMemory(const std::string& name, size_t size) {
+    if (0 == size) {
+        logger::acsdkError(logger::LogEntry(TAG, "createSharedMemoryFailed").d("reason", "zeroSize"));
+        return nullptr;
+    }
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "createSharedMemoryFailed")
+                               .d("reason", "shmOpenFailed")
+                               .d("name", name)
+                               .d("errno", errno));
+        return nullptr;
+    }
+    return map(fd, size, name);
+}
+
+inline std::shared_ptr<MmapSDSBuffer> MmapSDSBuffer::openSharedMemory(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "openSharedMemoryFailed")
+                               .d("reason", "shmOpenFailed")
+                               .d("name", name)
+                               .d("errno", errno));
+        return nullptr;
+    }
+    return map(fd, 0, name);
+}
+
+inline bool MmapSDSBuffer::unlinkSharedMemory(const std::string& name) {
+    if (shm_unlink(name.c_str()) != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "unlinkSharedMemoryFailed").d("name", name).d("errno", errno));
+        return false;
+    }
+    return true;
+}
+
+inline std::shared_ptr<MmapSDSBuffer> MmapSDSBuffer::map(int fd, size_t size, const std::string& name) {
+    if (size > 0) {
+        if (ftruncate(fd, size) != 0) {
+            logger::acsdkError(
+                logger::LogEntry(TAG, "mapFailed").d("reason", "ftruncateFailed").d("name", name).d("errno", errno));
+            ::close(fd);
+            return nullptr;
+        }
+    } else {
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            logger::acsdkError(logger::LogEntry(TAG, "mapFailed").d("reason", "invalidSize").d("name", name));
+            ::close(fd);
+            return nullptr;
+        }
+        size = static_cast<size_t>(info.st_size);
+    }
+
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping keeps the object alive, so the descriptor is no longer needed.
+    ::close(fd);
+    if (MAP_FAILED == data) {
+        logger::acsdkError(
+            logger::LogEntry(TAG, "mapFailed").d("reason", "mmapFailed").d("name", name).d("errno", errno));
+        return nullptr;
+    }
+    return std::shared_ptr<MmapSDSBuffer>(new MmapSDSBuffer(static_cast<uint8_t*>(data), size));
+}
+
+inline MmapSDSBuffer::MmapSDSBuffer(uint8_t* data, size_t size) : m_data{data}, m_size{size} {
+}
+
+inline MmapSDSBuffer::~MmapSDSBuffer() {
+    munmap(m_data, m_size);
+}
+
+inline uint8_t* MmapSDSBuffer::data() {
+    return m_data;
+}
+
+inline size_t MmapSDSBuffer::size() const {
+    return m_size;
+}
+
+inline ProcessSharedMutex::ProcessSharedMutex() : m_initialized{false} {
+    pthread_mutexattr_t attributes;
+    int result = pthread_mutexattr_init(&attributes);
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "mutexattrInitFailed").d("error", result));
+        return;
+    }
+    result = pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "setPsharedFailed").d("error", result));
+        pthread_mutexattr_destroy(&attributes);
+        return;
+    }
+#if !defined(__APPLE__) && !defined(__ANDROID__)
+    result = pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "setRobustFailed").d("error", result));
+        pthread_mutexattr_destroy(&attributes);
+        return;
+    }
+#endif
+    result = pthread_mutex_init(&m_mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "mutexInitFailed").d("error", result));
+        return;
+    }
+    m_initialized = true;
+}
+
+inline ProcessSharedMutex::~ProcessSharedMutex() {
+    if (m_initialized) {
+        pthread_mutex_destroy(&m_mutex);
+    }
+}
+
+inline void ProcessSharedMutex::lock() {
+    onAcquired(pthread_mutex_lock(&m_mutex));
+}
+
+inline void ProcessSharedMutex::unlock() {
+    pthread_mutex_unlock(&m_mutex);
+}
+
+inline pthread_mutex_t* ProcessSharedMutex::nativeHandle() {
+    return &m_mutex;
+}
+
+inline void ProcessSharedMutex::onAcquired(int result) {
+#if !defined(__APPLE__) && !defined(__ANDROID__)
+    if (EOWNERDEAD == result) {
+        // The previous owner died while holding the mutex.  We now own it; mark it usable again.
+        logger::acsdkWarn(logger::LogEntry(TAG, "lockRecovered").d("reason", "ownerDied"));
+        result = pthread_mutex_consistent(&m_mutex);
+        if (result != 0) {
+            pthread_mutex_unlock(&m_mutex);
+        }
+    }
+#endif
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "lockFailed").d("error", result));
+        throw std::system_error(result, std::system_category(), "ProcessSharedMutex::lock");
+    }
+}
+
+inline bool ProcessSharedMutex::isInitialized() const {
+    return m_initialized;
+}
+
+inline ProcessSharedConditionVariable::ProcessSharedConditionVariable() : m_initialized{false} {
+    pthread_condattr_t attributes;
+    int result = pthread_condattr_init(&attributes);
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "condattrInitFailed").d("error", result));
+        return;
+    }
+    result = pthread_condattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "setPsharedFailed").d("error", result));
+        pthread_condattr_destroy(&attributes);
+        return;
+    }
+#ifndef __APPLE__
+    result = pthread_condattr_setclock(&attributes, CLOCK_ID);
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "setClockFailed").d("error", result));
+        pthread_condattr_destroy(&attributes);
+        return;
+    }
+#endif
+    result = pthread_cond_init(&m_condition, &attributes);
+    pthread_condattr_destroy(&attributes);
+    if (result != 0) {
+        logger::acsdkError(logger::LogEntry(TAG, "initFailed").d("reason", "condInitFailed").d("error", result));
+        return;
+    }
+    m_initialized = true;
+}
+
+inline ProcessSharedConditionVariable::~ProcessSharedConditionVariable() {
+    if (m_initialized) {
+        pthread_cond_destroy(&m_condition);
+    }
+}
+
+inline void ProcessSharedConditionVariable::notify_all() {
+    pthread_cond_broadcast(&m_condition);
+}
+
+inline bool ProcessSharedConditionVariable::isInitialized() const {
+    return m_initialized;
+}
+
+template <typename Lock>
+void ProcessSharedConditionVariable::wait(Lock& lock) {
+    lock.mutex()->onAcquired(pthread_cond_wait(&m_condition, lock.mutex()->nativeHandle()));
+}
+
+template <typename Lock, typename Predicate>
+void ProcessSharedConditionVariable::wait(Lock& lock, Predicate predicate) {
+    while (!predicate()) {
+        wait(lock);
+    }
+}
+
+template <typename Lock, typename Rep, typename Period, typename Predicate>
+bool ProcessSharedConditionVariable::wait_for(
+    Lock& lock,
+    const std::chrono::duration<Rep, Period>& timeout,
+    Predicate predicate) {
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+    struct timespec deadline;
+    clock_gettime(CLOCK_ID, &deadline);
+    deadline.tv_sec += nanoseconds / 1000000000;
+    deadline.tv_nsec += nanoseconds % 1000000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+    while (!predicate()) {
+        int result = pthread_cond_timedwait(&m_condition, lock.mutex()->nativeHandle(), &deadline);
+        if (ETIMEDOUT == result) {
+            return predicate();
+        }
+        lock.mutex()->onAcquired(result);
+    }
+    return true;
+}
+
+}  // namespace sds
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_MMAPSDS_H_
@@ -26,6 +26,7 @@
 #include "AVSCommon/Utils/Logger/LoggerUtils.h"
 #include "SharedDataStream.h"
 #include "ReaderPolicy.h"
+#include "BufferRegions.h"
 
 namespace alexaClientSDK {
 namespace avsCommon {
@@ -46,6 +47,9 @@ public:
     /// Specifies the policy to use for reading from the stream.
     using Policy = ReaderPolicy;
 
+    /// A read-only view of data in the stream, as returned by @c peek().
+    using Regions = BufferRegions<const uint8_t>;
+
     /// Specifies a reference to measure @c seek()/@c tell()/@c close() offsets against.
     enum class Reference {
         /// The offset is from this @c Reader's current position: `(index = reader + offset)`.
@@ -114,6 +118,35 @@ public:
      */
     ssize_t read(void* buf, size_t nWords, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
 
+    /**
+     * This function provides direct access to unconsumed data in the stream without copying it or moving the
+     * @c Reader.  It follows the same blocking, close and overrun rules as @c read().  Once the caller is done with the
+     * data, it must call @c consume() to advance the @c Reader.
+     *
+     * @param regions The view to fill in.  On success it covers the returned number of words, split in two where the
+     *     data wraps around the end of the circular buffer.
+     * @param nWords The maximum number of @c wordSize words to expose.
+     * @param timeout The maximum time to wait (if @c policy is @c BLOCKING) for data.  If this parameter is zero,
+     *     there is no timeout and blocking peeks will wait forever.  If @c policy is @c NONBLOCKING, this parameter
+     *     is ignored.
+     * @return The number of @c wordSize words exposed in @c regions, or zero if the stream has closed, or a negative
+     *     @c Error code if the stream is still open, but no data is available.
+     *
+     * @warning A @c NONBLOCKABLE @c Writer may overwrite the exposed data while the caller is using it.  In that case
+     *     the following @c consume() returns @c Error::OVERRUN, and anything derived from the data must be discarded.
+     */
+    ssize_t peek(Regions* regions, size_t nWords, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    /**
+     * This function consumes data previously exposed by @c peek(), moving the @c Reader forward.
+     *
+     * @param nWords The number of @c wordSize words to consume.  This must not exceed the count returned by the
+     *     preceding @c peek().
+     * @return The number of @c wordSize words consumed, or a negative @c Error code.  @c Error::OVERRUN indicates that
+     *     the consumed data was overwritten while it was being accessed.
+     */
+    ssize_t consume(size_t nWords);
+
     /**
      * This function moves the @c Reader to the specified location in the stream.  If successful, subsequent calls to
      * @c read() will start from the new location.  For this function to succeed, the specified location *must* point
@@ -252,6 +285,34 @@ ssize_t SharedDataStream<T>::Reader::read(void* buf, size_t nWords, std::chrono:
         return Error::INVALID;
     }
 
+    Regions regions;
+    auto wordsAvailable = peek(&regions, nWords, timeout);
+    if (wordsAvailable <= 0) {
+        return wordsAvailable;
+    }
+
+    // Copy the two segments.
+    auto buf8 = static_cast<uint8_t*>(buf);
+    memcpy(buf8, regions.first, regions.firstWords * getWordSize());
+    if (regions.secondWords > 0) {
+        memcpy(buf8 + (regions.firstWords * getWordSize()), regions.second, regions.secondWords * getWordSize());
+    }
+
+    return consume(wordsAvailable);
+}
+
+template <typename T>
+ssize_t SharedDataStream<T>::Reader::peek(Regions* regions, size_t nWords, std::chrono::milliseconds timeout) {
+    if (nullptr == regions) {
+        logger::acsdkError(logger::LogEntry(TAG, "peekFailed").d("reason", "nullRegions"));
+        return Error::INVALID;
+    }
+
+    if (0 == nWords) {
+        logger::acsdkError(logger::LogEntry(TAG, "peekFailed").d("reason", "invalidNumWords").d("numWords", nWords));
+        return Error::INVALID;
+    }
+
     // Check if closed.
     auto readerCloseIndex = m_readerCloseIndex->load();
     if (*m_readerCursor >= readerCloseIndex) {
@@ -265,8 +326,9 @@ ssize_t SharedDataStream<T>::Reader::read(void* buf, size_t nWords, std::chrono:
         return Error::OVERRUN;
     }
 
+    // In single-reader mode the writer publishes its cursor without the mutex, so we only need it if we block.
     std::unique_lock<Mutex> lock(header->dataAvailableMutex, std::defer_lock);
-    if (Policy::BLOCKING == m_policy) {
+    if (Policy::BLOCKING == m_policy && !m_bufferLayout->isSingleReader()) {
         lock.lock();
     }
 
@@ -283,6 +345,10 @@ ssize_t SharedDataStream<T>::Reader::read(void* buf, size_t nWords, std::chrono:
                 return header->hasWriterBeenClosed || tell(Reference::BEFORE_WRITER) > 0;
             };
 
+            if (!lock.owns_lock()) {
+                lock.lock();
+            }
+
             if (std::chrono::milliseconds::zero() == timeout) {
                 header->dataAvailableConditionVariable.wait(lock, predicate);
             } else if (!header->dataAvailableConditionVariable.wait_for(lock, timeout, predicate)) {
@@ -297,7 +363,7 @@ ssize_t SharedDataStream<T>::Reader::read(void* buf, size_t nWords, std::chrono:
         }
     }
 
-    if (Policy::BLOCKING == m_policy) {
+    if (lock.owns_lock()) {
         lock.unlock();
     }
     if (nWords > wordsAvailable) {
@@ -314,23 +380,26 @@ ssize_t SharedDataStream<T>::Reader::read(void* buf, size_t nWords, std::chrono:
     if (beforeWrap > nWords) {
         beforeWrap = nWords;
     }
-    size_t afterWrap = nWords - beforeWrap;
+    regions->first = m_bufferLayout->getData(*m_readerCursor);
+    regions->firstWords = beforeWrap;
+    regions->secondWords = nWords - beforeWrap;
+    regions->second = regions->secondWords > 0 ? m_bufferLayout->getData(*m_readerCursor + beforeWrap) : nullptr;
 
-    // Copy the two segments.
-    auto buf8 = static_cast<uint8_t*>(buf);
-    memcpy(buf8, m_bufferLayout->getData(*m_readerCursor), beforeWrap * getWordSize());
-    if (afterWrap > 0) {
-        memcpy(
-            buf8 + (beforeWrap * getWordSize()),
-            m_bufferLayout->getData(*m_readerCursor + beforeWrap),
-            afterWrap * getWordSize());
+    return nWords;
+}
+
+template <typename T>
+ssize_t SharedDataStream<T>::Reader::consume(size_t nWords) {
+    if (0 == nWords || nWords > tell(Reference::BEFORE_WRITER)) {
+        logger::acsdkError(logger::LogEntry(TAG, "consumeFailed").d("reason", "invalidNumWords").d("numWords", nWords));
+        return Error::INVALID;
     }
 
     // Advance the read cursor.
     *m_readerCursor += nWords;
 
     // Final check for overrun (do this before the updateOldestUnconsumedCursor() call below for improved accuracy).
-    bool overrun = ((header->writeEndCursor - *m_readerCursor) > m_bufferLayout->getDataSize());
+    bool overrun = ((m_bufferLayout->getHeader()->writeEndCursor - *m_readerCursor) > m_bufferLayout->getDataSize());
 
     // Move the unconsumed cursor before returning.
     m_bufferLayout->updateOldestUnconsumedCursor();
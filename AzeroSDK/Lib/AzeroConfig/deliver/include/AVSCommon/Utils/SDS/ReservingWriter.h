@@ -0,0 +1,199 @@
+/*
+ * Copyright 2017-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_RESERVINGWRITER_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_RESERVINGWRITER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+#include "SharedDataStream.h"
+#include "BufferRegions.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace sds {
+
+/**
+ * This class wraps a @c SharedDataStream::Writer so that a producer can generate data directly into the circular
+ * buffer instead of copying it in with @c Writer::write().  The reservation state lives here rather than in the
+ * @c Writer, because the @c Writer layout is shared with prebuilt libraries and must not change.
+ *
+ * @note Like @c Writer, this class is intended to be used from a single thread.
+ */
+template <typename T>
+class ReservingWriter {
+public:
+    /// The wrapped @c Writer type.
+    using Writer = typename SharedDataStream<T>::Writer;
+
+    /// A writable view of space in the stream, as returned by @c reserve().
+    using Regions = BufferRegions<uint8_t>;
+
+    /**
+     * Constructs a @c ReservingWriter which takes ownership of a @c Writer.
+     *
+     * @param writer The @c Writer to reserve space through, as returned by @c SharedDataStream::createWriter().
+     */
+    explicit ReservingWriter(std::unique_ptr<Writer> writer);
+
+    /**
+     * This function reserves space in the stream.  It applies the same policy rules as @c Writer::write(), except that
+     * a reservation is never larger than the stream.  The reserved data only becomes visible to @c Readers when
+     * @c commit() is called.  A reservation which is not committed is discarded by the next @c reserve(), or by a
+     * @c write() through the wrapped @c Writer.
+     *
+     * @param regions The view to fill in.  On success it covers the returned number of words, split in two where the
+     *     space wraps around the end of the circular buffer.
+     * @param nWords The maximum number of @c wordSize words to reserve.
+     * @param timeout The maximum time to wait (if @c policy is @c BLOCKING) for space.  If this parameter is zero,
+     *     there is no timeout and blocking reservations will wait forever.  If @c policy is not @C BLOCKING, this
+     *     parameter is ignored.
+     * @return The number of @c wordSize words reserved, or zero if the stream has closed, or a negative
+     *     @c Writer::Error code if the stream is still open, but no space could be reserved.
+     */
+    ssize_t reserve(Regions* regions, size_t nWords, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    /**
+     * This function publishes data written into space obtained from @c reserve() and wakes any waiting @c Readers.
+     *
+     * @param nWords The number of @c wordSize words to publish, from the start of the reservation.  This must not
+     *     exceed the count returned by the preceding @c reserve().
+     * @return The number of @c wordSize words published, or a negative @c Writer::Error code.
+     */
+    ssize_t commit(size_t nWords);
+
+    /**
+     * This function returns the wrapped @c Writer, for @c tell(), @c close() and plain writes.
+     *
+     * @return The wrapped @c Writer.
+     */
+    Writer* getWriter() const;
+
+private:
+    /**
+     * The tag associated with log entries from this class.
+     */
+    static const std::string TAG;
+
+    /// The wrapped @c Writer.
+    std::unique_ptr<Writer> m_writer;
+
+    /// The number of words claimed by the last @c reserve() which have not yet been committed.
+    size_t m_reserved;
+
+    /// The write cursor at the last @c reserve(), used to detect a reservation discarded by a plain write.
+    typename SharedDataStream<T>::Index m_reservedAt;
+};
+
+template <typename T>
+const std::string ReservingWriter<T>::TAG = "SdsReservingWriter";
+
+template <typename T>
+ReservingWriter<T>::ReservingWriter(std::unique_ptr<Writer> writer) :
+        m_writer{std::move(writer)},
+        m_reserved{0},
+        m_reservedAt{0} {
+}
+
+template <typename T>
+ssize_t ReservingWriter<T>::reserve(Regions* regions, size_t nWords, std::chrono::milliseconds timeout) {
+    if (nullptr == regions) {
+        logger::acsdkError(logger::LogEntry(TAG, "reserveFailed").d("reason", "nullRegions"));
+        return Writer::Error::INVALID;
+    }
+    if (0 == nWords) {
+        logger::acsdkError(logger::LogEntry(TAG, "reserveFailed").d("reason", "zeroNumWords"));
+        return Writer::Error::INVALID;
+    }
+
+    auto& bufferLayout = m_writer->m_bufferLayout;
+
+    // Unlike write(), a reservation has to fit in the buffer, so never claim more than the buffer holds.
+    if (nWords > bufferLayout->getDataSize()) {
+        nWords = bufferLayout->getDataSize();
+    }
+
+    m_reserved = 0;
+    auto claimed = m_writer->claim(nWords, timeout);
+    if (claimed <= 0) {
+        return claimed;
+    }
+    nWords = claimed;
+
+    auto header = bufferLayout->getHeader();
+    m_reserved = nWords;
+    m_reservedAt = header->writeStartCursor;
+
+    // Split it across the wrap.
+    size_t beforeWrap = bufferLayout->wordsUntilWrap(m_reservedAt);
+    if (beforeWrap > nWords) {
+        beforeWrap = nWords;
+    }
+    regions->first = bufferLayout->getData(m_reservedAt);
+    regions->firstWords = beforeWrap;
+    regions->secondWords = nWords - beforeWrap;
+    regions->second = regions->secondWords > 0 ? bufferLayout->getData(m_reservedAt + beforeWrap) : nullptr;
+
+    return nWords;
+}
+
+template <typename T>
+ssize_t ReservingWriter<T>::commit(size_t nWords) {
+    if (0 == nWords || nWords > m_reserved) {
+        logger::acsdkError(logger::LogEntry(TAG, "commitFailed")
+                               .d("reason", "invalidNumWords")
+                               .d("numWords", nWords)
+                               .d("reserved", m_reserved));
+        return Writer::Error::INVALID;
+    }
+
+    auto header = m_writer->m_bufferLayout->getHeader();
+    if (header->writeStartCursor != m_reservedAt) {
+        logger::acsdkError(logger::LogEntry(TAG, "commitFailed").d("reason", "reservationDiscarded"));
+        m_reserved = 0;
+        return Writer::Error::INVALID;
+    }
+    if (!header->isWriterEnabled) {
+        logger::acsdkError(logger::LogEntry(TAG, "commitFailed").d("reason", "writerDisabled"));
+        m_reserved = 0;
+        return Writer::Error::CLOSED;
+    }
+
+    // Give back any reserved space which was not used.  Shrinking writeEndCursor is always safe for readers.
+    header->writeEndCursor = header->writeStartCursor + nWords;
+    m_reserved = 0;
+    m_writer->publish();
+
+    return nWords;
+}
+
+template <typename T>
+typename ReservingWriter<T>::Writer* ReservingWriter<T>::getWriter() const {
+    return m_writer.get();
+}
+
+}  // namespace sds
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_RESERVINGWRITER_H_
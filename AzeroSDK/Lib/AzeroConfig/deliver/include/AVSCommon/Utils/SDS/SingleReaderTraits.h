@@ -0,0 +1,207 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_SINGLEREADERTRAITS_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_SINGLEREADERTRAITS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace sds {
+
+/**
+ * Reports whether a @c SharedDataStream traits type opts in to single-reader mode, by declaring
+ * `static constexpr bool isSingleReader = true`.
+ *
+ * Streams with such traits are created with `maxReaders == 1`, and exchange cursors through the atomic @c Header
+ * fields alone.  @c dataAvailableMutex and @c backwardSeekMutex are only taken to wake a peer which is blocked, which
+ * the traits' @c ConditionVariable must be able to report (see @c WaiterCountingConditionVariable).
+ *
+ * Single-reader mode is a property of the traits rather than of a stream, so the existing traits (and the header
+ * layout of their streams, which prebuilt libraries share) are unaffected.
+ *
+ * @tparam T The traits type.
+ */
+template <typename T, typename = void>
+struct IsSingleReaderTraits : std::false_type {};
+
+/// Specialization for traits which declare @c isSingleReader.
+template <typename T>
+struct IsSingleReaderTraits<T, typename std::enable_if<T::isSingleReader>::type> : std::true_type {};
+
+/**
+ * A condition variable which counts the threads waiting on it, so that a notifier can skip taking the mutex when no
+ * one is waiting.
+ *
+ * A waiter increments the count while holding the mutex, before testing its predicate.  A notifier changes the state
+ * the predicate reads, then reads the count.  Both are sequentially consistent, so either the waiter sees the new
+ * state, or the notifier sees the count and takes the mutex, which it cannot acquire until the waiter is blocked on
+ * the condition variable.  Either way the notification is not lost.
+ *
+ * The count lives alongside the condition variable, so it works wherever @c ConditionVariable does, including in a
+ * buffer shared between processes.
+ *
+ * @tparam ConditionVariable The underlying condition variable, which provides @c notify_all(), @c wait(lock, predicate)
+ *     and @c wait_for(lock, timeout, predicate).
+ */
+template <typename ConditionVariable>
+class WaiterCountingConditionVariable {
+public:
+    /// Constructor.
+    WaiterCountingConditionVariable();
+
+    /// Unblocks all threads waiting on this condition variable.
+    void notify_all();
+
+    /**
+     * Waits until @c predicate is satisfied.
+     *
+     * @param lock A lock which holds the mutex used with this condition variable.
+     * @param predicate The condition to wait for.
+     */
+    template <typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate predicate);
+
+    /**
+     * Waits up to @c timeout for @c predicate to be satisfied.
+     *
+     * @param lock A lock which holds the mutex used with this condition variable.
+     * @param timeout The maximum time to wait.
+     * @param predicate The condition to wait for.
+     * @return The value of @c predicate when the wait ended.
+     */
+    template <typename Lock, typename Rep, typename Period, typename Predicate>
+    bool wait_for(Lock& lock, const std::chrono::duration<Rep, Period>& timeout, Predicate predicate);
+
+    /**
+     * Reports whether any thread is waiting, or about to test its predicate before waiting.
+     *
+     * @return @c true if a notification may be needed, else @c false.
+     */
+    bool hasWaiters() const;
+
+    /// Deleted copy constructor.
+    WaiterCountingConditionVariable(const WaiterCountingConditionVariable&) = delete;
+
+    /// Deleted assignment operator.
+    WaiterCountingConditionVariable& operator=(const WaiterCountingConditionVariable&) = delete;
+
+private:
+    /// Counts a waiter for as long as it exists, so the count is restored however the wait ends.
+    class WaiterGuard {
+    public:
+        /**
+         * Constructor.  Counts a waiter.
+         *
+         * @param waiters The count of waiters.
+         */
+        explicit WaiterGuard(std::atomic<uint32_t>& waiters);
+
+        /// Destructor.  Stops counting the waiter.
+        ~WaiterGuard();
+
+        /// Deleted copy constructor.
+        WaiterGuard(const WaiterGuard&) = delete;
+
+        /// Deleted assignment operator.
+        WaiterGuard& operator=(const WaiterGuard&) = delete;
+
+    private:
+        /// The count of waiters.
+        std::atomic<uint32_t>& m_waiters;
+    };
+
+    /// The underlying condition variable.
+    ConditionVariable m_condition;
+
+    /// The number of threads waiting on @c m_condition.
+    std::atomic<uint32_t> m_waiters;
+};
+
+/**
+ * Reports whether a notification on a condition variable may be needed.  A condition variable which does not count
+ * its waiters always may need one.
+ *
+ * @return @c true.
+ */
+template <typename ConditionVariable>
+bool hasWaiters(const ConditionVariable&) {
+    return true;
+}
+
+/**
+ * Reports whether a notification on @c condition may be needed.
+ *
+ * @param condition The condition variable.
+ * @return @c true if a thread is waiting on @c condition, else @c false.
+ */
+template <typename ConditionVariable>
+bool hasWaiters(const WaiterCountingConditionVariable<ConditionVariable>& condition) {
+    return condition.hasWaiters();
+}
+
+template <typename ConditionVariable>
+WaiterCountingConditionVariable<ConditionVariable>::WaiterCountingConditionVariable() : m_waiters{0} {
+}
+
+template <typename ConditionVariable>
+void WaiterCountingConditionVariable<ConditionVariable>::notify_all() {
+    m_condition.notify_all();
+}
+
+template <typename ConditionVariable>
+template <typename Lock, typename Predicate>
+void WaiterCountingConditionVariable<ConditionVariable>::wait(Lock& lock, Predicate predicate) {
+    WaiterGuard guard(m_waiters);
+    m_condition.wait(lock, predicate);
+}
+
+template <typename ConditionVariable>
+template <typename Lock, typename Rep, typename Period, typename Predicate>
+bool WaiterCountingConditionVariable<ConditionVariable>::wait_for(
+    Lock& lock,
+    const std::chrono::duration<Rep, Period>& timeout,
+    Predicate predicate) {
+    WaiterGuard guard(m_waiters);
+    return m_condition.wait_for(lock, timeout, predicate);
+}
+
+template <typename ConditionVariable>
+bool WaiterCountingConditionVariable<ConditionVariable>::hasWaiters() const {
+    return m_waiters > 0;
+}
+
+template <typename ConditionVariable>
+WaiterCountingConditionVariable<ConditionVariable>::WaiterGuard::WaiterGuard(std::atomic<uint32_t>& waiters) :
+        m_waiters(waiters) {
+    ++m_waiters;
+}
+
+template <typename ConditionVariable>
+WaiterCountingConditionVariable<ConditionVariable>::WaiterGuard::~WaiterGuard() {
+    --m_waiters;
+}
+
+}  // namespace sds
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_SDS_SINGLEREADERTRAITS_H_
@@ -33,6 +33,9 @@ namespace avsCommon {
 namespace utils {
 namespace sds {
 
+template <typename T>
+class ReservingWriter;
+
 /**
  * This is a nested class in @c SharedDataStream which provides an interface for writing (producing) data to the
  * stream.
@@ -125,11 +128,28 @@ public:
     static std::string errorToString(Error error);
 
 private:
+    /// @c ReservingWriter claims and publishes space through this @c Writer without adding state to it.
+    friend class ReservingWriter<T>;
+
     /**
      * The tag associated with log entries from this class.
      */
     static const std::string TAG;
 
+    /**
+     * This function applies @c m_policy to a write of @c nWords at the current write cursor, and claims the
+     * resulting region by moving @c writeEndCursor.
+     *
+     * @param nWords The number of @c wordSize words to claim.
+     * @param timeout The maximum time to wait (if @c policy is @c BLOCKING) for space.
+     * @return The number of @c wordSize words claimed (which may be truncated by the policy), or a value from
+     *     @c Error if nothing could be claimed.
+     */
+    ssize_t claim(size_t nWords, std::chrono::milliseconds timeout);
+
+    /// This function moves @c writeStartCursor up to @c writeEndCursor and wakes any waiting @c Readers.
+    void publish();
+
     /// The @c Policy to use for writing to the stream.
     Policy m_policy;
 
@@ -174,14 +194,54 @@ ssize_t SharedDataStream<T>::Writer::write(const void* buf, size_t nWords, std::
         return Error::INVALID;
     }
 
+    auto claimed = claim(nWords, timeout);
+    if (claimed <= 0) {
+        return claimed;
+    }
+    nWords = claimed;
+
+    auto header = m_bufferLayout->getHeader();
+    auto wordsToCopy = nWords;
+    auto buf8 = static_cast<const uint8_t*>(buf);
+
+    if (Policy::ALL_OR_NOTHING == m_policy) {
+        // If we have more data than the SDS can hold and we're not going to be overwriting oldestUnconsumedCursor, we
+        // can safely discard the initial data and just leave the trailing data in the buffer.
+        if (wordsToCopy > m_bufferLayout->getDataSize()) {
+            wordsToCopy = m_bufferLayout->getDataSize();
+            buf8 += (nWords - wordsToCopy) * getWordSize();
+        }
+    }
+
+    // Split it across the wrap.
+    size_t beforeWrap = m_bufferLayout->wordsUntilWrap(header->writeStartCursor);
+    if (beforeWrap > wordsToCopy) {
+        beforeWrap = wordsToCopy;
+    }
+    size_t afterWrap = wordsToCopy - beforeWrap;
+
+    // Copy the two segments.
+    memcpy(m_bufferLayout->getData(header->writeStartCursor), buf8, beforeWrap * getWordSize());
+    if (afterWrap > 0) {
+        memcpy(
+            m_bufferLayout->getData(header->writeStartCursor + beforeWrap),
+            buf8 + beforeWrap * getWordSize(),
+            afterWrap * getWordSize());
+    }
+
+    publish();
+
+    return nWords;
+}
+
+template <typename T>
+ssize_t SharedDataStream<T>::Writer::claim(size_t nWords, std::chrono::milliseconds timeout) {
     auto header = m_bufferLayout->getHeader();
     if (!header->isWriterEnabled) {
         logger::acsdkError(logger::LogEntry(TAG, "writeFailed").d("reason", "writerDisabled"));
         return Error::CLOSED;
     }
 
-    auto wordsToCopy = nWords;
-    auto buf8 = static_cast<const uint8_t*>(buf);
     std::unique_lock<Mutex> backwardSeekLock(header->backwardSeekMutex, std::defer_lock);
     Index writeEnd = header->writeStartCursor + nWords;
 
@@ -189,7 +249,7 @@ ssize_t SharedDataStream<T>::Writer::write(const void* buf, size_t nWords, std::
         case Policy::NONBLOCKABLE:
             // For NONBLOCKABLE, we can truncate the write if it won't fit in the buffer.
             if (nWords > m_bufferLayout->getDataSize()) {
-                wordsToCopy = nWords = m_bufferLayout->getDataSize();
+                nWords = m_bufferLayout->getDataSize();
                 writeEnd = header->writeStartCursor + nWords;
             }
             break;
@@ -238,7 +298,7 @@ ssize_t SharedDataStream<T>::Writer::write(const void* buf, size_t nWords, std::
 
             // For BLOCKING, we can truncate the write if it won't fit in the buffer.
             if (spaceAvailable < nWords) {
-                wordsToCopy = nWords = spaceAvailable;
+                nWords = spaceAvailable;
                 writeEnd = header->writeStartCursor + nWords;
             }
 
@@ -252,32 +312,24 @@ ssize_t SharedDataStream<T>::Writer::write(const void* buf, size_t nWords, std::
         backwardSeekLock.unlock();
     }
 
-    if (Policy::ALL_OR_NOTHING == m_policy) {
-        // If we have more data than the SDS can hold and we're not going to be overwriting oldestUnconsumedCursor, we
-        // can safely discard the initial data and just leave the trailing data in the buffer.
-        if (wordsToCopy > m_bufferLayout->getDataSize()) {
-            wordsToCopy = m_bufferLayout->getDataSize();
-            buf8 += (nWords - wordsToCopy) * getWordSize();
-        }
-    }
+    return nWords;
+}
 
-    // Split it across the wrap.
-    size_t beforeWrap = m_bufferLayout->wordsUntilWrap(header->writeStartCursor);
-    if (beforeWrap > wordsToCopy) {
-        beforeWrap = wordsToCopy;
-    }
-    size_t afterWrap = wordsToCopy - beforeWrap;
+template <typename T>
+void SharedDataStream<T>::Writer::publish() {
+    auto header = m_bufferLayout->getHeader();
 
-    // Copy the two segments.
-    memcpy(m_bufferLayout->getData(header->writeStartCursor), buf8, beforeWrap * getWordSize());
-    if (afterWrap > 0) {
-        memcpy(
-            m_bufferLayout->getData(header->writeStartCursor + beforeWrap),
-            buf8 + beforeWrap * getWordSize(),
-            afterWrap * getWordSize());
+    // Advance the write cursor.
+    if (m_bufferLayout->isSingleReader()) {
+        // In single-reader mode, only wake a reader which is waiting for data (see WaiterCountingConditionVariable).
+        header->writeStartCursor = header->writeEndCursor.load();
+        if (hasWaiters(header->dataAvailableConditionVariable)) {
+            std::lock_guard<Mutex> dataAvailableLock(header->dataAvailableMutex);
+            header->dataAvailableConditionVariable.notify_all();
+        }
+        return;
     }
 
-    // Advance the write cursor.
     // Note: To prevent a race condition and ensure that readers which block on dataAvailableConditionVariable don't
     // miss a notify, we should always lock the dataAvailableConditionVariable mutex while moving writeStartCursor.  As
     // an optimization, we skip that lock for NONBLOCKABLE writers under the assumption that they will be writing
@@ -295,8 +347,6 @@ ssize_t SharedDataStream<T>::Writer::write(const void* buf, size_t nWords, std::
     // Notify the reader(s).
     // Note: as an optimization, we could skip this if there are no blocking readers (ACSDK-251).
     header->dataAvailableConditionVariable.notify_all();
-
-    return nWords;
 }
 
 template <typename T>
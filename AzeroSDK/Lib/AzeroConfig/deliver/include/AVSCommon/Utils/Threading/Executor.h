@@ -16,9 +16,16 @@
 #ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_EXECUTOR_H_
 #define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_EXECUTOR_H_
 
+#include <atomic>
+#include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
+#include "AVSCommon/Utils/Threading/ExecutorMetrics.h"
 #include "AVSCommon/Utils/Threading/TaskThread.h"
 #include "AVSCommon/Utils/Threading/TaskQueue.h"
 
@@ -29,6 +36,9 @@ namespace threading {
 
 /**
  * An Executor is used to run callable types asynchronously.
+ *
+ * While @c ExecutorMetrics::setEnabled(true) is in effect, tasks report their queue latency and run time to the
+ * Executor's own @c ExecutorMetrics, named after the Executor, or @c METRICS_NAME if it was constructed without a name.
  */
 class Executor {
 public:
@@ -37,6 +47,13 @@ public:
      */
     Executor();
 
+    /**
+     * Constructs a named Executor.
+     *
+     * @param name The name to report metrics under, typically the name of the owning component.
+     */
+    explicit Executor(const std::string& name);
+
     /**
      * Destructs an Executor.
      */
@@ -65,6 +82,16 @@ public:
     template <typename Task, typename... Args>
     auto submitToFront(Task task, Args&&... args) -> std::future<decltype(task(args...))>;
 
+    /**
+     * Submits a callable type to be executed on an Executor thread, without a future.  This is the cheapest way to
+     * queue work when the caller does not need to wait for the result (see @c TaskQueue::post()).
+     *
+     * @param task A copyable callable type taking no arguments.  Its return value, if any, is discarded.
+     * @return @c false if the executor is shutdown and the task was dropped, else @c true.
+     */
+    template <typename Task>
+    bool execute(Task task);
+
     /**
      * Wait for any previously submitted tasks to complete.
      */
@@ -76,7 +103,55 @@ public:
     /// Returns whether or not the executor is shutdown.
     bool isShutdown();
 
+    /// @return The executor's metrics.
+    std::shared_ptr<ExecutorMetrics> getMetrics() const;
+
+    /// The name Executors constructed without a name report metrics under.
+    static constexpr const char* METRICS_NAME = "Executor";
+
 private:
+    /// The metrics of one Executor, and the number of measured tasks it has queued.
+    struct InstanceMetrics {
+        /// The task queue of the Executor these metrics belong to.
+        std::weak_ptr<TaskQueue> taskQueue;
+
+        /// The metrics.
+        std::shared_ptr<ExecutorMetrics> metrics;
+
+        /// The number of measured tasks queued.
+        std::atomic<size_t> queueDepth{0};
+    };
+
+    /// The metrics of every Executor which has reported any, keyed by task queue.
+    struct MetricsTable {
+        /// Protects @c entries.
+        std::mutex mutex;
+
+        /// The metrics, keyed by the address of the Executor's task queue.
+        std::unordered_map<const TaskQueue*, std::shared_ptr<InstanceMetrics>> entries;
+    };
+
+    /**
+     * Finds this Executor's metrics, creating them if there are none yet.  The Executor layout is shared with prebuilt
+     * libraries, so the metrics are kept in a table keyed by @c m_taskQueue rather than in a member.
+     *
+     * @param name The name to create the metrics under.
+     * @return The metrics.
+     */
+    std::shared_ptr<InstanceMetrics> instanceMetrics(const std::string& name = METRICS_NAME) const;
+
+    /**
+     * Wraps a task so that it reports to this Executor's metrics.
+     *
+     * @param callable The task.
+     * @return The wrapped task.
+     */
+    template <typename Callable>
+    MeasuredTask<Callable> measure(Callable callable) const;
+
+    /// @return The process-wide table of Executor metrics.
+    static MetricsTable& metricsTable();
+
     /// The queue of tasks to execute.
     std::shared_ptr<TaskQueue> m_taskQueue;
 
@@ -86,12 +161,67 @@ private:
 
 template <typename Task, typename... Args>
 auto Executor::submit(Task task, Args&&... args) -> std::future<decltype(task(args...))> {
-    return m_taskQueue->push(task, std::forward<Args>(args)...);
+    if (!ExecutorMetrics::isEnabled()) {
+        return m_taskQueue->push(task, std::forward<Args>(args)...);
+    }
+    return m_taskQueue->push(measure(std::bind(std::move(task), std::forward<Args>(args)...)));
 }
 
 template <typename Task, typename... Args>
 auto Executor::submitToFront(Task task, Args&&... args) -> std::future<decltype(task(args...))> {
-    return m_taskQueue->pushToFront(task, std::forward<Args>(args)...);
+    if (!ExecutorMetrics::isEnabled()) {
+        return m_taskQueue->pushToFront(task, std::forward<Args>(args)...);
+    }
+    return m_taskQueue->pushToFront(measure(std::bind(std::move(task), std::forward<Args>(args)...)));
+}
+
+template <typename Task>
+bool Executor::execute(Task task) {
+    if (!ExecutorMetrics::isEnabled()) {
+        return m_taskQueue->post(std::move(task));
+    }
+    // A measured task is move-only, so it cannot go in post()'s std::function; take the push() path instead.
+    return m_taskQueue->push(measure(std::move(task))).valid();
+}
+
+template <typename Callable>
+MeasuredTask<Callable> Executor::measure(Callable callable) const {
+    auto instance = instanceMetrics();
+    // Share ownership of the table entry with the task, so that its queue depth counter outlives the task.
+    std::shared_ptr<ExecutorMetrics> metrics(instance, instance->metrics.get());
+    return makeMeasuredTask(std::move(callable), std::move(metrics), &instance->queueDepth);
+}
+
+inline Executor::Executor(const std::string& name) : Executor() {
+    instanceMetrics(name);
+}
+
+inline std::shared_ptr<ExecutorMetrics> Executor::getMetrics() const {
+    return instanceMetrics()->metrics;
+}
+
+inline std::shared_ptr<Executor::InstanceMetrics> Executor::instanceMetrics(const std::string& name) const {
+    auto& table = metricsTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.entries.find(m_taskQueue.get());
+    if (it != table.entries.end() && it->second->taskQueue.lock() == m_taskQueue) {
+        return it->second;
+    }
+
+    // The destructor is not ours to extend, so entries of destroyed Executors are dropped as new ones are added.
+    for (auto entry = table.entries.begin(); entry != table.entries.end();) {
+        entry = entry->second->taskQueue.expired() ? table.entries.erase(entry) : std::next(entry);
+    }
+    auto instance = std::make_shared<InstanceMetrics>();
+    instance->taskQueue = m_taskQueue;
+    instance->metrics = ExecutorMetrics::create(name);
+    table.entries[m_taskQueue.get()] = instance;
+    return instance;
+}
+
+inline Executor::MetricsTable& Executor::metricsTable() {
+    static MetricsTable instance;
+    return instance;
 }
 
 }  // namespace threading
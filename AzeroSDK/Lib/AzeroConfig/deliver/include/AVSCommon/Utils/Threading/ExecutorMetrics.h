@@ -0,0 +1,617 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_EXECUTORMETRICS_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_EXECUTORMETRICS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace threading {
+
+/**
+ * A lock-free histogram of durations with power-of-two microsecond buckets.  Bucket 0 counts durations under 1us, and
+ * bucket @c i counts durations in [2^(i-1), 2^i) us; the last bucket also counts everything longer.
+ */
+class LatencyHistogram {
+public:
+    /// The number of buckets.  The last regular bucket ends at about 8.4 seconds.
+    static constexpr size_t BUCKET_COUNT = 24;
+
+    /// A point-in-time copy of a histogram.
+    struct Snapshot {
+        /// The count in each bucket.
+        std::vector<uint64_t> buckets;
+
+        /// The number of recorded durations.
+        uint64_t count = 0;
+
+        /// The sum of recorded durations, in microseconds.
+        uint64_t totalMicroseconds = 0;
+
+        /// The longest recorded duration, in microseconds.
+        uint64_t maxMicroseconds = 0;
+
+        /**
+         * Estimates a percentile from the buckets.
+         *
+         * @param percentile The percentile, in (0, 100].
+         * @return The upper bound in microseconds of the bucket holding the percentile, capped at the maximum, or 0
+         *     if the histogram is empty.
+         */
+        uint64_t percentileMicroseconds(double percentile) const;
+    };
+
+    /// Constructor.
+    LatencyHistogram();
+
+    /**
+     * Records a duration.
+     *
+     * @param duration The duration to record.
+     */
+    void record(std::chrono::steady_clock::duration duration);
+
+    /// @return A copy of the current counts.
+    Snapshot snapshot() const;
+
+    /// Clears all counts.
+    void reset();
+
+private:
+    /// The count in each bucket.
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+
+    /// The sum of recorded durations, in microseconds.
+    std::atomic<uint64_t> m_totalMicroseconds;
+
+    /// The longest recorded duration, in microseconds.
+    std::atomic<uint64_t> m_maxMicroseconds;
+};
+
+/**
+ * Runtime metrics for one executor: queue depth, how long tasks wait before they start, how long they run, and
+ * throughput.  Collection is switched on and off for all executors with @c setEnabled(); while it is off, the only
+ * cost to an executor is one relaxed atomic load per task.
+ *
+ * Applications read the metrics with `ExecutorMetrics::toJson(ExecutorMetrics::snapshotAll())` or
+ * @c ExecutorMetrics::logAll().  Each @c Strand and @c Executor reports separately, under the name it was constructed
+ * with; unnamed ones report under "Strand" or @c Executor::METRICS_NAME.
+ */
+class ExecutorMetrics {
+public:
+    /// A point-in-time copy of an executor's metrics.
+    struct Snapshot {
+        /// The executor's name.
+        std::string name;
+
+        /// The number of tasks queued when the snapshot was taken.
+        uint64_t queueDepth = 0;
+
+        /// The largest number of tasks queued at once.
+        uint64_t queueDepthHighWaterMark = 0;
+
+        /// The number of tasks which have completed.
+        uint64_t tasksCompleted = 0;
+
+        /// The average completion rate since the metrics were last reset.
+        double tasksPerSecond = 0;
+
+        /// The time from enqueueing each task to starting it.
+        LatencyHistogram::Snapshot queueLatency;
+
+        /// The time each task ran for.
+        LatencyHistogram::Snapshot runTime;
+    };
+
+    /**
+     * Creates metrics for an executor and adds them to the list returned by @c snapshotAll().
+     *
+     * @param name The executor's name.
+     * @return The new metrics.
+     */
+    static std::shared_ptr<ExecutorMetrics> create(const std::string& name);
+
+    /**
+     * Switches metric collection on or off for all executors.  Collection is off by default.
+     *
+     * @param enabled Whether to collect metrics.
+     */
+    static void setEnabled(bool enabled);
+
+    /// @return Whether metric collection is on.
+    static bool isEnabled();
+
+    /// @return Snapshots of every live executor's metrics.
+    static std::vector<Snapshot> snapshotAll();
+
+    /**
+     * Formats snapshots as JSON.
+     *
+     * @param snapshots The snapshots to format.
+     * @return A JSON array with one object per executor.
+     */
+    static std::string toJson(const std::vector<Snapshot>& snapshots);
+
+    /// Logs a one-line summary of every live executor's metrics.
+    static void logAll();
+
+    /// @return The executor's name.
+    const std::string& getName() const;
+
+    /**
+     * Records that a task was queued.
+     *
+     * @param queueDepth The number of queued tasks, including the new one.
+     */
+    void onTaskQueued(size_t queueDepth);
+
+    /**
+     * Records that a task was taken off the queue to run.
+     *
+     * @param queueDepth The number of tasks left queued.
+     * @param waited How long the task was queued for.
+     */
+    void onTaskStarted(size_t queueDepth, std::chrono::steady_clock::duration waited);
+
+    /**
+     * Records that a queued task was dropped without running, for example when its executor shut down.
+     *
+     * @param queueDepth The number of tasks left queued.
+     */
+    void onTaskDropped(size_t queueDepth);
+
+    /**
+     * Records that a task finished.
+     *
+     * @param ran How long the task ran for.
+     */
+    void onTaskCompleted(std::chrono::steady_clock::duration ran);
+
+    /// @return A snapshot of this executor's metrics.
+    Snapshot snapshot() const;
+
+    /// Clears this executor's metrics.
+    void reset();
+
+private:
+    /**
+     * Constructor.
+     *
+     * @param name The executor's name.
+     */
+    explicit ExecutorMetrics(const std::string& name);
+
+    /// The process-wide state shared by all metrics.
+    struct Registry {
+        /// Whether collection is on.
+        std::atomic<bool> enabled{false};
+
+        /// Protects @c metrics.
+        std::mutex mutex;
+
+        /// Every metrics object created; expired entries are pruned on @c create().
+        std::vector<std::weak_ptr<ExecutorMetrics>> metrics;
+    };
+
+    /// @return The process-wide registry.
+    static Registry& registry();
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "ExecutorMetrics";
+
+    /// The executor's name.
+    const std::string m_name;
+
+    /// The number of tasks queued.
+    std::atomic<uint64_t> m_queueDepth;
+
+    /// The largest number of tasks queued at once.
+    std::atomic<uint64_t> m_queueDepthHighWaterMark;
+
+    /// The number of tasks which have completed.
+    std::atomic<uint64_t> m_tasksCompleted;
+
+    /// When the metrics were last reset, in @c steady_clock ticks.
+    std::atomic<std::chrono::steady_clock::rep> m_resetTime;
+
+    /// The time from enqueueing each task to starting it.
+    LatencyHistogram m_queueLatency;
+
+    /// The time each task ran for.
+    LatencyHistogram m_runTime;
+};
+
+inline uint64_t LatencyHistogram::Snapshot::percentileMicroseconds(double percentile) const {
+    if (0 == count) {
+        return 0;
+    }
+    uint64_t threshold = static_cast<uint64_t>(count * percentile / 100.0 + 0.5);
+    uint64_t seen = 0;
+    for (size_t index = 0; index < buckets.size(); ++index) {
+        seen += buckets[index];
+        if (seen >= threshold && seen > 0) {
+            return index + 1 < buckets.size() ? std::min(uint64_t(1) << index, maxMicroseconds) : maxMicroseconds;
+        }
+    }
+    return maxMicroseconds;
+}
+
+inline LatencyHistogram::LatencyHistogram() : m_totalMicroseconds{0}, m_maxMicroseconds{0} {
+    for (auto& bucket : m_buckets) {
+        bucket = 0;
+    }
+}
+
+inline void LatencyHistogram::record(std::chrono::steady_clock::duration duration) {
+    auto count = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    uint64_t microseconds = count > 0 ? static_cast<uint64_t>(count) : 0;
+    size_t index = 0;
+    while (index + 1 < BUCKET_COUNT && microseconds >= (uint64_t(1) << index)) {
+        ++index;
+    }
+    m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+    m_totalMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+    uint64_t max = m_maxMicroseconds.load(std::memory_order_relaxed);
+    while (microseconds > max && !m_maxMicroseconds.compare_exchange_weak(max, microseconds)) {
+    }
+}
+
+inline LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.buckets.reserve(BUCKET_COUNT);
+    for (auto& bucket : m_buckets) {
+        snapshot.buckets.push_back(bucket.load(std::memory_order_relaxed));
+        snapshot.count += snapshot.buckets.back();
+    }
+    snapshot.totalMicroseconds = m_totalMicroseconds.load(std::memory_order_relaxed);
+    snapshot.maxMicroseconds = m_maxMicroseconds.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+inline void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket = 0;
+    }
+    m_totalMicroseconds = 0;
+    m_maxMicroseconds = 0;
+}
+
+inline std::shared_ptr<ExecutorMetrics> ExecutorMetrics::create(const std::string& name) {
+    std::shared_ptr<ExecutorMetrics> metrics(new ExecutorMetrics(name));
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<std::weak_ptr<ExecutorMetrics>> live;
+    live.reserve(reg.metrics.size() + 1);
+    for (auto& entry : reg.metrics) {
+        if (!entry.expired()) {
+            live.push_back(entry);
+        }
+    }
+    live.push_back(metrics);
+    reg.metrics.swap(live);
+    return metrics;
+}
+
+inline void ExecutorMetrics::setEnabled(bool enabled) {
+    registry().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+inline bool ExecutorMetrics::isEnabled() {
+    return registry().enabled.load(std::memory_order_relaxed);
+}
+
+inline std::vector<ExecutorMetrics::Snapshot> ExecutorMetrics::snapshotAll() {
+    std::vector<std::shared_ptr<ExecutorMetrics>> live;
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto& entry : reg.metrics) {
+            if (auto metrics = entry.lock()) {
+                live.push_back(metrics);
+            }
+        }
+    }
+    std::vector<Snapshot> snapshots;
+    snapshots.reserve(live.size());
+    for (auto& metrics : live) {
+        snapshots.push_back(metrics->snapshot());
+    }
+    return snapshots;
+}
+
+inline std::string ExecutorMetrics::toJson(const std::vector<Snapshot>& snapshots) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    auto writeHistogram = [&writer](const char* key, const LatencyHistogram::Snapshot& histogram) {
+        writer.Key(key);
+        writer.StartObject();
+        writer.Key("count");
+        writer.Uint64(histogram.count);
+        writer.Key("totalUs");
+        writer.Uint64(histogram.totalMicroseconds);
+        writer.Key("maxUs");
+        writer.Uint64(histogram.maxMicroseconds);
+        writer.Key("p50Us");
+        writer.Uint64(histogram.percentileMicroseconds(50));
+        writer.Key("p99Us");
+        writer.Uint64(histogram.percentileMicroseconds(99));
+        writer.Key("buckets");
+        writer.StartArray();
+        for (auto bucket : histogram.buckets) {
+            writer.Uint64(bucket);
+        }
+        writer.EndArray();
+        writer.EndObject();
+    };
+
+    writer.StartArray();
+    for (auto& snapshot : snapshots) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(snapshot.name.c_str(), static_cast<rapidjson::SizeType>(snapshot.name.size()));
+        writer.Key("queueDepth");
+        writer.Uint64(snapshot.queueDepth);
+        writer.Key("queueDepthHighWaterMark");
+        writer.Uint64(snapshot.queueDepthHighWaterMark);
+        writer.Key("tasksCompleted");
+        writer.Uint64(snapshot.tasksCompleted);
+        writer.Key("tasksPerSecond");
+        writer.Double(snapshot.tasksPerSecond);
+        writeHistogram("queueLatency", snapshot.queueLatency);
+        writeHistogram("runTime", snapshot.runTime);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    return buffer.GetString();
+}
+
+inline void ExecutorMetrics::logAll() {
+    for (auto& snapshot : snapshotAll()) {
+        logger::acsdkInfo(logger::LogEntry(TAG, "executorMetrics")
+                              .d("name", snapshot.name)
+                              .d("queueDepth", snapshot.queueDepth)
+                              .d("queueDepthHighWaterMark", snapshot.queueDepthHighWaterMark)
+                              .d("tasksCompleted", snapshot.tasksCompleted)
+                              .d("tasksPerSecond", snapshot.tasksPerSecond)
+                              .d("queueLatencyP50Us", snapshot.queueLatency.percentileMicroseconds(50))
+                              .d("queueLatencyP99Us", snapshot.queueLatency.percentileMicroseconds(99))
+                              .d("queueLatencyMaxUs", snapshot.queueLatency.maxMicroseconds)
+                              .d("runTimeP50Us", snapshot.runTime.percentileMicroseconds(50))
+                              .d("runTimeP99Us", snapshot.runTime.percentileMicroseconds(99))
+                              .d("runTimeMaxUs", snapshot.runTime.maxMicroseconds));
+    }
+}
+
+inline const std::string& ExecutorMetrics::getName() const {
+    return m_name;
+}
+
+inline void ExecutorMetrics::onTaskQueued(size_t queueDepth) {
+    m_queueDepth.store(queueDepth, std::memory_order_relaxed);
+    uint64_t highWaterMark = m_queueDepthHighWaterMark.load(std::memory_order_relaxed);
+    while (queueDepth > highWaterMark && !m_queueDepthHighWaterMark.compare_exchange_weak(highWaterMark, queueDepth)) {
+    }
+}
+
+inline void ExecutorMetrics::onTaskStarted(size_t queueDepth, std::chrono::steady_clock::duration waited) {
+    m_queueDepth.store(queueDepth, std::memory_order_relaxed);
+    m_queueLatency.record(waited);
+}
+
+inline void ExecutorMetrics::onTaskDropped(size_t queueDepth) {
+    m_queueDepth.store(queueDepth, std::memory_order_relaxed);
+}
+
+inline void ExecutorMetrics::onTaskCompleted(std::chrono::steady_clock::duration ran) {
+    m_tasksCompleted.fetch_add(1, std::memory_order_relaxed);
+    m_runTime.record(ran);
+}
+
+inline ExecutorMetrics::Snapshot ExecutorMetrics::snapshot() const {
+    Snapshot snapshot;
+    snapshot.name = m_name;
+    snapshot.queueDepth = m_queueDepth.load(std::memory_order_relaxed);
+    snapshot.queueDepthHighWaterMark = m_queueDepthHighWaterMark.load(std::memory_order_relaxed);
+    snapshot.tasksCompleted = m_tasksCompleted.load(std::memory_order_relaxed);
+    auto elapsed = std::chrono::steady_clock::now().time_since_epoch() -
+                   std::chrono::steady_clock::duration(m_resetTime.load(std::memory_order_relaxed));
+    auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count();
+    snapshot.tasksPerSecond = seconds > 0 ? snapshot.tasksCompleted / seconds : 0;
+    snapshot.queueLatency = m_queueLatency.snapshot();
+    snapshot.runTime = m_runTime.snapshot();
+    return snapshot;
+}
+
+inline void ExecutorMetrics::reset() {
+    m_queueDepthHighWaterMark = m_queueDepth.load();
+    m_tasksCompleted = 0;
+    m_resetTime = std::chrono::steady_clock::now().time_since_epoch().count();
+    m_queueLatency.reset();
+    m_runTime.reset();
+}
+
+inline ExecutorMetrics::ExecutorMetrics(const std::string& name) :
+        m_name{name},
+        m_queueDepth{0},
+        m_queueDepthHighWaterMark{0},
+        m_tasksCompleted{0},
+        m_resetTime{std::chrono::steady_clock::now().time_since_epoch().count()} {
+}
+
+inline ExecutorMetrics::Registry& ExecutorMetrics::registry() {
+    static Registry instance;
+    return instance;
+}
+
+/**
+ * Wraps a task for an executor whose queue cannot time stamp its entries, so that the task itself reports its queue
+ * latency and run time to an @c ExecutorMetrics.  The queue depth is kept in a counter shared by the executor's tasks;
+ * a task which is dropped without running still leaves the count.
+ */
+template <typename Callable>
+class MeasuredTask {
+public:
+    /**
+     * Constructor, called as the task is queued.
+     *
+     * @param callable The task.
+     * @param metrics The metrics to report to.
+     * @param queueDepth The counter of queued tasks, which must outlive the task.
+     */
+    MeasuredTask(Callable callable, std::shared_ptr<ExecutorMetrics> metrics, std::atomic<size_t>* queueDepth);
+
+    /**
+     * Move constructor.
+     *
+     * @param other The task to move from, which no longer counts as queued.
+     */
+    MeasuredTask(MeasuredTask&& other);
+
+    /// Destructor.  If the task never ran, it leaves the queue depth.
+    ~MeasuredTask();
+
+    /// Runs the task, recording how long it was queued and how long it ran.
+    auto operator()() -> decltype(std::declval<Callable&>()());
+
+    /// Deleted copy constructor.
+    MeasuredTask(const MeasuredTask&) = delete;
+
+    /// Deleted assignment operator.
+    MeasuredTask& operator=(const MeasuredTask&) = delete;
+
+private:
+    /// Records the run time of the task when destroyed, so that a task which throws is still counted.
+    class RunTimer {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param metrics The metrics to report to.
+         */
+        explicit RunTimer(ExecutorMetrics* metrics);
+
+        /// Destructor.  Records the run time.
+        ~RunTimer();
+
+    private:
+        /// The metrics to report to.
+        ExecutorMetrics* m_metrics;
+
+        /// When the task started.
+        std::chrono::steady_clock::time_point m_startedAt;
+    };
+
+    /// The task.
+    Callable m_callable;
+
+    /// The metrics to report to, or @c nullptr once the task has left the queue.
+    std::shared_ptr<ExecutorMetrics> m_metrics;
+
+    /// The counter of queued tasks.
+    std::atomic<size_t>* m_queueDepth;
+
+    /// When the task was queued.
+    std::chrono::steady_clock::time_point m_queuedAt;
+};
+
+template <typename Callable>
+MeasuredTask<Callable>::MeasuredTask(
+    Callable callable,
+    std::shared_ptr<ExecutorMetrics> metrics,
+    std::atomic<size_t>* queueDepth) :
+        m_callable(std::move(callable)),
+        m_metrics{std::move(metrics)},
+        m_queueDepth{queueDepth},
+        m_queuedAt{std::chrono::steady_clock::now()} {
+    m_metrics->onTaskQueued(m_queueDepth->fetch_add(1, std::memory_order_relaxed) + 1);
+}
+
+template <typename Callable>
+MeasuredTask<Callable>::MeasuredTask(MeasuredTask&& other) :
+        m_callable(std::move(other.m_callable)),
+        m_metrics{std::move(other.m_metrics)},
+        m_queueDepth{other.m_queueDepth},
+        m_queuedAt{other.m_queuedAt} {
+    other.m_metrics.reset();
+}
+
+template <typename Callable>
+MeasuredTask<Callable>::~MeasuredTask() {
+    if (m_metrics) {
+        m_metrics->onTaskDropped(m_queueDepth->fetch_sub(1, std::memory_order_relaxed) - 1);
+    }
+}
+
+template <typename Callable>
+auto MeasuredTask<Callable>::operator()() -> decltype(std::declval<Callable&>()()) {
+    auto metrics = std::move(m_metrics);
+    if (metrics) {
+        metrics->onTaskStarted(
+            m_queueDepth->fetch_sub(1, std::memory_order_relaxed) - 1, std::chrono::steady_clock::now() - m_queuedAt);
+    }
+    RunTimer runTimer(metrics.get());
+    return m_callable();
+}
+
+template <typename Callable>
+MeasuredTask<Callable>::RunTimer::RunTimer(ExecutorMetrics* metrics) :
+        m_metrics{metrics},
+        m_startedAt{std::chrono::steady_clock::now()} {
+}
+
+template <typename Callable>
+MeasuredTask<Callable>::RunTimer::~RunTimer() {
+    if (m_metrics) {
+        m_metrics->onTaskCompleted(std::chrono::steady_clock::now() - m_startedAt);
+    }
+}
+
+/**
+ * Utility function which creates a @c MeasuredTask, deducing the callable type.
+ *
+ * @param callable The task.
+ * @param metrics The metrics to report to.
+ * @param queueDepth The counter of queued tasks, which must outlive the task.
+ * @return The new @c MeasuredTask.
+ */
+template <typename Callable>
+MeasuredTask<Callable> makeMeasuredTask(
+    Callable callable,
+    std::shared_ptr<ExecutorMetrics> metrics,
+    std::atomic<size_t>* queueDepth) {
+    return MeasuredTask<Callable>(std::move(callable), std::move(metrics), queueDepth);
+}
+
+}  // namespace threading
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_EXECUTORMETRICS_H_
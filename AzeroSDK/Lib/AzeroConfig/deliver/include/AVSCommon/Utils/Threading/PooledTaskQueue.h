@@ -0,0 +1,284 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_POOLEDTASKQUEUE_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_POOLEDTASKQUEUE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+#include "AVSCommon/Utils/Threading/SmallTask.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace threading {
+
+/**
+ * A double-ended queue of @c SmallTasks whose nodes come from a free list.  Nodes are preallocated at construction and
+ * recycled on pop, so once the queue has reached its working depth, pushing and popping do not touch the heap.  The
+ * pool never shrinks; its memory is released when the queue is destroyed.
+ *
+ * This class is not thread-safe; callers must provide their own locking.
+ */
+class PooledTaskQueue {
+public:
+    /// The number of nodes preallocated by default.
+    static constexpr size_t DEFAULT_PREALLOCATED_NODES = 32;
+
+    /**
+     * Constructor.
+     *
+     * @param preallocatedNodes The number of nodes to allocate up front.
+     */
+    explicit PooledTaskQueue(size_t preallocatedNodes = DEFAULT_PREALLOCATED_NODES);
+
+    /// Destructor.  Outstanding tasks are destroyed without being run.
+    ~PooledTaskQueue();
+
+    /// The type of the optional time stamp stored with each task.
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    /**
+     * Adds a task to the back of the queue.
+     *
+     * @param task The task.
+     * @param queuedAt An optional time stamp to store with the task, for instrumentation.
+     */
+    void pushBack(SmallTask task, TimePoint queuedAt = TimePoint());
+
+    /**
+     * Adds a task to the front of the queue.
+     *
+     * @param task The task.
+     * @param queuedAt An optional time stamp to store with the task, for instrumentation.
+     */
+    void pushFront(SmallTask task, TimePoint queuedAt = TimePoint());
+
+    /**
+     * Removes the task at the front of the queue.
+     *
+     * @param[out] task Receives the task.
+     * @param[out] queuedAt If not @c nullptr, receives the time stamp stored with the task.
+     * @return @c false if the queue was empty, else @c true.
+     */
+    bool popFront(SmallTask* task, TimePoint* queuedAt = nullptr);
+
+    /**
+     * Removes the task at the back of the queue.
+     *
+     * @param[out] task Receives the task.
+     * @param[out] queuedAt If not @c nullptr, receives the time stamp stored with the task.
+     * @return @c false if the queue was empty, else @c true.
+     */
+    bool popBack(SmallTask* task, TimePoint* queuedAt = nullptr);
+
+    /// @return Whether the queue is empty.
+    bool empty() const;
+
+    /// @return The number of tasks in the queue.
+    size_t size() const;
+
+    /**
+     * Exchanges the contents and node pools of two queues.
+     *
+     * @param other The queue to swap with.
+     */
+    void swap(PooledTaskQueue& other);
+
+    /// Deleted copy constructor.
+    PooledTaskQueue(const PooledTaskQueue&) = delete;
+
+    /// Deleted assignment operator.
+    PooledTaskQueue& operator=(const PooledTaskQueue&) = delete;
+
+private:
+    /// A queue node.  Free nodes are chained through @c next.
+    struct Node {
+        /// The queued task.
+        SmallTask task;
+
+        /// The time stamp passed in with the task.
+        TimePoint queuedAt;
+
+        /// The node towards the front of the queue.
+        Node* previous;
+
+        /// The node towards the back of the queue, or the next free node.
+        Node* next;
+    };
+
+    /**
+     * Takes a node from the free list, allocating one if the list is empty.
+     *
+     * @param task The task to store in the node.
+     * @param queuedAt The time stamp to store in the node.
+     * @return The node.
+     */
+    Node* acquire(SmallTask task, TimePoint queuedAt);
+
+    /**
+     * Returns a node to the free list.
+     *
+     * @param node The node, whose task has been moved out.
+     */
+    void release(Node* node);
+
+    /**
+     * Unlinks a node and moves its task out.
+     *
+     * @param node The node to remove.
+     * @param[out] task Receives the task.
+     * @param[out] queuedAt If not @c nullptr, receives the node's time stamp.
+     */
+    void remove(Node* node, SmallTask* task, TimePoint* queuedAt);
+
+    /// The front of the queue.
+    Node* m_front;
+
+    /// The back of the queue.
+    Node* m_back;
+
+    /// The head of the free list.
+    Node* m_free;
+
+    /// The number of tasks in the queue.
+    size_t m_size;
+};
+
+inline PooledTaskQueue::PooledTaskQueue(size_t preallocatedNodes) :
+        m_front{nullptr},
+        m_back{nullptr},
+        m_free{nullptr},
+        m_size{0} {
+    for (size_t count = 0; count < preallocatedNodes; ++count) {
+        release(new Node());
+    }
+}
+
+inline PooledTaskQueue::~PooledTaskQueue() {
+    while (m_front) {
+        Node* node = m_front;
+        m_front = node->next;
+        delete node;
+    }
+    while (m_free) {
+        Node* node = m_free;
+        m_free = node->next;
+        delete node;
+    }
+}
+
+inline void PooledTaskQueue::pushBack(SmallTask task, TimePoint queuedAt) {
+    Node* node = acquire(std::move(task), queuedAt);
+    node->previous = m_back;
+    node->next = nullptr;
+    if (m_back) {
+        m_back->next = node;
+    } else {
+        m_front = node;
+    }
+    m_back = node;
+    ++m_size;
+}
+
+inline void PooledTaskQueue::pushFront(SmallTask task, TimePoint queuedAt) {
+    Node* node = acquire(std::move(task), queuedAt);
+    node->previous = nullptr;
+    node->next = m_front;
+    if (m_front) {
+        m_front->previous = node;
+    } else {
+        m_back = node;
+    }
+    m_front = node;
+    ++m_size;
+}
+
+inline bool PooledTaskQueue::popFront(SmallTask* task, TimePoint* queuedAt) {
+    if (!m_front) {
+        return false;
+    }
+    remove(m_front, task, queuedAt);
+    return true;
+}
+
+inline bool PooledTaskQueue::popBack(SmallTask* task, TimePoint* queuedAt) {
+    if (!m_back) {
+        return false;
+    }
+    remove(m_back, task, queuedAt);
+    return true;
+}
+
+inline bool PooledTaskQueue::empty() const {
+    return 0 == m_size;
+}
+
+inline size_t PooledTaskQueue::size() const {
+    return m_size;
+}
+
+inline void PooledTaskQueue::swap(PooledTaskQueue& other) {
+    std::swap(m_front, other.m_front);
+    std::swap(m_back, other.m_back);
+    std::swap(m_free, other.m_free);
+    std::swap(m_size, other.m_size);
+}
+
+inline PooledTaskQueue::Node* PooledTaskQueue::acquire(SmallTask task, TimePoint queuedAt) {
+    Node* node = m_free;
+    if (node) {
+        m_free = node->next;
+    } else {
+        node = new Node();
+    }
+    node->task = std::move(task);
+    node->queuedAt = queuedAt;
+    return node;
+}
+
+inline void PooledTaskQueue::release(Node* node) {
+    node->previous = nullptr;
+    node->next = m_free;
+    m_free = node;
+}
+
+inline void PooledTaskQueue::remove(Node* node, SmallTask* task, TimePoint* queuedAt) {
+    if (node->previous) {
+        node->previous->next = node->next;
+    } else {
+        m_front = node->next;
+    }
+    if (node->next) {
+        node->next->previous = node->previous;
+    } else {
+        m_back = node->previous;
+    }
+    --m_size;
+    *task = std::move(node->task);
+    if (queuedAt) {
+        *queuedAt = node->queuedAt;
+    }
+    release(node);
+}
+
+}  // namespace threading
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_POOLEDTASKQUEUE_H_
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_SMALLTASK_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_SMALLTASK_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace threading {
+
+/**
+ * A move-only holder for a @c void() callable, like @c std::function<void()>, which stores callables of up to
+ * @c INLINE_CAPACITY bytes inside the object instead of on the heap.  Unlike @c std::function it also accepts
+ * move-only callables, so a task can own a @c std::promise without a @c std::shared_ptr around it.
+ */
+class SmallTask {
+public:
+    /// The size in bytes of the largest callable stored without a heap allocation.
+    static constexpr size_t INLINE_CAPACITY = 64;
+
+    /// Constructs an empty task.
+    SmallTask() noexcept;
+
+    /// Constructs an empty task.
+    SmallTask(std::nullptr_t) noexcept;
+
+    /**
+     * Constructs a task holding a callable.
+     *
+     * @param callable The callable, which is moved or copied into the task.
+     */
+    template <
+        typename Callable,
+        typename = typename std::enable_if<!std::is_same<typename std::decay<Callable>::type, SmallTask>::value>::type>
+    SmallTask(Callable&& callable);
+
+    /**
+     * Move constructor.
+     *
+     * @param other The task to move from, which is left empty.
+     */
+    SmallTask(SmallTask&& other) noexcept;
+
+    /**
+     * Move assignment operator.
+     *
+     * @param other The task to move from, which is left empty.
+     * @return This task.
+     */
+    SmallTask& operator=(SmallTask&& other) noexcept;
+
+    /// Destroys the held callable, if any.
+    ~SmallTask();
+
+    /// @return Whether this task holds a callable.
+    explicit operator bool() const;
+
+    /// Calls the held callable.  The task must not be empty.
+    void operator()();
+
+    /// Deleted copy constructor.
+    SmallTask(const SmallTask&) = delete;
+
+    /// Deleted copy assignment operator.
+    SmallTask& operator=(const SmallTask&) = delete;
+
+private:
+    /// The type-erased operations on a held callable.
+    struct Operations {
+        /// Calls the callable in @c storage.
+        void (*invoke)(void* storage);
+
+        /// Moves the callable from @c from to @c to, and destroys the one at @c from.
+        void (*relocate)(void* from, void* to);
+
+        /// Destroys the callable in @c storage.
+        void (*destroy)(void* storage);
+    };
+
+    /**
+     * Whether a callable type is stored inline.  Inline callables must fit, and must be nothrow-movable so that moving
+     * a @c SmallTask stays @c noexcept.
+     */
+    template <typename Callable>
+    using IsInline = std::integral_constant<
+        bool,
+        sizeof(Callable) <= INLINE_CAPACITY && alignof(Callable) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible<Callable>::value>;
+
+    /**
+     * Builds the operations for a callable stored inline.
+     *
+     * @return The operations for @c Callable.
+     */
+    template <typename Callable>
+    static const Operations* operationsFor(std::true_type);
+
+    /**
+     * Builds the operations for a callable stored on the heap, with a pointer to it stored inline.
+     *
+     * @return The operations for @c Callable.
+     */
+    template <typename Callable>
+    static const Operations* operationsFor(std::false_type);
+
+    /**
+     * Stores a callable inline.
+     *
+     * @param callable The callable.
+     */
+    template <typename Callable, typename Arg>
+    void store(Arg&& callable, std::true_type);
+
+    /**
+     * Stores a callable on the heap.
+     *
+     * @param callable The callable.
+     */
+    template <typename Callable, typename Arg>
+    void store(Arg&& callable, std::false_type);
+
+    /// Destroys the held callable, if any, leaving the task empty.
+    void reset();
+
+    /// Storage for an inline callable, or for a pointer to a heap callable.
+    typename std::aligned_storage<INLINE_CAPACITY, alignof(std::max_align_t)>::type m_storage;
+
+    /// The operations on the held callable, or @c nullptr if the task is empty.
+    const Operations* m_operations;
+};
+
+inline SmallTask::SmallTask() noexcept : m_operations{nullptr} {
+}
+
+inline SmallTask::SmallTask(std::nullptr_t) noexcept : m_operations{nullptr} {
+}
+
+template <typename Callable, typename>
+SmallTask::SmallTask(Callable&& callable) : m_operations{nullptr} {
+    using Type = typename std::decay<Callable>::type;
+    store<Type>(std::forward<Callable>(callable), IsInline<Type>());
+}
+
+inline SmallTask::SmallTask(SmallTask&& other) noexcept : m_operations{other.m_operations} {
+    if (m_operations) {
+        m_operations->relocate(&other.m_storage, &m_storage);
+        other.m_operations = nullptr;
+    }
+}
+
+inline SmallTask& SmallTask::operator=(SmallTask&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_operations = other.m_operations;
+        if (m_operations) {
+            m_operations->relocate(&other.m_storage, &m_storage);
+            other.m_operations = nullptr;
+        }
+    }
+    return *this;
+}
+
+inline SmallTask::~SmallTask() {
+    reset();
+}
+
+inline SmallTask::operator bool() const {
+    return m_operations != nullptr;
+}
+
+inline void SmallTask::operator()() {
+    m_operations->invoke(&m_storage);
+}
+
+inline void SmallTask::reset() {
+    if (m_operations) {
+        m_operations->destroy(&m_storage);
+        m_operations = nullptr;
+    }
+}
+
+template <typename Callable>
+const SmallTask::Operations* SmallTask::operationsFor(std::true_type) {
+    static const Operations operations = {
+        [](void* storage) { (*static_cast<Callable*>(storage))(); },
+        [](void* from, void* to) {
+            new (to) Callable(std::move(*static_cast<Callable*>(from)));
+            static_cast<Callable*>(from)->~Callable();
+        },
+        [](void* storage) { static_cast<Callable*>(storage)->~Callable(); }};
+    return &operations;
+}
+
+template <typename Callable>
+const SmallTask::Operations* SmallTask::operationsFor(std::false_type) {
+    static const Operations operations = {
+        [](void* storage) { (**static_cast<Callable**>(storage))(); },
+        [](void* from, void* to) { *static_cast<Callable**>(to) = *static_cast<Callable**>(from); },
+        [](void* storage) { delete *static_cast<Callable**>(storage); }};
+    return &operations;
+}
+
+template <typename Callable, typename Arg>
+void SmallTask::store(Arg&& callable, std::true_type) {
+    new (&m_storage) Callable(std::forward<Arg>(callable));
+    m_operations = operationsFor<Callable>(std::true_type());
+}
+
+template <typename Callable, typename Arg>
+void SmallTask::store(Arg&& callable, std::false_type) {
+    *reinterpret_cast<Callable**>(&m_storage) = new Callable(std::forward<Arg>(callable));
+    m_operations = operationsFor<Callable>(std::false_type());
+}
+
+}  // namespace threading
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_SMALLTASK_H_
@@ -0,0 +1,348 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_STRAND_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_STRAND_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "AVSCommon/Utils/Threading/ExecutorMetrics.h"
+#include "AVSCommon/Utils/Threading/PooledTaskQueue.h"
+#include "AVSCommon/Utils/Threading/SmallTask.h"
+#include "AVSCommon/Utils/Threading/TaskQueue.h"
+#include "AVSCommon/Utils/Threading/ThreadPool.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace threading {
+
+/**
+ * A Strand runs callable types asynchronously and in submission order, like an @c Executor, but without a dedicated
+ * thread: its tasks are run on a shared @c ThreadPool, at most one at a time.  It has the same interface as
+ * @c Executor, so a component can switch by changing the type of its executor member.
+ *
+ * To stay fair to other strands sharing the pool, a strand gives its worker back after @c MAX_TASKS_PER_TURN tasks
+ * and reschedules itself at the back of the pool.
+ *
+ * Because workers are shared, a task should not block waiting on work queued to another strand of the same pool; with
+ * every worker blocked that way, the pool deadlocks where separate @c Executor threads would not.
+ *
+ * Each strand has a name and an @c ExecutorMetrics, which collects queue and latency metrics while
+ * @c ExecutorMetrics::setEnabled(true) is in effect.
+ */
+class Strand {
+public:
+    /**
+     * Constructs a Strand.
+     *
+     * @param pool The pool to run tasks on.  Defaults to the engine-wide pool.
+     */
+    explicit Strand(std::shared_ptr<ThreadPool> pool = ThreadPool::getDefaultThreadPool());
+
+    /**
+     * Constructs a named Strand.
+     *
+     * @param name The name to report metrics under, typically the name of the owning component.
+     * @param pool The pool to run tasks on.  Defaults to the engine-wide pool.
+     */
+    explicit Strand(const std::string& name, std::shared_ptr<ThreadPool> pool = ThreadPool::getDefaultThreadPool());
+
+    /**
+     * Destructs a Strand.  Outstanding tasks are dropped, and a running task is waited for.
+     */
+    ~Strand();
+
+    /**
+     * Submits a callable type (function, lambda expression, bind expression, or another function object) to be executed
+     * on the pool after all previously submitted tasks. The future must be checked for validity before waiting on it.
+     *
+     * @param task A callable type representing a task.
+     * @param args The arguments to call the task with.
+     * @returns A @c std::future for the return value of the task.
+     */
+    template <typename Task, typename... Args>
+    auto submit(Task task, Args&&... args) -> std::future<decltype(task(args...))>;
+
+    /**
+     * Submits a callable type to be executed after all previously submitted tasks, without a future.  This is the
+     * cheapest way to queue work: a task which fits in @c SmallTask::INLINE_CAPACITY is queued without allocating.
+     *
+     * @param task A callable type taking no arguments.  Its return value, if any, is discarded.
+     * @return @c false if the strand is shut down and the task was dropped, else @c true.
+     */
+    template <typename Task>
+    bool execute(Task task);
+
+    /**
+     * Submits a callable type (function, lambda expression, bind expression, or another function object) to run before
+     * any other outstanding tasks. The future must be checked for validity before waiting on it.
+     *
+     * @param task A callable type representing a task.
+     * @param args The arguments to call the task with.
+     * @returns A @c std::future for the return value of the task.
+     */
+    template <typename Task, typename... Args>
+    auto submitToFront(Task task, Args&&... args) -> std::future<decltype(task(args...))>;
+
+    /**
+     * Wait for any previously submitted tasks to complete.
+     */
+    void waitForSubmittedTasks();
+
+    /// Clears the strand of outstanding tasks and refuses any additional tasks to be submitted.
+    void shutdown();
+
+    /// Returns whether or not the strand is shutdown.
+    bool isShutdown();
+
+    /// @return The strand's metrics.
+    std::shared_ptr<ExecutorMetrics> getMetrics() const;
+
+    /// The number of tasks a strand runs before yielding its worker.
+    static constexpr size_t MAX_TASKS_PER_TURN = 16;
+
+private:
+    /// State shared between the @c Strand and the pool tasks which drain it.
+    struct State {
+        /// The pool to run tasks on.
+        std::shared_ptr<ThreadPool> pool;
+
+        /// Protects the members below.
+        std::mutex mutex;
+
+        /// Tasks waiting to run, in order.
+        PooledTaskQueue queue;
+
+        /// Whether a drain is posted to, or running on, the pool.
+        bool scheduled = false;
+
+        /// Whether the strand has been shut down.
+        bool shutdown = false;
+
+        /// The thread currently running a task for this strand.
+        std::thread::id runner;
+
+        /// Notified when @c scheduled becomes @c false.
+        std::condition_variable idle;
+
+        /// The strand's metrics.
+        std::shared_ptr<ExecutorMetrics> metrics;
+    };
+
+    /**
+     * Queues a wrapped task and schedules a drain if none is pending.
+     *
+     * @param front If @c true, run the task before other outstanding tasks.
+     * @param task The wrapped task.
+     * @return @c false if the strand is shut down (or its pool is), else @c true.
+     */
+    bool enqueue(bool front, SmallTask task);
+
+    /**
+     * Schedules a drain of @c state on its pool.  If the pool refuses it, nothing would ever run the queued tasks, so
+     * the strand is shut down and they are dropped, breaking the promises of any submitted futures.
+     *
+     * @param state The strand to drain.
+     * @return @c false if the pool refused the drain, else @c true.
+     */
+    static bool schedule(std::shared_ptr<State> state);
+
+    /**
+     * Runs up to @c MAX_TASKS_PER_TURN tasks on the calling pool worker, then reschedules if work remains.
+     *
+     * @param state The strand to drain.
+     */
+    static void drain(std::shared_ptr<State> state);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "Strand";
+
+    /// The shared state.
+    std::shared_ptr<State> m_state;
+};
+
+template <typename Task, typename... Args>
+auto Strand::submit(Task task, Args&&... args) -> std::future<decltype(task(args...))> {
+    SmallTask wrapped;
+    auto future = wrapTask(&wrapped, std::forward<Task>(task), std::forward<Args>(args)...);
+    if (!enqueue(false, std::move(wrapped))) {
+        using FutureType = decltype(task(args...));
+        return std::future<FutureType>();
+    }
+    return future;
+}
+
+template <typename Task, typename... Args>
+auto Strand::submitToFront(Task task, Args&&... args) -> std::future<decltype(task(args...))> {
+    SmallTask wrapped;
+    auto future = wrapTask(&wrapped, std::forward<Task>(task), std::forward<Args>(args)...);
+    if (!enqueue(true, std::move(wrapped))) {
+        using FutureType = decltype(task(args...));
+        return std::future<FutureType>();
+    }
+    return future;
+}
+
+template <typename Task>
+bool Strand::execute(Task task) {
+    return enqueue(false, SmallTask(std::move(task)));
+}
+
+inline Strand::Strand(std::shared_ptr<ThreadPool> pool) : Strand{TAG, pool} {
+}
+
+inline Strand::Strand(const std::string& name, std::shared_ptr<ThreadPool> pool) : m_state{std::make_shared<State>()} {
+    m_state->pool = pool;
+    m_state->metrics = ExecutorMetrics::create(name);
+    if (!pool) {
+        logger::acsdkError(logger::LogEntry(TAG, "StrandFailed").d("reason", "nullPool"));
+        m_state->shutdown = true;
+    }
+}
+
+inline Strand::~Strand() {
+    shutdown();
+}
+
+inline void Strand::waitForSubmittedTasks() {
+    std::promise<void> flushedPromise;
+    auto flushedFuture = flushedPromise.get_future();
+    auto task = [&flushedPromise]() { flushedPromise.set_value(); };
+    if (submit(task).valid()) {
+        flushedFuture.get();
+    }
+}
+
+inline void Strand::shutdown() {
+    PooledTaskQueue dropped(0);
+    {
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        m_state->shutdown = true;
+        dropped.swap(m_state->queue);
+
+        // Like Executor::shutdown(), wait for a running task to finish - unless we are that task.
+        if (m_state->runner != std::this_thread::get_id()) {
+            m_state->idle.wait(lock, [this] { return !m_state->scheduled; });
+        }
+    }
+    // Dropped tasks are destroyed (and their promises broken) outside the lock, when dropped goes out of scope.
+}
+
+inline bool Strand::isShutdown() {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->shutdown;
+}
+
+inline std::shared_ptr<ExecutorMetrics> Strand::getMetrics() const {
+    return m_state->metrics;
+}
+
+inline bool Strand::enqueue(bool front, SmallTask task) {
+    bool collectMetrics = ExecutorMetrics::isEnabled();
+    auto queuedAt = collectMetrics ? std::chrono::steady_clock::now() : PooledTaskQueue::TimePoint();
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->shutdown) {
+            return false;
+        }
+        if (front) {
+            m_state->queue.pushFront(std::move(task), queuedAt);
+        } else {
+            m_state->queue.pushBack(std::move(task), queuedAt);
+        }
+        if (collectMetrics) {
+            m_state->metrics->onTaskQueued(m_state->queue.size());
+        }
+        if (m_state->scheduled) {
+            return true;
+        }
+        m_state->scheduled = true;
+    }
+
+    return schedule(m_state);
+}
+
+inline bool Strand::schedule(std::shared_ptr<State> state) {
+    if (state->pool->post([state] { drain(state); })) {
+        return true;
+    }
+    logger::acsdkError(logger::LogEntry(TAG, "scheduleFailed").d("reason", "poolShutdown"));
+    PooledTaskQueue dropped(0);
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->shutdown = true;
+        dropped.swap(state->queue);
+        state->scheduled = false;
+        state->idle.notify_all();
+    }
+    // Dropped tasks are destroyed (and their promises broken) outside the lock, when dropped goes out of scope.
+    return false;
+}
+
+inline void Strand::drain(std::shared_ptr<State> state) {
+    for (size_t count = 0; count < MAX_TASKS_PER_TURN; ++count) {
+        SmallTask task;
+        PooledTaskQueue::TimePoint queuedAt;
+        size_t queueDepth = 0;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->shutdown || !state->queue.popFront(&task, &queuedAt)) {
+                state->runner = std::thread::id();
+                state->scheduled = false;
+                state->idle.notify_all();
+                return;
+            }
+            state->runner = std::this_thread::get_id();
+            queueDepth = state->queue.size();
+        }
+
+        // Only measure tasks which were time stamped, i.e. queued while metrics were enabled.
+        if (PooledTaskQueue::TimePoint() == queuedAt || !ExecutorMetrics::isEnabled()) {
+            task();
+            continue;
+        }
+        auto startedAt = std::chrono::steady_clock::now();
+        state->metrics->onTaskStarted(queueDepth, startedAt - queuedAt);
+        task();
+        state->metrics->onTaskCompleted(std::chrono::steady_clock::now() - startedAt);
+    }
+
+    // Yield the worker to other strands; we stay scheduled, so ordering is unaffected.
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->runner = std::thread::id();
+        if (state->queue.empty() || state->shutdown) {
+            state->scheduled = false;
+            state->idle.notify_all();
+            return;
+        }
+    }
+    schedule(state);
+}
+
+}  // namespace threading
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_STRAND_H_
@@ -19,12 +19,17 @@
 #include <atomic>
 #include <condition_variable>
 #include <deque>
+#include <exception>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <type_traits>
 #include <utility>
 
+#include "AVSCommon/Utils/Threading/SmallTask.h"
+
 namespace alexaClientSDK {
 namespace avsCommon {
 namespace utils {
@@ -64,6 +69,17 @@ public:
     template <typename Task, typename... Args>
     auto pushToFront(Task task, Args&&... args) -> std::future<decltype(task(args...))>;
 
+    /**
+     * Pushes a task on the back of the queue without a future.  This is the cheapest way to queue work: the only
+     * allocations are the queued @c std::function and, if the task does not fit in its small buffer, a copy of the
+     * task.  @c push() also allocates a promise and a shared copy of the bound task.
+     *
+     * @param task A copyable callable type taking no arguments.  Its return value, if any, is discarded.
+     * @return @c false if the queue is shutdown and the task was dropped, else @c true.
+     */
+    template <typename Task>
+    bool post(Task task);
+
     /**
      * Returns and removes the task at the front of the queue. If there are no tasks, this call will block until there
      * is one. A @c nullptr will be returned if there are no more tasks expected.
@@ -128,6 +144,22 @@ auto TaskQueue::pushToFront(Task task, Args&&... args) -> std::future<decltype(t
     return pushTo(front, std::forward<Task>(task), std::forward<Args>(args)...);
 }
 
+template <typename Task>
+bool TaskQueue::post(Task task) {
+    std::unique_ptr<std::function<void()>> translated_task(new std::function<void()>(std::move(task)));
+
+    {
+        std::lock_guard<std::mutex> queueLock{m_queueMutex};
+        if (m_shutdown) {
+            return false;
+        }
+        m_queue.emplace_back(std::move(translated_task));
+    }
+
+    m_queueChanged.notify_all();
+    return true;
+}
+
 /**
  * Utility function which waits for a @c std::future to be fulfilled and forward the result to a @c std::promise.
  *
@@ -151,51 +183,200 @@ inline void forwardPromise<void>(std::shared_ptr<std::promise<void>> promise, st
     promise->set_value();
 }
 
-template <typename Task, typename... Args>
-auto TaskQueue::pushTo(bool front, Task task, Args&&... args) -> std::future<decltype(task(args...))> {
-    // Remove arguments from the tasks type by binding the arguments to the task.
-    auto boundTask = std::bind(std::forward<Task>(task), std::forward<Args>(args)...);
+/**
+ * A move-only task which calls a callable and fulfills a @c std::promise with its result (or exception).
+ *
+ * Note: A std::packaged_task fulfills its future *during* the call to operator().  If the user of a std::packaged_task
+ * hands it off to another thread to execute, and then waits on the future, they will be able to retrieve the return
+ * value from the task and know that the task has executed, but they do not know exactly when the task object has been
+ * deleted.  This distinction can be significant if the packaged task is holding onto resources that need to be freed
+ * (through a std::shared_ptr for example).  A PromisedTask therefore destroys the callable *before* fulfilling the
+ * promise, and needs no allocations beyond the promise's shared state.
+ */
+template <typename Result, typename Callable>
+class PromisedTask {
+public:
+    /**
+     * Constructor.
+     *
+     * @param callable The callable to run.
+     */
+    explicit PromisedTask(Callable callable);
 
-    /*
-     * Create a std::packaged_task with the correct return type. The decltype only returns the return value of the
-     * boundTask. The following parentheses make it a function call with the boundTask return type. The package task
-     * will then return a future of the correct type.
+    /**
+     * Move constructor.
      *
-     * Note: A std::packaged_task fulfills its future *during* the call to operator().  If the user of a
-     * std::packaged_task hands it off to another thread to execute, and then waits on the future, they will be able to
-     * retrieve the return value from the task and know that the task has executed, but they do not know exactly when
-     * the task object has been deleted.  This distinction can be significant if the packaged task is holding onto
-     * resources that need to be freed (through a std::shared_ptr for example).  If the user needs to wait for those
-     * resources to be freed they have no way of knowing how long to wait.  The translated_task lambda below is a
-     * workaround for this limitation.  It executes the packaged task, then disposes of it before passing the task's
-     * return value back to the future that the user is waiting on.
+     * @param other The task to move from, which is left without a callable.
      */
-    using PackagedTaskType = std::packaged_task<decltype(boundTask())()>;
-    auto packaged_task = std::make_shared<PackagedTaskType>(boundTask);
-
-    // Create a promise/future that we will fulfill when we have cleaned up the task.
-    auto cleanupPromise = std::make_shared<std::promise<decltype(task(args...))>>();
-    auto cleanupFuture = cleanupPromise->get_future();
-
-    // Remove the return type from the task by wrapping it in a lambda with no return value.
-    auto translated_task = [packaged_task, cleanupPromise]() mutable {
-        // Execute the task.
-        packaged_task->operator()();
-        // Note the future for the task's result.
-        auto taskFuture = packaged_task->get_future();
-        // Clean up the task.
-        packaged_task.reset();
-        // Forward the task's result to our cleanup promise/future.
-        forwardPromise(cleanupPromise, &taskFuture);
-    };
-
-    // Release our local reference to packaged task so that the only remaining reference is inside the lambda.
-    packaged_task.reset();
+    PromisedTask(PromisedTask&& other) noexcept(std::is_nothrow_move_constructible<Callable>::value);
+
+    /// Destructor.  If the task has not run, the promise is broken.
+    ~PromisedTask();
+
+    /// @return The future for the task's result.  May only be called once.
+    std::future<Result> getFuture();
+
+    /// Runs the callable, destroys it, and then fulfills the promise.  Does nothing if called again.
+    void operator()();
+
+    /// Deleted copy constructor.
+    PromisedTask(const PromisedTask&) = delete;
+
+    /// Deleted assignment operator.
+    PromisedTask& operator=(const PromisedTask&) = delete;
+
+private:
+    /// @return The stored callable.
+    Callable& callable();
+
+    /// Destroys the stored callable.
+    void destroyCallable();
+
+    /// Runs a callable returning @c void.
+    void run(std::true_type);
+
+    /// Runs a callable returning a value.
+    void run(std::false_type);
+
+    /// The promise to fulfill.
+    std::promise<Result> m_promise;
+
+    /// Storage for the callable, which is destroyed before @c m_promise is fulfilled.
+    typename std::aligned_storage<sizeof(Callable), alignof(Callable)>::type m_storage;
+
+    /// Whether @c m_storage holds a callable.
+    bool m_hasCallable;
+};
+
+template <typename Result, typename Callable>
+PromisedTask<Result, Callable>::PromisedTask(Callable callable) : m_hasCallable{true} {
+    new (&m_storage) Callable(std::move(callable));
+}
+
+template <typename Result, typename Callable>
+PromisedTask<Result, Callable>::PromisedTask(PromisedTask&& other) noexcept(
+    std::is_nothrow_move_constructible<Callable>::value) :
+        m_promise{std::move(other.m_promise)},
+        m_hasCallable{other.m_hasCallable} {
+    if (m_hasCallable) {
+        new (&m_storage) Callable(std::move(other.callable()));
+        other.destroyCallable();
+    }
+}
+
+template <typename Result, typename Callable>
+PromisedTask<Result, Callable>::~PromisedTask() {
+    destroyCallable();
+}
+
+template <typename Result, typename Callable>
+std::future<Result> PromisedTask<Result, Callable>::getFuture() {
+    return m_promise.get_future();
+}
+
+template <typename Result, typename Callable>
+void PromisedTask<Result, Callable>::operator()() {
+    if (!m_hasCallable) {
+        return;
+    }
+    try {
+        run(std::is_void<Result>());
+    } catch (...) {
+        destroyCallable();
+        m_promise.set_exception(std::current_exception());
+    }
+}
+
+template <typename Result, typename Callable>
+Callable& PromisedTask<Result, Callable>::callable() {
+    return *reinterpret_cast<Callable*>(&m_storage);
+}
+
+template <typename Result, typename Callable>
+void PromisedTask<Result, Callable>::destroyCallable() {
+    if (m_hasCallable) {
+        m_hasCallable = false;
+        callable().~Callable();
+    }
+}
+
+template <typename Result, typename Callable>
+void PromisedTask<Result, Callable>::run(std::true_type) {
+    callable()();
+    destroyCallable();
+    m_promise.set_value();
+}
+
+template <typename Result, typename Callable>
+void PromisedTask<Result, Callable>::run(std::false_type) {
+    Result result = callable()();
+    destroyCallable();
+    m_promise.set_value(std::forward<Result>(result));
+}
+
+/**
+ * Utility function which creates a @c PromisedTask, deducing the callable type.
+ *
+ * @param callable The callable to run.
+ * @return The new @c PromisedTask.
+ */
+template <typename Result, typename Callable>
+PromisedTask<Result, Callable> makePromisedTask(Callable callable) {
+    return PromisedTask<Result, Callable>(std::move(callable));
+}
+
+/**
+ * Utility function which binds a task to its arguments and wraps it in a @c std::function<void()>, so that it can be
+ * queued and later run without knowing its return type.
+ *
+ * @param[out] wrappedTask Receives the wrapped task.
+ * @param task A callable type representing a task.
+ * @param args The arguments to call the task with.
+ * @returns A @c std::future which is fulfilled with the return value of the task once the task has run *and* the task
+ *     object has been destroyed.
+ */
+template <typename Task, typename... Args>
+auto wrapTask(std::function<void()>* wrappedTask, Task task, Args&&... args) -> std::future<decltype(task(args...))> {
+    // Remove arguments from the tasks type by binding the arguments to the task.
+    auto promisedTask =
+        makePromisedTask<decltype(task(args...))>(std::bind(std::forward<Task>(task), std::forward<Args>(args)...));
+    auto future = promisedTask.getFuture();
+
+    // std::function requires a copyable callable, so share the move-only task.
+    auto sharedTask = std::make_shared<decltype(promisedTask)>(std::move(promisedTask));
+    *wrappedTask = [sharedTask]() { (*sharedTask)(); };
+    return future;
+}
+
+/**
+ * Utility function which binds a task to its arguments and wraps it in a @c SmallTask.  Unlike the
+ * @c std::function overload, the only allocation is the future's shared state, as long as the bound task fits in
+ * @c SmallTask::INLINE_CAPACITY.
+ *
+ * @param[out] wrappedTask Receives the wrapped task.
+ * @param task A callable type representing a task.
+ * @param args The arguments to call the task with.
+ * @returns A @c std::future which is fulfilled with the return value of the task once the task has run *and* the task
+ *     object has been destroyed.
+ */
+template <typename Task, typename... Args>
+auto wrapTask(SmallTask* wrappedTask, Task task, Args&&... args) -> std::future<decltype(task(args...))> {
+    auto promisedTask =
+        makePromisedTask<decltype(task(args...))>(std::bind(std::forward<Task>(task), std::forward<Args>(args)...));
+    auto future = promisedTask.getFuture();
+    *wrappedTask = std::move(promisedTask);
+    return future;
+}
+
+template <typename Task, typename... Args>
+auto TaskQueue::pushTo(bool front, Task task, Args&&... args) -> std::future<decltype(task(args...))> {
+    std::unique_ptr<std::function<void()>> translated_task(new std::function<void()>());
+    auto cleanupFuture = wrapTask(translated_task.get(), std::forward<Task>(task), std::forward<Args>(args)...);
 
     {
         std::lock_guard<std::mutex> queueLock{m_queueMutex};
         if (!m_shutdown) {
-            m_queue.emplace(front ? m_queue.begin() : m_queue.end(), new std::function<void()>(translated_task));
+            m_queue.emplace(front ? m_queue.begin() : m_queue.end(), std::move(translated_task));
         } else {
             using FutureType = decltype(task(args...));
             return std::future<FutureType>();
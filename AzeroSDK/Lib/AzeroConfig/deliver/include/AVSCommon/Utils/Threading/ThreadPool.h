@@ -0,0 +1,325 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_THREADPOOL_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_THREADPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AVSCommon/Utils/Configuration/ConfigurationNode.h"
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+#include "AVSCommon/Utils/Threading/PooledTaskQueue.h"
+#include "AVSCommon/Utils/Threading/SmallTask.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace threading {
+
+/**
+ * A fixed-size pool of worker threads shared by the whole engine.  Each worker owns a queue of tasks; a worker which
+ * runs out of work steals from the back of its siblings' queues before parking.  Tasks posted from a worker thread go
+ * to that worker's own queue, and tasks posted from other threads are spread round-robin.
+ *
+ * The pool makes no ordering guarantees between tasks.  Components which need serial, FIFO execution (as with an
+ * @c Executor) should submit through a @c Strand.
+ */
+class ThreadPool {
+public:
+    /**
+     * Creates a pool.
+     *
+     * @param threadCount The number of worker threads.  Must be at least 1; values above @c MAX_THREADS are clamped.
+     * @return The new pool, or @c nullptr if @c threadCount is invalid.
+     */
+    static std::shared_ptr<ThreadPool> create(size_t threadCount);
+
+    /**
+     * Returns the engine-wide pool, creating it on first use.  The thread count is read from the @c threadCount key of
+     * the @c threadPool node of the SDK configuration, and defaults to the number of CPU cores, clamped to
+     * [ @c DEFAULT_MIN_THREADS, @c DEFAULT_MAX_THREADS ].
+     *
+     * @return The engine-wide pool.
+     */
+    static std::shared_ptr<ThreadPool> getDefaultThreadPool();
+
+    /// The destructor stops and joins the worker threads.  Tasks which have not started are dropped.
+    ~ThreadPool();
+
+    /**
+     * Queues a task to run on one of the workers.  Once the worker queues have grown to their working depth, posting a
+     * task which fits in @c SmallTask::INLINE_CAPACITY does not allocate.
+     *
+     * @param task The task to run.
+     * @return @c false if the pool has been shut down, else @c true.
+     */
+    bool post(SmallTask task);
+
+    /// @return The number of worker threads.
+    size_t getThreadCount() const;
+
+    /// Stops and joins the worker threads.  Tasks which have not started are dropped.
+    void shutdown();
+
+    /// The configuration node holding the pool settings.
+    static constexpr const char* CONFIG_KEY_ROOT = "threadPool";
+
+    /// The configuration key holding the number of worker threads.
+    static constexpr const char* CONFIG_KEY_THREAD_COUNT = "threadCount";
+
+    /// Lower bound of the default thread count.
+    static constexpr size_t DEFAULT_MIN_THREADS = 2;
+
+    /// Upper bound of the default thread count.
+    static constexpr size_t DEFAULT_MAX_THREADS = 4;
+
+    /// Upper bound of any pool's thread count, including one read from the configuration.
+    static constexpr size_t MAX_THREADS = 32;
+
+    /// Deleted copy constructor.
+    ThreadPool(const ThreadPool&) = delete;
+
+    /// Deleted assignment operator.
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    /// The per-worker queue of tasks.
+    struct WorkerQueue {
+        /// Protects @c tasks.
+        std::mutex mutex;
+
+        /// Tasks waiting to run.  The owner pops from the front; thieves take from the back.
+        PooledTaskQueue tasks;
+    };
+
+    /**
+     * Constructor.  Starts the worker threads.
+     *
+     * @param threadCount The number of worker threads.
+     */
+    explicit ThreadPool(size_t threadCount);
+
+    /**
+     * The loop run by each worker thread.
+     *
+     * @param index The index of the worker's queue in @c m_queues.
+     */
+    void workerLoop(size_t index);
+
+    /**
+     * Takes the next task for a worker, from its own queue if possible, else by stealing from another worker.
+     *
+     * @param index The index of the worker's queue in @c m_queues.
+     * @param[out] task Receives the task.
+     * @return @c true if a task was found, else @c false.
+     */
+    bool takeTask(size_t index, SmallTask* task);
+
+    /**
+     * Identifies the pool and worker (if any) the calling thread belongs to.
+     *
+     * @return A reference to the calling thread's (pool, index) slot.
+     */
+    static std::pair<const ThreadPool*, size_t>& currentWorker();
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "ThreadPool";
+
+    /// One queue per worker.
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+    /// The worker threads.
+    std::vector<std::thread> m_threads;
+
+    /// The number of tasks queued across all workers.
+    std::atomic<size_t> m_pendingTasks;
+
+    /// The number of workers parked on @c m_wakeTrigger.
+    std::atomic<size_t> m_parkedWorkers;
+
+    /// Round-robin cursor for tasks posted from outside the pool.
+    std::atomic<size_t> m_nextQueue;
+
+    /// Flag which tells the workers to exit.
+    std::atomic_bool m_shutdown;
+
+    /// Protects parking and waking of workers.
+    std::mutex m_wakeMutex;
+
+    /// Wakes a parked worker when a task is posted.
+    std::condition_variable m_wakeTrigger;
+};
+
+inline std::shared_ptr<ThreadPool> ThreadPool::create(size_t threadCount) {
+    if (0 == threadCount) {
+        logger::acsdkError(logger::LogEntry(TAG, "createFailed").d("reason", "zeroThreadCount"));
+        return nullptr;
+    }
+    if (threadCount > MAX_THREADS) {
+        // Copy the bound so that the log entry does not odr-use the static member.
+        size_t maxThreads = MAX_THREADS;
+        logger::acsdkWarn(logger::LogEntry(TAG, "createThreadCountClamped")
+                              .d("threadCount", threadCount)
+                              .d("maxThreads", maxThreads));
+        threadCount = maxThreads;
+    }
+    return std::shared_ptr<ThreadPool>(new ThreadPool(threadCount));
+}
+
+inline std::shared_ptr<ThreadPool> ThreadPool::getDefaultThreadPool() {
+    static std::shared_ptr<ThreadPool> defaultPool = [] {
+        // Copy the bounds so that std::min/std::max do not odr-use the static members.
+        size_t minThreads = DEFAULT_MIN_THREADS;
+        size_t maxThreads = DEFAULT_MAX_THREADS;
+        size_t threadCount = std::min(maxThreads, std::max(minThreads, size_t(std::thread::hardware_concurrency())));
+        int configuredCount = 0;
+        auto configRoot = configuration::ConfigurationNode::getRoot()[std::string(CONFIG_KEY_ROOT)];
+        if (configRoot.getInt(CONFIG_KEY_THREAD_COUNT, &configuredCount) && configuredCount > 0) {
+            threadCount = configuredCount;
+        }
+        logger::acsdkInfo(logger::LogEntry(TAG, "getDefaultThreadPool").d("threadCount", threadCount));
+        return create(threadCount);
+    }();
+    return defaultPool;
+}
+
+inline ThreadPool::ThreadPool(size_t threadCount) :
+        m_pendingTasks{0},
+        m_parkedWorkers{0},
+        m_nextQueue{0},
+        m_shutdown{false} {
+    for (size_t index = 0; index < threadCount; ++index) {
+        m_queues.emplace_back(new WorkerQueue);
+    }
+    for (size_t index = 0; index < threadCount; ++index) {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, index);
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+inline bool ThreadPool::post(SmallTask task) {
+    if (m_shutdown) {
+        return false;
+    }
+
+    auto& current = currentWorker();
+    size_t index = (this == current.first) ? current.second : m_nextQueue++ % m_queues.size();
+
+    {
+        // shutdown() sets m_shutdown before it drains the queues under their mutexes, so re-checking it here under
+        // the queue mutex guarantees that no task is queued after that queue has been drained.
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        if (m_shutdown) {
+            return false;
+        }
+        // Count the task before it becomes visible, so that a thief can never take it before it is counted.
+        ++m_pendingTasks;
+        m_queues[index]->tasks.pushBack(std::move(task));
+    }
+
+    // A parking worker bumps m_parkedWorkers under m_wakeMutex before re-checking m_pendingTasks.  Both are
+    // sequentially consistent, so either it sees this task, or we see it parked and notify it under the mutex.
+    if (m_parkedWorkers > 0) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeTrigger.notify_one();
+    }
+    return true;
+}
+
+inline size_t ThreadPool::getThreadCount() const {
+    return m_threads.size();
+}
+
+inline void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (m_shutdown) {
+            return;
+        }
+        m_shutdown = true;
+    }
+    m_wakeTrigger.notify_all();
+    for (auto& thread : m_threads) {
+        if (thread.get_id() == std::this_thread::get_id()) {
+            // The pool may be destroyed as soon as we return, so tell the worker loop not to touch it again.
+            logger::acsdkWarn(logger::LogEntry(TAG, "shutdown").d("reason", "calledFromWorker"));
+            currentWorker() = std::make_pair(nullptr, 0);
+            thread.detach();
+        } else if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    // m_shutdown is already set, so post() rejects any task which reaches a queue after it has been drained.
+    for (auto& queue : m_queues) {
+        PooledTaskQueue dropped(0);
+        {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            dropped.swap(queue->tasks);
+        }
+    }
+}
+
+inline void ThreadPool::workerLoop(size_t index) {
+    currentWorker() = std::make_pair(this, index);
+    SmallTask task;
+    while (!m_shutdown) {
+        if (takeTask(index, &task)) {
+            task();
+            // Destroying the task may release the last reference to this pool (see shutdown()).
+            task = SmallTask();
+            if (currentWorker().first != this) {
+                return;
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        ++m_parkedWorkers;
+        m_wakeTrigger.wait(lock, [this] { return m_shutdown || m_pendingTasks > 0; });
+        --m_parkedWorkers;
+    }
+}
+
+inline bool ThreadPool::takeTask(size_t index, SmallTask* task) {
+    for (size_t offset = 0; offset < m_queues.size(); ++offset) {
+        auto& queue = *m_queues[(index + offset) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (0 == offset ? queue.tasks.popFront(task) : queue.tasks.popBack(task)) {
+            --m_pendingTasks;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline std::pair<const ThreadPool*, size_t>& ThreadPool::currentWorker() {
+    static thread_local std::pair<const ThreadPool*, size_t> worker{nullptr, 0};
+    return worker;
+}
+
+}  // namespace threading
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_THREADING_THREADPOOL_H_
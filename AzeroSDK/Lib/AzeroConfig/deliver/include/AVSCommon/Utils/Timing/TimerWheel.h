@@ -0,0 +1,508 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_TIMING_TIMERWHEEL_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_TIMING_TIMERWHEEL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+#include "AVSCommon/Utils/Threading/SmallTask.h"
+#include "AVSCommon/Utils/Threading/ThreadPool.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace timing {
+
+/**
+ * A hierarchical timer wheel which runs every timer in the engine from a single thread.  Scheduling and cancelling
+ * are O(1).  Expired tasks are posted to a @c ThreadPool rather than run on the wheel thread, so a slow task does not
+ * stop the wheel from expiring other timers.  It does occupy a pool worker, though, and once every worker is busy,
+ * expired tasks wait for one.  Timers which need to be isolated from other work should be given a wheel with a pool of
+ * their own.
+ *
+ * The wheel has @c LEVELS levels of @c SLOTS slots each.  Level 0 has one slot per tick; each higher level covers
+ * @c SLOTS times the span of the one below, and its slots are redistributed ("cascaded") to lower levels as time
+ * reaches them.  Timers fire on the first tick at or after their deadline, so they may be up to one tick late, but
+ * never early.  While no timers are pending, the wheel thread sleeps without waking.
+ */
+class TimerWheel {
+public:
+    /// Identifies a scheduled timer.
+    using TimerId = uint64_t;
+
+    /// A @c TimerId which never identifies a timer.
+    static constexpr TimerId INVALID_TIMER_ID = 0;
+
+    /**
+     * Creates a timer wheel with its own thread.
+     *
+     * @param tick The duration of one tick, which is the resolution of the wheel.  Must be positive.  Defaults to 10ms.
+     * @param pool The pool to run expired tasks on.
+     * @return The new wheel, or @c nullptr if the arguments are invalid.
+     */
+    static std::shared_ptr<TimerWheel> create(
+        std::chrono::milliseconds tick = std::chrono::milliseconds(10),
+        std::shared_ptr<threading::ThreadPool> pool = threading::ThreadPool::getDefaultThreadPool());
+
+    /**
+     * Returns the engine-wide timer wheel, creating it on first use.
+     *
+     * @return The engine-wide timer wheel.
+     */
+    static std::shared_ptr<TimerWheel> getDefaultTimerWheel();
+
+    /// The destructor stops the wheel thread.  Pending tasks are dropped.
+    ~TimerWheel();
+
+    /**
+     * Schedules a task to run at a point in time.
+     *
+     * @param deadline The earliest time at which to run @c task.  Past deadlines run on the next tick.
+     * @param task The task to run.
+     * @return An id which may be passed to @c cancel(), or @c INVALID_TIMER_ID if the wheel has been shut down.
+     */
+    TimerId schedule(std::chrono::steady_clock::time_point deadline, threading::SmallTask task);
+
+    /**
+     * Schedules a task to run after a delay.
+     *
+     * @param delay The minimum time to wait before running @c task.
+     * @param task The task to run.
+     * @return An id which may be passed to @c cancel(), or @c INVALID_TIMER_ID if the wheel has been shut down.
+     */
+    template <typename Rep, typename Period>
+    TimerId schedule(const std::chrono::duration<Rep, Period>& delay, threading::SmallTask task);
+
+    /**
+     * Cancels a scheduled task.  The task is destroyed without running.
+     *
+     * @param id The id returned by @c schedule().
+     * @return @c true if the task was cancelled, or @c false if it has already been handed to the pool (or the id is
+     *     unknown).
+     */
+    bool cancel(TimerId id);
+
+    /// Stops the wheel thread.  Pending tasks are dropped, and further calls to @c schedule() fail.
+    void shutdown();
+
+    /// Deleted copy constructor.
+    TimerWheel(const TimerWheel&) = delete;
+
+    /// Deleted assignment operator.
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+private:
+    /// The number of bits of the tick count covered by each level.
+    static constexpr unsigned SLOT_BITS = 6;
+
+    /// The number of slots in each level.
+    static constexpr size_t SLOTS = 1 << SLOT_BITS;
+
+    /// The number of levels.  With 10ms ticks, four levels span about 46 hours; later timers are cascaded repeatedly.
+    static constexpr size_t LEVELS = 4;
+
+    /// Marks the end of an entry list.
+    static constexpr uint32_t NIL = std::numeric_limits<uint32_t>::max();
+
+    /// A scheduled timer.  Entries live in @c m_entries and are chained by index, so cancelling needs no search.
+    struct Entry {
+        /// The tick on which the timer fires.
+        uint64_t expiry;
+
+        /// The task to run.
+        threading::SmallTask task;
+
+        /// Incremented each time the entry is freed, so that stale @c TimerIds do not match.
+        uint32_t generation;
+
+        /// The slot list holding the entry, as an index into @c m_slots.
+        uint32_t slot;
+
+        /// The previous entry in the slot list.
+        uint32_t previous;
+
+        /// The next entry in the slot list, or the next free entry.
+        uint32_t next;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param tick The duration of one tick.
+     * @param pool The pool to run expired tasks on.
+     */
+    TimerWheel(std::chrono::steady_clock::duration tick, std::shared_ptr<threading::ThreadPool> pool);
+
+    /// The loop run by the wheel thread.
+    void wheelLoop();
+
+    /**
+     * Converts a point in time to a tick count, rounding down.
+     *
+     * @param time The point in time.
+     * @return The number of whole ticks between the start of the wheel and @c time.
+     */
+    uint64_t toTick(std::chrono::steady_clock::time_point time) const;
+
+    /**
+     * Advances the wheel to a tick, cascading higher levels and collecting the tasks which expire on the way.
+     * @c m_mutex must be held.
+     *
+     * @param tick The tick to advance to.
+     * @param[out] expired Receives the expired tasks.
+     */
+    void advanceTo(uint64_t tick, std::vector<threading::SmallTask>* expired);
+
+    /**
+     * Finds the next tick on which the wheel thread has work to do.  @c m_mutex must be held.
+     *
+     * @return The next occupied level-0 slot in the current rotation, or the start of the next rotation.
+     */
+    uint64_t nextEventTick() const;
+
+    /**
+     * Adds an entry to the slot for its expiry.  @c m_mutex must be held.
+     *
+     * @param index The entry's index in @c m_entries.
+     */
+    void link(uint32_t index);
+
+    /**
+     * Removes an entry from its slot.  @c m_mutex must be held.
+     *
+     * @param index The entry's index in @c m_entries.
+     */
+    void unlink(uint32_t index);
+
+    /**
+     * Returns an entry to the free list.  @c m_mutex must be held.
+     *
+     * @param index The entry's index in @c m_entries.
+     */
+    void release(uint32_t index);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "TimerWheel";
+
+    /// The duration of one tick.
+    const std::chrono::steady_clock::duration m_tick;
+
+    /// The time of tick 0.
+    const std::chrono::steady_clock::time_point m_start;
+
+    /// The pool to run expired tasks on.
+    std::shared_ptr<threading::ThreadPool> m_pool;
+
+    /// Protects the members below.
+    std::mutex m_mutex;
+
+    /// Wakes the wheel thread when an earlier timer is scheduled, or on shutdown.
+    std::condition_variable m_wakeTrigger;
+
+    /// All entries, live and free.
+    std::vector<Entry> m_entries;
+
+    /// The head of each slot list; slot @c s of level @c l is at <tt>l * SLOTS + s</tt>.
+    uint32_t m_slots[LEVELS * SLOTS];
+
+    /// The head of the free entry list.
+    uint32_t m_free;
+
+    /// The number of pending timers.
+    size_t m_pendingTimers;
+
+    /// The last tick processed.
+    uint64_t m_currentTick;
+
+    /// The tick the wheel thread is sleeping until, or the maximum value if it is sleeping until woken.
+    uint64_t m_wakeTick;
+
+    /// Whether the wheel has been shut down.
+    bool m_shutdown;
+
+    /// The wheel thread.
+    std::thread m_thread;
+};
+
+template <typename Rep, typename Period>
+TimerWheel::TimerId TimerWheel::schedule(const std::chrono::duration<Rep, Period>& delay, threading::SmallTask task) {
+    auto deadline = std::chrono::steady_clock::now();
+    if (delay > std::chrono::duration<Rep, Period>::zero()) {
+        deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+    }
+    return schedule(deadline, std::move(task));
+}
+
+inline std::shared_ptr<TimerWheel> TimerWheel::create(
+    std::chrono::milliseconds tick,
+    std::shared_ptr<threading::ThreadPool> pool) {
+    if (tick <= std::chrono::milliseconds::zero()) {
+        logger::acsdkError(logger::LogEntry(TAG, "createFailed").d("reason", "nonPositiveTick"));
+        return nullptr;
+    }
+    if (!pool) {
+        logger::acsdkError(logger::LogEntry(TAG, "createFailed").d("reason", "nullPool"));
+        return nullptr;
+    }
+    return std::shared_ptr<TimerWheel>(new TimerWheel(tick, pool));
+}
+
+inline std::shared_ptr<TimerWheel> TimerWheel::getDefaultTimerWheel() {
+    static std::shared_ptr<TimerWheel> defaultWheel = create();
+    return defaultWheel;
+}
+
+inline TimerWheel::TimerWheel(std::chrono::steady_clock::duration tick, std::shared_ptr<threading::ThreadPool> pool) :
+        m_tick{tick},
+        m_start{std::chrono::steady_clock::now()},
+        m_pool{pool},
+        m_free{NIL},
+        m_pendingTimers{0},
+        m_currentTick{0},
+        m_wakeTick{std::numeric_limits<uint64_t>::max()},
+        m_shutdown{false} {
+    for (auto& slot : m_slots) {
+        slot = NIL;
+    }
+    m_thread = std::thread(&TimerWheel::wheelLoop, this);
+}
+
+inline TimerWheel::~TimerWheel() {
+    shutdown();
+}
+
+inline TimerWheel::TimerId TimerWheel::schedule(
+    std::chrono::steady_clock::time_point deadline,
+    threading::SmallTask task) {
+    if (!task) {
+        logger::acsdkError(logger::LogEntry(TAG, "scheduleFailed").d("reason", "nullTask"));
+        return INVALID_TIMER_ID;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_shutdown) {
+        logger::acsdkError(logger::LogEntry(TAG, "scheduleFailed").d("reason", "shutdown"));
+        return INVALID_TIMER_ID;
+    }
+
+    // An empty wheel has nothing to cascade, so it can jump straight to the present instead of catching up.
+    if (0 == m_pendingTimers) {
+        m_currentTick = std::max(m_currentTick, toTick(std::chrono::steady_clock::now()));
+    }
+
+    uint32_t index = m_free;
+    if (NIL == index) {
+        index = static_cast<uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+        m_entries[index].generation = 1;
+    } else {
+        m_free = m_entries[index].next;
+    }
+
+    // Round the deadline up to a whole tick, and never schedule into the slot which has already been processed.
+    auto& entry = m_entries[index];
+    entry.expiry = 0;
+    if (deadline > m_start) {
+        entry.expiry = (deadline - m_start + m_tick - std::chrono::steady_clock::duration(1)) / m_tick;
+    }
+    entry.expiry = std::max(entry.expiry, m_currentTick + 1);
+    entry.task = std::move(task);
+    link(index);
+    ++m_pendingTimers;
+
+    if (entry.expiry < m_wakeTick) {
+        m_wakeTrigger.notify_one();
+    }
+    return (static_cast<TimerId>(entry.generation) << 32) | index;
+}
+
+inline bool TimerWheel::cancel(TimerId id) {
+    uint32_t index = static_cast<uint32_t>(id);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    threading::SmallTask task;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (index >= m_entries.size() || m_entries[index].generation != generation || NIL == m_entries[index].slot) {
+            return false;
+        }
+        unlink(index);
+        task = std::move(m_entries[index].task);
+        release(index);
+        --m_pendingTimers;
+    }
+    // The task is destroyed here, outside the lock.
+    return true;
+}
+
+inline void TimerWheel::shutdown() {
+    std::vector<threading::SmallTask> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_shutdown) {
+            return;
+        }
+        m_shutdown = true;
+        for (auto& entry : m_entries) {
+            if (entry.task) {
+                dropped.push_back(std::move(entry.task));
+            }
+        }
+        m_pendingTimers = 0;
+    }
+    m_wakeTrigger.notify_all();
+    if (m_thread.get_id() == std::this_thread::get_id()) {
+        m_thread.detach();
+    } else if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+inline void TimerWheel::wheelLoop() {
+    std::vector<threading::SmallTask> expired;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_shutdown) {
+        if (0 == m_pendingTimers) {
+            m_wakeTick = std::numeric_limits<uint64_t>::max();
+            m_wakeTrigger.wait(lock);
+            continue;
+        }
+
+        uint64_t nowTick = toTick(std::chrono::steady_clock::now());
+        if (nowTick > m_currentTick) {
+            advanceTo(nowTick, &expired);
+        }
+        if (!expired.empty()) {
+            lock.unlock();
+            for (auto& task : expired) {
+                if (!m_pool->post(std::move(task))) {
+                    logger::acsdkError(logger::LogEntry(TAG, "postFailed").d("reason", "poolShutdown"));
+                }
+            }
+            expired.clear();
+            lock.lock();
+            continue;
+        }
+
+        m_wakeTick = nextEventTick();
+        m_wakeTrigger.wait_until(lock, m_start + m_tick * static_cast<std::chrono::steady_clock::rep>(m_wakeTick));
+    }
+}
+
+inline uint64_t TimerWheel::toTick(std::chrono::steady_clock::time_point time) const {
+    return time > m_start ? static_cast<uint64_t>((time - m_start) / m_tick) : 0;
+}
+
+inline void TimerWheel::advanceTo(uint64_t tick, std::vector<threading::SmallTask>* expired) {
+    while (m_currentTick < tick) {
+        ++m_currentTick;
+
+        // At the start of each rotation of a level, move the next slot of the level above down, highest first.
+        size_t level = 0;
+        while (level + 1 < LEVELS && 0 == (m_currentTick & ((uint64_t(1) << (SLOT_BITS * (level + 1))) - 1))) {
+            ++level;
+        }
+        for (; level > 0; --level) {
+            uint32_t& head = m_slots[level * SLOTS + ((m_currentTick >> (SLOT_BITS * level)) & (SLOTS - 1))];
+            uint32_t index = head;
+            head = NIL;
+            while (NIL != index) {
+                uint32_t next = m_entries[index].next;
+                link(index);
+                index = next;
+            }
+        }
+
+        uint32_t& head = m_slots[m_currentTick & (SLOTS - 1)];
+        uint32_t index = head;
+        head = NIL;
+        while (NIL != index) {
+            uint32_t next = m_entries[index].next;
+            expired->push_back(std::move(m_entries[index].task));
+            release(index);
+            --m_pendingTimers;
+            index = next;
+        }
+    }
+}
+
+inline uint64_t TimerWheel::nextEventTick() const {
+    uint64_t rotationStart = m_currentTick & ~uint64_t(SLOTS - 1);
+    for (uint64_t slot = (m_currentTick & (SLOTS - 1)) + 1; slot < SLOTS; ++slot) {
+        if (NIL != m_slots[slot]) {
+            return rotationStart + slot;
+        }
+    }
+    return rotationStart + SLOTS;
+}
+
+inline void TimerWheel::link(uint32_t index) {
+    auto& entry = m_entries[index];
+    uint64_t delta = entry.expiry > m_currentTick ? entry.expiry - m_currentTick : 0;
+    uint64_t expiry = entry.expiry;
+    size_t level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    if (delta >= (uint64_t(1) << (SLOT_BITS * LEVELS))) {
+        // Beyond the span of the wheel: park in the farthest slot, and re-link with the real expiry on cascade.
+        expiry = m_currentTick + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    }
+    entry.slot = static_cast<uint32_t>(level * SLOTS + ((expiry >> (SLOT_BITS * level)) & (SLOTS - 1)));
+    entry.previous = NIL;
+    entry.next = m_slots[entry.slot];
+    if (NIL != entry.next) {
+        m_entries[entry.next].previous = index;
+    }
+    m_slots[entry.slot] = index;
+}
+
+inline void TimerWheel::unlink(uint32_t index) {
+    auto& entry = m_entries[index];
+    if (NIL != entry.previous) {
+        m_entries[entry.previous].next = entry.next;
+    } else {
+        m_slots[entry.slot] = entry.next;
+    }
+    if (NIL != entry.next) {
+        m_entries[entry.next].previous = entry.previous;
+    }
+}
+
+inline void TimerWheel::release(uint32_t index) {
+    auto& entry = m_entries[index];
+    entry.slot = NIL;
+    entry.task = threading::SmallTask();
+    if (0 == ++entry.generation) {
+        entry.generation = 1;
+    }
+    entry.next = m_free;
+    m_free = index;
+}
+
+}  // namespace timing
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_TIMING_TIMERWHEEL_H_
@@ -0,0 +1,416 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#ifndef ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_TIMING_WHEELTIMER_H_
+#define ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_TIMING_WHEELTIMER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "AVSCommon/Utils/Logger/LoggerUtils.h"
+#include "AVSCommon/Utils/Threading/SmallTask.h"
+#include "AVSCommon/Utils/Threading/TaskQueue.h"
+#include "AVSCommon/Utils/Timing/Timer.h"
+#include "AVSCommon/Utils/Timing/TimerWheel.h"
+
+namespace alexaClientSDK {
+namespace avsCommon {
+namespace utils {
+namespace timing {
+
+/**
+ * A @c WheelTimer schedules a callable type to run in the future, with the same interface and semantics as @c Timer,
+ * but without a thread of its own: the waiting is done by a shared @c TimerWheel, and the task runs on the wheel's
+ * @c ThreadPool.  A component can switch by changing the type of its timer member.
+ *
+ * Because the task runs on a shared pool, a call may be delayed while every worker is busy with other work.  Timers
+ * which must not be delayed that way should use a wheel created with a dedicated pool (see @c TimerWheel::create()).
+ *
+ * Timing is accurate to the wheel's tick (10ms for the default wheel); calls are never early.
+ */
+class WheelTimer {
+public:
+    /**
+     * Value for @c start()'s @c maxCount parameter which indicates that the @c WheelTimer should continue firing
+     * indefinitely.
+     */
+    static const size_t FOREVER = Timer::FOREVER;
+
+    /// Specifies different ways to apply the period of a recurring task.
+    using PeriodType = Timer::PeriodType;
+
+    /**
+     * Constructs a @c WheelTimer.
+     *
+     * @param wheel The timer wheel to schedule on.  Defaults to the engine-wide wheel.
+     */
+    explicit WheelTimer(std::shared_ptr<TimerWheel> wheel = TimerWheel::getDefaultTimerWheel());
+
+    /**
+     * Destructs a @c WheelTimer, stopping it if it is active.
+     */
+    ~WheelTimer();
+
+    /**
+     * Submits a callable type to be executed after an initial delay, and then called repeatedly on a fixed time
+     * schedule.  See @c Timer::start().
+     *
+     * @param delay The non-negative time to wait before making the first task call.
+     * @param period The non-negative time to wait between subsequent task calls.
+     * @param periodType The type of period to use when making subsequent task calls.
+     * @param maxCount The desired number of times to call task, or @c FOREVER.
+     * @param task A callable type representing a task.
+     * @param args The arguments to call the task with.
+     * @returns @c true if the timer started, else @c false.
+     */
+    template <typename Rep, typename Period, typename Task, typename... Args>
+    bool start(
+        const std::chrono::duration<Rep, Period>& delay,
+        const std::chrono::duration<Rep, Period>& period,
+        PeriodType periodType,
+        size_t maxCount,
+        Task task,
+        Args&&... args);
+
+    /**
+     * Submits a callable type to be executed repeatedly on a fixed time schedule.  See @c Timer::start().
+     *
+     * @param period The non-negative time to wait before each @c task call.
+     * @param periodType The type of period to use when making subsequent task calls.
+     * @param maxCount The desired number of times to call task, or @c FOREVER.
+     * @param task A callable type representing a task.
+     * @param args The arguments to call @c task with.
+     * @returns @c true if the timer started, else @c false.
+     */
+    template <typename Rep, typename Period, typename Task, typename... Args>
+    bool start(
+        const std::chrono::duration<Rep, Period>& period,
+        PeriodType periodType,
+        size_t maxCount,
+        Task task,
+        Args&&... args);
+
+    /**
+     * Submits a callable type to be executed once, after the specified duration.  See @c Timer::start().
+     *
+     * @param delay The non-negative time to wait before calling @c task.
+     * @param task A callable type representing a task.
+     * @param args The arguments to call @c task with.
+     * @returns A valid @c std::future for the return value of @c task if the timer started, else an invalid
+     *     @c std::future.  Note that the promise will be broken if @c stop() is called before @c task is called.
+     */
+    template <typename Rep, typename Period, typename Task, typename... Args>
+    auto start(const std::chrono::duration<Rep, Period>& delay, Task task, Args&&... args)
+        -> std::future<decltype(task(args...))>;
+
+    /**
+     * Stops the @c WheelTimer (if running).  This will not interrupt an active call to the task, but will prevent any
+     * subsequent calls to the task.  If @c stop() is called while the task is executing, this function will block
+     * until the task completes, unless it is called from inside the task.
+     */
+    void stop();
+
+    /**
+     * Reports whether the @c WheelTimer is active, i.e. waiting to start a call to the task, or in a call to the task.
+     *
+     * @returns @c true if the @c WheelTimer is active, else @c false.
+     */
+    bool isActive() const;
+
+private:
+    /// One run of the timer, from @c start() until its last call or @c stop().
+    struct Run {
+        /// The @c State::generation this run belongs to.
+        uint64_t generation;
+
+        /// The deadline of the next call.
+        std::chrono::steady_clock::time_point deadline;
+
+        /// The time between calls.
+        std::chrono::steady_clock::duration period;
+
+        /// The type of period.
+        PeriodType periodType;
+
+        /// The desired number of calls, or @c FOREVER.
+        size_t maxCount;
+
+        /// The number of calls made so far.
+        size_t count;
+
+        /// The task to call.
+        threading::SmallTask task;
+    };
+
+    /// State shared between the @c WheelTimer and its scheduled calls.
+    struct State {
+        /// The wheel to schedule on.
+        std::shared_ptr<TimerWheel> wheel;
+
+        /// Protects the members below.
+        std::mutex mutex;
+
+        /// Incremented by @c stop() and @c start(), so that calls scheduled by an earlier run are ignored.
+        uint64_t generation = 0;
+
+        /// The id of the scheduled call, if any.
+        TimerWheel::TimerId timerId = TimerWheel::INVALID_TIMER_ID;
+
+        /// Whether a call to the task is in progress.
+        bool inCall = false;
+
+        /// The thread making the call in progress.
+        std::thread::id caller;
+
+        /// Notified when @c inCall becomes @c false.
+        std::condition_variable callDone;
+
+        /// Whether the timer is active.
+        std::atomic<bool> active{false};
+    };
+
+    /**
+     * Starts a run of the timer.
+     *
+     * @param delay The time to wait before the first call.
+     * @param period The time between calls.
+     * @param periodType The type of period.
+     * @param maxCount The desired number of calls, or @c FOREVER.
+     * @param task The task to call.
+     * @return @c true if the timer started, else @c false.
+     */
+    bool startRun(
+        std::chrono::steady_clock::duration delay,
+        std::chrono::steady_clock::duration period,
+        PeriodType periodType,
+        size_t maxCount,
+        threading::SmallTask task);
+
+    /**
+     * Schedules the next call of a run.  @c State::mutex must be held.
+     *
+     * @param state The timer state.
+     * @param run The run.
+     */
+    static void scheduleCall(const std::shared_ptr<State>& state, const std::shared_ptr<Run>& run);
+
+    /**
+     * Makes a call of a run, then schedules the next one.  Runs on the wheel's pool.
+     *
+     * @param state The timer state.
+     * @param run The run.
+     */
+    static void call(std::shared_ptr<State> state, std::shared_ptr<Run> run);
+
+    /// The tag associated with log entries from this class.
+    static constexpr const char* TAG = "WheelTimer";
+
+    /// The shared state.
+    std::shared_ptr<State> m_state;
+};
+
+template <typename Rep, typename Period, typename Task, typename... Args>
+bool WheelTimer::start(
+    const std::chrono::duration<Rep, Period>& delay,
+    const std::chrono::duration<Rep, Period>& period,
+    PeriodType periodType,
+    size_t maxCount,
+    Task task,
+    Args&&... args) {
+    if (delay < std::chrono::duration<Rep, Period>::zero()) {
+        logger::acsdkError(logger::LogEntry(TAG, "startFailed").d("reason", "negativeDelay"));
+        return false;
+    }
+    if (period < std::chrono::duration<Rep, Period>::zero()) {
+        logger::acsdkError(logger::LogEntry(TAG, "startFailed").d("reason", "negativePeriod"));
+        return false;
+    }
+
+    // Remove arguments from the task's type by binding the arguments to the task.
+    return startRun(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay),
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(period),
+        periodType,
+        maxCount,
+        std::bind(std::forward<Task>(task), std::forward<Args>(args)...));
+}
+
+template <typename Rep, typename Period, typename Task, typename... Args>
+bool WheelTimer::start(
+    const std::chrono::duration<Rep, Period>& period,
+    PeriodType periodType,
+    size_t maxCount,
+    Task task,
+    Args&&... args) {
+    return start(period, period, periodType, maxCount, std::forward<Task>(task), std::forward<Args>(args)...);
+}
+
+template <typename Rep, typename Period, typename Task, typename... Args>
+auto WheelTimer::start(const std::chrono::duration<Rep, Period>& delay, Task task, Args&&... args)
+    -> std::future<decltype(task(args...))> {
+    using FutureType = decltype(task(args...));
+    if (delay < std::chrono::duration<Rep, Period>::zero()) {
+        logger::acsdkError(logger::LogEntry(TAG, "startFailed").d("reason", "negativeDelay"));
+        return std::future<FutureType>();
+    }
+
+    threading::SmallTask wrapped;
+    auto future = threading::wrapTask(&wrapped, std::forward<Task>(task), std::forward<Args>(args)...);
+    static const size_t once = 1;
+    auto steadyDelay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+    if (!startRun(steadyDelay, steadyDelay, PeriodType::ABSOLUTE, once, std::move(wrapped))) {
+        return std::future<FutureType>();
+    }
+    return future;
+}
+
+inline WheelTimer::WheelTimer(std::shared_ptr<TimerWheel> wheel) : m_state{std::make_shared<State>()} {
+    m_state->wheel = wheel;
+    if (!wheel) {
+        logger::acsdkError(logger::LogEntry(TAG, "WheelTimerFailed").d("reason", "nullWheel"));
+    }
+}
+
+inline WheelTimer::~WheelTimer() {
+    stop();
+}
+
+inline void WheelTimer::stop() {
+    TimerWheel::TimerId timerId;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        ++m_state->generation;
+        timerId = m_state->timerId;
+        m_state->timerId = TimerWheel::INVALID_TIMER_ID;
+        m_state->active = false;
+    }
+
+    // Cancel outside the lock: cancelling destroys the scheduled call, and with it (if this was the last reference to
+    // its run) the user's task, whose destructor may do anything.  If the call fires first, it sees the new generation
+    // and does nothing.
+    if (m_state->wheel && TimerWheel::INVALID_TIMER_ID != timerId) {
+        m_state->wheel->cancel(timerId);
+    }
+
+    // Like Timer::stop(), wait for a call in progress - unless we are that call.
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    if (m_state->caller != std::this_thread::get_id()) {
+        m_state->callDone.wait(lock, [this] { return !m_state->inCall; });
+    }
+}
+
+inline bool WheelTimer::isActive() const {
+    return m_state->active;
+}
+
+inline bool WheelTimer::startRun(
+    std::chrono::steady_clock::duration delay,
+    std::chrono::steady_clock::duration period,
+    PeriodType periodType,
+    size_t maxCount,
+    threading::SmallTask task) {
+    if (!m_state->wheel) {
+        logger::acsdkError(logger::LogEntry(TAG, "startFailed").d("reason", "nullWheel"));
+        return false;
+    }
+
+    // The run is declared before the lock so that, if it is not started, the task is destroyed outside the lock.
+    auto run = std::make_shared<Run>();
+    run->deadline = std::chrono::steady_clock::now() + delay;
+    run->period = period;
+    run->periodType = periodType;
+    run->maxCount = maxCount;
+    run->count = 0;
+    run->task = std::move(task);
+
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+
+    // Can't start if already running.
+    if (m_state->active) {
+        logger::acsdkError(logger::LogEntry(TAG, "startFailed").d("reason", "timerAlreadyActive"));
+        return false;
+    }
+
+    run->generation = ++m_state->generation;
+    m_state->active = true;
+    scheduleCall(m_state, run);
+    return m_state->active;
+}
+
+inline void WheelTimer::scheduleCall(const std::shared_ptr<State>& state, const std::shared_ptr<Run>& run) {
+    auto nextCall = [state, run] { call(state, run); };
+    state->timerId = state->wheel->schedule(run->deadline, std::move(nextCall));
+    if (TimerWheel::INVALID_TIMER_ID == state->timerId) {
+        logger::acsdkError(logger::LogEntry(TAG, "scheduleCallFailed").d("reason", "wheelShutdown"));
+        state->active = false;
+    }
+}
+
+inline void WheelTimer::call(std::shared_ptr<State> state, std::shared_ptr<Run> run) {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (run->generation != state->generation) {
+            return;
+        }
+        state->timerId = TimerWheel::INVALID_TIMER_ID;
+        state->inCall = true;
+        state->caller = std::this_thread::get_id();
+    }
+
+    run->task();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->inCall = false;
+    state->caller = std::thread::id();
+    state->callDone.notify_all();
+    if (run->generation != state->generation) {
+        return;
+    }
+
+    ++run->count;
+    auto now = std::chrono::steady_clock::now();
+    switch (run->periodType) {
+        case PeriodType::ABSOLUTE:
+            // Keep to the original cadence; periods which passed while the task was running are skipped.  Skipped
+            // periods do not count towards maxCount, so the task is still called maxCount times.
+            run->deadline += run->period;
+            while (run->deadline < now && run->period > std::chrono::steady_clock::duration::zero()) {
+                run->deadline += run->period;
+            }
+            break;
+        case PeriodType::RELATIVE:
+            run->deadline = now + run->period;
+            break;
+    }
+
+    if (FOREVER != run->maxCount && run->count >= run->maxCount) {
+        state->active = false;
+        return;
+    }
+    scheduleCall(state, run);
+}
+
+}  // namespace timing
+}  // namespace utils
+}  // namespace avsCommon
+}  // namespace alexaClientSDK
+
+#endif  // ALEXA_CLIENT_SDK_AVSCOMMON_UTILS_INCLUDE_AVSCOMMON_UTILS_TIMING_WHEELTIMER_H_